@@ -0,0 +1,126 @@
+/*
+	Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+	This file is part of the "Nazara Shading Language - C Binding" project
+	For conditions of distribution and use, see copyright notice in Config.hpp
+*/
+
+#pragma once
+
+#ifndef CNZSL_ASYNCCOMPILER_H
+#define CNZSL_ASYNCCOMPILER_H
+
+#include <CNZSL/Config.h>
+#include <CNZSL/GlslWriter.h>
+#include <CNZSL/LangWriter.h>
+#include <CNZSL/Module.h>
+#include <CNZSL/ShaderStageType.h>
+#include <CNZSL/SpirvWriter.h>
+#include <CNZSL/WriterStates.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct nzslAsyncCompiler nzslAsyncCompiler;
+typedef struct nzslCompileJob nzslCompileJob;
+
+typedef enum
+{
+	NZSL_COMPILE_JOB_PENDING,
+	NZSL_COMPILE_JOB_RUNNING,
+	NZSL_COMPILE_JOB_SUCCEEDED,
+	NZSL_COMPILE_JOB_FAILED,
+	NZSL_COMPILE_JOB_CANCELLED,
+
+	NZSL_COMPILE_JOB_MAX_ENUM = 0x7FFFFFFF
+} nzslCompileJobStatus;
+
+typedef void (*nzslExecutorTask)(void* taskData);
+
+/**
+**  User executor callback, task(taskData) must be called exactly once (from any thread)
+**/
+typedef void (*nzslExecutorCallback)(void* userdata, nzslExecutorTask task, void* taskData);
+
+/**
+**  Creates an async compiler running jobs on its own threads
+**
+** @param threadCount number of worker threads, 0 to use one thread per hardware thread
+**/
+CNZSL_API nzslAsyncCompiler* nzslAsyncCompilerCreate(unsigned int threadCount);
+CNZSL_API nzslAsyncCompiler* nzslAsyncCompilerCreateWithExecutor(nzslExecutorCallback executor, void* userdata);
+
+/**
+**  Destroys the compiler, pending jobs are cancelled and running jobs are waited for (job handles stay valid)
+**/
+CNZSL_API void nzslAsyncCompilerDestroy(nzslAsyncCompiler* compilerPtr);
+
+CNZSL_API void nzslAsyncCompilerCancelAll(nzslAsyncCompiler* compilerPtr);
+
+/**
+**  Gets the last error message set by the last operation to this compiler
+**
+** @param compilerPtr
+** @returns null-terminated error string
+**/
+CNZSL_API const char* nzslAsyncCompilerGetLastError(const nzslAsyncCompiler* compilerPtr);
+
+/**
+**  Queues the generation of a module, which can be freed as soon as the call returns
+**
+** @returns a job handle to destroy with nzslCompileJobDestroy, or null on failure (see nzslAsyncCompilerGetLastError)
+**/
+CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitGlsl(nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslGlslBindingMapping* bindingMapping, const nzslWriterStates* statesPtr, const nzslGlslWriterEnvironment* env, int priority);
+CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitGlslStage(nzslShaderStageType stage, nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslGlslBindingMapping* bindingMapping, const nzslWriterStates* statesPtr, const nzslGlslWriterEnvironment* env, int priority);
+CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitNzsl(nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslWriterStates* statesPtr, int priority);
+CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitSpirv(nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslWriterStates* statesPtr, const nzslSpirvWriterEnvironment* env, int priority);
+
+/**
+**  Releases a job handle, this doesn't cancel the job
+**/
+CNZSL_API void nzslCompileJobDestroy(nzslCompileJob* jobPtr);
+
+/**
+**  Cancels a job which hasn't started yet
+**
+** @returns 1 if the job was cancelled, 0 if it already started
+**/
+CNZSL_API nzslBool nzslCompileJobCancel(nzslCompileJob* jobPtr);
+
+/**
+**  Gets the error message set by the last nzslCompileJobGet*Output call to this job
+**
+** @param jobPtr
+** @returns null-terminated error string
+**/
+CNZSL_API const char* nzslCompileJobGetLastError(const nzslCompileJob* jobPtr);
+CNZSL_API int nzslCompileJobGetPriority(const nzslCompileJob* jobPtr);
+CNZSL_API nzslCompileJobStatus nzslCompileJobGetStatus(const nzslCompileJob* jobPtr);
+
+/**
+**  Waits for the job and returns a copy of its output, which must be destroyed by the caller
+**
+** @returns the output, or null if the job failed or was cancelled (see nzslCompileJobGetLastError)
+**/
+CNZSL_API nzslGlslOutput* nzslCompileJobGetGlslOutput(nzslCompileJob* jobPtr);
+CNZSL_API nzslLangOutput* nzslCompileJobGetNzslOutput(nzslCompileJob* jobPtr);
+CNZSL_API nzslSpirvOutput* nzslCompileJobGetSpirvOutput(nzslCompileJob* jobPtr);
+
+CNZSL_API void nzslCompileJobSetPriority(nzslCompileJob* jobPtr, int priority);
+
+CNZSL_API void nzslCompileJobWait(const nzslCompileJob* jobPtr);
+
+/**
+**  Waits for the job to finish, at most timeoutMs milliseconds
+**
+** @returns 1 if the job is finished, 0 on timeout
+**/
+CNZSL_API nzslBool nzslCompileJobWaitFor(const nzslCompileJob* jobPtr, uint32_t timeoutMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CNZSL_ASYNCCOMPILER_H */
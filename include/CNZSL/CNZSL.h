@@ -9,11 +9,13 @@
 #ifndef CNZSL_CNZSL_H
 #define CNZSL_CNZSL_H
 
+#include <CNZSL/AsyncCompiler.h>
 #include <CNZSL/FilesystemModuleResolver.h>
 #include <CNZSL/GlslWriter.h>
 #include <CNZSL/LangWriter.h>
 #include <CNZSL/Module.h>
 #include <CNZSL/Parser.h>
+#include <CNZSL/PermutationCompiler.h>
 #include <CNZSL/Serializer.h>
 #include <CNZSL/SpirvWriter.h>
 
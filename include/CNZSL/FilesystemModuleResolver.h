@@ -29,6 +29,8 @@ CNZSL_API void nzslFilesystemModuleResolverRegisterDirectory(nzslFilesystemModul
 CNZSL_API void nzslFilesystemModuleResolverRegisterFile(nzslFilesystemModuleResolver* resolverPtr, const char* sourcePath, size_t sourcePathLen);
 CNZSL_API void nzslFilesystemModuleResolverRegisterModule(nzslFilesystemModuleResolver* resolverPtr, const nzslModule* module);
 CNZSL_API void nzslFilesystemModuleResolverRegisterModuleFromSource(nzslFilesystemModuleResolver* resolverPtr, const char* source, size_t sourceLen);
+CNZSL_API void nzslFilesystemModuleResolverSetLazyLoading(nzslFilesystemModuleResolver* resolverPtr, nzslBool lazyLoading);
+CNZSL_API void nzslFilesystemModuleResolverSetThreadCount(nzslFilesystemModuleResolver* resolverPtr, unsigned int threadCount);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,73 @@
+/*
+	Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+	This file is part of the "Nazara Shading Language - C Binding" project
+	For conditions of distribution and use, see copyright notice in Config.hpp
+*/
+
+#pragma once
+
+#ifndef CNZSL_PERMUTATIONCOMPILER_H
+#define CNZSL_PERMUTATIONCOMPILER_H
+
+#include <CNZSL/Config.h>
+#include <CNZSL/GlslWriter.h>
+#include <CNZSL/Module.h>
+#include <CNZSL/ShaderStageType.h>
+#include <CNZSL/SpirvWriter.h>
+#include <CNZSL/WriterStates.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct nzslPermutationCompiler nzslPermutationCompiler;
+typedef struct nzslGlslPermutationOutput nzslGlslPermutationOutput;
+typedef struct nzslSpirvPermutationOutput nzslSpirvPermutationOutput;
+
+CNZSL_API nzslPermutationCompiler* nzslPermutationCompilerCreate(void);
+CNZSL_API void nzslPermutationCompilerDestroy(nzslPermutationCompiler* compilerPtr);
+
+/**
+**  Runs the shared front end (import resolution and partial sanitization) on the module, must be called before generating permutations
+**
+** @param compilerPtr
+** @param modulePtr
+** @param statesPtr states shared by all permutations (module resolver, common options, debug level, etc.), can be null
+** @returns 1 on success, 0 on failure (see nzslPermutationCompilerGetLastError)
+**/
+CNZSL_API nzslBool nzslPermutationCompilerSetModule(nzslPermutationCompiler* compilerPtr, const nzslModule* modulePtr, const nzslWriterStates* statesPtr);
+CNZSL_API void nzslPermutationCompilerSetThreadCount(nzslPermutationCompiler* compilerPtr, unsigned int threadCount);
+
+/**
+**  Generates one output per option set (only option values of the states are used), identical outputs are deduplicated
+**/
+CNZSL_API nzslGlslPermutationOutput* nzslPermutationCompilerGenerateGlsl(nzslPermutationCompiler* compilerPtr, const nzslWriterStates* const* optionSets, size_t optionSetCount, const nzslGlslBindingMapping* bindingMapping, const nzslGlslWriterEnvironment* env);
+CNZSL_API nzslGlslPermutationOutput* nzslPermutationCompilerGenerateGlslStage(nzslShaderStageType stage, nzslPermutationCompiler* compilerPtr, const nzslWriterStates* const* optionSets, size_t optionSetCount, const nzslGlslBindingMapping* bindingMapping, const nzslGlslWriterEnvironment* env);
+CNZSL_API nzslSpirvPermutationOutput* nzslPermutationCompilerGenerateSpirv(nzslPermutationCompiler* compilerPtr, const nzslWriterStates* const* optionSets, size_t optionSetCount, const nzslSpirvWriterEnvironment* env);
+
+/** 
+**  Gets the last error message set by the last operation to this compiler
+**
+** @param compilerPtr
+** @returns null-terminated error string
+**/
+CNZSL_API const char* nzslPermutationCompilerGetLastError(const nzslPermutationCompiler* compilerPtr);
+
+CNZSL_API void nzslGlslPermutationOutputDestroy(nzslGlslPermutationOutput* outputPtr);
+CNZSL_API size_t nzslGlslPermutationOutputGetOptionSetVariant(const nzslGlslPermutationOutput* outputPtr, size_t optionSetIndex);
+CNZSL_API const char* nzslGlslPermutationOutputGetVariantCode(const nzslGlslPermutationOutput* outputPtr, size_t variantIndex, size_t* length);
+CNZSL_API size_t nzslGlslPermutationOutputGetVariantCount(const nzslGlslPermutationOutput* outputPtr);
+
+CNZSL_API void nzslSpirvPermutationOutputDestroy(nzslSpirvPermutationOutput* outputPtr);
+CNZSL_API size_t nzslSpirvPermutationOutputGetOptionSetVariant(const nzslSpirvPermutationOutput* outputPtr, size_t optionSetIndex);
+CNZSL_API const uint32_t* nzslSpirvPermutationOutputGetVariantSpirv(const nzslSpirvPermutationOutput* outputPtr, size_t variantIndex, size_t* length);
+CNZSL_API size_t nzslSpirvPermutationOutputGetVariantCount(const nzslSpirvPermutationOutput* outputPtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CNZSL_PERMUTATIONCOMPILER_H */
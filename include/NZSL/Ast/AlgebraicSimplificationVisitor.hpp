@@ -0,0 +1,65 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_ALGEBRAICSIMPLIFICATIONVISITOR_HPP
+#define NZSL_AST_ALGEBRAICSIMPLIFICATIONVISITOR_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/Module.hpp>
+
+namespace nzsl::Ast
+{
+	// Rewrites algebraic identities (x * 1.0, pow(x, 2.0), abs(abs(x)), ...) and replaces costly operations by cheaper equivalent ones, requires a sanitized AST
+	class NZSL_API AlgebraicSimplificationVisitor : public Cloner
+	{
+		public:
+			struct Options;
+
+			AlgebraicSimplificationVisitor() = default;
+			AlgebraicSimplificationVisitor(const AlgebraicSimplificationVisitor&) = delete;
+			AlgebraicSimplificationVisitor(AlgebraicSimplificationVisitor&&) = delete;
+			~AlgebraicSimplificationVisitor() = default;
+
+			inline std::size_t GetSimplificationCount() const;
+
+			ExpressionPtr Process(Expression& expression, const Options& options);
+			ModulePtr Process(const Module& shaderModule, const Options& options);
+			StatementPtr Process(Statement& statement, const Options& options);
+			void ProcessInPlace(Module& shaderModule, const Options& options);
+
+			AlgebraicSimplificationVisitor& operator=(const AlgebraicSimplificationVisitor&) = delete;
+			AlgebraicSimplificationVisitor& operator=(AlgebraicSimplificationVisitor&&) = delete;
+
+			struct Options
+			{
+				bool fastMath = false; //< allows rewrites changing floating-point results (rounding, NaN/infinities and signed zeros handling)
+				bool optimizeForSize = false; //< skips rewrites which may grow the code (pow(x, 2.0) => x * x)
+			};
+
+		protected:
+			ExpressionPtr Clone(BinaryExpression& node) override;
+			ExpressionPtr Clone(CastExpression& node) override;
+			ExpressionPtr Clone(IntrinsicExpression& node) override;
+			ExpressionPtr Clone(SwizzleExpression& node) override;
+			ExpressionPtr Clone(UnaryExpression& node) override;
+
+		private:
+			ExpressionPtr SimplifyArithmetic(BinaryExpression& node);
+			ExpressionPtr SimplifyBitwise(BinaryExpression& node);
+			ExpressionPtr SimplifyLogical(BinaryExpression& node);
+
+			Options m_options;
+			std::size_t m_simplificationCount = 0;
+	};
+
+	inline ModulePtr SimplifyAlgebra(const Module& shaderModule, const AlgebraicSimplificationVisitor::Options& options = {});
+	inline std::size_t SimplifyAlgebraInPlace(Module& shaderModule, const AlgebraicSimplificationVisitor::Options& options = {});
+}
+
+#include <NZSL/Ast/AlgebraicSimplificationVisitor.inl>
+
+#endif // NZSL_AST_ALGEBRAICSIMPLIFICATIONVISITOR_HPP
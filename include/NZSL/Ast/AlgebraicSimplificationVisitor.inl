@@ -0,0 +1,26 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl::Ast
+{
+	inline std::size_t AlgebraicSimplificationVisitor::GetSimplificationCount() const
+	{
+		return m_simplificationCount;
+	}
+
+	inline ModulePtr SimplifyAlgebra(const Module& shaderModule, const AlgebraicSimplificationVisitor::Options& options)
+	{
+		AlgebraicSimplificationVisitor simplifier;
+		return simplifier.Process(shaderModule, options);
+	}
+
+	inline std::size_t SimplifyAlgebraInPlace(Module& shaderModule, const AlgebraicSimplificationVisitor::Options& options)
+	{
+		AlgebraicSimplificationVisitor simplifier;
+		simplifier.ProcessInPlace(shaderModule, options);
+
+		return simplifier.GetSimplificationCount();
+	}
+}
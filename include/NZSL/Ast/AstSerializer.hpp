@@ -7,14 +7,37 @@
 #ifndef NZSL_AST_ASTSERIALIZER_HPP
 #define NZSL_AST_ASTSERIALIZER_HPP
 
+#include <NazaraUtils/Bitset.hpp>
+#include <NazaraUtils/FunctionRef.hpp>
 #include <NZSL/Config.hpp>
 #include <NZSL/Serializer.hpp>
 #include <NZSL/Ast/Module.hpp>
 #include <NZSL/Lang/SourceLocation.hpp>
+#include <optional>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace nzsl::Ast
 {
+	struct ModuleIndex
+	{
+		struct StatementEntry
+		{
+			std::string_view name; //< points into the deserialized data (or the statement it was built from), which must outlive the entry
+			std::optional<std::size_t> declaredIndex; //< alias, constant, function or struct index declared by a sanitized statement (only set from version 13)
+			std::size_t offset;
+			std::size_t size;
+			NodeType declarationType; //< type of the declaring statement, looking through conditional statements (same as nodeType before version 13)
+			NodeType nodeType;
+			bool isEntryPoint;
+			bool isExported;
+		};
+
+		std::shared_ptr<const Module::Metadata> metadata;
+		std::vector<StatementEntry> statements;
+	};
+
 	class NZSL_API SerializerBase
 	{
 		public:
@@ -78,6 +101,7 @@ namespace nzsl::Ast
 			template<typename T> void OptEnum(std::optional<T>& optVal);
 			inline void OptSizeT(std::optional<std::size_t>& optVal);
 			inline void OptType(std::optional<ExpressionType>& optType);
+			inline void OptType(std::optional<ExpressionTypeHandle>& optType);
 			template<typename T> void OptVal(std::optional<T>& optVal);
 
 			virtual bool IsVersionGreaterOrEqual(std::uint32_t version) const = 0;
@@ -134,10 +158,12 @@ namespace nzsl::Ast
 		private:
 			using SerializerBase::Serialize;
 
+			std::uint32_t InternString(const std::string& str);
 			bool IsVersionGreaterOrEqual(std::uint32_t version) const override;
 			bool IsWriting() const override;
 			void Node(ExpressionPtr& node) override;
 			void Node(StatementPtr& node) override;
+			std::size_t NodeWithOffset(StatementPtr& node);
 			void SerializeModule(Module& module) override;
 			void SharedString(std::shared_ptr<const std::string>& val) override;
 			void Type(ExpressionType& type) override;
@@ -167,6 +193,7 @@ namespace nzsl::Ast
 			void Value(std::uint64_t& val) override;
 
 			std::unordered_map<std::string, std::uint32_t> m_stringIndices;
+			std::vector<std::string_view> m_stringTable;
 			AbstractSerializer& m_serializer;
 	};
 
@@ -177,14 +204,23 @@ namespace nzsl::Ast
 			~ShaderAstDeserializer() = default;
 
 			ModulePtr Deserialize();
+			ModulePtr Deserialize(const Nz::FunctionRef<bool(const ModuleIndex::StatementEntry& entry)>& statementFilter);
+			ModulePtr Deserialize(const std::unordered_set<std::string>& requestedSymbols);
+			ModuleIndex DeserializeIndex();
+			std::shared_ptr<const Module::Metadata> DeserializeMetadata();
 
 		private:
 			using SerializerBase::Serialize;
 
+			ModulePtr DeserializeFromIndex(const Nz::FunctionRef<Nz::Bitset<>(const std::vector<ModuleIndex::StatementEntry>& entries, const Nz::FunctionRef<Statement*(std::size_t statementIndex)>& loadStatement)>& selectStatements);
 			bool IsVersionGreaterOrEqual(std::uint32_t version) const override;
 			bool IsWriting() const override;
 			void Node(ExpressionPtr& node) override;
 			void Node(StatementPtr& node) override;
+			void ReadHeader();
+			std::vector<ModuleIndex::StatementEntry> ReadIndex(std::uint32_t statementCount, std::uint32_t indexOffset);
+			std::shared_ptr<Module::Metadata> ReadMetadata();
+			std::string_view RetrieveString(std::uint32_t stringIndex) const;
 			void SerializeModule(Module& module) override;
 			void SharedString(std::shared_ptr<const std::string>& val) override;
 			void Type(ExpressionType& type) override;
@@ -214,12 +250,17 @@ namespace nzsl::Ast
 			void Value(std::uint64_t& val) override;
 
 			std::vector<std::shared_ptr<const std::string>> m_strings;
+			std::vector<std::string_view> m_stringTable;
 			AbstractDeserializer& m_deserializer;
 			std::uint32_t m_version;
 	};
 	
 	NZSL_API void SerializeShader(AbstractSerializer& serializer, const Module& shader);
 	NZSL_API ModulePtr DeserializeShader(AbstractDeserializer& deserializer);
+	NZSL_API ModulePtr DeserializeShader(AbstractDeserializer& deserializer, const Nz::FunctionRef<bool(const ModuleIndex::StatementEntry& entry)>& statementFilter);
+	NZSL_API ModulePtr DeserializeShader(AbstractDeserializer& deserializer, const std::unordered_set<std::string>& requestedSymbols);
+	NZSL_API ModuleIndex DeserializeShaderIndex(AbstractDeserializer& deserializer);
+	NZSL_API std::shared_ptr<const Module::Metadata> DeserializeShaderMetadata(AbstractDeserializer& deserializer);
 }
 
 #include <NZSL/Ast/AstSerializer.inl>
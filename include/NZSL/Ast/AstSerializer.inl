@@ -163,6 +163,30 @@ namespace nzsl::Ast
 			Type(optType.value());
 	}
 
+	inline void SerializerBase::OptType(std::optional<ExpressionTypeHandle>& optType)
+	{
+		bool isWriting = IsWriting();
+
+		bool hasValue;
+		if (isWriting)
+			hasValue = optType.has_value();
+
+		Value(hasValue);
+
+		if (hasValue)
+		{
+			// interned types are immutable, go through a copy
+			ExpressionType type;
+			if (isWriting)
+				type = optType->Get();
+
+			Type(type);
+
+			if (!isWriting)
+				optType = std::move(type);
+		}
+	}
+
 	inline void SerializerBase::Metadata(Module::Metadata& metadata)
 	{
 		Value(metadata.moduleName);
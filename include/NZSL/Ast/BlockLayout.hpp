@@ -0,0 +1,35 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_BLOCKLAYOUT_HPP
+#define NZSL_AST_BLOCKLAYOUT_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Enums.hpp>
+#include <NZSL/Ast/ExpressionType.hpp>
+#include <NZSL/Math/FieldOffsets.hpp>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	struct BlockLayoutOptimization
+	{
+		std::vector<std::size_t> memberOrder; //< original member index of each member in the suggested declaration order (runtime arrays and disabled members last)
+		std::vector<std::size_t> memberOffsets; //< offset of each member (indexed by original member index) in the suggested order
+		std::size_t optimizedSize;
+		std::size_t originalSize;
+		StructLayout layout;
+	};
+
+	// Computes the offsets of a sanitized struct members in declaration order, disabled members get a zero offset and don't take any space
+	NZSL_API FieldOffsets ComputeStructFieldOffsets(const StructDescription& structDesc, StructLayout layout, const StructFinder& structFinder, std::vector<std::size_t>* memberOffsets = nullptr);
+	NZSL_API StructLayout GetStructLayout(const StructDescription& structDesc);
+
+	// Finds a member order minimizing the aligned size of a sanitized struct used as a block, the original order is kept if no order is smaller
+	NZSL_API BlockLayoutOptimization OptimizeBlockLayout(const StructDescription& structDesc, const StructFinder& structFinder);
+}
+
+#endif // NZSL_AST_BLOCKLAYOUT_HPP
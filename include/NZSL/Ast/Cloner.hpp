@@ -11,6 +11,8 @@
 #include <NZSL/Ast/ExpressionValue.hpp>
 #include <NZSL/Ast/ExpressionVisitor.hpp>
 #include <NZSL/Ast/StatementVisitor.hpp>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace nzsl::Ast
@@ -32,7 +34,11 @@ namespace nzsl::Ast
 			Cloner& operator=(Cloner&&) = delete;
 
 		protected:
+			template<typename T> std::unique_ptr<T> AllocateNode(T& node);
+
+			inline ExpressionPtr CloneExpression(ExpressionPtr& expr);
 			inline ExpressionPtr CloneExpression(const ExpressionPtr& expr);
+			inline StatementPtr CloneStatement(StatementPtr& statement);
 			inline StatementPtr CloneStatement(const StatementPtr& statement);
 
 			virtual ExpressionPtr CloneExpression(Expression& expr);
@@ -92,9 +98,18 @@ namespace nzsl::Ast
 			ExpressionPtr PopExpression();
 			StatementPtr PopStatement();
 
+			// Transforms a tree owned by the caller: nodes reached through their owning pointer are reused instead of being copied
+			ExpressionPtr TransformInPlace(ExpressionPtr&& expression);
+			StatementPtr TransformInPlace(StatementPtr&& statement);
+
 		private:
 			std::vector<ExpressionPtr> m_expressionStack;
 			std::vector<StatementPtr>  m_statementStack;
+			ExpressionPtr* m_currentExpressionOwner = nullptr;
+			ExpressionPtr* m_ownedExpression = nullptr;
+			StatementPtr* m_currentStatementOwner = nullptr;
+			StatementPtr* m_ownedStatement = nullptr;
+			bool m_transformInPlace = false;
 	};
 
 	template<typename T> ExpressionValue<T> Clone(const ExpressionValue<T>& attribute);
@@ -25,6 +25,41 @@ namespace nzsl::Ast
 		return CloneType(expressionValue);
 	}
 
+	template<typename T>
+	std::unique_ptr<T> Cloner::AllocateNode(T& node)
+	{
+		if (m_transformInPlace)
+		{
+			auto* owner = [&]
+			{
+				if constexpr (std::is_base_of_v<Expression, T>)
+					return m_currentExpressionOwner;
+				else
+					return m_currentStatementOwner;
+			}();
+
+			// Take the node from its owner, its fields will be assigned to themselves
+			if (owner && owner->get() == &node)
+			{
+				owner->release();
+				return std::unique_ptr<T>(&node);
+			}
+		}
+
+		return std::make_unique<T>();
+	}
+
+	inline ExpressionPtr Cloner::CloneExpression(ExpressionPtr& expr)
+	{
+		if (!expr)
+			return nullptr;
+
+		if (m_transformInPlace)
+			m_ownedExpression = &expr;
+
+		return CloneExpression(*expr);
+	}
+
 	inline ExpressionPtr Cloner::CloneExpression(const ExpressionPtr& expr)
 	{
 		if (!expr)
@@ -33,6 +68,17 @@ namespace nzsl::Ast
 		return CloneExpression(*expr);
 	}
 
+	inline StatementPtr Cloner::CloneStatement(StatementPtr& statement)
+	{
+		if (!statement)
+			return nullptr;
+
+		if (m_transformInPlace)
+			m_ownedStatement = &statement;
+
+		return CloneStatement(*statement);
+	}
+
 	inline StatementPtr Cloner::CloneStatement(const StatementPtr& statement)
 	{
 		if (!statement)
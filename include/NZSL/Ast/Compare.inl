@@ -304,6 +304,9 @@ namespace nzsl::Ast
 		if (!Compare(lhs.locationIndex, rhs.locationIndex, params))
 			return false;
 
+		if (!Compare(lhs.precision, rhs.precision, params))
+			return false;
+
 		if (!Compare(lhs.name, rhs.name, params))
 			return false;
 
@@ -24,12 +24,16 @@ namespace nzsl::Ast
 			ConstantPropagationVisitor(ConstantPropagationVisitor&&) = delete;
 			~ConstantPropagationVisitor() = default;
 
+			inline std::size_t GetPropagationCount() const;
+
 			inline ExpressionPtr Process(Expression& expression);
 			inline ExpressionPtr Process(Expression& expression, const Options& options);
 			ModulePtr Process(const Module& shaderModule);
 			ModulePtr Process(const Module& shaderModule, const Options& options);
 			inline StatementPtr Process(Statement& statement);
 			inline StatementPtr Process(Statement& statement, const Options& options);
+			void ProcessInPlace(Module& shaderModule);
+			void ProcessInPlace(Module& shaderModule, const Options& options);
 
 			ConstantPropagationVisitor& operator=(const ConstantPropagationVisitor&) = delete;
 			ConstantPropagationVisitor& operator=(ConstantPropagationVisitor&&) = delete;
@@ -66,6 +70,7 @@ namespace nzsl::Ast
 
 		private:
 			Options m_options;
+			std::size_t m_propagationCount = 0;
 	};
 
 	inline ExpressionPtr PropagateConstants(Expression& expr);
@@ -74,6 +79,8 @@ namespace nzsl::Ast
 	inline ModulePtr PropagateConstants(const Module& shaderModule, const ConstantPropagationVisitor::Options& options);
 	inline StatementPtr PropagateConstants(Statement& ast);
 	inline StatementPtr PropagateConstants(Statement& ast, const ConstantPropagationVisitor::Options& options);
+	inline std::size_t PropagateConstantsInPlace(Module& shaderModule);
+	inline std::size_t PropagateConstantsInPlace(Module& shaderModule, const ConstantPropagationVisitor::Options& options);
 }
 
 #include <NZSL/Ast/ConstantPropagationVisitor.inl>
@@ -5,27 +5,36 @@
 
 namespace nzsl::Ast
 {
+	inline std::size_t ConstantPropagationVisitor::GetPropagationCount() const
+	{
+		return m_propagationCount;
+	}
+
 	inline ExpressionPtr ConstantPropagationVisitor::Process(Expression& expression)
 	{
 		m_options = {};
+		m_propagationCount = 0;
 		return CloneExpression(expression);
 	}
 
 	inline ExpressionPtr ConstantPropagationVisitor::Process(Expression& expression, const Options& options)
 	{
 		m_options = options;
+		m_propagationCount = 0;
 		return CloneExpression(expression);
 	}
 
 	inline StatementPtr ConstantPropagationVisitor::Process(Statement& statement)
 	{
 		m_options = {};
+		m_propagationCount = 0;
 		return CloneStatement(statement);
 	}
 
 	inline StatementPtr ConstantPropagationVisitor::Process(Statement& statement, const Options& options)
 	{
 		m_options = options;
+		m_propagationCount = 0;
 		return CloneStatement(statement);
 	}
 
@@ -64,4 +73,20 @@ namespace nzsl::Ast
 		ConstantPropagationVisitor optimize;
 		return optimize.Process(ast, options);
 	}
+
+	inline std::size_t PropagateConstantsInPlace(Module& shaderModule)
+	{
+		ConstantPropagationVisitor optimize;
+		optimize.ProcessInPlace(shaderModule);
+
+		return optimize.GetPropagationCount();
+	}
+
+	inline std::size_t PropagateConstantsInPlace(Module& shaderModule, const ConstantPropagationVisitor::Options& options)
+	{
+		ConstantPropagationVisitor optimize;
+		optimize.ProcessInPlace(shaderModule, options);
+
+		return optimize.GetPropagationCount();
+	}
 }
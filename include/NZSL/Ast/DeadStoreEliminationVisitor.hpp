@@ -0,0 +1,55 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_DEADSTOREELIMINATIONVISITOR_HPP
+#define NZSL_AST_DEADSTOREELIMINATIONVISITOR_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/Module.hpp>
+
+namespace nzsl::Ast
+{
+	// Optimizes function-local variables: propagates copies of variables which are never reassigned, removes stores which are never read and drops the declarations left unused, requires a sanitized AST
+	class NZSL_API DeadStoreEliminationVisitor : public Cloner
+	{
+		public:
+			DeadStoreEliminationVisitor() = default;
+			DeadStoreEliminationVisitor(const DeadStoreEliminationVisitor&) = delete;
+			DeadStoreEliminationVisitor(DeadStoreEliminationVisitor&&) = delete;
+			~DeadStoreEliminationVisitor() = default;
+
+			inline std::size_t GetEliminationCount() const;
+
+			ModulePtr Process(const Module& shaderModule);
+			StatementPtr Process(Statement& statement);
+			void ProcessInPlace(Module& shaderModule);
+
+			DeadStoreEliminationVisitor& operator=(const DeadStoreEliminationVisitor&) = delete;
+			DeadStoreEliminationVisitor& operator=(DeadStoreEliminationVisitor&&) = delete;
+
+		protected:
+			using Cloner::Clone;
+			StatementPtr Clone(DeclareFunctionStatement& node) override;
+			StatementPtr Clone(DeclareVariableStatement& node) override;
+			StatementPtr Clone(ExpressionStatement& node) override;
+			ExpressionPtr Clone(VariableValueExpression& node) override;
+
+		private:
+			struct FunctionData;
+
+			FunctionData* m_function = nullptr;
+			std::size_t m_eliminationCount = 0;
+	};
+
+	inline ModulePtr EliminateDeadStores(const Module& shaderModule);
+	inline StatementPtr EliminateDeadStores(Statement& ast);
+	inline std::size_t EliminateDeadStoresInPlace(Module& shaderModule);
+}
+
+#include <NZSL/Ast/DeadStoreEliminationVisitor.inl>
+
+#endif // NZSL_AST_DEADSTOREELIMINATIONVISITOR_HPP
@@ -0,0 +1,32 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl::Ast
+{
+	inline std::size_t DeadStoreEliminationVisitor::GetEliminationCount() const
+	{
+		return m_eliminationCount;
+	}
+
+	inline ModulePtr EliminateDeadStores(const Module& shaderModule)
+	{
+		DeadStoreEliminationVisitor visitor;
+		return visitor.Process(shaderModule);
+	}
+
+	inline StatementPtr EliminateDeadStores(Statement& ast)
+	{
+		DeadStoreEliminationVisitor visitor;
+		return visitor.Process(ast);
+	}
+
+	inline std::size_t EliminateDeadStoresInPlace(Module& shaderModule)
+	{
+		DeadStoreEliminationVisitor visitor;
+		visitor.ProcessInPlace(shaderModule);
+
+		return visitor.GetEliminationCount();
+	}
+}
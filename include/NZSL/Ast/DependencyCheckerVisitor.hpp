@@ -70,6 +70,7 @@ namespace nzsl::Ast
 			void Visit(DeclareConstStatement& node) override;
 			void Visit(DeclareExternalStatement& node) override;
 			void Visit(DeclareFunctionStatement& node) override;
+			void Visit(DeclareOptionStatement& node) override;
 			void Visit(DeclareStructStatement& node) override;
 			void Visit(DeclareVariableStatement& node) override;
 
@@ -23,8 +23,11 @@ namespace nzsl::Ast
 			EliminateUnusedPassVisitor(EliminateUnusedPassVisitor&&) = delete;
 			~EliminateUnusedPassVisitor() = default;
 
+			inline std::size_t GetEliminationCount() const;
+
 			ModulePtr Process(const Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet);
 			StatementPtr Process(Statement& statement, const DependencyCheckerVisitor::UsageSet& usageSet);
+			void ProcessInPlace(Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet);
 
 			EliminateUnusedPassVisitor& operator=(const EliminateUnusedPassVisitor&) = delete;
 			EliminateUnusedPassVisitor& operator=(EliminateUnusedPassVisitor&&) = delete;
@@ -46,6 +49,7 @@ namespace nzsl::Ast
 
 			struct Context;
 			Context* m_context;
+			std::size_t m_eliminationCount = 0;
 	};
 
 	inline ModulePtr EliminateUnusedPass(const Module& shaderModule);
@@ -55,6 +59,10 @@ namespace nzsl::Ast
 	inline StatementPtr EliminateUnusedPass(Statement& ast);
 	inline StatementPtr EliminateUnusedPass(Statement& ast, const DependencyCheckerVisitor::Config& config);
 	inline StatementPtr EliminateUnusedPass(Statement& ast, const DependencyCheckerVisitor::UsageSet& usageSet);
+
+	inline std::size_t EliminateUnusedPassInPlace(Module& shaderModule);
+	inline std::size_t EliminateUnusedPassInPlace(Module& shaderModule, const DependencyCheckerVisitor::Config& config);
+	inline std::size_t EliminateUnusedPassInPlace(Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet);
 }
 
 #include <NZSL/Ast/EliminateUnusedPassVisitor.inl>
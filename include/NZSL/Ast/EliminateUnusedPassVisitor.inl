@@ -5,6 +5,11 @@
 
 namespace nzsl::Ast
 {
+	inline std::size_t EliminateUnusedPassVisitor::GetEliminationCount() const
+	{
+		return m_eliminationCount;
+	}
+
 	inline ModulePtr EliminateUnusedPass(const Module& shaderModule)
 	{
 		DependencyCheckerVisitor::Config defaultConfig;
@@ -49,4 +54,30 @@ namespace nzsl::Ast
 		EliminateUnusedPassVisitor visitor;
 		return visitor.Process(ast, usageSet);
 	}
+
+	inline std::size_t EliminateUnusedPassInPlace(Module& shaderModule)
+	{
+		DependencyCheckerVisitor::Config defaultConfig;
+		return EliminateUnusedPassInPlace(shaderModule, defaultConfig);
+	}
+
+	inline std::size_t EliminateUnusedPassInPlace(Module& shaderModule, const DependencyCheckerVisitor::Config& config)
+	{
+		DependencyCheckerVisitor dependencyVisitor;
+		for (const auto& importedModule : shaderModule.importedModules)
+			dependencyVisitor.Register(*importedModule.module->rootNode, config);
+
+		dependencyVisitor.Register(*shaderModule.rootNode, config);
+		dependencyVisitor.Resolve();
+
+		return EliminateUnusedPassInPlace(shaderModule, dependencyVisitor.GetUsage());
+	}
+
+	inline std::size_t EliminateUnusedPassInPlace(Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet)
+	{
+		EliminateUnusedPassVisitor visitor;
+		visitor.ProcessInPlace(shaderModule, usageSet);
+
+		return visitor.GetEliminationCount();
+	}
 }
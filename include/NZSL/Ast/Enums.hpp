@@ -26,7 +26,7 @@ namespace nzsl::Ast
 
 	enum class AttributeType
 	{
-		// Next free ID: 20
+		// Next free ID: 21
 		AutoBinding        = 17, //< Incremental binding index (external block only)
 		Author             = 12, //< Module author (module statement only) - has argument version string
 		Binding            =  0, //< Binding (external var only) - has argument index
@@ -43,6 +43,7 @@ namespace nzsl::Ast
 		License            = 14, //< Module license (module statement) - has argument version string
 		Layout             =  7, //< Struct layout (struct only) - has argument style
 		Location           =  8, //< Location (struct member only) - has argument index
+		Precision          = 20, //< Precision (struct member only) - has argument precision qualifier
 		Set                = 10, //< Binding set (external var only) - has argument index
 		Tag                = 16, //< Tag (external block and external var only) - has argument string
 		Unroll             = 11, //< Unroll (for/for each only) - has argument mode
@@ -183,6 +184,7 @@ namespace nzsl::Ast
 
 	enum class MemoryLayout
 	{
+		Scalar = 2,
 		Std140 = 0,
 		Std430 = 1
 	};
@@ -248,6 +250,12 @@ namespace nzsl::Ast
 		Max = ContinueStatement
 	};
 
+	enum class PrecisionQualifier
+	{
+		High   = 0,
+		Medium = 1
+	};
+
 	enum class PrimitiveType
 	{
 		Boolean = 0, //< bool
@@ -231,6 +231,7 @@ namespace nzsl::Ast
 			ExpressionValue<InterpolationQualifier> interp;
 			ExpressionValue<bool> cond;
 			ExpressionValue<std::uint32_t> locationIndex;
+			ExpressionValue<PrecisionQualifier> precision;
 			ExpressionValue<ExpressionType> type;
 			SourceLocation sourceLocation;
 			std::string originalName; //< used when sanitizing field name
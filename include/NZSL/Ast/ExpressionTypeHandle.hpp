@@ -0,0 +1,71 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_EXPRESSIONTYPEHANDLE_HPP
+#define NZSL_AST_EXPRESSIONTYPEHANDLE_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/ExpressionType.hpp>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace nzsl::Ast
+{
+	// Handle to an interned expression type: every distinct type is stored once (and never modified), copying, comparing and hashing handles is O(1)
+	// Interned types are shared by all threads and released once the last handle referencing them is destroyed
+	class NZSL_API ExpressionTypeHandle
+	{
+		public:
+			ExpressionTypeHandle(const ExpressionType& type);
+			template<typename T, typename = std::enable_if_t<std::conjunction_v<std::negation<std::is_same<std::decay_t<T>, ExpressionTypeHandle>>, std::negation<std::is_same<std::decay_t<T>, ExpressionType>>, std::is_constructible<ExpressionType, T>>>> ExpressionTypeHandle(T&& type);
+			ExpressionTypeHandle(const ExpressionTypeHandle&) = default;
+			ExpressionTypeHandle(ExpressionTypeHandle&&) noexcept = default;
+			~ExpressionTypeHandle() = default;
+
+			inline const ExpressionType& Get() const;
+			inline std::size_t GetHash() const;
+
+			inline operator const ExpressionType&() const;
+
+			ExpressionTypeHandle& operator=(const ExpressionTypeHandle&) = default;
+			ExpressionTypeHandle& operator=(ExpressionTypeHandle&&) noexcept = default;
+
+			inline bool operator==(const ExpressionTypeHandle& rhs) const;
+			inline bool operator!=(const ExpressionTypeHandle& rhs) const;
+
+			static std::size_t GetInternedTypeCount();
+
+		private:
+			struct Entry
+			{
+				ExpressionType type;
+				std::size_t hash;
+			};
+
+			struct Interner;
+
+			static std::shared_ptr<const Entry> Intern(const ExpressionType& type);
+
+			std::shared_ptr<const Entry> m_entry;
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<nzsl::Ast::ExpressionTypeHandle>
+	{
+		std::size_t operator()(const nzsl::Ast::ExpressionTypeHandle& typeHandle) const
+		{
+			return typeHandle.GetHash();
+		}
+	};
+}
+
+#include <NZSL/Ast/ExpressionTypeHandle.inl>
+
+#endif // NZSL_AST_EXPRESSIONTYPEHANDLE_HPP
@@ -0,0 +1,38 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl::Ast
+{
+	template<typename T, typename>
+	ExpressionTypeHandle::ExpressionTypeHandle(T&& type) :
+	ExpressionTypeHandle(ExpressionType(std::forward<T>(type)))
+	{
+	}
+
+	inline const ExpressionType& ExpressionTypeHandle::Get() const
+	{
+		return m_entry->type;
+	}
+
+	inline std::size_t ExpressionTypeHandle::GetHash() const
+	{
+		return m_entry->hash;
+	}
+
+	inline ExpressionTypeHandle::operator const ExpressionType&() const
+	{
+		return m_entry->type;
+	}
+
+	inline bool ExpressionTypeHandle::operator==(const ExpressionTypeHandle& rhs) const
+	{
+		return m_entry == rhs.m_entry;
+	}
+
+	inline bool ExpressionTypeHandle::operator!=(const ExpressionTypeHandle& rhs) const
+	{
+		return !operator==(rhs);
+	}
+}
@@ -0,0 +1,55 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_LOOPINVARIANTCODEMOTIONVISITOR_HPP
+#define NZSL_AST_LOOPINVARIANTCODEMOTIONVISITOR_HPP
+
+#include <NazaraUtils/Bitset.hpp>
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/Module.hpp>
+
+namespace nzsl::Ast
+{
+	// Moves computations whose operands don't change during a loop in variables declared before the loop, requires a sanitized AST
+	class NZSL_API LoopInvariantCodeMotionVisitor : public Cloner
+	{
+		public:
+			LoopInvariantCodeMotionVisitor() = default;
+			LoopInvariantCodeMotionVisitor(const LoopInvariantCodeMotionVisitor&) = delete;
+			LoopInvariantCodeMotionVisitor(LoopInvariantCodeMotionVisitor&&) = delete;
+			~LoopInvariantCodeMotionVisitor() = default;
+
+			inline std::size_t GetHoistedExpressionCount() const;
+
+			ModulePtr Process(const Module& shaderModule);
+			void ProcessInPlace(Module& shaderModule);
+
+			LoopInvariantCodeMotionVisitor& operator=(const LoopInvariantCodeMotionVisitor&) = delete;
+			LoopInvariantCodeMotionVisitor& operator=(LoopInvariantCodeMotionVisitor&&) = delete;
+
+		protected:
+			using Cloner::Clone;
+			StatementPtr Clone(ForStatement& node) override;
+			StatementPtr Clone(ForEachStatement& node) override;
+			StatementPtr Clone(WhileStatement& node) override;
+
+		private:
+			void PrepareModule(const Module& shaderModule);
+			StatementPtr HoistInvariants(StatementPtr loop, std::vector<ExpressionPtr*> loopExpressions, std::vector<StatementPtr*> loopStatements);
+
+			Nz::Bitset<> m_externalVariables;
+			std::size_t m_hoistedExpressionCount = 0;
+			std::size_t m_nextVarIndex = 0;
+	};
+
+	inline ModulePtr HoistLoopInvariants(const Module& shaderModule);
+	inline std::size_t HoistLoopInvariantsInPlace(Module& shaderModule);
+}
+
+#include <NZSL/Ast/LoopInvariantCodeMotionVisitor.inl>
+
+#endif // NZSL_AST_LOOPINVARIANTCODEMOTIONVISITOR_HPP
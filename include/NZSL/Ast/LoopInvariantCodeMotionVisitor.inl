@@ -0,0 +1,26 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl::Ast
+{
+	inline std::size_t LoopInvariantCodeMotionVisitor::GetHoistedExpressionCount() const
+	{
+		return m_hoistedExpressionCount;
+	}
+
+	inline ModulePtr HoistLoopInvariants(const Module& shaderModule)
+	{
+		LoopInvariantCodeMotionVisitor visitor;
+		return visitor.Process(shaderModule);
+	}
+
+	inline std::size_t HoistLoopInvariantsInPlace(Module& shaderModule)
+	{
+		LoopInvariantCodeMotionVisitor visitor;
+		visitor.ProcessInPlace(shaderModule);
+
+		return visitor.GetHoistedExpressionCount();
+	}
+}
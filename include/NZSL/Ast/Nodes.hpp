@@ -11,6 +11,7 @@
 #include <NZSL/Ast/ConstantValue.hpp>
 #include <NZSL/Ast/Enums.hpp>
 #include <NZSL/Ast/ExpressionType.hpp>
+#include <NZSL/Ast/ExpressionTypeHandle.hpp>
 #include <NZSL/Ast/ExpressionValue.hpp>
 #include <NZSL/Lang/SourceLocation.hpp>
 #include <array>
@@ -60,7 +61,7 @@ namespace nzsl::Ast
 		Expression& operator=(const Expression&) = delete;
 		Expression& operator=(Expression&&) noexcept = default;
 
-		std::optional<ExpressionType> cachedExpressionType;
+		std::optional<ExpressionTypeHandle> cachedExpressionType;
 	};
 
 	struct NZSL_API AccessIdentifierExpression : Expression
@@ -514,7 +515,7 @@ namespace nzsl::Ast
 
 	const ExpressionType& EnsureExpressionType(const Expression& expr);
 	inline const ExpressionType* GetExpressionType(const Expression& expr);
-	inline ExpressionType* GetExpressionTypeMut(Expression& expr);
+	inline const ExpressionTypeHandle* GetExpressionTypeHandle(const Expression& expr);
 	inline bool IsExpression(NodeType nodeType);
 	inline bool IsStatement(NodeType nodeType);
 
@@ -7,10 +7,10 @@ namespace nzsl::Ast
 {
 	inline const ExpressionType* GetExpressionType(const Expression& expr)
 	{
-		return (expr.cachedExpressionType) ? &expr.cachedExpressionType.value() : nullptr;
+		return (expr.cachedExpressionType) ? &expr.cachedExpressionType->Get() : nullptr;
 	}
 
-	inline ExpressionType* GetExpressionTypeMut(Expression& expr)
+	inline const ExpressionTypeHandle* GetExpressionTypeHandle(const Expression& expr)
 	{
 		return (expr.cachedExpressionType) ? &expr.cachedExpressionType.value() : nullptr;
 	}
@@ -0,0 +1,144 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_OPTIONUSAGEVISITOR_HPP
+#define NZSL_AST_OPTIONUSAGEVISITOR_HPP
+
+#include <NazaraUtils/Bitset.hpp>
+#include <NZSL/Config.hpp>
+#include <NZSL/Enums.hpp>
+#include <NZSL/Ast/ConstantValue.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <NZSL/Ast/Option.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <deque>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	// Computes which options can influence each entry point of a partially sanitized module (options without values)
+	class NZSL_API OptionUsageVisitor : public RecursiveVisitor
+	{
+		public:
+			struct EntryPoint;
+			struct Option;
+			struct Result;
+
+			OptionUsageVisitor() = default;
+			OptionUsageVisitor(const OptionUsageVisitor&) = delete;
+			OptionUsageVisitor(OptionUsageVisitor&&) = delete;
+			~OptionUsageVisitor() = default;
+
+			Result Analyze(const Module& shaderModule);
+			Result Analyze(Statement& statement);
+
+			OptionUsageVisitor& operator=(const OptionUsageVisitor&) = delete;
+			OptionUsageVisitor& operator=(OptionUsageVisitor&&) = delete;
+
+			struct EntryPoint
+			{
+				std::optional<ShaderStageType> stage; //< unset if the stage depends on an option
+				std::string functionName;
+				std::vector<OptionHash> options; //< options (transitively) referenced by the entry point
+			};
+
+			struct Option
+			{
+				std::string name;
+				OptionHash hash;
+			};
+
+			struct Result
+			{
+				std::vector<OptionHash> GetStageOptions(ShaderStageTypeFlags shaderStages) const;
+
+				std::vector<EntryPoint> entryPoints;
+				std::vector<Option> options; //< unresolved options declared by the module
+				std::vector<OptionHash> moduleOptions; //< options referenced anywhere in the module, even by unused code
+			};
+
+		private:
+			struct Symbol;
+			struct UsageSet;
+
+			Result BuildResult();
+			void MergeUsage(UsageSet& usage, const UsageSet& other);
+			std::size_t RegisterSymbol(std::unordered_map<std::size_t, std::size_t>& symbolByIndex, const std::optional<std::size_t>& index, const std::string& name);
+			void RegisterType(const ExpressionType& exprType);
+			template<typename T> void RegisterValue(const ExpressionValue<T>& value);
+			void ResolveOptions(std::size_t symbolIndex, Nz::Bitset<>& visitedSymbols, Nz::Bitset<>& options) const;
+
+			using RecursiveVisitor::Visit;
+
+			void Visit(AliasValueExpression& node) override;
+			void Visit(CastExpression& node) override;
+			void Visit(ConditionalExpression& node) override;
+			void Visit(ConstantExpression& node) override;
+			void Visit(FunctionExpression& node) override;
+			void Visit(IdentifierExpression& node) override;
+			void Visit(StructTypeExpression& node) override;
+			void Visit(VariableValueExpression& node) override;
+
+			void Visit(ConditionalStatement& node) override;
+			void Visit(DeclareAliasStatement& node) override;
+			void Visit(DeclareConstStatement& node) override;
+			void Visit(DeclareExternalStatement& node) override;
+			void Visit(DeclareFunctionStatement& node) override;
+			void Visit(DeclareOptionStatement& node) override;
+			void Visit(DeclareStructStatement& node) override;
+			void Visit(DeclareVariableStatement& node) override;
+			void Visit(ForStatement& node) override;
+			void Visit(ForEachStatement& node) override;
+			void Visit(WhileStatement& node) override;
+
+			struct UsageSet
+			{
+				Nz::Bitset<> usedAliases;
+				Nz::Bitset<> usedConstants;
+				Nz::Bitset<> usedFunctions;
+				Nz::Bitset<> usedStructs;
+				Nz::Bitset<> usedVariables;
+				std::vector<std::string> usedIdentifiers; //< unresolved code (partial sanitization) still references symbols by name
+			};
+
+			struct Symbol
+			{
+				std::optional<std::size_t> optionIndex;
+				UsageSet usage;
+			};
+
+			struct PendingEntryPoint
+			{
+				std::optional<ShaderStageType> stage;
+				std::string functionName;
+				std::size_t symbolIndex;
+			};
+
+			std::deque<Symbol> m_symbols;
+			std::deque<UsageSet> m_conditionUsages;
+			std::unordered_map<std::size_t, std::size_t> m_aliasSymbols;
+			std::unordered_map<std::size_t, std::size_t> m_constantSymbols;
+			std::unordered_map<std::size_t, std::size_t> m_functionSymbols;
+			std::unordered_map<std::size_t, std::size_t> m_structSymbols;
+			std::unordered_map<std::size_t, std::size_t> m_variableSymbols;
+			std::unordered_map<std::string, std::vector<std::size_t>> m_symbolsByName;
+			std::vector<Option> m_options;
+			std::vector<PendingEntryPoint> m_entryPoints;
+			UsageSet* m_currentUsage = nullptr;
+	};
+
+	inline OptionUsageVisitor::Result AnalyzeOptionUsage(const Module& shaderModule);
+
+	// Returns, for each option set, the index of the first option set giving the same values to every influencing option
+	NZSL_API std::vector<std::size_t> PartitionOptionSets(const std::vector<OptionHash>& influencingOptions, const std::vector<std::unordered_map<OptionHash, ConstantValue>>& optionSets);
+}
+
+#include <NZSL/Ast/OptionUsageVisitor.inl>
+
+#endif // NZSL_AST_OPTIONUSAGEVISITOR_HPP
@@ -0,0 +1,13 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl::Ast
+{
+	inline OptionUsageVisitor::Result AnalyzeOptionUsage(const Module& shaderModule)
+	{
+		OptionUsageVisitor visitor;
+		return visitor.Analyze(shaderModule);
+	}
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_PASSMANAGER_HPP
+#define NZSL_AST_PASSMANAGER_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Enums.hpp>
+#include <NZSL/Ast/AlgebraicSimplificationVisitor.hpp>
+#include <NZSL/Ast/DependencyCheckerVisitor.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace nzsl
+{
+	class CompilationStats;
+}
+
+namespace nzsl::Ast
+{
+	// Runs module passes in registration order, repeating the whole list until no pass changes the module (or the iteration budget is exhausted)
+	class NZSL_API PassManager
+	{
+		public:
+			struct PassStatistics;
+			struct Result;
+
+			using Pass = std::function<std::size_t(Module& shaderModule)>; //< transforms the module in place and returns the number of changes it made
+
+			PassManager() = default;
+			PassManager(const PassManager&) = default;
+			PassManager(PassManager&&) noexcept = default;
+			~PassManager() = default;
+
+			void AddPass(std::string name, Pass pass);
+
+			inline std::size_t GetMaxIterations() const;
+			inline std::size_t GetPassCount() const;
+
+			Result Run(Module& shaderModule, CompilationStats* compilationStats = nullptr) const;
+
+			inline void SetMaxIterations(std::size_t maxIterations);
+
+			PassManager& operator=(const PassManager&) = default;
+			PassManager& operator=(PassManager&&) noexcept = default;
+
+			static PassManager BuildPreset(OptimizationLevel optimizationLevel, const DependencyCheckerVisitor::Config& dependencyConfig, const AlgebraicSimplificationVisitor::Options& simplificationOptions = {});
+
+			static std::size_t AlgebraicSimplificationPass(Module& shaderModule, const AlgebraicSimplificationVisitor::Options& simplificationOptions);
+			static std::size_t ConstantPropagationPass(Module& shaderModule);
+			static std::size_t DeadStoreEliminationPass(Module& shaderModule);
+			static std::size_t EliminateUnusedCodePass(Module& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig);
+			static std::size_t LoopInvariantCodeMotionPass(Module& shaderModule);
+
+			struct PassStatistics
+			{
+				std::string name;
+				std::chrono::microseconds duration; //< accumulated over all iterations
+				std::size_t changeCount;
+				std::size_t runCount;
+			};
+
+			struct Result
+			{
+				std::vector<PassStatistics> passes; //< in registration order
+				std::size_t iterationCount;
+				bool fixedPointReached; //< false if passes were still changing the module when the iteration budget ran out
+			};
+
+		private:
+			struct PassData
+			{
+				std::string name;
+				Pass pass;
+			};
+
+			std::size_t m_maxIterations = 1;
+			std::vector<PassData> m_passes;
+	};
+}
+
+#include <NZSL/Ast/PassManager.inl>
+
+#endif // NZSL_AST_PASSMANAGER_HPP
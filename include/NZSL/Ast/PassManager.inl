@@ -0,0 +1,22 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl::Ast
+{
+	inline std::size_t PassManager::GetMaxIterations() const
+	{
+		return m_maxIterations;
+	}
+
+	inline std::size_t PassManager::GetPassCount() const
+	{
+		return m_passes.size();
+	}
+
+	inline void PassManager::SetMaxIterations(std::size_t maxIterations)
+	{
+		m_maxIterations = maxIterations;
+	}
+}
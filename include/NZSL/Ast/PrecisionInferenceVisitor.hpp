@@ -0,0 +1,73 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_PRECISIONINFERENCEVISITOR_HPP
+#define NZSL_AST_PRECISIONINFERENCEVISITOR_HPP
+
+#include <NazaraUtils/Bitset.hpp>
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	// Finds the local f32 variables which only hold medium precision values (texture samples, normalized vectors, precision(medium) struct members and computations on them), requires a sanitized AST
+	// values which may grow out of the medium precision range (scaling by constants, accumulation in loops) keep their full precision
+	class NZSL_API PrecisionInferenceVisitor : public RecursiveVisitor
+	{
+		public:
+			PrecisionInferenceVisitor() = default;
+			PrecisionInferenceVisitor(const PrecisionInferenceVisitor&) = delete;
+			PrecisionInferenceVisitor(PrecisionInferenceVisitor&&) = delete;
+			~PrecisionInferenceVisitor() = default;
+
+			Nz::Bitset<> Process(const Module& shaderModule);
+			Nz::Bitset<> Process(Statement& statement);
+
+			PrecisionInferenceVisitor& operator=(const PrecisionInferenceVisitor&) = delete;
+			PrecisionInferenceVisitor& operator=(PrecisionInferenceVisitor&&) = delete;
+
+		private:
+			enum class Precision;
+
+			struct CandidateStore
+			{
+				const Expression* value;
+				AssignType op;
+				bool accumulatesInLoop;
+			};
+
+			Precision Classify(const Expression& expression, std::size_t varIndex, const Nz::Bitset<>& relaxedVariables) const;
+			const StructDescription::StructMember* FindMember(const ExpressionType& structType, const std::string& memberName) const;
+			const StructDescription::StructMember* FindMember(const ExpressionType& structType, std::int32_t memberIndex) const;
+			Nz::Bitset<> Resolve();
+
+			using RecursiveVisitor::Visit;
+
+			void Visit(AssignExpression& node) override;
+			void Visit(IntrinsicExpression& node) override;
+
+			void Visit(DeclareStructStatement& node) override;
+			void Visit(DeclareVariableStatement& node) override;
+			void Visit(ForStatement& node) override;
+			void Visit(ForEachStatement& node) override;
+			void Visit(WhileStatement& node) override;
+
+			std::unordered_map<std::size_t, std::vector<CandidateStore>> m_candidateStores; //< stored values of every f32 scalar/vector variable
+			std::vector<std::size_t> m_candidates; //< in declaration order
+			std::vector<const StructDescription*> m_structs;
+			Nz::Bitset<> m_highPrecisionVariables;
+			bool m_inLoop = false;
+	};
+
+	inline Nz::Bitset<> InferRelaxedPrecisionVariables(const Module& shaderModule);
+}
+
+#include <NZSL/Ast/PrecisionInferenceVisitor.inl>
+
+#endif // NZSL_AST_PRECISIONINFERENCEVISITOR_HPP
@@ -8,6 +8,7 @@
 #define NZSL_AST_SANITIZEVISITOR_HPP
 
 #include <NazaraUtils/Bitset.hpp>
+#include <NZSL/CompilationStats.hpp>
 #include <NZSL/Config.hpp>
 #include <NZSL/ModuleResolver.hpp>
 #include <NZSL/Ast/Cloner.hpp>
@@ -17,6 +18,7 @@
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 namespace nzsl::Ast
@@ -43,9 +45,14 @@ namespace nzsl::Ast
 			{
 				std::function<bool(std::string& identifier, IdentifierScope identifierScope)> identifierSanitizer; //< ignored when performing partial sanitization
 				std::shared_ptr<ModuleResolver> moduleResolver;
+				CompilationStats* compilationStats = nullptr; //< if set, records timings of sanitization phases and imports
 				std::unordered_map<OptionHash, ConstantValue> optionValues;
+				std::unordered_set<OptionHash> bakedOptions; //< options which are always resolved, even if optionsAsSpecializationConstants is set
+				unsigned int moduleResolverThreadCount = 0; //< number of threads resolving imported modules and sanitizing those which don't import anything (0 means one thread per hardware thread, module resolver must be thread-safe), the output doesn't depend on it
 				bool forceAutoBindingResolve = false;
+				bool importOnlyRequestedSymbols = false; //< only sanitize symbols imported from modules (and their dependencies), ignored when performing partial sanitization
 				bool makeVariableNameUnique = false;
+				bool optionsAsSpecializationConstants = false; //< scalar options (bool, f32, i32, u32) only used at runtime keep their declaration and ConstantExpression references, ignored when performing partial sanitization
 				bool partialSanitization = false;
 				bool reduceLoopsToWhile = false;
 				bool removeAliases = false;
@@ -138,7 +145,9 @@ namespace nzsl::Ast
 			template<typename T> ValidationResult ComputeExprValue(const ExpressionValue<T>& attribute, ExpressionValue<T>& targetAttribute, const SourceLocation& sourceLocation);
 			template<typename T> std::unique_ptr<T> PropagateConstants(T& node) const;
 
+			void PrefetchImportedModules(const Module& module);
 			void PreregisterIndices(const Module& module);
+			void PresanitizeIndependentModules(const std::vector<std::string>& moduleNames);
 			void PropagateFunctionRequirements(FunctionData& callingFunction, std::size_t calledFuncIndex, Nz::Bitset<>& seen);
 
 			void RegisterBuiltin();
@@ -56,6 +56,9 @@ namespace nzsl::Ast
 	};
 
 	inline ExpressionCategory GetExpressionCategory(Expression& expression);
+
+	// Returns true if evaluating the expression can change the program state (assignments, function calls, texture writes)
+	NZSL_API bool HasSideEffects(Expression& expression);
 }
 
 #include <NZSL/Ast/Utils.inl>
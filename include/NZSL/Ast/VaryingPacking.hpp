@@ -0,0 +1,56 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_VARYINGPACKING_HPP
+#define NZSL_AST_VARYINGPACKING_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/Enums.hpp>
+#include <NZSL/Ast/ExpressionType.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	struct VaryingLocation
+	{
+		std::optional<std::size_t> packedVaryingIndex; //< set if the member shares its location with other members
+		std::size_t memberIndex; //< index in the struct description members
+		std::uint32_t componentCount; //< number of components used in each location
+		std::uint32_t firstComponent;
+		std::uint32_t location;
+		std::uint32_t locationCount;
+		std::uint32_t originalLocation;
+	};
+
+	struct PackedVarying
+	{
+		std::vector<std::size_t> locations; //< indices in VaryingPacking::locations, in component order
+		InterpolationQualifier interpolation;
+		PrimitiveType componentType;
+		std::uint32_t componentCount;
+		std::uint32_t location;
+		bool relaxedPrecision; //< true if every packed member has a medium precision
+	};
+
+	struct VaryingPacking
+	{
+		std::vector<PackedVarying> packedVaryings;
+		std::vector<VaryingLocation> locations; //< one per enabled location member, sorted by original location
+	};
+
+	// Packs location members with the same component type and interpolation qualifier into shared locations, requires a sanitized struct
+	// Locations are reassigned from zero, the result only depends on the location members so both stages have to declare the same ones
+	NZSL_API VaryingPacking PackVaryings(const StructDescription& structDesc);
+
+	// Throws if vertex outputs and fragment inputs of a sanitized module don't declare the same location members (location, type and interpolation) and wouldn't agree on the packed layout
+	// Stages living in different modules can't be checked and should share their varying struct through an imported module
+	NZSL_API void ValidateVaryingPacking(const Module& shaderModule);
+}
+
+#endif // NZSL_AST_VARYINGPACKING_HPP
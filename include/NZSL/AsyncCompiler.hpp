@@ -0,0 +1,123 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_ASYNCCOMPILER_HPP
+#define NZSL_ASYNCCOMPILER_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/GlslWriter.hpp>
+#include <NZSL/LangWriter.hpp>
+#include <NZSL/ShaderWriter.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace nzsl
+{
+	enum class CompileJobStatus
+	{
+		Pending,
+		Running,
+		Succeeded,
+		Failed,
+		Cancelled
+	};
+
+	// Runs shader generation in the background, jobs with a higher priority are started first
+	class NZSL_API AsyncCompiler
+	{
+		public:
+			class Job;
+
+			using Executor = std::function<void(std::function<void()> task)>;
+			using JobPtr = std::shared_ptr<Job>;
+
+			explicit AsyncCompiler(unsigned int threadCount = 0); //< 0 means one thread per hardware thread
+			explicit AsyncCompiler(Executor executor); //< executor must run each task exactly once, on any thread
+			AsyncCompiler(const AsyncCompiler&) = delete;
+			AsyncCompiler(AsyncCompiler&&) = delete;
+			~AsyncCompiler();
+
+			void CancelAll();
+
+			JobPtr SubmitGlsl(Ast::ModulePtr module, std::optional<ShaderStageType> shaderStage, const ShaderWriter::States& states = {}, const GlslWriter::BindingMapping& bindingMapping = {}, const GlslWriter::Environment& environment = {}, int priority = 0);
+			JobPtr SubmitNzsl(Ast::ModulePtr module, const ShaderWriter::States& states = {}, const LangWriter::Environment& environment = {}, int priority = 0);
+			JobPtr SubmitSpirv(Ast::ModulePtr module, const ShaderWriter::States& states = {}, const SpirvWriter::Environment& environment = {}, int priority = 0);
+
+			AsyncCompiler& operator=(const AsyncCompiler&) = delete;
+			AsyncCompiler& operator=(AsyncCompiler&&) = delete;
+
+			class NZSL_API Job
+			{
+				friend AsyncCompiler;
+
+				public:
+					Job(const Job&) = delete;
+					Job(Job&&) = delete;
+					~Job() = default;
+
+					bool Cancel();
+
+					const GlslWriter::Output& GetGlslOutput() const;
+					const std::string& GetNzslOutput() const;
+					inline int GetPriority() const;
+					const std::vector<std::uint32_t>& GetSpirvOutput() const;
+					CompileJobStatus GetStatus() const;
+
+					bool IsFinished() const;
+
+					inline void SetPriority(int priority);
+
+					void Wait() const;
+					template<typename Rep, typename Period> bool WaitFor(const std::chrono::duration<Rep, Period>& timeout) const;
+
+					Job& operator=(const Job&) = delete;
+					Job& operator=(Job&&) = delete;
+
+				private:
+					using Output = std::variant<std::monostate, GlslWriter::Output, std::string, std::vector<std::uint32_t>>;
+
+					Job(std::function<Output()> task, int priority, std::uint64_t sequence);
+
+					template<typename T> const T& GetOutput() const;
+					void Run();
+
+					mutable std::condition_variable m_condition;
+					mutable std::mutex m_mutex;
+					std::atomic_int m_priority;
+					std::exception_ptr m_error;
+					std::function<Output()> m_task;
+					std::uint64_t m_sequence;
+					CompileJobStatus m_status;
+					Output m_output;
+			};
+
+		private:
+			struct JobQueue;
+
+			JobPtr Submit(std::function<Job::Output()> task, int priority);
+
+			std::shared_ptr<JobQueue> m_queue;
+			std::vector<std::thread> m_workers;
+			Executor m_executor;
+	};
+}
+
+#include <NZSL/AsyncCompiler.inl>
+
+#endif // NZSL_ASYNCCOMPILER_HPP
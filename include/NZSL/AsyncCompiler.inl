@@ -0,0 +1,25 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl
+{
+	inline int AsyncCompiler::Job::GetPriority() const
+	{
+		return m_priority.load(std::memory_order_relaxed);
+	}
+
+	inline void AsyncCompiler::Job::SetPriority(int priority)
+	{
+		// only taken into account while the job is still pending
+		m_priority.store(priority, std::memory_order_relaxed);
+	}
+
+	template<typename Rep, typename Period>
+	bool AsyncCompiler::Job::WaitFor(const std::chrono::duration<Rep, Period>& timeout) const
+	{
+		std::unique_lock lock(m_mutex);
+		return m_condition.wait_for(lock, timeout, [&] { return m_status != CompileJobStatus::Pending && m_status != CompileJobStatus::Running; });
+	}
+}
@@ -0,0 +1,119 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_COMPILATIONSTATS_HPP
+#define NZSL_COMPILATIONSTATS_HPP
+
+#include <NZSL/Config.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace nzsl
+{
+	namespace Ast
+	{
+		class Module;
+		struct Statement;
+	}
+
+	// Records wall time, AST node count and allocation count of every compilation phase (thread-safe)
+	class NZSL_API CompilationStats
+	{
+		public:
+			class Scope;
+			struct Phase;
+
+			using AllocationCounter = std::function<std::uint64_t()>; //< called on the thread beginning/ending a phase, should only count the allocations of that thread
+
+			CompilationStats();
+			CompilationStats(const CompilationStats&) = delete;
+			CompilationStats(CompilationStats&&) = delete;
+			~CompilationStats() = default;
+
+			std::size_t BeginPhase(std::string_view category, std::string_view name);
+
+			void Clear();
+
+			void EndPhase(std::size_t phaseIndex, std::optional<std::size_t> nodeCount = std::nullopt);
+
+			std::vector<Phase> GetPhases() const;
+
+			void SetAllocationCounter(AllocationCounter allocationCounter);
+
+			CompilationStats& operator=(const CompilationStats&) = delete;
+			CompilationStats& operator=(CompilationStats&&) = delete;
+
+			static std::size_t CountNodes(const Ast::Module& module); //< includes imported modules
+			static std::size_t CountNodes(Ast::Statement& statement);
+
+			struct Phase
+			{
+				std::string category; //< lexer, parser, import, sanitize, optimize, codegen, ...
+				std::string name;
+				std::chrono::microseconds start; //< since the stats creation (or last Clear call)
+				std::chrono::microseconds duration;
+				std::optional<std::size_t> nodeCount; //< AST nodes produced by the phase, if known
+				std::optional<std::uint64_t> allocationCount; //< allocations made by the thread running the phase (not by worker threads it spawned), only set if an allocation counter was provided
+				std::size_t depth; //< number of enclosing phases running on the same thread
+				std::size_t threadIndex; //< 0 for the first thread recording a phase, 1 for the next one, etc.
+				bool finished;
+			};
+
+			class Scope
+			{
+				public:
+					inline Scope(CompilationStats* stats, std::string_view category, std::string_view name);
+					Scope(const Scope&) = delete;
+					Scope(Scope&&) = delete;
+					inline ~Scope();
+
+					inline bool IsEnabled() const;
+
+					inline void SetNodeCount(std::size_t nodeCount);
+					inline void SetNodeCount(const Ast::Module& module);
+
+					Scope& operator=(const Scope&) = delete;
+					Scope& operator=(Scope&&) = delete;
+
+				private:
+					std::optional<std::size_t> m_nodeCount;
+					CompilationStats* m_stats;
+					std::size_t m_phaseIndex = 0;
+			};
+
+		private:
+			struct ThreadData
+			{
+				std::size_t depth = 0;
+				std::size_t index;
+			};
+
+			struct PhaseData
+			{
+				std::chrono::steady_clock::time_point start;
+				std::uint64_t startAllocationCount;
+			};
+
+			AllocationCounter m_allocationCounter;
+			mutable std::mutex m_mutex;
+			std::chrono::steady_clock::time_point m_origin;
+			std::unordered_map<std::thread::id, ThreadData> m_threads;
+			std::vector<Phase> m_phases;
+			std::vector<PhaseData> m_phaseData;
+	};
+}
+
+#include <NZSL/CompilationStats.inl>
+
+#endif // NZSL_COMPILATIONSTATS_HPP
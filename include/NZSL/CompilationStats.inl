@@ -0,0 +1,37 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl
+{
+	inline CompilationStats::Scope::Scope(CompilationStats* stats, std::string_view category, std::string_view name) :
+	m_stats(stats)
+	{
+		if (m_stats)
+			m_phaseIndex = m_stats->BeginPhase(category, name);
+	}
+
+	inline CompilationStats::Scope::~Scope()
+	{
+		if (m_stats)
+			m_stats->EndPhase(m_phaseIndex, m_nodeCount);
+	}
+
+	inline bool CompilationStats::Scope::IsEnabled() const
+	{
+		return m_stats != nullptr;
+	}
+
+	inline void CompilationStats::Scope::SetNodeCount(std::size_t nodeCount)
+	{
+		m_nodeCount = nodeCount;
+	}
+
+	inline void CompilationStats::Scope::SetNodeCount(const Ast::Module& module)
+	{
+		// counting nodes requires a full AST traversal, don't do it if nobody is listening
+		if (m_stats)
+			m_nodeCount = CountNodes(module);
+	}
+}
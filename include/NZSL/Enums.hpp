@@ -91,6 +91,14 @@ namespace nzsl
 
 	constexpr std::size_t ImageTypeCount = static_cast<std::size_t>(ImageType::Max) + 1;
 
+	enum class OptimizationLevel
+	{
+		Size  = 3, //< Same passes as Full, minus the ones trading code size for speed (loop-invariant code motion, pow(x, 2.0) => x * x)
+		Full  = 2, //< Every optimization pass, repeated until the module stops changing
+		Basic = 1, //< Constant propagation followed by unused code elimination, once
+		None  = 0, //< No optimization pass is run
+	};
+
 	enum class ShaderStageType
 	{
 		Compute,
@@ -139,8 +147,9 @@ namespace nzsl
 		Packed,
 		Std140,
 		Std430,
+		Scalar,
 
-		Max = Std430
+		Max = Scalar
 	};
 }
 
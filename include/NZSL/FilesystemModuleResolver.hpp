@@ -8,25 +8,31 @@
 #define NZSL_FILESYSTEMMODULERESOLVER_HPP
 
 #include <NazaraUtils/MovablePtr.hpp>
+#include <NZSL/Archive.hpp>
 #include <NZSL/Config.hpp>
 #include <NZSL/ModuleResolver.hpp>
 #include <filesystem>
+#include <functional>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace nzsl
 {
-	class Archive;
-
 	class NZSL_API FilesystemModuleResolver : public ModuleResolver
 	{
 		public:
-			FilesystemModuleResolver() = default;
+			FilesystemModuleResolver();
 			FilesystemModuleResolver(const FilesystemModuleResolver&) = delete;
 			FilesystemModuleResolver(FilesystemModuleResolver&&) noexcept = delete;
 			~FilesystemModuleResolver();
 
+			inline unsigned int GetThreadCount() const;
+
+			inline bool IsLazyLoadingEnabled() const;
+
 			void RegisterArchive(const Archive& archive);
 			void RegisterDirectory(const std::filesystem::path& realPath, bool watchDirectory = false);
 			void RegisterFile(const std::filesystem::path& realPath);
@@ -34,6 +40,10 @@ namespace nzsl
 			void RegisterModule(Ast::ModulePtr module);
 
 			Ast::ModulePtr Resolve(const std::string& moduleName) override;
+			Ast::ModulePtr ResolveSymbols(const std::string& moduleName, const std::unordered_set<std::string>& symbols) override;
+
+			inline void SetLazyLoading(bool lazyLoading); //< registering files only reads module names, modules are loaded on first resolve
+			inline void SetThreadCount(unsigned int threadCount); //< number of threads used to load directories and archives
 
 			FilesystemModuleResolver& operator=(const FilesystemModuleResolver&) = delete;
 			FilesystemModuleResolver& operator=(FilesystemModuleResolver&&) noexcept = delete;
@@ -43,17 +53,37 @@ namespace nzsl
 			static constexpr const char* ModuleExtension = ".nzsl";
 
 		private:
+			struct ModuleLoader
+			{
+				std::function<Ast::ModulePtr()> load;
+				std::function<Ast::ModulePtr(const std::unordered_set<std::string>& symbols)> loadSymbols; //< only set for binary modules, which can skip statements not required by symbols
+			};
+
+			struct FileData
+			{
+				Ast::ModulePtr module;
+				ModuleLoader moduleLoader;
+				std::optional<Archive> archive;
+				std::string moduleName;
+			};
+
+			FileData LoadFile(const std::filesystem::path& realPath) const;
 			void OnFileAdded(std::string_view directory, std::string_view filename);
 			void OnFileRemoved(std::string_view directory, std::string_view filename);
 			void OnFileMoved(std::string_view directory, std::string_view filename, std::string_view oldFilename);
 			void OnFileUpdated(std::string_view directory, std::string_view filename);
+			void RegisterFileData(const std::filesystem::path& realPath, FileData&& fileData);
+			void RegisterModuleLoader(const std::string& moduleName, ModuleLoader moduleLoader);
 
 			static bool CheckExtension(std::string_view filename);
 
 			std::recursive_mutex m_moduleLock;
 			std::unordered_map<std::string, std::string> m_moduleByFilepath;
 			std::unordered_map<std::string, Ast::ModulePtr> m_modules;
+			std::unordered_map<std::string, ModuleLoader> m_moduleLoaders; //< modules whose name is known but which are not loaded yet
 			Nz::MovablePtr<void> m_fileWatcher;
+			unsigned int m_threadCount;
+			bool m_lazyLoading = false;
 	};
 }
 
@@ -2,7 +2,28 @@
 // This file is part of the "Nazara Shading Language" project
 // For conditions of distribution and use, see copyright notice in Config.hpp
 
+#include <cassert>
 
 namespace nzsl
 {
+	inline unsigned int FilesystemModuleResolver::GetThreadCount() const
+	{
+		return m_threadCount;
+	}
+
+	inline bool FilesystemModuleResolver::IsLazyLoadingEnabled() const
+	{
+		return m_lazyLoading;
+	}
+
+	inline void FilesystemModuleResolver::SetLazyLoading(bool lazyLoading)
+	{
+		m_lazyLoading = lazyLoading;
+	}
+
+	inline void FilesystemModuleResolver::SetThreadCount(unsigned int threadCount)
+	{
+		assert(threadCount > 0);
+		m_threadCount = threadCount;
+	}
 }
@@ -79,6 +79,7 @@ namespace nzsl
 			void Append(const Ast::MethodType& methodType);
 			void Append(Ast::MemoryLayout layout);
 			void Append(Ast::NoType);
+			void Append(Ast::PrecisionQualifier precision);
 			void Append(Ast::PrimitiveType type);
 			void Append(const Ast::PushConstantType& pushConstantType);
 			void Append(const Ast::SamplerType& samplerType);
@@ -99,6 +100,7 @@ namespace nzsl
 			void AppendLine(std::string_view txt = {});
 			template<typename... Args> void AppendLine(Args&&... params);
 			void AppendModuleComments(const Ast::Module& module);
+			void AppendPrecisionQualifier(const Ast::ExpressionValue<Ast::PrecisionQualifier>& precision);
 			void AppendStatementList(std::vector<Ast::StatementPtr>& statements);
 			template<typename T> void AppendValue(const T& value);
 			void AppendVariableDeclaration(const Ast::ExpressionType& varType, const std::string& varName);
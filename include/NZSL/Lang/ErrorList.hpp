@@ -143,6 +143,7 @@ NZSL_SHADERLANG_COMPILER_ERROR(StructDeclarationInsideFunction, "structs must be
 NZSL_SHADERLANG_COMPILER_ERROR(StructExpected, "struct type expected, got {}", std::string)
 NZSL_SHADERLANG_COMPILER_ERROR(StructFieldBuiltinLocation, "a struct field cannot have both builtin and location attributes")
 NZSL_SHADERLANG_COMPILER_ERROR(StructFieldMultiple, "multiple {} active struct field found, only one can be active at a time", std::string)
+NZSL_SHADERLANG_COMPILER_ERROR(StructFieldPrecisionType, "precision attribute requires a f32 type (scalar, vector, matrix or array of them), got {}", std::string)
 NZSL_SHADERLANG_COMPILER_ERROR(StructLayoutInnerMismatch, "inner struct layout mismatch, struct is declared with {} but field has layout {}", std::string, std::string)
 NZSL_SHADERLANG_COMPILER_ERROR(StructLayoutTypeNotAllowed, "{} type is not allowed in {} layout", std::string, std::string)
 NZSL_SHADERLANG_COMPILER_ERROR(SwizzleUnexpectedType, "expression type ({}) does not support swizzling", std::string)
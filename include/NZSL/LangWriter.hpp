@@ -56,6 +56,7 @@ namespace nzsl
 			struct LayoutAttribute;
 			struct LicenseAttribute;
 			struct LocationAttribute;
+			struct PrecisionAttribute;
 			struct SetAttribute;
 			struct TagAttribute;
 			struct UnrollAttribute;
@@ -100,6 +101,7 @@ namespace nzsl
 			void AppendAttribute(LayoutAttribute attribute);
 			void AppendAttribute(LicenseAttribute attribute);
 			void AppendAttribute(LocationAttribute attribute);
+			void AppendAttribute(PrecisionAttribute attribute);
 			void AppendAttribute(SetAttribute attribute);
 			void AppendAttribute(TagAttribute attribute);
 			void AppendAttribute(UnrollAttribute attribute);
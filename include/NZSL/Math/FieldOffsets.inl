@@ -36,10 +36,13 @@ namespace nzsl
 		if (m_layout == StructLayout::Std140)
 			fieldAlignement = Nz::AlignPow2(fieldAlignement, GetAlignement(StructLayout::Std140, StructFieldType::Float4));
 
+		// scalar layout doesn't round the array stride up to the vector alignment
+		std::size_t arrayStride = (m_layout == StructLayout::Scalar) ? GetSize(type) : fieldAlignement;
+
 		m_largestFieldAlignment = std::max(fieldAlignement, m_largestFieldAlignment);
 
 		std::size_t offset = Nz::AlignPow2(m_size, Nz::AlignPow2(fieldAlignement, m_offsetRounding));
-		m_size = offset + fieldAlignement * arraySize;
+		m_size = offset + arrayStride * arraySize;
 
 		m_offsetRounding = 1;
 
@@ -133,6 +136,39 @@ namespace nzsl
 			case StructLayout::Packed:
 				return 1;
 
+			case StructLayout::Scalar:
+			{
+				// vectors and matrices are aligned on their component size
+				switch (fieldType)
+				{
+					case StructFieldType::Bool1:
+					case StructFieldType::Bool2:
+					case StructFieldType::Bool3:
+					case StructFieldType::Bool4:
+					case StructFieldType::Float1:
+					case StructFieldType::Float2:
+					case StructFieldType::Float3:
+					case StructFieldType::Float4:
+					case StructFieldType::Int1:
+					case StructFieldType::Int2:
+					case StructFieldType::Int3:
+					case StructFieldType::Int4:
+					case StructFieldType::UInt1:
+					case StructFieldType::UInt2:
+					case StructFieldType::UInt3:
+					case StructFieldType::UInt4:
+						return 4;
+
+					case StructFieldType::Double1:
+					case StructFieldType::Double2:
+					case StructFieldType::Double3:
+					case StructFieldType::Double4:
+						return 8;
+				}
+
+				break;
+			}
+
 			case StructLayout::Std140:
 			case StructLayout::Std430:
 			{
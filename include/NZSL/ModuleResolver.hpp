@@ -11,6 +11,7 @@
 #include <NZSL/Config.hpp>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace nzsl
@@ -29,6 +30,7 @@ namespace nzsl
 			virtual ~ModuleResolver();
 
 			virtual Ast::ModulePtr Resolve(const std::string& /*moduleName*/) = 0;
+			virtual Ast::ModulePtr ResolveSymbols(const std::string& moduleName, const std::unordered_set<std::string>& symbols); //< may only load what the symbols (and their dependencies) require, defaults to Resolve
 
 			ModuleResolver& operator=(const ModuleResolver&) = default;
 			ModuleResolver& operator=(ModuleResolver&&) = default;
@@ -0,0 +1,75 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_PERMUTATIONCOMPILER_HPP
+#define NZSL_PERMUTATIONCOMPILER_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/GlslWriter.hpp>
+#include <NZSL/ShaderWriter.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/Ast/ConstantValue.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <NZSL/Ast/OptionUsageVisitor.hpp>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nzsl
+{
+	class NZSL_API PermutationCompiler
+	{
+		public:
+			template<typename T> struct Output;
+
+			using GlslOutput = Output<GlslWriter::Output>;
+			using OptionSet = std::unordered_map<std::uint32_t, Ast::ConstantValue>;
+			using OptionSpace = std::vector<std::pair<std::uint32_t, std::vector<Ast::ConstantValue>>>;
+			using SpirvOutput = Output<std::vector<std::uint32_t>>;
+
+			PermutationCompiler(const Ast::Module& module, const ShaderWriter::States& states = {});
+			PermutationCompiler(const PermutationCompiler&) = delete;
+			PermutationCompiler(PermutationCompiler&&) = delete;
+			~PermutationCompiler() = default;
+
+			GlslOutput CompileGlsl(std::optional<ShaderStageType> shaderStage, const std::vector<OptionSet>& optionSets, const GlslWriter::BindingMapping& bindingMapping = {}, const GlslWriter::Environment& environment = {}) const;
+			SpirvOutput CompileSpirv(const std::vector<OptionSet>& optionSets, const SpirvWriter::Environment& environment = {}) const;
+
+			inline const Ast::Module& GetModule() const;
+			inline const Ast::OptionUsageVisitor::Result& GetOptionUsage() const;
+			inline unsigned int GetThreadCount() const;
+
+			inline void SetThreadCount(unsigned int threadCount);
+
+			PermutationCompiler& operator=(const PermutationCompiler&) = delete;
+			PermutationCompiler& operator=(PermutationCompiler&&) = delete;
+
+			static std::vector<OptionSet> ExpandOptionSpace(const OptionSpace& optionSpace);
+
+			template<typename T>
+			struct Output
+			{
+				std::vector<T> variants; //< unique outputs
+				std::vector<std::size_t> variantByOptionSet; //< variant index of each option set
+				std::size_t generatedCount = 0; //< option sets which had to be generated (others were equivalent to one of them)
+			};
+
+		private:
+			template<typename T, typename F> Output<T> Compile(const std::vector<OptionSet>& optionSets, const std::vector<Ast::OptionHash>& influencingOptions, F&& generate) const;
+			std::vector<Ast::OptionHash> GetInfluencingOptions(ShaderStageTypeFlags shaderStages) const;
+			ShaderWriter::States BuildStates(const OptionSet& optionSet) const;
+
+			Ast::ModulePtr m_module;
+			Ast::OptionUsageVisitor::Result m_optionUsage;
+			ShaderWriter::States m_states;
+			unsigned int m_threadCount;
+	};
+}
+
+#include <NZSL/PermutationCompiler.inl>
+
+#endif // NZSL_PERMUTATIONCOMPILER_HPP
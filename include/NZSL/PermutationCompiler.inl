@@ -0,0 +1,29 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <cassert>
+
+namespace nzsl
+{
+	inline const Ast::Module& PermutationCompiler::GetModule() const
+	{
+		return *m_module;
+	}
+
+	inline const Ast::OptionUsageVisitor::Result& PermutationCompiler::GetOptionUsage() const
+	{
+		return m_optionUsage;
+	}
+
+	inline unsigned int PermutationCompiler::GetThreadCount() const
+	{
+		return m_threadCount;
+	}
+
+	inline void PermutationCompiler::SetThreadCount(unsigned int threadCount)
+	{
+		assert(threadCount > 0);
+		m_threadCount = threadCount;
+	}
+}
@@ -67,7 +67,7 @@ namespace nzsl
 			virtual void Deserialize(std::uint64_t& value) = 0;
 			virtual void Deserialize(std::string& value);
 			virtual void Deserialize(void* data, std::size_t size) = 0;
-			virtual void Deserialize(std::size_t size, const Nz::FunctionRef<std::size_t(const void* data)>& callback) = 0;
+			virtual void Deserialize(std::size_t size, const Nz::FunctionRef<std::size_t(const void* data)>& callback) = 0; //< data must stay valid as long as the deserializer, binary module readers keep views into it
 
 			virtual void SeekTo(std::size_t offset) = 0;
 	};
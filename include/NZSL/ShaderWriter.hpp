@@ -15,6 +15,7 @@
 
 namespace nzsl
 {
+	class CompilationStats;
 	class ModuleResolver;
 
 	class NZSL_API ShaderWriter
@@ -31,8 +32,13 @@ namespace nzsl
 			{
 				std::shared_ptr<ModuleResolver> shaderModuleResolver;
 				std::unordered_map<std::uint32_t, Ast::ConstantValue> optionValues;
+				CompilationStats* compilationStats = nullptr; //< if set, records timings of every phase (must outlive the generation)
 				DebugLevel debugLevel = DebugLevel::Minimal;
+				OptimizationLevel optimizationLevel = OptimizationLevel::Basic; //< passes run when optimize is set
+				bool fastMath = false; //< allows optimizations changing floating-point results (rounding, NaN and signed zeros)
+				bool inferPrecision = false; //< lowers the precision of local f32 variables only holding medium precision values (mediump in GLSL ES, RelaxedPrecision in SPIR-V)
 				bool optimize = false;
+				bool packVaryings = false; //< packs vertex outputs and fragment inputs sharing a component type and interpolation into the same locations (see Ast::PackVaryings), every stage must be generated with it and declare the same location members (see Ast::ValidateVaryingPacking)
 				bool sanitized = false;
 			};
 	};
@@ -111,12 +111,38 @@ namespace nzsl
 					SpirvConstantCache::TypePtr type;
 				};
 
+				// Variable holding multiple members in its components (see Ast::PackVaryings)
+				struct PackedInput
+				{
+					struct Member
+					{
+						std::uint32_t componentCount;
+						std::uint32_t firstComponent;
+						std::uint32_t memberIndexConstantId;
+						std::uint32_t memberPointerId;
+						std::uint32_t memberTypeId;
+					};
+
+					std::vector<Member> members;
+					std::uint32_t typeId;
+					std::uint32_t varId;
+				};
+
+				struct PackedOutput
+				{
+					std::vector<Output> members; //< in component order
+					std::uint32_t typeId;
+					std::uint32_t varId;
+				};
+
 				ShaderStageType stageType;
 				std::optional<InputStruct> inputStruct;
 				std::optional<std::uint32_t> outputStructTypeId;
 				std::vector<ExecutionMode> executionModes;
 				std::vector<Input> inputs;
 				std::vector<Output> outputs;
+				std::vector<PackedInput> packedInputs;
+				std::vector<PackedOutput> packedOutputs;
 			};
 
 			struct FuncData
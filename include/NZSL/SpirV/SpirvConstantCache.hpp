@@ -31,7 +31,7 @@ namespace nzsl
 		public:
 			using StructCallback = std::function<const Ast::StructDescription&(std::size_t structIndex)>;
 
-			SpirvConstantCache(SpirvWriter& writer, std::uint32_t& resultId);
+			SpirvConstantCache(SpirvWriter& writer, std::uint32_t& resultId, const SpirvConstantCache* parentCache = nullptr);
 			SpirvConstantCache(const SpirvConstantCache& cache) = delete;
 			SpirvConstantCache(SpirvConstantCache&& cache) noexcept = default;
 			~SpirvConstantCache();
@@ -113,6 +113,7 @@ namespace nzsl
 					std::string name;
 					TypePtr type;
 					mutable std::optional<std::uint32_t> offset;
+					bool relaxedPrecision = false;
 				};
 
 				std::string name;
@@ -208,6 +209,7 @@ namespace nzsl
 			std::uint32_t Register(Constant c);
 			std::uint32_t Register(Type t);
 			std::uint32_t Register(Variable v);
+			std::vector<std::uint32_t> RegisterChildIds(const SpirvConstantCache& childCache, std::uint32_t firstChildId, std::uint32_t childIdCount);
 			
 			void RegisterSource(SpirvSourceLanguage sourceLang, std::uint32_t version, std::uint32_t fileNameId = 0, std::string source = "");
 			void RegisterSourceExtension(std::string sourceExtension);
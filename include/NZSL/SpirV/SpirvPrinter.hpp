@@ -9,8 +9,9 @@
 
 #include <NZSL/Config.hpp>
 #include <NZSL/SpirV/SpirvDecoder.hpp>
-#include <iosfwd>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace nzsl
@@ -20,6 +21,8 @@ namespace nzsl
 		public:
 			struct Settings;
 
+			using OutputCallback = std::function<void(std::string_view text)>;
+
 			inline SpirvPrinter();
 			SpirvPrinter(const SpirvPrinter&) = default;
 			SpirvPrinter(SpirvPrinter&&) = default;
@@ -29,6 +32,7 @@ namespace nzsl
 			inline std::string Print(const std::uint32_t* codepoints, std::size_t count);
 			inline std::string Print(const std::vector<std::uint32_t>& codepoints, const Settings& settings);
 			std::string Print(const std::uint32_t* codepoints, std::size_t count, const Settings& settings);
+			void Print(const std::uint32_t* codepoints, std::size_t count, const Settings& settings, const OutputCallback& outputCallback); //< streams text by chunks instead of building the whole string
 
 			SpirvPrinter& operator=(const SpirvPrinter&) = default;
 			SpirvPrinter& operator=(SpirvPrinter&&) = default;
@@ -42,7 +46,7 @@ namespace nzsl
 		private:
 			bool HandleHeader(const SpirvHeader& header) override;
 			bool HandleOpcode(const SpirvInstruction& instruction, std::uint32_t wordCount) override;
-			void PrintOperand(std::ostream& instructionStream, const SpirvOperand* operand);
+			void PrintOperand(const SpirvOperand* operand);
 
 			enum class ExtensionSet
 			{
@@ -11,12 +11,15 @@
 #include <NZSL/ShaderWriter.hpp>
 #include <NZSL/Ast/ConstantValue.hpp>
 #include <NZSL/Ast/Module.hpp>
+#include <NZSL/Ast/Option.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <NZSL/SpirV/SpirvConstantCache.hpp>
 #include <NZSL/SpirV/SpirvVariable.hpp>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace nzsl
 {
@@ -33,6 +36,7 @@ namespace nzsl
 
 		public:
 			struct Environment;
+			struct SpecializationConstant;
 
 			SpirvWriter();
 			SpirvWriter(const SpirvWriter&) = delete;
@@ -42,6 +46,7 @@ namespace nzsl
 			std::vector<std::uint32_t> Generate(const Ast::Module& module, const States& states = {});
 
 			const SpirvVariable& GetConstantVariable(std::size_t constIndex) const;
+			inline const std::vector<SpecializationConstant>& GetSpecializationConstants() const;
 
 			bool IsVersionGreaterOrEqual(std::uint32_t spvMajor, std::uint32_t spvMinor) const;
 
@@ -51,6 +56,16 @@ namespace nzsl
 			{
 				std::uint32_t spvMajorVersion = 1;
 				std::uint32_t spvMinorVersion = 0;
+				bool optionsAsSpecializationConstants = false; //< emit scalar options (bool, f32, i32, u32) which are only used at runtime as specialization constants
+				unsigned int codegenThreadCount = 1; //< number of threads generating function bodies, the output doesn't depend on it
+			};
+
+			struct SpecializationConstant
+			{
+				std::string optionName;
+				Ast::ConstantValue value; //< default value of the specialization constant
+				Ast::OptionHash optionHash;
+				std::uint32_t specId;
 			};
 			
 			static std::pair<std::uint32_t, std::uint32_t> GetMaximumSupportedVersion(std::uint32_t vkMajorVersion, std::uint32_t vkMinorVersion);
@@ -62,6 +77,7 @@ namespace nzsl
 
 			std::uint32_t AllocateResultId();
 
+			void AppendFunctions(const Ast::Module& module);
 			void AppendHeader();
 
 			SpirvConstantCache::TypePtr BuildType(const Ast::ExpressionType& type);
@@ -75,6 +91,7 @@ namespace nzsl
 			std::uint32_t GetPointerTypeId(const SpirvConstantCache::TypePtr& typePtr, SpirvStorageClass storageClass) const;
 			std::uint32_t GetPointerTypeId(const Ast::ExpressionType& type, SpirvStorageClass storageClass) const;
 			std::uint32_t GetSourceFileId(const std::shared_ptr<const std::string>& filepathPtr);
+			std::optional<std::uint32_t> GetSpecializationConstantId(std::size_t constIndex) const;
 			std::uint32_t GetTypeId(const SpirvConstantCache::Type& type) const;
 			std::uint32_t GetTypeId(const Ast::ExpressionType& type) const;
 
@@ -99,6 +116,7 @@ namespace nzsl
 			Context m_context;
 			Environment m_environment;
 			State* m_currentState;
+			std::vector<SpecializationConstant> m_specializationConstants;
 	};
 }
 
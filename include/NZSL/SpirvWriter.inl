@@ -5,4 +5,8 @@
 
 namespace nzsl
 {
+	inline auto SpirvWriter::GetSpecializationConstants() const -> const std::vector<SpecializationConstant>&
+	{
+		return m_specializationConstants;
+	}
 }
@@ -0,0 +1,271 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language - C Binding" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <CNZSL/AsyncCompiler.h>
+#include <CNZSL/Structs/AsyncCompiler.hpp>
+#include <CNZSL/Structs/GlslBindingMapping.hpp>
+#include <CNZSL/Structs/GlslOutput.hpp>
+#include <CNZSL/Structs/LangOutput.hpp>
+#include <CNZSL/Structs/Module.hpp>
+#include <CNZSL/Structs/SpirvOutput.hpp>
+#include <CNZSL/Structs/WriterStates.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace
+{
+	nzsl::ShaderWriter::States BuildStates(const nzslWriterStates* statesPtr)
+	{
+		nzsl::ShaderWriter::States states;
+		if (statesPtr)
+			states = static_cast<const nzsl::ShaderWriter::States&>(*statesPtr);
+
+		return states;
+	}
+
+	nzslCompileJob* SubmitGlsl(std::optional<nzsl::ShaderStageType> stage, nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslGlslBindingMapping* bindingMapping, const nzslWriterStates* statesPtr, const nzslGlslWriterEnvironment* env, int priority)
+	{
+		try
+		{
+			nzsl::GlslWriter::Environment writerEnv;
+			if (env)
+			{
+				writerEnv.glMajorVersion = env->glMajorVersion;
+				writerEnv.glMinorVersion = env->glMinorVersion;
+				writerEnv.glES = env->glES;
+				writerEnv.flipYPosition = env->flipYPosition;
+				writerEnv.remapZPosition = env->remapZPosition;
+				writerEnv.allowDrawParametersUniformsFallback = env->allowDrawParametersUniformsFallback;
+			}
+
+			nzsl::GlslWriter::BindingMapping mappings;
+			if (bindingMapping)
+				mappings = bindingMapping->mappings;
+
+			std::unique_ptr<nzslCompileJob> job = std::make_unique<nzslCompileJob>();
+			job->job = compilerPtr->compiler->SubmitGlsl(modulePtr->module, stage, BuildStates(statesPtr), mappings, writerEnv, priority);
+
+			return job.release();
+		}
+		catch (std::exception& e)
+		{
+			compilerPtr->lastError = fmt::format("nzslAsyncCompilerSubmitGlsl failed: {}", e.what());
+			return nullptr;
+		}
+		catch (...)
+		{
+			compilerPtr->lastError = "nzslAsyncCompilerSubmitGlsl failed with unknown error";
+			return nullptr;
+		}
+	}
+
+	template<typename T, typename F>
+	T* GetOutput(nzslCompileJob* jobPtr, const char* functionName, F&& fillOutput)
+	{
+		try
+		{
+			std::unique_ptr<T> output = std::make_unique<T>();
+			fillOutput(*output);
+
+			return output.release();
+		}
+		catch (std::exception& e)
+		{
+			jobPtr->lastError = fmt::format("{} failed: {}", functionName, e.what());
+			return nullptr;
+		}
+		catch (...)
+		{
+			jobPtr->lastError = fmt::format("{} failed with unknown error", functionName);
+			return nullptr;
+		}
+	}
+}
+
+extern "C"
+{
+	CNZSL_API nzslAsyncCompiler* nzslAsyncCompilerCreate(unsigned int threadCount)
+	{
+		std::unique_ptr<nzslAsyncCompiler> compiler = std::make_unique<nzslAsyncCompiler>();
+		compiler->compiler = std::make_unique<nzsl::AsyncCompiler>(threadCount);
+
+		return compiler.release();
+	}
+
+	CNZSL_API nzslAsyncCompiler* nzslAsyncCompilerCreateWithExecutor(nzslExecutorCallback executor, void* userdata)
+	{
+		std::unique_ptr<nzslAsyncCompiler> compiler = std::make_unique<nzslAsyncCompiler>();
+		compiler->compiler = std::make_unique<nzsl::AsyncCompiler>([executor, userdata](std::function<void()> task)
+		{
+			using Task = std::function<void()>;
+
+			std::unique_ptr<Task> taskData = std::make_unique<Task>(std::move(task));
+			executor(userdata, [](void* data)
+			{
+				std::unique_ptr<Task> task(static_cast<Task*>(data));
+				(*task)();
+			}, taskData.get());
+
+			taskData.release(); //< now owned by the executor task
+		});
+
+		return compiler.release();
+	}
+
+	CNZSL_API void nzslAsyncCompilerDestroy(nzslAsyncCompiler* compilerPtr)
+	{
+		delete compilerPtr;
+	}
+
+	CNZSL_API void nzslAsyncCompilerCancelAll(nzslAsyncCompiler* compilerPtr)
+	{
+		compilerPtr->compiler->CancelAll();
+	}
+
+	CNZSL_API const char* nzslAsyncCompilerGetLastError(const nzslAsyncCompiler* compilerPtr)
+	{
+		return compilerPtr->lastError.c_str();
+	}
+
+	CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitGlsl(nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslGlslBindingMapping* bindingMapping, const nzslWriterStates* statesPtr, const nzslGlslWriterEnvironment* env, int priority)
+	{
+		return SubmitGlsl(std::nullopt, compilerPtr, modulePtr, bindingMapping, statesPtr, env, priority);
+	}
+
+	CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitGlslStage(nzslShaderStageType stage, nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslGlslBindingMapping* bindingMapping, const nzslWriterStates* statesPtr, const nzslGlslWriterEnvironment* env, int priority)
+	{
+		constexpr std::array s_shaderStages = {
+			nzsl::ShaderStageType::Compute,  // NZSL_STAGE_COMPUTE
+			nzsl::ShaderStageType::Fragment, // NZSL_STAGE_FRAGMENT
+			nzsl::ShaderStageType::Vertex    // NZSL_STAGE_VERTEX
+		};
+
+		return SubmitGlsl(s_shaderStages[stage], compilerPtr, modulePtr, bindingMapping, statesPtr, env, priority);
+	}
+
+	CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitNzsl(nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslWriterStates* statesPtr, int priority)
+	{
+		try
+		{
+			std::unique_ptr<nzslCompileJob> job = std::make_unique<nzslCompileJob>();
+			job->job = compilerPtr->compiler->SubmitNzsl(modulePtr->module, BuildStates(statesPtr), {}, priority);
+
+			return job.release();
+		}
+		catch (std::exception& e)
+		{
+			compilerPtr->lastError = fmt::format("nzslAsyncCompilerSubmitNzsl failed: {}", e.what());
+			return nullptr;
+		}
+		catch (...)
+		{
+			compilerPtr->lastError = "nzslAsyncCompilerSubmitNzsl failed with unknown error";
+			return nullptr;
+		}
+	}
+
+	CNZSL_API nzslCompileJob* nzslAsyncCompilerSubmitSpirv(nzslAsyncCompiler* compilerPtr, const nzslModule* modulePtr, const nzslWriterStates* statesPtr, const nzslSpirvWriterEnvironment* env, int priority)
+	{
+		try
+		{
+			nzsl::SpirvWriter::Environment writerEnv;
+			if (env)
+			{
+				writerEnv.spvMajorVersion = env->spvMajorVersion;
+				writerEnv.spvMinorVersion = env->spvMinorVersion;
+			}
+
+			std::unique_ptr<nzslCompileJob> job = std::make_unique<nzslCompileJob>();
+			job->job = compilerPtr->compiler->SubmitSpirv(modulePtr->module, BuildStates(statesPtr), writerEnv, priority);
+
+			return job.release();
+		}
+		catch (std::exception& e)
+		{
+			compilerPtr->lastError = fmt::format("nzslAsyncCompilerSubmitSpirv failed: {}", e.what());
+			return nullptr;
+		}
+		catch (...)
+		{
+			compilerPtr->lastError = "nzslAsyncCompilerSubmitSpirv failed with unknown error";
+			return nullptr;
+		}
+	}
+
+	CNZSL_API void nzslCompileJobDestroy(nzslCompileJob* jobPtr)
+	{
+		delete jobPtr;
+	}
+
+	CNZSL_API nzslBool nzslCompileJobCancel(nzslCompileJob* jobPtr)
+	{
+		return jobPtr->job->Cancel();
+	}
+
+	CNZSL_API const char* nzslCompileJobGetLastError(const nzslCompileJob* jobPtr)
+	{
+		return jobPtr->lastError.c_str();
+	}
+
+	CNZSL_API int nzslCompileJobGetPriority(const nzslCompileJob* jobPtr)
+	{
+		return jobPtr->job->GetPriority();
+	}
+
+	CNZSL_API nzslCompileJobStatus nzslCompileJobGetStatus(const nzslCompileJob* jobPtr)
+	{
+		switch (jobPtr->job->GetStatus())
+		{
+			case nzsl::CompileJobStatus::Pending:   return NZSL_COMPILE_JOB_PENDING;
+			case nzsl::CompileJobStatus::Running:   return NZSL_COMPILE_JOB_RUNNING;
+			case nzsl::CompileJobStatus::Succeeded: return NZSL_COMPILE_JOB_SUCCEEDED;
+			case nzsl::CompileJobStatus::Failed:    return NZSL_COMPILE_JOB_FAILED;
+			case nzsl::CompileJobStatus::Cancelled: return NZSL_COMPILE_JOB_CANCELLED;
+		}
+
+		return NZSL_COMPILE_JOB_FAILED;
+	}
+
+	CNZSL_API nzslGlslOutput* nzslCompileJobGetGlslOutput(nzslCompileJob* jobPtr)
+	{
+		return GetOutput<nzslGlslOutput>(jobPtr, "nzslCompileJobGetGlslOutput", [&](nzslGlslOutput& output)
+		{
+			static_cast<nzsl::GlslWriter::Output&>(output) = jobPtr->job->GetGlslOutput();
+		});
+	}
+
+	CNZSL_API nzslLangOutput* nzslCompileJobGetNzslOutput(nzslCompileJob* jobPtr)
+	{
+		return GetOutput<nzslLangOutput>(jobPtr, "nzslCompileJobGetNzslOutput", [&](nzslLangOutput& output)
+		{
+			output.code = jobPtr->job->GetNzslOutput();
+		});
+	}
+
+	CNZSL_API nzslSpirvOutput* nzslCompileJobGetSpirvOutput(nzslCompileJob* jobPtr)
+	{
+		return GetOutput<nzslSpirvOutput>(jobPtr, "nzslCompileJobGetSpirvOutput", [&](nzslSpirvOutput& output)
+		{
+			output.spirv = jobPtr->job->GetSpirvOutput();
+		});
+	}
+
+	CNZSL_API void nzslCompileJobSetPriority(nzslCompileJob* jobPtr, int priority)
+	{
+		jobPtr->job->SetPriority(priority);
+	}
+
+	CNZSL_API void nzslCompileJobWait(const nzslCompileJob* jobPtr)
+	{
+		jobPtr->job->Wait();
+	}
+
+	CNZSL_API nzslBool nzslCompileJobWaitFor(const nzslCompileJob* jobPtr, uint32_t timeoutMs)
+	{
+		return jobPtr->job->WaitFor(std::chrono::milliseconds(timeoutMs));
+	}
+}
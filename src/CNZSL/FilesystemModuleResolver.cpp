@@ -98,6 +98,18 @@ extern "C"
 		}
 	}
 
+	CNZSL_API void nzslFilesystemModuleResolverSetLazyLoading(nzslFilesystemModuleResolver* resolverPtr, nzslBool lazyLoading)
+	{
+		assert(resolverPtr);
+		resolverPtr->resolver->SetLazyLoading(lazyLoading != 0);
+	}
+
+	CNZSL_API void nzslFilesystemModuleResolverSetThreadCount(nzslFilesystemModuleResolver* resolverPtr, unsigned int threadCount)
+	{
+		assert(resolverPtr);
+		resolverPtr->resolver->SetThreadCount(threadCount);
+	}
+
 	CNZSL_API const char* nzslFilesystemModuleResolverGetLastError(const nzslFilesystemModuleResolver* resolverPtr)
 	{
 		assert(resolverPtr);
@@ -0,0 +1,216 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language - C Binding" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <CNZSL/PermutationCompiler.h>
+#include <CNZSL/Structs/GlslBindingMapping.hpp>
+#include <CNZSL/Structs/Module.hpp>
+#include <CNZSL/Structs/PermutationCompiler.hpp>
+#include <CNZSL/Structs/WriterStates.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <optional>
+#include <string>
+
+namespace
+{
+	std::vector<nzsl::PermutationCompiler::OptionSet> BuildOptionSets(const nzslWriterStates* const* optionSets, size_t optionSetCount)
+	{
+		std::vector<nzsl::PermutationCompiler::OptionSet> result;
+		result.reserve(optionSetCount);
+		for (size_t i = 0; i < optionSetCount; ++i)
+		{
+			if (optionSets[i])
+				result.push_back(optionSets[i]->optionValues);
+			else
+				result.emplace_back();
+		}
+
+		return result;
+	}
+
+	nzslGlslPermutationOutput* GenerateGlsl(std::optional<nzsl::ShaderStageType> stage, nzslPermutationCompiler* compilerPtr, const nzslWriterStates* const* optionSets, size_t optionSetCount, const nzslGlslBindingMapping* bindingMapping, const nzslGlslWriterEnvironment* env)
+	{
+		try
+		{
+			if (!compilerPtr->compiler)
+				throw std::runtime_error("no module set");
+
+			nzsl::GlslWriter::Environment writerEnv;
+			if (env)
+			{
+				writerEnv.glMajorVersion = env->glMajorVersion;
+				writerEnv.glMinorVersion = env->glMinorVersion;
+				writerEnv.glES = env->glES;
+				writerEnv.flipYPosition = env->flipYPosition;
+				writerEnv.remapZPosition = env->remapZPosition;
+				writerEnv.allowDrawParametersUniformsFallback = env->allowDrawParametersUniformsFallback;
+			}
+
+			nzsl::GlslWriter::BindingMapping mappings;
+			if (bindingMapping)
+				mappings = bindingMapping->mappings;
+
+			std::unique_ptr<nzslGlslPermutationOutput> output = std::make_unique<nzslGlslPermutationOutput>();
+			static_cast<nzsl::PermutationCompiler::GlslOutput&>(*output) = compilerPtr->compiler->CompileGlsl(stage, BuildOptionSets(optionSets, optionSetCount), mappings, writerEnv);
+
+			return output.release();
+		}
+		catch (std::exception& e)
+		{
+			compilerPtr->lastError = fmt::format("nzslPermutationCompilerGenerateGlsl failed: {}", e.what());
+			return nullptr;
+		}
+		catch (...)
+		{
+			compilerPtr->lastError = "nzslPermutationCompilerGenerateGlsl failed with unknown error";
+			return nullptr;
+		}
+	}
+}
+
+extern "C"
+{
+	CNZSL_API nzslPermutationCompiler* nzslPermutationCompilerCreate(void)
+	{
+		return new nzslPermutationCompiler;
+	}
+
+	CNZSL_API void nzslPermutationCompilerDestroy(nzslPermutationCompiler* compilerPtr)
+	{
+		delete compilerPtr;
+	}
+
+	CNZSL_API nzslBool nzslPermutationCompilerSetModule(nzslPermutationCompiler* compilerPtr, const nzslModule* modulePtr, const nzslWriterStates* statesPtr)
+	{
+		try
+		{
+			nzsl::ShaderWriter::States states;
+			if (statesPtr)
+				states = static_cast<const nzsl::ShaderWriter::States&>(*statesPtr);
+
+			compilerPtr->compiler = std::make_unique<nzsl::PermutationCompiler>(*modulePtr->module, states);
+			if (compilerPtr->threadCount > 0)
+				compilerPtr->compiler->SetThreadCount(compilerPtr->threadCount);
+
+			return 1;
+		}
+		catch (std::exception& e)
+		{
+			compilerPtr->lastError = fmt::format("nzslPermutationCompilerSetModule failed: {}", e.what());
+			return 0;
+		}
+		catch (...)
+		{
+			compilerPtr->lastError = "nzslPermutationCompilerSetModule failed with unknown error";
+			return 0;
+		}
+	}
+
+	CNZSL_API void nzslPermutationCompilerSetThreadCount(nzslPermutationCompiler* compilerPtr, unsigned int threadCount)
+	{
+		compilerPtr->threadCount = threadCount;
+		if (compilerPtr->compiler && threadCount > 0)
+			compilerPtr->compiler->SetThreadCount(threadCount);
+	}
+
+	CNZSL_API nzslGlslPermutationOutput* nzslPermutationCompilerGenerateGlsl(nzslPermutationCompiler* compilerPtr, const nzslWriterStates* const* optionSets, size_t optionSetCount, const nzslGlslBindingMapping* bindingMapping, const nzslGlslWriterEnvironment* env)
+	{
+		return GenerateGlsl(std::nullopt, compilerPtr, optionSets, optionSetCount, bindingMapping, env);
+	}
+
+	CNZSL_API nzslGlslPermutationOutput* nzslPermutationCompilerGenerateGlslStage(nzslShaderStageType stage, nzslPermutationCompiler* compilerPtr, const nzslWriterStates* const* optionSets, size_t optionSetCount, const nzslGlslBindingMapping* bindingMapping, const nzslGlslWriterEnvironment* env)
+	{
+		constexpr std::array s_shaderStages = {
+			nzsl::ShaderStageType::Compute,  // NZSL_STAGE_COMPUTE
+			nzsl::ShaderStageType::Fragment, // NZSL_STAGE_FRAGMENT
+			nzsl::ShaderStageType::Vertex    // NZSL_STAGE_VERTEX
+		};
+
+		return GenerateGlsl(s_shaderStages[stage], compilerPtr, optionSets, optionSetCount, bindingMapping, env);
+	}
+
+	CNZSL_API nzslSpirvPermutationOutput* nzslPermutationCompilerGenerateSpirv(nzslPermutationCompiler* compilerPtr, const nzslWriterStates* const* optionSets, size_t optionSetCount, const nzslSpirvWriterEnvironment* env)
+	{
+		try
+		{
+			if (!compilerPtr->compiler)
+				throw std::runtime_error("no module set");
+
+			nzsl::SpirvWriter::Environment writerEnv;
+			if (env)
+			{
+				writerEnv.spvMajorVersion = env->spvMajorVersion;
+				writerEnv.spvMinorVersion = env->spvMinorVersion;
+			}
+
+			std::unique_ptr<nzslSpirvPermutationOutput> output = std::make_unique<nzslSpirvPermutationOutput>();
+			static_cast<nzsl::PermutationCompiler::SpirvOutput&>(*output) = compilerPtr->compiler->CompileSpirv(BuildOptionSets(optionSets, optionSetCount), writerEnv);
+
+			return output.release();
+		}
+		catch (std::exception& e)
+		{
+			compilerPtr->lastError = fmt::format("nzslPermutationCompilerGenerateSpirv failed: {}", e.what());
+			return nullptr;
+		}
+		catch (...)
+		{
+			compilerPtr->lastError = "nzslPermutationCompilerGenerateSpirv failed with unknown error";
+			return nullptr;
+		}
+	}
+
+	CNZSL_API const char* nzslPermutationCompilerGetLastError(const nzslPermutationCompiler* compilerPtr)
+	{
+		return compilerPtr->lastError.c_str();
+	}
+
+	CNZSL_API void nzslGlslPermutationOutputDestroy(nzslGlslPermutationOutput* outputPtr)
+	{
+		delete outputPtr;
+	}
+
+	CNZSL_API size_t nzslGlslPermutationOutputGetOptionSetVariant(const nzslGlslPermutationOutput* outputPtr, size_t optionSetIndex)
+	{
+		return outputPtr->variantByOptionSet[optionSetIndex];
+	}
+
+	CNZSL_API const char* nzslGlslPermutationOutputGetVariantCode(const nzslGlslPermutationOutput* outputPtr, size_t variantIndex, size_t* length)
+	{
+		const std::string& code = outputPtr->variants[variantIndex].code;
+		if (length)
+			*length = code.size();
+
+		return code.data();
+	}
+
+	CNZSL_API size_t nzslGlslPermutationOutputGetVariantCount(const nzslGlslPermutationOutput* outputPtr)
+	{
+		return outputPtr->variants.size();
+	}
+
+	CNZSL_API void nzslSpirvPermutationOutputDestroy(nzslSpirvPermutationOutput* outputPtr)
+	{
+		delete outputPtr;
+	}
+
+	CNZSL_API size_t nzslSpirvPermutationOutputGetOptionSetVariant(const nzslSpirvPermutationOutput* outputPtr, size_t optionSetIndex)
+	{
+		return outputPtr->variantByOptionSet[optionSetIndex];
+	}
+
+	CNZSL_API const uint32_t* nzslSpirvPermutationOutputGetVariantSpirv(const nzslSpirvPermutationOutput* outputPtr, size_t variantIndex, size_t* length)
+	{
+		const std::vector<std::uint32_t>& spirv = outputPtr->variants[variantIndex];
+		if (length)
+			*length = spirv.size();
+
+		return spirv.data();
+	}
+
+	CNZSL_API size_t nzslSpirvPermutationOutputGetVariantCount(const nzslSpirvPermutationOutput* outputPtr)
+	{
+		return outputPtr->variants.size();
+	}
+}
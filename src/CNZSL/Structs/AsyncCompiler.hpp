@@ -0,0 +1,26 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language - C Binding" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef CNZSL_STRUCTS_ASYNCCOMPILER_HPP
+#define CNZSL_STRUCTS_ASYNCCOMPILER_HPP
+
+#include <NZSL/AsyncCompiler.hpp>
+#include <memory>
+#include <string>
+
+struct nzslAsyncCompiler
+{
+	std::string lastError;
+	std::unique_ptr<nzsl::AsyncCompiler> compiler;
+};
+
+struct nzslCompileJob
+{
+	std::string lastError;
+	nzsl::AsyncCompiler::JobPtr job;
+};
+
+#endif // CNZSL_STRUCTS_ASYNCCOMPILER_HPP
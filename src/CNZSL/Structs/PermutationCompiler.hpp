@@ -0,0 +1,29 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language - C Binding" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef CNZSL_STRUCTS_PERMUTATIONCOMPILER_HPP
+#define CNZSL_STRUCTS_PERMUTATIONCOMPILER_HPP
+
+#include <NZSL/PermutationCompiler.hpp>
+#include <memory>
+#include <string>
+
+struct nzslPermutationCompiler
+{
+	std::string lastError;
+	std::unique_ptr<nzsl::PermutationCompiler> compiler;
+	unsigned int threadCount = 0;
+};
+
+struct nzslGlslPermutationOutput : nzsl::PermutationCompiler::GlslOutput
+{
+};
+
+struct nzslSpirvPermutationOutput : nzsl::PermutationCompiler::SpirvOutput
+{
+};
+
+#endif // CNZSL_STRUCTS_PERMUTATIONCOMPILER_HPP
@@ -0,0 +1,784 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/AlgebraicSimplificationVisitor.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <NZSL/ShaderBuilder.hpp>
+#include <NZSL/Ast/Compare.hpp>
+#include <NZSL/Ast/Utils.hpp>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+namespace nzsl::Ast
+{
+	namespace
+	{
+		// Expressions which can be evaluated twice instead of once without any noticeable cost
+		bool IsTrivial(const Expression& expr)
+		{
+			switch (expr.GetType())
+			{
+				case NodeType::ConstantValueExpression:
+				case NodeType::VariableValueExpression:
+					return true;
+
+				case NodeType::AccessIdentifierExpression:
+					return IsTrivial(*static_cast<const AccessIdentifierExpression&>(expr).expr);
+
+				case NodeType::AccessIndexExpression:
+				{
+					const AccessIndexExpression& accessIndex = static_cast<const AccessIndexExpression&>(expr);
+					for (const ExpressionPtr& index : accessIndex.indices)
+					{
+						if (index->GetType() != NodeType::ConstantValueExpression)
+							return false;
+					}
+
+					return IsTrivial(*accessIndex.expr);
+				}
+
+				case NodeType::SwizzleExpression:
+					return IsTrivial(*static_cast<const SwizzleExpression&>(expr).expression);
+
+				default:
+					return false;
+			}
+		}
+
+		std::optional<PrimitiveType> GetBaseType(const ExpressionType& exprType)
+		{
+			const ExpressionType& resolvedType = ResolveAlias(exprType);
+			if (IsPrimitiveType(resolvedType))
+				return std::get<PrimitiveType>(resolvedType);
+			else if (IsVectorType(resolvedType))
+				return std::get<VectorType>(resolvedType).type;
+			else if (IsMatrixType(resolvedType))
+				return std::get<MatrixType>(resolvedType).type;
+			else
+				return std::nullopt;
+		}
+
+		bool IsFloatingPoint(const Expression& expr)
+		{
+			const ExpressionType* exprType = GetExpressionType(expr);
+			if (!exprType)
+				return false;
+
+			std::optional<PrimitiveType> baseType = GetBaseType(*exprType);
+			return baseType == PrimitiveType::Float32 || baseType == PrimitiveType::Float64;
+		}
+
+		bool IsInteger(const Expression& expr)
+		{
+			const ExpressionType* exprType = GetExpressionType(expr);
+			if (!exprType)
+				return false;
+
+			std::optional<PrimitiveType> baseType = GetBaseType(*exprType);
+			return baseType == PrimitiveType::Int32 || baseType == PrimitiveType::UInt32;
+		}
+
+		bool IsScalarType(const Expression& expr, PrimitiveType primitiveType)
+		{
+			const ExpressionType* exprType = GetExpressionType(expr);
+			if (!exprType)
+				return false;
+
+			const ExpressionType& resolvedType = ResolveAlias(*exprType);
+			return IsPrimitiveType(resolvedType) && std::get<PrimitiveType>(resolvedType) == primitiveType;
+		}
+
+		bool HasSameType(const Expression& lhs, const Expression& rhs)
+		{
+			return lhs.cachedExpressionType && lhs.cachedExpressionType == rhs.cachedExpressionType;
+		}
+
+		// Value of a numerical scalar constant, or of a vector constant having the same value in every component
+		std::optional<double> GetSplatValue(const Expression& expr)
+		{
+			if (expr.GetType() != NodeType::ConstantValueExpression)
+				return std::nullopt;
+
+			return std::visit([](auto&& arg) -> std::optional<double>
+			{
+				using T = std::decay_t<decltype(arg)>;
+
+				if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t>)
+					return static_cast<double>(arg);
+				else if constexpr (IsVector_v<T>)
+				{
+					if constexpr (std::is_same_v<typename T::Base, bool>)
+						return std::nullopt;
+
+					double value = static_cast<double>(arg[0]);
+					for (std::size_t i = 1; i < T::Dimensions; ++i)
+					{
+						double componentValue = static_cast<double>(arg[i]);
+						if (componentValue != value || std::signbit(componentValue) != std::signbit(value))
+							return std::nullopt;
+					}
+
+					return value;
+				}
+				else
+					return std::nullopt;
+			}, static_cast<const ConstantValueExpression&>(expr).value);
+		}
+
+		std::optional<bool> GetBooleanValue(const Expression& expr)
+		{
+			if (expr.GetType() != NodeType::ConstantValueExpression)
+				return std::nullopt;
+
+			const ConstantSingleValue& value = static_cast<const ConstantValueExpression&>(expr).value;
+			if (!std::holds_alternative<bool>(value))
+				return std::nullopt;
+
+			return std::get<bool>(value);
+		}
+
+		bool IsSplatValue(const Expression& expr, double value)
+		{
+			std::optional<double> splatValue = GetSplatValue(expr);
+			return splatValue && *splatValue == value;
+		}
+
+		bool IsPositiveZero(const Expression& expr)
+		{
+			std::optional<double> splatValue = GetSplatValue(expr);
+			return splatValue && *splatValue == 0.0 && !std::signbit(*splatValue);
+		}
+
+		// Returns n if value is 2^n (with n > 0 for integers)
+		std::optional<int> GetPowerOfTwoExponent(double value)
+		{
+			if (!std::isfinite(value) || value == 0.0)
+				return std::nullopt;
+
+			int exponent;
+			if (std::frexp(value, &exponent) != 0.5)
+				return std::nullopt;
+
+			return exponent - 1;
+		}
+
+		template<typename T>
+		std::optional<ConstantSingleValue> BuildSplatValue(std::size_t componentCount, T value)
+		{
+			switch (componentCount)
+			{
+				case 1: return ConstantSingleValue(value);
+				case 2: return ConstantSingleValue(Vector2<T>(value, value));
+				case 3: return ConstantSingleValue(Vector3<T>(value, value, value));
+				case 4: return ConstantSingleValue(Vector4<T>(value, value, value, value));
+			}
+
+			return std::nullopt;
+		}
+
+		std::optional<ConstantSingleValue> BuildSplatValue(const ExpressionType& exprType, double value)
+		{
+			const ExpressionType& resolvedType = ResolveAlias(exprType);
+
+			PrimitiveType primitiveType;
+			std::size_t componentCount;
+			if (IsPrimitiveType(resolvedType))
+			{
+				primitiveType = std::get<PrimitiveType>(resolvedType);
+				componentCount = 1;
+			}
+			else if (IsVectorType(resolvedType))
+			{
+				const VectorType& vecType = std::get<VectorType>(resolvedType);
+				primitiveType = vecType.type;
+				componentCount = vecType.componentCount;
+			}
+			else
+				return std::nullopt;
+
+			switch (primitiveType)
+			{
+				case PrimitiveType::Float32: return BuildSplatValue(componentCount, static_cast<float>(value));
+				case PrimitiveType::Float64: return BuildSplatValue(componentCount, value);
+				case PrimitiveType::Int32:   return BuildSplatValue(componentCount, static_cast<std::int32_t>(value));
+				case PrimitiveType::UInt32:  return BuildSplatValue(componentCount, static_cast<std::uint32_t>(value));
+
+				case PrimitiveType::Boolean:
+				case PrimitiveType::String:
+					break;
+			}
+
+			return std::nullopt;
+		}
+
+		ExpressionPtr BuildSplatConstant(const ExpressionType& exprType, double value, const SourceLocation& sourceLocation)
+		{
+			std::optional<ConstantSingleValue> constantValue = BuildSplatValue(exprType, value);
+			if (!constantValue)
+				return nullptr;
+
+			return ShaderBuilder::ConstantValue(std::move(*constantValue), sourceLocation);
+		}
+
+		ExpressionPtr BuildBinary(BinaryType op, ExpressionPtr lhs, ExpressionPtr rhs, const Expression& original)
+		{
+			auto binary = ShaderBuilder::Binary(op, std::move(lhs), std::move(rhs));
+			binary->cachedExpressionType = original.cachedExpressionType;
+			binary->sourceLocation = original.sourceLocation;
+
+			return binary;
+		}
+
+		ExpressionPtr BuildUnary(UnaryType op, ExpressionPtr expr, const Expression& original)
+		{
+			auto unary = ShaderBuilder::Unary(op, std::move(expr));
+			unary->cachedExpressionType = original.cachedExpressionType;
+			unary->sourceLocation = original.sourceLocation;
+
+			return unary;
+		}
+
+		bool IsIdempotentIntrinsic(IntrinsicType intrinsicType)
+		{
+			switch (intrinsicType)
+			{
+				case IntrinsicType::Abs:
+				case IntrinsicType::Ceil:
+				case IntrinsicType::Floor:
+				case IntrinsicType::Round:
+				case IntrinsicType::RoundEven:
+				case IntrinsicType::Sign:
+				case IntrinsicType::Trunc:
+					return true;
+
+				default:
+					return false;
+			}
+		}
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::Process(Expression& expression, const Options& options)
+	{
+		m_options = options;
+		m_simplificationCount = 0;
+
+		return CloneExpression(expression);
+	}
+
+	ModulePtr AlgebraicSimplificationVisitor::Process(const Module& shaderModule, const Options& options)
+	{
+		auto rootNode = Nz::StaticUniquePointerCast<MultiStatement>(Process(*shaderModule.rootNode, options));
+
+		return std::make_shared<Module>(shaderModule.metadata, std::move(rootNode), shaderModule.importedModules);
+	}
+
+	StatementPtr AlgebraicSimplificationVisitor::Process(Statement& statement, const Options& options)
+	{
+		m_options = options;
+		m_simplificationCount = 0;
+
+		return CloneStatement(statement);
+	}
+
+	void AlgebraicSimplificationVisitor::ProcessInPlace(Module& shaderModule, const Options& options)
+	{
+		m_options = options;
+		m_simplificationCount = 0;
+
+		shaderModule.rootNode = Nz::StaticUniquePointerCast<MultiStatement>(TransformInPlace(std::move(shaderModule.rootNode)));
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::Clone(BinaryExpression& node)
+	{
+		auto clone = Nz::StaticUniquePointerCast<BinaryExpression>(Cloner::Clone(node));
+		if (!clone->cachedExpressionType || !clone->left->cachedExpressionType || !clone->right->cachedExpressionType)
+			return clone;
+
+		ExpressionPtr simplified;
+		switch (clone->op)
+		{
+			case BinaryType::Add:
+			case BinaryType::Divide:
+			case BinaryType::Modulo:
+			case BinaryType::Multiply:
+			case BinaryType::Subtract:
+				simplified = SimplifyArithmetic(*clone);
+				break;
+
+			case BinaryType::BitwiseAnd:
+			case BinaryType::BitwiseOr:
+			case BinaryType::BitwiseXor:
+			case BinaryType::ShiftLeft:
+			case BinaryType::ShiftRight:
+				simplified = SimplifyBitwise(*clone);
+				break;
+
+			case BinaryType::LogicalAnd:
+			case BinaryType::LogicalOr:
+				simplified = SimplifyLogical(*clone);
+				break;
+
+			case BinaryType::CompEq:
+			case BinaryType::CompGe:
+			case BinaryType::CompGt:
+			case BinaryType::CompLe:
+			case BinaryType::CompLt:
+			case BinaryType::CompNe:
+				break;
+		}
+
+		if (!simplified)
+			return clone;
+
+		m_simplificationCount++;
+		return simplified;
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::Clone(CastExpression& node)
+	{
+		auto clone = Nz::StaticUniquePointerCast<CastExpression>(Cloner::Clone(node));
+
+		// T(x) where x is already a T
+		if (clone->expressions.size() == 1 && HasSameType(*clone, *clone->expressions.front()))
+		{
+			m_simplificationCount++;
+			return std::move(clone->expressions.front());
+		}
+
+		return clone;
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::Clone(IntrinsicExpression& node)
+	{
+		auto clone = Nz::StaticUniquePointerCast<IntrinsicExpression>(Cloner::Clone(node));
+		if (!clone->cachedExpressionType)
+			return clone;
+
+		auto& parameters = clone->parameters;
+
+		if (IsIdempotentIntrinsic(clone->intrinsic) && parameters.size() == 1)
+		{
+			Expression& param = *parameters.front();
+
+			// abs(abs(x)) => abs(x), floor(floor(x)) => floor(x), ...
+			if (param.GetType() == NodeType::IntrinsicExpression && static_cast<IntrinsicExpression&>(param).intrinsic == clone->intrinsic)
+			{
+				m_simplificationCount++;
+				return std::move(parameters.front());
+			}
+
+			// abs(-x) => abs(x)
+			if (clone->intrinsic == IntrinsicType::Abs && param.GetType() == NodeType::UnaryExpression && static_cast<UnaryExpression&>(param).op == UnaryType::Minus)
+			{
+				parameters.front() = std::move(static_cast<UnaryExpression&>(param).expression);
+
+				m_simplificationCount++;
+				return clone;
+			}
+		}
+
+		switch (clone->intrinsic)
+		{
+			case IntrinsicType::Max:
+			case IntrinsicType::Min:
+			{
+				// min(x, x) => x
+				if (parameters.size() == 2 && HasSameType(*clone, *parameters[0]) && !HasSideEffects(*parameters[0]) && Compare(*parameters[0], *parameters[1]))
+				{
+					m_simplificationCount++;
+					return std::move(parameters[0]);
+				}
+
+				break;
+			}
+
+			case IntrinsicType::Normalize:
+			{
+				// normalize(normalize(v)) => normalize(v), normalizing an already normalized vector may still change its last bits
+				if (m_options.fastMath && parameters.size() == 1 && parameters.front()->GetType() == NodeType::IntrinsicExpression && static_cast<IntrinsicExpression&>(*parameters.front()).intrinsic == IntrinsicType::Normalize)
+				{
+					m_simplificationCount++;
+					return std::move(parameters.front());
+				}
+
+				break;
+			}
+
+			case IntrinsicType::Pow:
+			{
+				if (parameters.size() != 2 || !HasSameType(*clone, *parameters[0]))
+					break;
+
+				std::optional<double> exponent = GetSplatValue(*parameters[1]);
+				if (!exponent)
+					break;
+
+				// pow(x, 1.0) => x
+				if (*exponent == 1.0)
+				{
+					m_simplificationCount++;
+					return std::move(parameters[0]);
+				}
+
+				// pow(x, 2.0) => x * x (which is more precise)
+				if (*exponent == 2.0 && IsTrivial(*parameters[0]) && !m_options.optimizeForSize)
+				{
+					ExpressionPtr value = std::move(parameters[0]);
+					ExpressionPtr valueCopy = Ast::Clone(*value);
+
+					m_simplificationCount++;
+					return BuildBinary(BinaryType::Multiply, std::move(value), std::move(valueCopy), *clone);
+				}
+
+				if (!m_options.fastMath)
+					break;
+
+				// pow(x, 0.5) => sqrt(x) (differs for -0.0 and -inf)
+				if (*exponent == 0.5)
+				{
+					std::vector<ExpressionPtr> sqrtParameters;
+					sqrtParameters.push_back(std::move(parameters[0]));
+
+					auto sqrt = ShaderBuilder::Intrinsic(IntrinsicType::Sqrt, std::move(sqrtParameters));
+					sqrt->cachedExpressionType = clone->cachedExpressionType;
+					sqrt->sourceLocation = clone->sourceLocation;
+
+					m_simplificationCount++;
+					return sqrt;
+				}
+
+				// pow(x, -1.0) => 1.0 / x
+				if (*exponent == -1.0)
+				{
+					ExpressionPtr one = BuildSplatConstant(clone->cachedExpressionType->Get(), 1.0, clone->sourceLocation);
+					if (!one)
+						break;
+
+					m_simplificationCount++;
+					return BuildBinary(BinaryType::Divide, std::move(one), std::move(parameters[0]), *clone);
+				}
+
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		return clone;
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::Clone(SwizzleExpression& node)
+	{
+		auto clone = Nz::StaticUniquePointerCast<SwizzleExpression>(Cloner::Clone(node));
+
+		const ExpressionType* exprType = GetExpressionType(*clone->expression);
+		if (!exprType)
+			return clone;
+
+		const ExpressionType& resolvedExprType = ResolveAlias(*exprType);
+
+		// x.x => x (scalar swizzle)
+		if (IsPrimitiveType(resolvedExprType) && clone->componentCount == 1)
+		{
+			m_simplificationCount++;
+			return std::move(clone->expression);
+		}
+
+		// v.xyz => v (when v is a vec3)
+		if (IsVectorType(resolvedExprType) && std::get<VectorType>(resolvedExprType).componentCount == clone->componentCount)
+		{
+			bool isIdentity = true;
+			for (std::size_t i = 0; i < clone->componentCount; ++i)
+			{
+				if (clone->components[i] != i)
+				{
+					isIdentity = false;
+					break;
+				}
+			}
+
+			if (isIdentity)
+			{
+				m_simplificationCount++;
+				return std::move(clone->expression);
+			}
+		}
+
+		// v.zyx.xy => v.zy
+		if (clone->expression->GetType() == NodeType::SwizzleExpression)
+		{
+			auto& innerSwizzle = static_cast<SwizzleExpression&>(*clone->expression);
+
+			std::array<std::uint32_t, 4> components = {};
+			for (std::size_t i = 0; i < clone->componentCount; ++i)
+				components[i] = innerSwizzle.components[clone->components[i]];
+
+			clone->components = components;
+			clone->expression = std::move(innerSwizzle.expression);
+
+			m_simplificationCount++;
+		}
+
+		return clone;
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::Clone(UnaryExpression& node)
+	{
+		auto clone = Nz::StaticUniquePointerCast<UnaryExpression>(Cloner::Clone(node));
+
+		// +x => x
+		if (clone->op == UnaryType::Plus && HasSameType(*clone, *clone->expression))
+		{
+			m_simplificationCount++;
+			return std::move(clone->expression);
+		}
+
+		// -(-x) => x, !!x => x, ~~x => x
+		if (clone->expression->GetType() == NodeType::UnaryExpression)
+		{
+			auto& innerUnary = static_cast<UnaryExpression&>(*clone->expression);
+			if (innerUnary.op == clone->op && clone->op != UnaryType::Plus && HasSameType(*clone, *innerUnary.expression))
+			{
+				m_simplificationCount++;
+				return std::move(innerUnary.expression);
+			}
+		}
+
+		return clone;
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::SimplifyArithmetic(BinaryExpression& node)
+	{
+		bool isFloatingPoint = IsFloatingPoint(node);
+		bool isInteger = IsInteger(node);
+		if (!isFloatingPoint && !isInteger)
+			return nullptr;
+
+		// Integer arithmetic is exact, floating-point rewrites have to give the same result for every input (including NaN, infinities and signed zeros) unless fast-math is enabled
+		bool allowInexact = isInteger || m_options.fastMath;
+
+		bool leftKeepsType = HasSameType(node, *node.left);
+		bool rightKeepsType = HasSameType(node, *node.right);
+
+		switch (node.op)
+		{
+			case BinaryType::Add:
+			{
+				// x + 0 => x (-0.0 + 0.0 gives 0.0)
+				if (allowInexact && leftKeepsType && IsSplatValue(*node.right, 0.0))
+					return std::move(node.left);
+
+				if (allowInexact && rightKeepsType && IsSplatValue(*node.left, 0.0))
+					return std::move(node.right);
+
+				break;
+			}
+
+			case BinaryType::Subtract:
+			{
+				// x - 0 => x (-0.0 - -0.0 gives 0.0)
+				if (leftKeepsType && ((isInteger) ? IsSplatValue(*node.right, 0.0) : IsPositiveZero(*node.right)))
+					return std::move(node.left);
+
+				// 0 - x => -x (0.0 - 0.0 gives 0.0 while -(0.0) gives -0.0)
+				if (allowInexact && rightKeepsType && IsSplatValue(*node.left, 0.0))
+					return BuildUnary(UnaryType::Minus, std::move(node.right), node);
+
+				break;
+			}
+
+			case BinaryType::Multiply:
+			{
+				for (bool constantOnRight : { true, false })
+				{
+					ExpressionPtr& value = (constantOnRight) ? node.left : node.right;
+					ExpressionPtr& constant = (constantOnRight) ? node.right : node.left;
+					if (!HasSameType(node, *value))
+						continue;
+
+					std::optional<double> constantValue = GetSplatValue(*constant);
+					if (!constantValue)
+						continue;
+
+					// x * 1 => x
+					if (*constantValue == 1.0)
+						return std::move(value);
+
+					// x * -1 => -x
+					if (*constantValue == -1.0)
+						return BuildUnary(UnaryType::Minus, std::move(value), node);
+
+					// x * 0 => 0 (NaN * 0.0 gives NaN)
+					if (*constantValue == 0.0 && allowInexact && !HasSideEffects(*value))
+					{
+						if (ExpressionPtr zero = BuildSplatConstant(node.cachedExpressionType->Get(), 0.0, node.sourceLocation))
+							return zero;
+					}
+
+					// x * 2^n => x << n
+					if (isInteger && *constantValue > 1.0 && IsPrimitiveType(ResolveAlias(node.cachedExpressionType->Get())))
+					{
+						if (std::optional<int> exponent = GetPowerOfTwoExponent(*constantValue))
+						{
+							if (ExpressionPtr shift = BuildSplatConstant(node.cachedExpressionType->Get(), *exponent, node.sourceLocation))
+								return BuildBinary(BinaryType::ShiftLeft, std::move(value), std::move(shift), node);
+						}
+					}
+				}
+
+				break;
+			}
+
+			case BinaryType::Divide:
+			{
+				if (!leftKeepsType)
+					break;
+
+				std::optional<double> divisor = GetSplatValue(*node.right);
+				if (!divisor)
+					break;
+
+				// x / 1 => x
+				if (*divisor == 1.0)
+					return std::move(node.left);
+
+				if (isFloatingPoint)
+				{
+					// x / c => x * (1 / c), which only gives the exact same result if 1 / c is exactly representable
+					std::optional<int> exponent = GetPowerOfTwoExponent(*divisor);
+					bool isExact = exponent && *exponent >= -126 && *exponent <= 126;
+					if ((isExact || m_options.fastMath) && *divisor != 0.0 && std::isfinite(*divisor))
+					{
+						const ExpressionType& divisorType = node.right->cachedExpressionType->Get();
+						if (ExpressionPtr reciprocal = BuildSplatConstant(divisorType, 1.0 / *divisor, node.sourceLocation))
+							return BuildBinary(BinaryType::Multiply, std::move(node.left), std::move(reciprocal), node);
+					}
+				}
+				else if (IsScalarType(node, PrimitiveType::UInt32) && *divisor > 1.0)
+				{
+					// x / 2^n => x >> n (only for unsigned integers as signed division rounds toward zero)
+					if (std::optional<int> exponent = GetPowerOfTwoExponent(*divisor))
+						return BuildBinary(BinaryType::ShiftRight, std::move(node.left), ShaderBuilder::ConstantValue(std::uint32_t(*exponent), node.sourceLocation), node);
+				}
+
+				break;
+			}
+
+			case BinaryType::Modulo:
+			{
+				if (!leftKeepsType || !IsScalarType(node, PrimitiveType::UInt32))
+					break;
+
+				std::optional<double> divisor = GetSplatValue(*node.right);
+				if (!divisor || *divisor < 1.0)
+					break;
+
+				// x % 2^n => x & (2^n - 1)
+				if (GetPowerOfTwoExponent(*divisor))
+					return BuildBinary(BinaryType::BitwiseAnd, std::move(node.left), ShaderBuilder::ConstantValue(std::uint32_t(*divisor - 1.0), node.sourceLocation), node);
+
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		return nullptr;
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::SimplifyBitwise(BinaryExpression& node)
+	{
+		if (!HasSameType(node, *node.left))
+			return nullptr;
+
+		std::optional<double> rightValue = GetSplatValue(*node.right);
+		std::optional<double> leftValue = GetSplatValue(*node.left);
+
+		switch (node.op)
+		{
+			case BinaryType::BitwiseAnd:
+			{
+				// x & 0 => 0
+				if (rightValue == 0.0 && !HasSideEffects(*node.left))
+					return std::move(node.right);
+
+				if (leftValue == 0.0 && !HasSideEffects(*node.right))
+					return std::move(node.left);
+
+				// x & ~0 => x
+				auto IsAllOnes = [](const Expression& expr)
+				{
+					const ConstantSingleValue& value = static_cast<const ConstantValueExpression&>(expr).value;
+					return (std::holds_alternative<std::int32_t>(value) && std::get<std::int32_t>(value) == -1) || (std::holds_alternative<std::uint32_t>(value) && std::get<std::uint32_t>(value) == std::numeric_limits<std::uint32_t>::max());
+				};
+
+				if (rightValue && IsAllOnes(*node.right))
+					return std::move(node.left);
+
+				if (leftValue && IsAllOnes(*node.left))
+					return std::move(node.right);
+
+				break;
+			}
+
+			case BinaryType::BitwiseOr:
+			case BinaryType::BitwiseXor:
+			{
+				// x | 0 => x, x ^ 0 => x
+				if (rightValue == 0.0)
+					return std::move(node.left);
+
+				if (leftValue == 0.0)
+					return std::move(node.right);
+
+				break;
+			}
+
+			case BinaryType::ShiftLeft:
+			case BinaryType::ShiftRight:
+			{
+				// x << 0 => x
+				if (rightValue == 0.0)
+					return std::move(node.left);
+
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		return nullptr;
+	}
+
+	ExpressionPtr AlgebraicSimplificationVisitor::SimplifyLogical(BinaryExpression& node)
+	{
+		std::optional<bool> leftValue = GetBooleanValue(*node.left);
+		std::optional<bool> rightValue = GetBooleanValue(*node.right);
+
+		// the right operand is only evaluated depending on the left operand value
+		bool absorbingValue = (node.op == BinaryType::LogicalOr);
+
+		// true && x => x, false || x => x
+		if (leftValue == !absorbingValue)
+			return std::move(node.right);
+
+		// false && x => false, true || x => true
+		if (leftValue == absorbingValue)
+			return std::move(node.left);
+
+		// x && true => x, x || false => x
+		if (rightValue == !absorbingValue)
+			return std::move(node.left);
+
+		// x && false => false, x || true => true
+		if (rightValue == absorbingValue && !HasSideEffects(*node.left))
+			return std::move(node.right);
+
+		return nullptr;
+	}
+}
@@ -6,13 +6,113 @@
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Ast/ExpressionVisitor.hpp>
 #include <NZSL/Ast/StatementVisitor.hpp>
+#include <NZSL/Ast/SymbolDependencies.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <limits>
 
 namespace nzsl::Ast
 {
 	namespace
 	{
 		constexpr std::uint32_t s_shaderAstMagicNumber = 0x4E534852;
-		constexpr std::uint32_t s_shaderAstCurrentVersion = 10;
+		constexpr std::uint32_t s_shaderAstCurrentVersion = 13;
+		constexpr std::uint32_t s_shaderAstInvalidIndex = std::numeric_limits<std::uint32_t>::max();
+		constexpr std::uint32_t s_shaderAstInvalidStringIndex = std::numeric_limits<std::uint32_t>::max();
+		constexpr std::uint8_t s_shaderAstIndexEntryExported = 1 << 0;
+		constexpr std::uint8_t s_shaderAstIndexEntryEntryPoint = 1 << 1;
+
+		constexpr std::size_t GetIndexEntrySize(std::uint32_t version)
+		{
+			// Version 13 added the declaration type and index of each entry, and turned the export flag into a flag byte
+			return (version >= 13) ? 6 * sizeof(std::uint32_t) + sizeof(std::uint8_t) : 4 * sizeof(std::uint32_t) + sizeof(std::uint8_t);
+		}
+
+		bool IsStatementExported(const ExpressionValue<bool>& isExported)
+		{
+			if (!isExported.HasValue())
+				return false;
+
+			if (isExported.IsResultingValue())
+				return isExported.GetResultingValue();
+
+			return true; //< unresolved expression, it may be exported
+		}
+
+		ModuleIndex::StatementEntry BuildIndexEntry(const Statement& statement)
+		{
+			SymbolDeclaration declaration = GetSymbolDeclaration(statement);
+
+			ModuleIndex::StatementEntry entry;
+			entry.nodeType = statement.GetType();
+			entry.declarationType = declaration.declarationType;
+			entry.declaredIndex = declaration.index;
+			entry.isEntryPoint = declaration.isEntryPoint;
+			entry.isExported = false;
+			entry.offset = 0;
+			entry.size = 0;
+
+			switch (entry.nodeType)
+			{
+				case NodeType::ConditionalStatement:
+				{
+					// Use the name of the conditional statement so it can be looked up
+					const auto& condStatement = static_cast<const ConditionalStatement&>(statement);
+					if (condStatement.statement)
+					{
+						ModuleIndex::StatementEntry innerEntry = BuildIndexEntry(*condStatement.statement);
+						entry.name = innerEntry.name;
+						entry.isExported = innerEntry.isExported;
+					}
+					break;
+				}
+
+				case NodeType::DeclareAliasStatement:
+					entry.name = static_cast<const DeclareAliasStatement&>(statement).name;
+					break;
+
+				case NodeType::DeclareConstStatement:
+				{
+					const auto& constStatement = static_cast<const DeclareConstStatement&>(statement);
+					entry.name = constStatement.name;
+					entry.isExported = IsStatementExported(constStatement.isExported);
+					break;
+				}
+
+				case NodeType::DeclareExternalStatement:
+					entry.name = static_cast<const DeclareExternalStatement&>(statement).tag;
+					break;
+
+				case NodeType::DeclareFunctionStatement:
+				{
+					const auto& funcStatement = static_cast<const DeclareFunctionStatement&>(statement);
+					entry.name = funcStatement.name;
+					entry.isExported = IsStatementExported(funcStatement.isExported);
+					break;
+				}
+
+				case NodeType::DeclareOptionStatement:
+					entry.name = static_cast<const DeclareOptionStatement&>(statement).optName;
+					break;
+
+				case NodeType::DeclareStructStatement:
+				{
+					const auto& structStatement = static_cast<const DeclareStructStatement&>(statement);
+					entry.name = structStatement.description.name;
+					entry.isExported = IsStatementExported(structStatement.isExported);
+					break;
+				}
+
+				case NodeType::ImportStatement:
+					entry.name = static_cast<const ImportStatement&>(statement).moduleName;
+					break;
+
+				default:
+					break;
+			}
+
+			return entry;
+		}
 
 		class ShaderSerializerVisitor : public ExpressionVisitor, public StatementVisitor
 		{
@@ -412,6 +512,8 @@ namespace nzsl::Ast
 				Value(member.originalName);
 			if (IsVersionGreaterOrEqual(9))
 				ExprValue(member.interp);
+			if (IsVersionGreaterOrEqual(12))
+				ExprValue(member.precision);
 		}
 	}
 	
@@ -514,7 +616,32 @@ namespace nzsl::Ast
 		m_serializer.Serialize(s_shaderAstMagicNumber);
 		m_serializer.Serialize(s_shaderAstCurrentVersion);
 
+		// String table is written at the end, its offset is patched once known
+		std::size_t stringTableOffsetPos = m_serializer.Serialize(std::uint32_t(0));
+		std::size_t moduleOffsetPos = m_serializer.Serialize(std::uint32_t(0));
+
+		std::size_t moduleOffset = moduleOffsetPos + sizeof(std::uint32_t);
+		m_serializer.Serialize(moduleOffsetPos, Nz::SafeCast<std::uint32_t>(moduleOffset));
+
 		SerializeModule(const_cast<Module&>(module)); //< won't be used for writing
+
+		std::size_t stringTableOffset = m_serializer.Serialize(Nz::SafeCast<std::uint32_t>(m_stringTable.size()));
+		for (std::string_view str : m_stringTable)
+			m_serializer.Serialize(std::string(str));
+
+		m_serializer.Serialize(stringTableOffsetPos, Nz::SafeCast<std::uint32_t>(stringTableOffset));
+	}
+
+	std::uint32_t ShaderAstSerializer::InternString(const std::string& str)
+	{
+		auto it = m_stringIndices.find(str);
+		if (it == m_stringIndices.end())
+		{
+			it = m_stringIndices.emplace(str, Nz::SafeCast<std::uint32_t>(m_stringTable.size())).first;
+			m_stringTable.push_back(it->first); //< unordered_map keys have stable addresses
+		}
+
+		return it->second;
 	}
 	
 	bool ShaderAstSerializer::IsVersionGreaterOrEqual(std::uint32_t /*version*/) const
@@ -540,15 +667,22 @@ namespace nzsl::Ast
 	}
 
 	void ShaderAstSerializer::Node(StatementPtr& node)
+	{
+		NodeWithOffset(node);
+	}
+
+	std::size_t ShaderAstSerializer::NodeWithOffset(StatementPtr& node)
 	{
 		NodeType nodeType = (node) ? node->GetType() : NodeType::None;
-		m_serializer.Serialize(static_cast<std::int32_t>(nodeType));
+		std::size_t offset = m_serializer.Serialize(static_cast<std::int32_t>(nodeType));
 
 		if (node)
 		{
 			ShaderSerializerVisitor visitor(*this);
 			node->Visit(visitor);
 		}
+
+		return offset;
 	}
 	
 	void ShaderAstSerializer::SerializeModule(Module& module)
@@ -556,14 +690,72 @@ namespace nzsl::Ast
 		Metadata(const_cast<Module::Metadata&>(*module.metadata)); //< won't be used for writing
 
 		Container(module.importedModules);
+
+		// Root section offset allows readers to skip imported modules
+		std::size_t rootOffsetPos = m_serializer.Serialize(std::uint32_t(0));
+
 		for (auto& importedModule : module.importedModules)
 		{
 			Value(importedModule.identifier);
 			SerializeModule(*importedModule.module);
 		}
 
-		ShaderSerializerVisitor visitor(*this);
-		module.rootNode->Visit(visitor);
+		MultiStatement& rootNode = *module.rootNode;
+
+		std::uint32_t statementCount = Nz::SafeCast<std::uint32_t>(rootNode.statements.size());
+		std::size_t rootOffset = m_serializer.Serialize(statementCount);
+		m_serializer.Serialize(rootOffsetPos, Nz::SafeCast<std::uint32_t>(rootOffset));
+
+		std::size_t indexOffsetPos = m_serializer.Serialize(std::uint32_t(0));
+		SourceLoc(rootNode.sourceLocation);
+
+		std::vector<std::size_t> statementOffsets;
+		statementOffsets.reserve(rootNode.statements.size());
+		for (auto& statement : rootNode.statements)
+			statementOffsets.push_back(NodeWithOffset(statement));
+
+		// Statement index (offset, size, node type, name, declaration type and index, and export and entry point flags of each root statement)
+		std::size_t indexOffset = 0;
+		for (std::size_t i = 0; i < rootNode.statements.size(); ++i)
+		{
+			std::size_t entryOffset = m_serializer.Serialize(Nz::SafeCast<std::uint32_t>(statementOffsets[i]));
+			if (i == 0)
+				indexOffset = entryOffset;
+
+			std::size_t statementEnd = (i + 1 < statementOffsets.size()) ? statementOffsets[i + 1] : indexOffset;
+			m_serializer.Serialize(Nz::SafeCast<std::uint32_t>(statementEnd - statementOffsets[i]));
+
+			std::int32_t nodeType = static_cast<std::int32_t>(NodeType::None);
+			std::int32_t declarationType = static_cast<std::int32_t>(NodeType::None);
+			std::uint32_t nameIndex = s_shaderAstInvalidStringIndex;
+			std::uint32_t declaredIndex = s_shaderAstInvalidIndex;
+			std::uint8_t flags = 0;
+			if (const auto& statement = rootNode.statements[i])
+			{
+				ModuleIndex::StatementEntry entry = BuildIndexEntry(*statement);
+				nodeType = static_cast<std::int32_t>(entry.nodeType);
+				declarationType = static_cast<std::int32_t>(entry.declarationType);
+				if (!entry.name.empty())
+					nameIndex = InternString(std::string(entry.name));
+
+				if (entry.declaredIndex)
+					declaredIndex = Nz::SafeCast<std::uint32_t>(*entry.declaredIndex);
+
+				if (entry.isExported)
+					flags |= s_shaderAstIndexEntryExported;
+
+				if (entry.isEntryPoint)
+					flags |= s_shaderAstIndexEntryEntryPoint;
+			}
+
+			m_serializer.Serialize(nodeType);
+			m_serializer.Serialize(nameIndex);
+			m_serializer.Serialize(declarationType);
+			m_serializer.Serialize(declaredIndex);
+			m_serializer.Serialize(flags);
+		}
+
+		m_serializer.Serialize(indexOffsetPos, Nz::SafeCast<std::uint32_t>(indexOffset));
 	}
 
 	void ShaderAstSerializer::SharedString(std::shared_ptr<const std::string>& val)
@@ -572,19 +764,7 @@ namespace nzsl::Ast
 		Value(hasValue);
 
 		if (hasValue)
-		{
-			auto it = m_stringIndices.find(*val);
-			bool newString = (it == m_stringIndices.end());
-			Value(newString);
-
-			if (newString)
-			{
-				Value(const_cast<std::string&>(*val)); //< won't be used for writing
-				m_stringIndices.emplace(*val, Nz::SafeCast<std::uint32_t>(m_stringIndices.size()));
-			}
-			else
-				Value(it->second); //< string index
-		}
+			m_serializer.Serialize(InternString(*val));
 	}
 
 	void ShaderAstSerializer::Type(ExpressionType& type)
@@ -713,7 +893,7 @@ namespace nzsl::Ast
 
 	void ShaderAstSerializer::Value(std::string& val)
 	{
-		m_serializer.Serialize(val);
+		m_serializer.Serialize(InternString(val));
 	}
 
 	void ShaderAstSerializer::Value(std::int32_t& val)
@@ -848,15 +1028,7 @@ namespace nzsl::Ast
 
 	ModulePtr ShaderAstDeserializer::Deserialize()
 	{
-		std::uint32_t magicNumber = 0;
-		m_version = 0;
-		m_deserializer.Deserialize(magicNumber);
-		if (magicNumber != s_shaderAstMagicNumber)
-			throw std::runtime_error("invalid shader file");
-
-		m_deserializer.Deserialize(m_version);
-		if (m_version > s_shaderAstCurrentVersion)
-			throw std::runtime_error("unsupported version");
+		ReadHeader();
 
 		ModulePtr module = std::make_shared<Module>();
 		SerializeModule(*module);
@@ -864,6 +1036,176 @@ namespace nzsl::Ast
 		return module;
 	}
 
+	ModulePtr ShaderAstDeserializer::Deserialize(const Nz::FunctionRef<bool(const ModuleIndex::StatementEntry& entry)>& statementFilter)
+	{
+		ReadHeader();
+
+		if (!IsVersionGreaterOrEqual(11))
+		{
+			// No index in older versions, read everything and filter afterwards
+			ModulePtr module = std::make_shared<Module>();
+			SerializeModule(*module);
+
+			auto& statements = module->rootNode->statements;
+			statements.erase(std::remove_if(statements.begin(), statements.end(), [&](const StatementPtr& statement)
+			{
+				return !statement || !statementFilter(BuildIndexEntry(*statement));
+			}), statements.end());
+
+			return module;
+		}
+
+		// Only materialize statements accepted by the filter, jumping over the others
+		return DeserializeFromIndex([&](const std::vector<ModuleIndex::StatementEntry>& entries, const Nz::FunctionRef<Statement*(std::size_t statementIndex)>& /*loadStatement*/)
+		{
+			Nz::Bitset<> selectedStatements(entries.size(), false);
+			for (std::size_t i = 0; i < entries.size(); ++i)
+			{
+				if (statementFilter(entries[i]))
+					selectedStatements.Set(i);
+			}
+
+			return selectedStatements;
+		});
+	}
+
+	ModulePtr ShaderAstDeserializer::Deserialize(const std::unordered_set<std::string>& requestedSymbols)
+	{
+		ReadHeader();
+
+		if (!IsVersionGreaterOrEqual(13))
+		{
+			// Older indices don't tell what statements declare, read everything and filter afterwards
+			ModulePtr module = std::make_shared<Module>();
+			SerializeModule(*module);
+
+			auto& statements = module->rootNode->statements;
+
+			std::vector<SymbolDeclaration> declarations;
+			declarations.reserve(statements.size());
+			for (const StatementPtr& statement : statements)
+				declarations.push_back((statement) ? GetSymbolDeclaration(*statement) : SymbolDeclaration{});
+
+			Nz::Bitset<> requiredStatements = ResolveRequiredStatements(declarations, requestedSymbols, [&](std::size_t statementIndex)
+			{
+				return statements[statementIndex].get();
+			});
+
+			std::vector<StatementPtr> filteredStatements;
+			for (std::size_t statementIndex = requiredStatements.FindFirst(); statementIndex != requiredStatements.npos; statementIndex = requiredStatements.FindNext(statementIndex))
+				filteredStatements.push_back(std::move(statements[statementIndex]));
+
+			statements = std::move(filteredStatements);
+
+			return module;
+		}
+
+		// Statements are only materialized once they are known to be required by a requested symbol
+		return DeserializeFromIndex([&](const std::vector<ModuleIndex::StatementEntry>& entries, const Nz::FunctionRef<Statement*(std::size_t statementIndex)>& loadStatement)
+		{
+			std::vector<SymbolDeclaration> declarations;
+			declarations.reserve(entries.size());
+			for (const ModuleIndex::StatementEntry& entry : entries)
+			{
+				auto& declaration = declarations.emplace_back();
+				declaration.name = entry.name;
+				declaration.index = entry.declaredIndex;
+				declaration.declarationType = entry.declarationType;
+				declaration.isEntryPoint = entry.isEntryPoint;
+			}
+
+			return ResolveRequiredStatements(declarations, requestedSymbols, loadStatement);
+		});
+	}
+
+	ModuleIndex ShaderAstDeserializer::DeserializeIndex()
+	{
+		ReadHeader();
+
+		if (!IsVersionGreaterOrEqual(11))
+			throw std::runtime_error(fmt::format("binary module version {} has no statement index", m_version));
+
+		ModuleIndex moduleIndex;
+		moduleIndex.metadata = ReadMetadata();
+
+		std::uint32_t importCount;
+		m_deserializer.Deserialize(importCount);
+
+		std::uint32_t rootOffset;
+		m_deserializer.Deserialize(rootOffset);
+		m_deserializer.SeekTo(rootOffset);
+
+		std::uint32_t statementCount;
+		m_deserializer.Deserialize(statementCount);
+
+		std::uint32_t indexOffset;
+		m_deserializer.Deserialize(indexOffset);
+
+		moduleIndex.statements = ReadIndex(statementCount, indexOffset);
+
+		return moduleIndex;
+	}
+
+	ModulePtr ShaderAstDeserializer::DeserializeFromIndex(const Nz::FunctionRef<Nz::Bitset<>(const std::vector<ModuleIndex::StatementEntry>& entries, const Nz::FunctionRef<Statement*(std::size_t statementIndex)>& loadStatement)>& selectStatements)
+	{
+		std::shared_ptr<Module::Metadata> metadata = ReadMetadata();
+
+		std::vector<Module::ImportedModule> importedModules;
+		Container(importedModules);
+
+		std::uint32_t rootOffset;
+		m_deserializer.Deserialize(rootOffset);
+
+		for (auto& importedModule : importedModules)
+		{
+			Value(const_cast<std::string&>(importedModule.identifier)); //< not used for writing
+
+			importedModule.module = std::make_shared<Module>();
+			SerializeModule(*importedModule.module);
+		}
+
+		std::uint32_t statementCount;
+		m_deserializer.Deserialize(statementCount);
+
+		std::uint32_t indexOffset;
+		m_deserializer.Deserialize(indexOffset);
+
+		MultiStatementPtr rootNode = std::make_unique<MultiStatement>();
+		SourceLoc(rootNode->sourceLocation);
+
+		std::vector<ModuleIndex::StatementEntry> entries = ReadIndex(statementCount, indexOffset);
+
+		std::vector<StatementPtr> statements(entries.size());
+		Nz::Bitset<> loadedStatements(entries.size(), false);
+		auto LoadStatement = [&](std::size_t statementIndex) -> Statement*
+		{
+			if (!loadedStatements.Test(statementIndex))
+			{
+				m_deserializer.SeekTo(entries[statementIndex].offset);
+				Node(statements[statementIndex]);
+				loadedStatements.Set(statementIndex);
+			}
+
+			return statements[statementIndex].get();
+		};
+
+		Nz::Bitset<> selectedStatements = selectStatements(entries, LoadStatement);
+		for (std::size_t statementIndex = selectedStatements.FindFirst(); statementIndex != selectedStatements.npos; statementIndex = selectedStatements.FindNext(statementIndex))
+		{
+			LoadStatement(statementIndex);
+			rootNode->statements.push_back(std::move(statements[statementIndex]));
+		}
+
+		return std::make_shared<Module>(std::move(metadata), std::move(rootNode), std::move(importedModules));
+	}
+
+	std::shared_ptr<const Module::Metadata> ShaderAstDeserializer::DeserializeMetadata()
+	{
+		ReadHeader();
+
+		return ReadMetadata();
+	}
+
 	bool ShaderAstDeserializer::IsVersionGreaterOrEqual(std::uint32_t version) const
 	{
 		return m_version >= version;
@@ -926,13 +1268,149 @@ namespace nzsl::Ast
 		}
 	}
 
-	void ShaderAstDeserializer::SerializeModule(Module& module)
+	void ShaderAstDeserializer::ReadHeader()
+	{
+		std::uint32_t magicNumber = 0;
+		m_version = 0;
+		m_deserializer.Deserialize(magicNumber);
+		if (magicNumber != s_shaderAstMagicNumber)
+			throw std::runtime_error("invalid shader file");
+
+		m_deserializer.Deserialize(m_version);
+		if (m_version > s_shaderAstCurrentVersion)
+			throw std::runtime_error("unsupported version");
+
+		m_strings.clear();
+		m_stringTable.clear();
+
+		if (IsVersionGreaterOrEqual(11))
+		{
+			std::uint32_t stringTableOffset;
+			m_deserializer.Deserialize(stringTableOffset);
+
+			std::uint32_t moduleOffset;
+			m_deserializer.Deserialize(moduleOffset);
+
+			m_deserializer.SeekTo(stringTableOffset);
+
+			std::uint32_t stringCount;
+			m_deserializer.Deserialize(stringCount);
+
+			// Strings are kept as views into the deserialized data, only strings used by materialized nodes are copied
+			m_stringTable.resize(stringCount);
+			for (std::string_view& str : m_stringTable)
+			{
+				std::uint32_t size;
+				m_deserializer.Deserialize(size);
+
+				m_deserializer.Deserialize(size, [&](const void* data)
+				{
+					str = std::string_view(static_cast<const char*>(data), size);
+					return size;
+				});
+			}
+
+			m_strings.resize(stringCount);
+
+			m_deserializer.SeekTo(moduleOffset);
+		}
+	}
+
+	std::vector<ModuleIndex::StatementEntry> ShaderAstDeserializer::ReadIndex(std::uint32_t statementCount, std::uint32_t indexOffset)
+	{
+		std::vector<ModuleIndex::StatementEntry> entries;
+		if (statementCount == 0)
+			return entries;
+
+		auto ReadNodeType = [&]
+		{
+			std::int32_t nodeType;
+			m_deserializer.Deserialize(nodeType);
+			if (nodeType < static_cast<std::int32_t>(NodeType::None) || nodeType > static_cast<std::int32_t>(NodeType::Max))
+				throw std::runtime_error("invalid node type");
+
+			return static_cast<NodeType>(nodeType);
+		};
+
+		// Entries are not preallocated as the statement count comes from the data and may be corrupted, reading them checks it
+		m_deserializer.SeekTo(indexOffset);
+		for (std::uint32_t i = 0; i < statementCount; ++i)
+		{
+			auto& entry = entries.emplace_back();
+
+			std::uint32_t offset;
+			m_deserializer.Deserialize(offset);
+
+			std::uint32_t size;
+			m_deserializer.Deserialize(size);
+
+			entry.offset = offset;
+			entry.size = size;
+			entry.nodeType = ReadNodeType();
+
+			std::uint32_t nameIndex;
+			m_deserializer.Deserialize(nameIndex);
+			if (nameIndex != s_shaderAstInvalidStringIndex)
+				entry.name = RetrieveString(nameIndex);
+
+			if (IsVersionGreaterOrEqual(13))
+			{
+				entry.declarationType = ReadNodeType();
+
+				std::uint32_t declaredIndex;
+				m_deserializer.Deserialize(declaredIndex);
+				if (declaredIndex != s_shaderAstInvalidIndex)
+					entry.declaredIndex = declaredIndex;
+
+				std::uint8_t flags;
+				m_deserializer.Deserialize(flags);
+
+				entry.isEntryPoint = (flags & s_shaderAstIndexEntryEntryPoint) != 0;
+				entry.isExported = (flags & s_shaderAstIndexEntryExported) != 0;
+			}
+			else
+			{
+				std::uint8_t isExported;
+				m_deserializer.Deserialize(isExported);
+
+				entry.declarationType = entry.nodeType;
+				entry.isEntryPoint = false;
+				entry.isExported = (isExported != 0);
+			}
+		}
+
+		return entries;
+	}
+
+	std::shared_ptr<Module::Metadata> ShaderAstDeserializer::ReadMetadata()
 	{
 		std::shared_ptr<Module::Metadata> metadata = std::make_shared<Module::Metadata>();
 		Metadata(*metadata);
 
+		return metadata;
+	}
+
+	std::string_view ShaderAstDeserializer::RetrieveString(std::uint32_t stringIndex) const
+	{
+		if (stringIndex >= m_stringTable.size())
+			throw std::runtime_error("invalid string index");
+
+		return m_stringTable[stringIndex];
+	}
+
+	void ShaderAstDeserializer::SerializeModule(Module& module)
+	{
+		std::shared_ptr<Module::Metadata> metadata = ReadMetadata();
+
 		std::vector<Module::ImportedModule> importedModules;
 		Container(importedModules);
+
+		if (IsVersionGreaterOrEqual(11))
+		{
+			std::uint32_t rootOffset;
+			m_deserializer.Deserialize(rootOffset);
+		}
+
 		for (auto& importedModule : importedModules)
 		{
 			Value(const_cast<std::string&>(importedModule.identifier)); //< not used for writing
@@ -943,8 +1421,29 @@ namespace nzsl::Ast
 
 		MultiStatementPtr rootNode = std::make_unique<MultiStatement>();
 
-		ShaderSerializerVisitor visitor(*this);
-		rootNode->Visit(visitor);
+		if (IsVersionGreaterOrEqual(11))
+		{
+			std::uint32_t statementCount;
+			m_deserializer.Deserialize(statementCount);
+
+			std::uint32_t indexOffset;
+			m_deserializer.Deserialize(indexOffset);
+
+			SourceLoc(rootNode->sourceLocation);
+
+			rootNode->statements.resize(statementCount);
+			for (auto& statement : rootNode->statements)
+				Node(statement);
+
+			// Skip statement index
+			if (statementCount > 0)
+				m_deserializer.SeekTo(std::size_t(indexOffset) + std::size_t(statementCount) * GetIndexEntrySize(m_version));
+		}
+		else
+		{
+			ShaderSerializerVisitor visitor(*this);
+			rootNode->Visit(visitor);
+		}
 
 		module = Module(std::move(metadata), std::move(rootNode), std::move(importedModules));
 	}
@@ -954,7 +1453,20 @@ namespace nzsl::Ast
 		bool hasValue;
 		Value(hasValue);
 
-		if (hasValue)
+		if (hasValue && IsVersionGreaterOrEqual(11))
+		{
+			std::uint32_t strIndex;
+			m_deserializer.Deserialize(strIndex);
+
+			if (strIndex >= m_strings.size())
+				throw std::runtime_error("invalid string index");
+
+			if (!m_strings[strIndex])
+				m_strings[strIndex] = std::make_shared<const std::string>(m_stringTable[strIndex]);
+
+			val = m_strings[strIndex];
+		}
+		else if (hasValue)
 		{
 			bool newString;
 			Value(newString);
@@ -1251,7 +1763,15 @@ namespace nzsl::Ast
 
 	void ShaderAstDeserializer::Value(std::string& val)
 	{
-		m_deserializer.Deserialize(val);
+		if (IsVersionGreaterOrEqual(11))
+		{
+			std::uint32_t strIndex;
+			m_deserializer.Deserialize(strIndex);
+
+			val.assign(RetrieveString(strIndex));
+		}
+		else
+			m_deserializer.Deserialize(val);
 	}
 
 	void ShaderAstDeserializer::Value(std::int32_t& val)
@@ -1396,4 +1916,28 @@ namespace nzsl::Ast
 		ShaderAstDeserializer astDeserializer(deserializer);
 		return astDeserializer.Deserialize();
 	}
+
+	ModulePtr DeserializeShader(AbstractDeserializer& deserializer, const Nz::FunctionRef<bool(const ModuleIndex::StatementEntry& entry)>& statementFilter)
+	{
+		ShaderAstDeserializer astDeserializer(deserializer);
+		return astDeserializer.Deserialize(statementFilter);
+	}
+
+	ModulePtr DeserializeShader(AbstractDeserializer& deserializer, const std::unordered_set<std::string>& requestedSymbols)
+	{
+		ShaderAstDeserializer astDeserializer(deserializer);
+		return astDeserializer.Deserialize(requestedSymbols);
+	}
+
+	ModuleIndex DeserializeShaderIndex(AbstractDeserializer& deserializer)
+	{
+		ShaderAstDeserializer astDeserializer(deserializer);
+		return astDeserializer.DeserializeIndex();
+	}
+
+	std::shared_ptr<const Module::Metadata> DeserializeShaderMetadata(AbstractDeserializer& deserializer)
+	{
+		ShaderAstDeserializer astDeserializer(deserializer);
+		return astDeserializer.DeserializeMetadata();
+	}
 }
@@ -0,0 +1,186 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/BlockLayout.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace nzsl::Ast
+{
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		bool IsMemberEnabled(const StructDescription::StructMember& member)
+		{
+			return !member.cond.HasValue() || member.cond.GetResultingValue();
+		}
+
+		FieldOffsets RegisterMembers(const StructDescription& structDesc, StructLayout layout, const std::vector<std::size_t>& memberOrder, const StructFinder& structFinder, std::vector<std::size_t>* memberOffsets)
+		{
+			if (memberOffsets)
+				memberOffsets->assign(structDesc.members.size(), 0);
+
+			FieldOffsets fieldOffsets(layout);
+			for (std::size_t memberIndex : memberOrder)
+			{
+				const auto& member = structDesc.members[memberIndex];
+				if (!IsMemberEnabled(member))
+					continue;
+
+				std::size_t offset = RegisterStructField(fieldOffsets, member.type.GetResultingValue(), structFinder);
+				if (memberOffsets)
+					(*memberOffsets)[memberIndex] = offset;
+			}
+
+			return fieldOffsets;
+		}
+	}
+
+	FieldOffsets ComputeStructFieldOffsets(const StructDescription& structDesc, StructLayout layout, const StructFinder& structFinder, std::vector<std::size_t>* memberOffsets)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		std::vector<std::size_t> memberOrder(structDesc.members.size());
+		std::iota(memberOrder.begin(), memberOrder.end(), std::size_t(0));
+
+		return RegisterMembers(structDesc, layout, memberOrder, structFinder, memberOffsets);
+	}
+
+	StructLayout GetStructLayout(const StructDescription& structDesc)
+	{
+		if (structDesc.layout.HasValue())
+		{
+			switch (structDesc.layout.GetResultingValue())
+			{
+				case MemoryLayout::Scalar: return StructLayout::Scalar;
+				case MemoryLayout::Std140: return StructLayout::Std140;
+				case MemoryLayout::Std430: return StructLayout::Std430;
+			}
+		}
+
+		return StructLayout::Std140;
+	}
+
+	BlockLayoutOptimization OptimizeBlockLayout(const StructDescription& structDesc, const StructFinder& structFinder)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		BlockLayoutOptimization optimization;
+		optimization.layout = GetStructLayout(structDesc);
+
+		// Runtime arrays have to stay last and disabled members don't take any space, both are kept at the end in their original order
+		std::vector<std::size_t> movableMembers;
+		std::vector<std::size_t> trailingMembers;
+
+		struct MemberInfo
+		{
+			std::size_t alignment;
+			std::size_t size;
+		};
+
+		std::vector<MemberInfo> memberInfos(structDesc.members.size());
+		for (std::size_t memberIndex = 0; memberIndex < structDesc.members.size(); ++memberIndex)
+		{
+			const auto& member = structDesc.members[memberIndex];
+			if (!IsMemberEnabled(member) || IsDynArrayType(ResolveAlias(member.type.GetResultingValue())))
+			{
+				trailingMembers.push_back(memberIndex);
+				continue;
+			}
+
+			FieldOffsets memberOffsets(optimization.layout);
+			RegisterStructField(memberOffsets, member.type.GetResultingValue(), structFinder);
+
+			memberInfos[memberIndex].alignment = memberOffsets.GetLargestFieldAlignement();
+			memberInfos[memberIndex].size = memberOffsets.GetSize();
+
+			movableMembers.push_back(memberIndex);
+		}
+
+		std::stable_partition(trailingMembers.begin(), trailingMembers.end(), [&](std::size_t memberIndex) { return IsMemberEnabled(structDesc.members[memberIndex]); });
+
+		auto FinalizeOrder = [&](std::vector<std::size_t> memberOrder)
+		{
+			memberOrder.insert(memberOrder.end(), trailingMembers.begin(), trailingMembers.end());
+			return memberOrder;
+		};
+
+		// Candidate 1: declaration order
+		std::vector<std::size_t> originalOrder = FinalizeOrder(movableMembers);
+
+		optimization.originalSize = RegisterMembers(structDesc, optimization.layout, originalOrder, structFinder, nullptr).GetAlignedSize();
+		optimization.optimizedSize = optimization.originalSize;
+		optimization.memberOrder = std::move(originalOrder);
+
+		auto TryOrder = [&](std::vector<std::size_t> memberOrder)
+		{
+			memberOrder = FinalizeOrder(std::move(memberOrder));
+
+			std::size_t size = RegisterMembers(structDesc, optimization.layout, memberOrder, structFinder, nullptr).GetAlignedSize();
+			if (size < optimization.optimizedSize)
+			{
+				optimization.optimizedSize = size;
+				optimization.memberOrder = std::move(memberOrder);
+			}
+		};
+
+		// Candidate 2: largest alignments first
+		std::vector<std::size_t> sortedOrder = movableMembers;
+		std::stable_sort(sortedOrder.begin(), sortedOrder.end(), [&](std::size_t lhs, std::size_t rhs)
+		{
+			return memberInfos[lhs].alignment > memberInfos[rhs].alignment;
+		});
+
+		TryOrder(std::move(sortedOrder));
+
+		// Candidate 3: greedily pick the member introducing the least padding at the current offset (which fills holes left by vec3 in std140/std430)
+		// ties are broken by larger alignment first, then by larger size and then by declaration order
+		std::vector<std::size_t> greedyOrder;
+		greedyOrder.reserve(movableMembers.size());
+
+		FieldOffsets greedyOffsets(optimization.layout);
+		std::vector<std::size_t> remainingMembers = movableMembers;
+		while (!remainingMembers.empty())
+		{
+			auto bestIt = remainingMembers.end();
+			std::size_t bestPadding = 0;
+			for (auto it = remainingMembers.begin(); it != remainingMembers.end(); ++it)
+			{
+				FieldOffsets trialOffsets = greedyOffsets;
+				std::size_t offset = RegisterStructField(trialOffsets, structDesc.members[*it].type.GetResultingValue(), structFinder);
+				std::size_t padding = offset - greedyOffsets.GetSize();
+
+				if (bestIt != remainingMembers.end())
+				{
+					if (padding > bestPadding)
+						continue;
+
+					if (padding == bestPadding)
+					{
+						const MemberInfo& bestInfo = memberInfos[*bestIt];
+						const MemberInfo& info = memberInfos[*it];
+						if (info.alignment < bestInfo.alignment || (info.alignment == bestInfo.alignment && info.size <= bestInfo.size))
+							continue;
+					}
+				}
+
+				bestIt = it;
+				bestPadding = padding;
+			}
+
+			assert(bestIt != remainingMembers.end());
+			RegisterStructField(greedyOffsets, structDesc.members[*bestIt].type.GetResultingValue(), structFinder);
+
+			greedyOrder.push_back(*bestIt);
+			remainingMembers.erase(bestIt);
+		}
+
+		TryOrder(std::move(greedyOrder));
+
+		RegisterMembers(structDesc, optimization.layout, optimization.memberOrder, structFinder, &optimization.memberOffsets);
+
+		return optimization;
+	}
+}
@@ -3,7 +3,9 @@
 // For conditions of distribution and use, see copyright notice in Config.hpp
 
 #include <NZSL/Ast/Cloner.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
 #include <stdexcept>
+#include <utility>
 
 namespace nzsl::Ast
 {
@@ -51,13 +53,14 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(BranchStatement& node)
 	{
-		auto clone = std::make_unique<BranchStatement>();
-		clone->condStatements.reserve(node.condStatements.size());
+		auto clone = AllocateNode(node);
+		clone->condStatements.resize(node.condStatements.size());
 		clone->isConst = node.isConst;
 
-		for (auto& cond : node.condStatements)
+		for (std::size_t i = 0; i < node.condStatements.size(); ++i)
 		{
-			auto& condStatement = clone->condStatements.emplace_back();
+			auto& cond = node.condStatements[i];
+			auto& condStatement = clone->condStatements[i];
 			condStatement.condition = CloneExpression(cond.condition);
 			condStatement.statement = CloneStatement(cond.statement);
 		}
@@ -71,7 +74,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(BreakStatement& node)
 	{
-		auto clone = std::make_unique<BreakStatement>();
+		auto clone = AllocateNode(node);
 		clone->sourceLocation = node.sourceLocation;
 
 		return clone;
@@ -79,7 +82,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ConditionalStatement& node)
 	{
-		auto clone = std::make_unique<ConditionalStatement>();
+		auto clone = AllocateNode(node);
 		clone->condition = CloneExpression(node.condition);
 		clone->statement = CloneStatement(node.statement);
 
@@ -90,7 +93,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ContinueStatement& node)
 	{
-		auto clone = std::make_unique<ContinueStatement>();
+		auto clone = AllocateNode(node);
 		clone->sourceLocation = node.sourceLocation;
 
 		return clone;
@@ -98,7 +101,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareAliasStatement& node)
 	{
-		auto clone = std::make_unique<DeclareAliasStatement>();
+		auto clone = AllocateNode(node);
 		clone->aliasIndex = node.aliasIndex;
 		clone->name = node.name;
 		clone->expression = CloneExpression(node.expression);
@@ -110,7 +113,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareConstStatement& node)
 	{
-		auto clone = std::make_unique<DeclareConstStatement>();
+		auto clone = AllocateNode(node);
 		clone->constIndex = node.constIndex;
 		clone->isExported = Clone(node.isExported);
 		clone->name = node.name;
@@ -124,16 +127,17 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareExternalStatement& node)
 	{
-		auto clone = std::make_unique<DeclareExternalStatement>();
+		auto clone = AllocateNode(node);
 		clone->autoBinding = Clone(node.autoBinding);
 		clone->bindingSet = Clone(node.bindingSet);
 		clone->name = node.name;
 		clone->tag = node.tag;
 
-		clone->externalVars.reserve(node.externalVars.size());
-		for (const auto& var : node.externalVars)
+		clone->externalVars.resize(node.externalVars.size());
+		for (std::size_t i = 0; i < node.externalVars.size(); ++i)
 		{
-			auto& cloneVar = clone->externalVars.emplace_back();
+			const auto& var = node.externalVars[i];
+			auto& cloneVar = clone->externalVars[i];
 			cloneVar.name = var.name;
 			cloneVar.varIndex = var.varIndex;
 			cloneVar.type = Clone(var.type);
@@ -151,7 +155,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareFunctionStatement& node)
 	{
-		auto clone = std::make_unique<DeclareFunctionStatement>();
+		auto clone = AllocateNode(node);
 		clone->depthWrite = Clone(node.depthWrite);
 		clone->earlyFragmentTests = Clone(node.earlyFragmentTests);
 		clone->entryStage = Clone(node.entryStage);
@@ -161,10 +165,11 @@ namespace nzsl::Ast
 		clone->returnType = Clone(node.returnType);
 		clone->workgroupSize = Clone(node.workgroupSize);
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
 		{
-			auto& cloneParam = clone->parameters.emplace_back();
+			const auto& parameter = node.parameters[i];
+			auto& cloneParam = clone->parameters[i];
 			cloneParam.name = parameter.name;
 			cloneParam.type = Clone(parameter.type);
 			cloneParam.varIndex = parameter.varIndex;
@@ -172,9 +177,9 @@ namespace nzsl::Ast
 			cloneParam.sourceLocation = parameter.sourceLocation;
 		}
 
-		clone->statements.reserve(node.statements.size());
-		for (auto& statement : node.statements)
-			clone->statements.push_back(CloneStatement(statement));
+		clone->statements.resize(node.statements.size());
+		for (std::size_t i = 0; i < node.statements.size(); ++i)
+			clone->statements[i] = CloneStatement(node.statements[i]);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -183,7 +188,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareOptionStatement& node)
 	{
-		auto clone = std::make_unique<DeclareOptionStatement>();
+		auto clone = AllocateNode(node);
 		clone->defaultValue = CloneExpression(node.defaultValue);
 		clone->optIndex = node.optIndex;
 		clone->optName = node.optName;
@@ -196,7 +201,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareStructStatement& node)
 	{
-		auto clone = std::make_unique<DeclareStructStatement>();
+		auto clone = AllocateNode(node);
 		clone->isExported = Clone(node.isExported);
 		clone->structIndex = node.structIndex;
 
@@ -204,10 +209,11 @@ namespace nzsl::Ast
 		clone->description.name = node.description.name;
 		clone->description.tag = node.description.tag;
 
-		clone->description.members.reserve(node.description.members.size());
-		for (const auto& member : node.description.members)
+		clone->description.members.resize(node.description.members.size());
+		for (std::size_t i = 0; i < node.description.members.size(); ++i)
 		{
-			auto& cloneMember = clone->description.members.emplace_back();
+			const auto& member = node.description.members[i];
+			auto& cloneMember = clone->description.members[i];
 			cloneMember.name = member.name;
 			cloneMember.originalName = member.originalName;
 			cloneMember.type = Clone(member.type);
@@ -215,6 +221,7 @@ namespace nzsl::Ast
 			cloneMember.cond = Clone(member.cond);
 			cloneMember.interp = Clone(member.interp);
 			cloneMember.locationIndex = Clone(member.locationIndex);
+			cloneMember.precision = Clone(member.precision);
 
 			cloneMember.sourceLocation = member.sourceLocation;
 			cloneMember.tag = member.tag;
@@ -227,7 +234,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareVariableStatement& node)
 	{
-		auto clone = std::make_unique<DeclareVariableStatement>();
+		auto clone = AllocateNode(node);
 		clone->initialExpression = CloneExpression(node.initialExpression);
 		clone->varIndex = node.varIndex;
 		clone->varName = node.varName;
@@ -240,7 +247,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DiscardStatement& node)
 	{
-		auto clone = std::make_unique<DiscardStatement>();
+		auto clone = AllocateNode(node);
 		clone->sourceLocation = node.sourceLocation;
 
 		return clone;
@@ -248,7 +255,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ExpressionStatement& node)
 	{
-		auto clone = std::make_unique<ExpressionStatement>();
+		auto clone = AllocateNode(node);
 		clone->expression = CloneExpression(node.expression);
 
 		clone->sourceLocation = node.sourceLocation;
@@ -258,7 +265,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ForStatement& node)
 	{
-		auto clone = std::make_unique<ForStatement>();
+		auto clone = AllocateNode(node);
 		clone->fromExpr = CloneExpression(node.fromExpr);
 		clone->stepExpr = CloneExpression(node.stepExpr);
 		clone->toExpr = CloneExpression(node.toExpr);
@@ -274,7 +281,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ForEachStatement& node)
 	{
-		auto clone = std::make_unique<ForEachStatement>();
+		auto clone = AllocateNode(node);
 		clone->expression = CloneExpression(node.expression);
 		clone->statement = CloneStatement(node.statement);
 		clone->unroll = Clone(node.unroll);
@@ -288,7 +295,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ImportStatement& node)
 	{
-		auto clone = std::make_unique<ImportStatement>();
+		auto clone = AllocateNode(node);
 		clone->moduleName = node.moduleName;
 		clone->identifiers = node.identifiers;
 
@@ -299,10 +306,10 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(MultiStatement& node)
 	{
-		auto clone = std::make_unique<MultiStatement>();
-		clone->statements.reserve(node.statements.size());
-		for (auto& statement : node.statements)
-			clone->statements.push_back(CloneStatement(statement));
+		auto clone = AllocateNode(node);
+		clone->statements.resize(node.statements.size());
+		for (std::size_t i = 0; i < node.statements.size(); ++i)
+			clone->statements[i] = CloneStatement(node.statements[i]);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -311,7 +318,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(NoOpStatement& node)
 	{
-		auto clone = std::make_unique<NoOpStatement>();
+		auto clone = AllocateNode(node);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -320,7 +327,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ReturnStatement& node)
 	{
-		auto clone = std::make_unique<ReturnStatement>();
+		auto clone = AllocateNode(node);
 		clone->returnExpr = CloneExpression(node.returnExpr);
 
 		clone->sourceLocation = node.sourceLocation;
@@ -330,7 +337,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ScopedStatement& node)
 	{
-		auto clone = std::make_unique<ScopedStatement>();
+		auto clone = AllocateNode(node);
 		clone->statement = CloneStatement(node.statement);
 
 		clone->sourceLocation = node.sourceLocation;
@@ -340,7 +347,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(WhileStatement& node)
 	{
-		auto clone = std::make_unique<WhileStatement>();
+		auto clone = AllocateNode(node);
 		clone->condition = CloneExpression(node.condition);
 		clone->body = CloneStatement(node.body);
 		clone->unroll = Clone(node.unroll);
@@ -352,7 +359,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AccessIdentifierExpression& node)
 	{
-		auto clone = std::make_unique<AccessIdentifierExpression>();
+		auto clone = AllocateNode(node);
 		clone->identifiers = node.identifiers;
 		clone->expr = CloneExpression(node.expr);
 
@@ -364,12 +371,12 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AccessIndexExpression& node)
 	{
-		auto clone = std::make_unique<AccessIndexExpression>();
+		auto clone = AllocateNode(node);
 		clone->expr = CloneExpression(node.expr);
 
-		clone->indices.reserve(node.indices.size());
-		for (auto& parameter : node.indices)
-			clone->indices.push_back(CloneExpression(parameter));
+		clone->indices.resize(node.indices.size());
+		for (std::size_t i = 0; i < node.indices.size(); ++i)
+			clone->indices[i] = CloneExpression(node.indices[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -379,7 +386,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AliasValueExpression& node)
 	{
-		auto clone = std::make_unique<AliasValueExpression>();
+		auto clone = AllocateNode(node);
 		clone->aliasId = node.aliasId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -390,7 +397,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AssignExpression& node)
 	{
-		auto clone = std::make_unique<AssignExpression>();
+		auto clone = AllocateNode(node);
 		clone->op = node.op;
 		clone->left = CloneExpression(node.left);
 		clone->right = CloneExpression(node.right);
@@ -403,7 +410,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(BinaryExpression& node)
 	{
-		auto clone = std::make_unique<BinaryExpression>();
+		auto clone = AllocateNode(node);
 		clone->op = node.op;
 		clone->left = CloneExpression(node.left);
 		clone->right = CloneExpression(node.right);
@@ -416,12 +423,12 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(CallFunctionExpression& node)
 	{
-		auto clone = std::make_unique<CallFunctionExpression>();
+		auto clone = AllocateNode(node);
 		clone->targetFunction = CloneExpression(node.targetFunction);
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
-			clone->parameters.push_back(CloneExpression(parameter));
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
+			clone->parameters[i] = CloneExpression(node.parameters[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -431,14 +438,14 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(CallMethodExpression& node)
 	{
-		auto clone = std::make_unique<CallMethodExpression>();
+		auto clone = AllocateNode(node);
 		clone->methodName = node.methodName;
 
 		clone->object = CloneExpression(node.object);
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
-			clone->parameters.push_back(CloneExpression(parameter));
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
+			clone->parameters[i] = CloneExpression(node.parameters[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -448,12 +455,12 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(CastExpression& node)
 	{
-		auto clone = std::make_unique<CastExpression>();
+		auto clone = AllocateNode(node);
 		clone->targetType = Clone(node.targetType);
 
-		clone->expressions.reserve(node.expressions.size());
-		for (const auto& exprPtr : node.expressions)
-			clone->expressions.push_back(CloneExpression(exprPtr));
+		clone->expressions.resize(node.expressions.size());
+		for (std::size_t i = 0; i < node.expressions.size(); ++i)
+			clone->expressions[i] = CloneExpression(node.expressions[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -463,7 +470,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConditionalExpression& node)
 	{
-		auto clone = std::make_unique<ConditionalExpression>();
+		auto clone = AllocateNode(node);
 		clone->condition = CloneExpression(node.condition);
 		clone->falsePath = CloneExpression(node.falsePath);
 		clone->truePath = CloneExpression(node.truePath);
@@ -476,7 +483,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConstantExpression& node)
 	{
-		auto clone = std::make_unique<ConstantExpression>();
+		auto clone = AllocateNode(node);
 		clone->constantId = node.constantId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -487,7 +494,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConstantArrayValueExpression& node)
 	{
-		auto clone = std::make_unique<ConstantArrayValueExpression>();
+		auto clone = AllocateNode(node);
 		clone->values = node.values;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -498,7 +505,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConstantValueExpression& node)
 	{
-		auto clone = std::make_unique<ConstantValueExpression>();
+		auto clone = AllocateNode(node);
 		clone->value = node.value;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -509,7 +516,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(FunctionExpression& node)
 	{
-		auto clone = std::make_unique<FunctionExpression>();
+		auto clone = AllocateNode(node);
 		clone->funcId = node.funcId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -520,7 +527,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(IdentifierExpression& node)
 	{
-		auto clone = std::make_unique<IdentifierExpression>();
+		auto clone = AllocateNode(node);
 		clone->identifier = node.identifier;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -531,12 +538,12 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(IntrinsicExpression& node)
 	{
-		auto clone = std::make_unique<IntrinsicExpression>();
+		auto clone = AllocateNode(node);
 		clone->intrinsic = node.intrinsic;
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
-			clone->parameters.push_back(CloneExpression(parameter));
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
+			clone->parameters[i] = CloneExpression(node.parameters[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -546,7 +553,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(IntrinsicFunctionExpression& node)
 	{
-		auto clone = std::make_unique<IntrinsicFunctionExpression>();
+		auto clone = AllocateNode(node);
 		clone->intrinsicId = node.intrinsicId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -557,7 +564,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(StructTypeExpression& node)
 	{
-		auto clone = std::make_unique<StructTypeExpression>();
+		auto clone = AllocateNode(node);
 		clone->structTypeId = node.structTypeId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -568,7 +575,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(SwizzleExpression& node)
 	{
-		auto clone = std::make_unique<SwizzleExpression>();
+		auto clone = AllocateNode(node);
 		clone->componentCount = node.componentCount;
 		clone->components = node.components;
 		clone->expression = CloneExpression(node.expression);
@@ -581,7 +588,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(TypeExpression& node)
 	{
-		auto clone = std::make_unique<TypeExpression>();
+		auto clone = AllocateNode(node);
 		clone->typeId = node.typeId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -592,7 +599,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(VariableValueExpression& node)
 	{
-		auto clone = std::make_unique<VariableValueExpression>();
+		auto clone = AllocateNode(node);
 		clone->variableId = node.variableId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -603,7 +610,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(UnaryExpression& node)
 	{
-		auto clone = std::make_unique<UnaryExpression>();
+		auto clone = AllocateNode(node);
 		clone->expression = CloneExpression(node.expression);
 		clone->op = node.op;
 
@@ -615,7 +622,23 @@ namespace nzsl::Ast
 
 #define NZSL_SHADERAST_NODE(NodeType, Category) void Cloner::Visit(NodeType##Category& node) \
 	{ \
+		if (!m_transformInPlace) \
+		{ \
+			Push##Category(Clone(node)); \
+			return; \
+		} \
+		Category##Ptr* owner = std::exchange(m_owned##Category, nullptr); \
+		if (!owner || owner->get() != &node) \
+		{ \
+			/* node isn't part of the transformed tree (it was explicitly cloned), copy it */ \
+			m_transformInPlace = false; \
+			Push##Category(Clone(node)); \
+			m_transformInPlace = true; \
+			return; \
+		} \
+		Category##Ptr* previousOwner = std::exchange(m_current##Category##Owner, owner); \
 		Push##Category(Clone(node)); \
+		m_current##Category##Owner = previousOwner; \
 	}
 
 #include <NZSL/Ast/NodeList.hpp>
@@ -649,4 +672,46 @@ namespace nzsl::Ast
 
 		return expr;
 	}
+
+	ExpressionPtr Cloner::TransformInPlace(ExpressionPtr&& expression)
+	{
+		assert(!m_transformInPlace);
+
+		m_transformInPlace = true;
+		Nz::CallOnExit onExit([this]()
+		{
+			m_currentExpressionOwner = nullptr;
+			m_currentStatementOwner = nullptr;
+			m_ownedExpression = nullptr;
+			m_ownedStatement = nullptr;
+			m_transformInPlace = false;
+		});
+
+		// expression is either empty (its node was reused) or holds what's left of the previous tree
+		ExpressionPtr result = CloneExpression(expression);
+		expression.reset();
+
+		return result;
+	}
+
+	StatementPtr Cloner::TransformInPlace(StatementPtr&& statement)
+	{
+		assert(!m_transformInPlace);
+
+		m_transformInPlace = true;
+		Nz::CallOnExit onExit([this]()
+		{
+			m_currentExpressionOwner = nullptr;
+			m_currentStatementOwner = nullptr;
+			m_ownedExpression = nullptr;
+			m_ownedStatement = nullptr;
+			m_transformInPlace = false;
+		});
+
+		// statement is either empty (its node was reused) or holds what's left of the previous tree
+		StatementPtr result = CloneStatement(statement);
+		statement.reset();
+
+		return result;
+	}
 }
@@ -421,6 +421,20 @@ namespace nzsl::Ast
 		return std::make_shared<Module>(shaderModule.metadata, std::move(rootNode), shaderModule.importedModules);
 	}
 	
+	void ConstantPropagationVisitor::ProcessInPlace(Module& shaderModule)
+	{
+		m_options = {};
+		m_propagationCount = 0;
+		shaderModule.rootNode = Nz::StaticUniquePointerCast<MultiStatement>(TransformInPlace(std::move(shaderModule.rootNode)));
+	}
+
+	void ConstantPropagationVisitor::ProcessInPlace(Module& shaderModule, const Options& options)
+	{
+		m_options = options;
+		m_propagationCount = 0;
+		shaderModule.rootNode = Nz::StaticUniquePointerCast<MultiStatement>(TransformInPlace(std::move(shaderModule.rootNode)));
+	}
+
 	ExpressionPtr ConstantPropagationVisitor::Clone(BinaryExpression& node)
 	{
 		auto lhs = CloneExpression(node.left);
@@ -463,12 +477,16 @@ namespace nzsl::Ast
 			{
 				optimized->cachedExpressionType = node.cachedExpressionType;
 				optimized->sourceLocation = node.sourceLocation;
-				
+
+				m_propagationCount++;
 				return optimized;
 			}
 		}
 
-		auto binary = ShaderBuilder::Binary(node.op, std::move(lhs), std::move(rhs));
+		auto binary = AllocateNode(node);
+		binary->op = node.op;
+		binary->left = std::move(lhs);
+		binary->right = std::move(rhs);
 		binary->cachedExpressionType = node.cachedExpressionType;
 		binary->sourceLocation = node.sourceLocation;
 
@@ -637,6 +655,7 @@ namespace nzsl::Ast
 			optimized->cachedExpressionType = node.cachedExpressionType;
 			optimized->sourceLocation = node.sourceLocation;
 
+			m_propagationCount++;
 			return optimized;
 		}
 		
@@ -672,6 +691,9 @@ namespace nzsl::Ast
 				if (!IsPrimitiveType(*constantType) || std::get<PrimitiveType>(*constantType) != PrimitiveType::Boolean)
 					continue;
 
+				// Each constant condition removes its branch (or every branch after it)
+				m_propagationCount++;
+
 				bool cValue = std::get<bool>(constant.value);
 				if (!cValue)
 					continue;
@@ -723,11 +745,13 @@ namespace nzsl::Ast
 		auto& constant = static_cast<ConstantValueExpression&>(*cond);
 
 		assert(constant.cachedExpressionType);
-		const ExpressionType& constantType = constant.cachedExpressionType.value();
+		const ExpressionType& constantType = constant.cachedExpressionType->Get();
 
 		if (!IsPrimitiveType(constantType) || std::get<PrimitiveType>(constantType) != PrimitiveType::Boolean)
 			throw std::runtime_error("conditional expression condition must resolve to a boolean");
 
+		m_propagationCount++;
+
 		bool cValue = std::get<bool>(constant.value);
 		if (cValue)
 			return Cloner::Clone(*node.truePath);
@@ -760,6 +784,7 @@ namespace nzsl::Ast
 				auto constant = ShaderBuilder::ConstantValue(arg);
 				constant->sourceLocation = node.sourceLocation;
 
+				m_propagationCount++;
 				return constant;
 			}
 		}, *constantValue);
@@ -789,6 +814,7 @@ namespace nzsl::Ast
 						auto constant = ShaderBuilder::ConstantValue(arrayType.length);
 						constant->sourceLocation = node.sourceLocation;
 
+						m_propagationCount++;
 						return constant;
 					}
 				}
@@ -887,6 +913,8 @@ namespace nzsl::Ast
 			if (optimized)
 			{
 				optimized->sourceLocation = node.sourceLocation;
+
+				m_propagationCount++;
 				return optimized;
 			}
 		}
@@ -901,10 +929,14 @@ namespace nzsl::Ast
 			constantExpr.componentCount = node.componentCount;
 			constantExpr.components = newComponents;
 
+			m_propagationCount++;
 			return expr;
 		}
 
-		auto swizzle = ShaderBuilder::Swizzle(std::move(expr), node.components, node.componentCount);
+		auto swizzle = AllocateNode(node);
+		swizzle->componentCount = node.componentCount;
+		swizzle->components = node.components;
+		swizzle->expression = std::move(expr);
 		swizzle->cachedExpressionType = node.cachedExpressionType;
 		swizzle->sourceLocation = node.sourceLocation;
 
@@ -942,11 +974,15 @@ namespace nzsl::Ast
 			if (optimized)
 			{
 				optimized->sourceLocation = node.sourceLocation;
+
+				m_propagationCount++;
 				return optimized;
 			}
 		}
 
-		auto unary = ShaderBuilder::Unary(node.op, std::move(expr));
+		auto unary = AllocateNode(node);
+		unary->op = node.op;
+		unary->expression = std::move(expr);
 		unary->cachedExpressionType = node.cachedExpressionType;
 		unary->sourceLocation = node.sourceLocation;
 
@@ -955,18 +991,21 @@ namespace nzsl::Ast
 
 	StatementPtr ConstantPropagationVisitor::Clone(ConditionalStatement& node)
 	{
-		auto cond = CloneExpression(node.condition);
+		// Propagate constants on a copy of the condition, the statement is cloned as a whole afterwards
+		auto cond = CloneExpression(*node.condition);
 		if (cond->GetType() != NodeType::ConstantValueExpression)
 			throw std::runtime_error("conditional expression condition must be a constant expression");
 
 		auto& constant = static_cast<ConstantValueExpression&>(*cond);
 
 		assert(constant.cachedExpressionType);
-		const ExpressionType& constantType = constant.cachedExpressionType.value();
+		const ExpressionType& constantType = constant.cachedExpressionType->Get();
 
 		if (!IsPrimitiveType(constantType) || std::get<PrimitiveType>(constantType) != PrimitiveType::Boolean)
 			throw std::runtime_error("conditional expression condition must resolve to a boolean");
 
+		m_propagationCount++;
+
 		bool cValue = std::get<bool>(constant.value);
 		if (cValue)
 			return Cloner::Clone(node);
@@ -0,0 +1,476 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/DeadStoreEliminationVisitor.hpp>
+#include <NazaraUtils/Bitset.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
+#include <NZSL/ShaderBuilder.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <NZSL/Ast/Utils.hpp>
+#include <cassert>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace nzsl::Ast
+{
+	namespace
+	{
+		// Returns the variable written by an assignment target (x, x.field, x[i].zw, ...)
+		const VariableValueExpression* GetStoreTarget(const Expression& expr)
+		{
+			const Expression* currentExpr = &expr;
+			for (;;)
+			{
+				switch (currentExpr->GetType())
+				{
+					case NodeType::AccessIdentifierExpression:
+						currentExpr = static_cast<const AccessIdentifierExpression&>(*currentExpr).expr.get();
+						break;
+
+					case NodeType::AccessIndexExpression:
+						currentExpr = static_cast<const AccessIndexExpression&>(*currentExpr).expr.get();
+						break;
+
+					case NodeType::SwizzleExpression:
+						currentExpr = static_cast<const SwizzleExpression&>(*currentExpr).expression.get();
+						break;
+
+					case NodeType::VariableValueExpression:
+						return static_cast<const VariableValueExpression*>(currentExpr);
+
+					default:
+						return nullptr;
+				}
+			}
+		}
+
+		// Returns the assignment if the statement overwrites a whole variable (x = value;)
+		AssignExpression* GetVariableOverwrite(Statement& statement)
+		{
+			if (statement.GetType() != NodeType::ExpressionStatement)
+				return nullptr;
+
+			Expression& expr = *static_cast<ExpressionStatement&>(statement).expression;
+			if (expr.GetType() != NodeType::AssignExpression)
+				return nullptr;
+
+			AssignExpression& assign = static_cast<AssignExpression&>(expr);
+			if (assign.op != AssignType::Simple || assign.left->GetType() != NodeType::VariableValueExpression)
+				return nullptr;
+
+			return &assign;
+		}
+
+		class VariableReferenceChecker : public RecursiveVisitor
+		{
+			public:
+				VariableReferenceChecker(std::size_t variableIndex) :
+				m_variableIndex(variableIndex)
+				{
+				}
+
+				using RecursiveVisitor::Visit;
+
+				void Visit(VariableValueExpression& node) override
+				{
+					if (node.variableId == m_variableIndex)
+						isReferenced = true;
+				}
+
+				bool isReferenced = false;
+
+			private:
+				std::size_t m_variableIndex;
+		};
+
+		template<typename T>
+		bool IsVariableReferenced(T& node, std::size_t variableIndex)
+		{
+			VariableReferenceChecker checker(variableIndex);
+			node.Visit(checker);
+
+			return checker.isReferenced;
+		}
+
+		// Looks for break and continue statements which would exit the current loop iteration (ignoring the ones of nested loops)
+		class LoopJumpChecker : public RecursiveVisitor
+		{
+			public:
+				using RecursiveVisitor::Visit;
+
+				void Visit(BreakStatement& /*node*/) override
+				{
+					hasLoopJump = true;
+				}
+
+				void Visit(ContinueStatement& /*node*/) override
+				{
+					hasLoopJump = true;
+				}
+
+				void Visit(ForStatement& /*node*/) override
+				{
+				}
+
+				void Visit(ForEachStatement& /*node*/) override
+				{
+				}
+
+				void Visit(WhileStatement& /*node*/) override
+				{
+				}
+
+				bool hasLoopJump = false;
+		};
+
+		bool HasLoopJump(Statement& statement)
+		{
+			LoopJumpChecker checker;
+			statement.Visit(checker);
+
+			return checker.hasLoopJump;
+		}
+
+		struct VariableUsage
+		{
+			std::vector<ExpressionStatement*> removableStores;
+			DeclareVariableStatement* declaration = nullptr;
+			std::size_t readCount = 0;
+			std::size_t storeCount = 0;
+			bool hasUnremovableStore = false;
+			bool isLocal = false; //< declared by the function (parameters included)
+		};
+
+		class VariableUsageCollector : public RecursiveVisitor
+		{
+			public:
+				using RecursiveVisitor::Visit;
+
+				void Visit(AssignExpression& node) override
+				{
+					HandleStore(node, nullptr);
+				}
+
+				void Visit(DeclareVariableStatement& node) override
+				{
+					assert(node.varIndex);
+
+					VariableUsage& usage = variables[*node.varIndex];
+					usage.declaration = &node;
+					usage.isLocal = true;
+
+					declarationOrder.push_back(*node.varIndex);
+
+					if (node.initialExpression)
+					{
+						node.initialExpression->Visit(*this);
+						if (HasSideEffects(*node.initialExpression))
+							usage.hasUnremovableStore = true;
+					}
+				}
+
+				void Visit(ExpressionStatement& node) override
+				{
+					if (node.expression->GetType() == NodeType::AssignExpression)
+						HandleStore(static_cast<AssignExpression&>(*node.expression), &node);
+					else
+						RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(VariableValueExpression& node) override
+				{
+					variables[node.variableId].readCount++;
+				}
+
+				std::unordered_map<std::size_t, VariableUsage> variables;
+				std::vector<std::size_t> declarationOrder;
+
+			private:
+				void HandleStore(AssignExpression& node, ExpressionStatement* statement)
+				{
+					const VariableValueExpression* target = GetStoreTarget(*node.left);
+					if (!target)
+					{
+						RecursiveVisitor::Visit(node);
+						return;
+					}
+
+					VariableUsage& usage = variables[target->variableId];
+					usage.storeCount++;
+					if (node.op != AssignType::Simple)
+						usage.readCount++;
+
+					// indices are read even when the variable is only written
+					Expression* currentExpr = node.left.get();
+					while (currentExpr != target)
+					{
+						switch (currentExpr->GetType())
+						{
+							case NodeType::AccessIdentifierExpression:
+								currentExpr = static_cast<AccessIdentifierExpression&>(*currentExpr).expr.get();
+								break;
+
+							case NodeType::AccessIndexExpression:
+							{
+								AccessIndexExpression& accessIndex = static_cast<AccessIndexExpression&>(*currentExpr);
+								for (auto& index : accessIndex.indices)
+									index->Visit(*this);
+
+								currentExpr = accessIndex.expr.get();
+								break;
+							}
+
+							default:
+								currentExpr = static_cast<SwizzleExpression&>(*currentExpr).expression.get();
+								break;
+						}
+					}
+
+					node.right->Visit(*this);
+
+					if (statement && !HasSideEffects(*node.left) && !HasSideEffects(*node.right))
+						usage.removableStores.push_back(statement);
+					else
+						usage.hasUnremovableStore = true;
+				}
+		};
+
+		// Finds stores overwritten by a later store of the same block before the variable could be read
+		class OverwrittenStoreCollector : public RecursiveVisitor
+		{
+			public:
+				OverwrittenStoreCollector(const std::unordered_map<std::size_t, VariableUsage>& variables) :
+				m_variables(variables)
+				{
+				}
+
+				using RecursiveVisitor::Visit;
+
+				void Collect(std::vector<StatementPtr>& statements)
+				{
+					for (std::size_t i = 0; i < statements.size(); ++i)
+					{
+						Statement& statement = *statements[i];
+
+						std::size_t varIndex;
+						if (statement.GetType() == NodeType::DeclareVariableStatement)
+						{
+							DeclareVariableStatement& declareVariable = static_cast<DeclareVariableStatement&>(statement);
+							if (!declareVariable.initialExpression || HasSideEffects(*declareVariable.initialExpression))
+								continue;
+
+							varIndex = *declareVariable.varIndex;
+						}
+						else if (AssignExpression* assign = GetVariableOverwrite(statement))
+						{
+							if (HasSideEffects(*assign->right))
+								continue;
+
+							varIndex = static_cast<VariableValueExpression&>(*assign->left).variableId;
+						}
+						else
+							continue;
+
+						// stores to global variables can be observed by other functions
+						auto it = m_variables.find(varIndex);
+						if (it == m_variables.end() || !it->second.isLocal)
+							continue;
+
+						if (IsOverwritten(statements, i + 1, varIndex))
+						{
+							if (statement.GetType() == NodeType::DeclareVariableStatement)
+								deadInitializers.insert(static_cast<DeclareVariableStatement*>(&statement));
+							else
+								deadStores.insert(&statement);
+						}
+					}
+
+					for (auto& statement : statements)
+						statement->Visit(*this);
+				}
+
+				void Visit(MultiStatement& node) override
+				{
+					Collect(node.statements);
+				}
+
+				std::unordered_set<const DeclareVariableStatement*> deadInitializers;
+				std::unordered_set<const Statement*> deadStores;
+
+			private:
+				static bool IsOverwritten(std::vector<StatementPtr>& statements, std::size_t firstIndex, std::size_t varIndex)
+				{
+					for (std::size_t i = firstIndex; i < statements.size(); ++i)
+					{
+						Statement& statement = *statements[i];
+						if (AssignExpression* assign = GetVariableOverwrite(statement))
+						{
+							if (static_cast<VariableValueExpression&>(*assign->left).variableId == varIndex)
+								return !IsVariableReferenced(*assign->right, varIndex);
+						}
+
+						// a break or continue could skip the overwriting store and read the value after the loop (or at the next iteration)
+						if (IsVariableReferenced(statement, varIndex) || HasLoopJump(statement))
+							return false;
+					}
+
+					return false;
+				}
+
+				const std::unordered_map<std::size_t, VariableUsage>& m_variables;
+		};
+	}
+
+	struct DeadStoreEliminationVisitor::FunctionData
+	{
+		std::unordered_map<std::size_t, ExpressionPtr> copies;
+		std::unordered_set<const DeclareVariableStatement*> deadInitializers;
+		std::unordered_set<const Statement*> deadStores;
+		Nz::Bitset<> unusedVariables;
+	};
+
+	ModulePtr DeadStoreEliminationVisitor::Process(const Module& shaderModule)
+	{
+		auto rootNode = Nz::StaticUniquePointerCast<MultiStatement>(Process(*shaderModule.rootNode));
+
+		return std::make_shared<Module>(shaderModule.metadata, std::move(rootNode), shaderModule.importedModules);
+	}
+
+	StatementPtr DeadStoreEliminationVisitor::Process(Statement& statement)
+	{
+		m_eliminationCount = 0;
+
+		return Clone(statement);
+	}
+
+	void DeadStoreEliminationVisitor::ProcessInPlace(Module& shaderModule)
+	{
+		m_eliminationCount = 0;
+
+		shaderModule.rootNode = Nz::StaticUniquePointerCast<MultiStatement>(TransformInPlace(std::move(shaderModule.rootNode)));
+	}
+
+	StatementPtr DeadStoreEliminationVisitor::Clone(DeclareFunctionStatement& node)
+	{
+		VariableUsageCollector usageCollector;
+		for (auto& parameter : node.parameters)
+		{
+			assert(parameter.varIndex);
+			usageCollector.variables[*parameter.varIndex].isLocal = true;
+		}
+
+		for (auto& statement : node.statements)
+			statement->Visit(usageCollector);
+
+		FunctionData functionData;
+
+		// let x = y; => replace x by y if neither of them is ever assigned (which means they hold the same value during the whole lifetime of x)
+		for (std::size_t varIndex : usageCollector.declarationOrder)
+		{
+			const VariableUsage& usage = usageCollector.variables[varIndex];
+			if (usage.storeCount > 0 || !usage.declaration->initialExpression)
+				continue;
+
+			Expression& initialValue = *usage.declaration->initialExpression;
+			if (initialValue.GetType() == NodeType::VariableValueExpression)
+			{
+				std::size_t sourceIndex = static_cast<VariableValueExpression&>(initialValue).variableId;
+
+				const VariableUsage& sourceUsage = usageCollector.variables[sourceIndex];
+				if (!sourceUsage.isLocal || sourceUsage.storeCount > 0)
+					continue;
+
+				// copy of a copy
+				auto it = functionData.copies.find(sourceIndex);
+				functionData.copies[varIndex] = Ast::Clone((it != functionData.copies.end()) ? *it->second : initialValue);
+			}
+			else if (initialValue.GetType() == NodeType::ConstantValueExpression)
+				functionData.copies[varIndex] = Ast::Clone(initialValue);
+			else
+				continue;
+
+			functionData.unusedVariables.UnboundedSet(varIndex);
+		}
+
+		// variables which are never read only need their side effects
+		for (auto&& [varIndex, usage] : usageCollector.variables)
+		{
+			if (!usage.isLocal || usage.readCount > 0)
+				continue;
+
+			for (ExpressionStatement* store : usage.removableStores)
+				functionData.deadStores.insert(store);
+
+			// parameters are declared by the function itself
+			if (usage.declaration && !usage.hasUnremovableStore)
+				functionData.unusedVariables.UnboundedSet(varIndex);
+		}
+
+		OverwrittenStoreCollector overwrittenStoreCollector(usageCollector.variables);
+		overwrittenStoreCollector.Collect(node.statements);
+
+		functionData.deadInitializers = std::move(overwrittenStoreCollector.deadInitializers);
+		functionData.deadStores.merge(overwrittenStoreCollector.deadStores);
+
+		FunctionData* previousFunction = m_function;
+		m_function = &functionData;
+		Nz::CallOnExit restoreFunction([&]
+		{
+			m_function = previousFunction;
+		});
+
+		return Cloner::Clone(node);
+	}
+
+	StatementPtr DeadStoreEliminationVisitor::Clone(DeclareVariableStatement& node)
+	{
+		if (!m_function)
+			return Cloner::Clone(node);
+
+		assert(node.varIndex);
+		if (m_function->unusedVariables.UnboundedTest(*node.varIndex))
+		{
+			m_eliminationCount++;
+			return ShaderBuilder::NoOp();
+		}
+
+		auto clone = Nz::StaticUniquePointerCast<DeclareVariableStatement>(Cloner::Clone(node));
+		if (m_function->deadInitializers.count(&node) > 0)
+		{
+			clone->initialExpression.reset();
+			m_eliminationCount++;
+		}
+
+		return clone;
+	}
+
+	StatementPtr DeadStoreEliminationVisitor::Clone(ExpressionStatement& node)
+	{
+		if (m_function && m_function->deadStores.count(&node) > 0)
+		{
+			m_eliminationCount++;
+			return ShaderBuilder::NoOp();
+		}
+
+		return Cloner::Clone(node);
+	}
+
+	ExpressionPtr DeadStoreEliminationVisitor::Clone(VariableValueExpression& node)
+	{
+		if (m_function)
+		{
+			auto it = m_function->copies.find(node.variableId);
+			if (it != m_function->copies.end())
+			{
+				ExpressionPtr value = Ast::Clone(*it->second);
+				value->sourceLocation = node.sourceLocation;
+
+				m_eliminationCount++;
+				return value;
+			}
+		}
+
+		return Cloner::Clone(node);
+	}
+}
@@ -186,6 +186,23 @@ namespace nzsl::Ast
 		m_currentFunctionIndex = {};
 	}
 
+	void DependencyCheckerVisitor::Visit(DeclareOptionStatement& node)
+	{
+		// Options are registered as constants
+		if (!node.optIndex)
+			return;
+
+		assert(m_constantUsages.find(*node.optIndex) == m_constantUsages.end());
+		UsageSet& usageSet = m_constantUsages[*node.optIndex];
+
+		if (node.optType.IsResultingValue())
+			RegisterType(usageSet, node.optType.GetResultingValue());
+
+		m_currentConstantIndex = *node.optIndex;
+		RecursiveVisitor::Visit(node);
+		m_currentConstantIndex = {};
+	}
+
 	void DependencyCheckerVisitor::Visit(DeclareStructStatement& node)
 	{
 		assert(node.structIndex);
@@ -27,6 +27,8 @@ namespace nzsl::Ast
 		};
 
 		m_context = &context;
+		m_eliminationCount = 0;
+
 		Nz::CallOnExit onExit([this]()
 		{
 			m_context = nullptr;
@@ -35,11 +37,31 @@ namespace nzsl::Ast
 		return Clone(statement);
 	}
 
+	void EliminateUnusedPassVisitor::ProcessInPlace(Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet)
+	{
+		Context context{
+			usageSet
+		};
+
+		m_context = &context;
+		m_eliminationCount = 0;
+
+		Nz::CallOnExit onExit([this]()
+		{
+			m_context = nullptr;
+		});
+
+		shaderModule.rootNode = Nz::StaticUniquePointerCast<MultiStatement>(TransformInPlace(std::move(shaderModule.rootNode)));
+	}
+
 	StatementPtr EliminateUnusedPassVisitor::Clone(DeclareAliasStatement& node)
 	{
 		assert(node.aliasIndex);
 		if (!IsAliasUsed(*node.aliasIndex))
+		{
+			m_eliminationCount++;
 			return ShaderBuilder::NoOp();
+		}
 
 		return Cloner::Clone(node);
 	}
@@ -48,7 +70,10 @@ namespace nzsl::Ast
 	{
 		assert(node.constIndex);
 		if (!IsConstantUsed(*node.constIndex))
+		{
+			m_eliminationCount++;
 			return ShaderBuilder::NoOp();
+		}
 
 		return Cloner::Clone(node);
 	}
@@ -69,7 +94,10 @@ namespace nzsl::Ast
 		}
 
 		if (!isUsed)
+		{
+			m_eliminationCount++;
 			return ShaderBuilder::NoOp();
+		}
 
 		auto clonedNode = Cloner::Clone(node);
 
@@ -81,7 +109,10 @@ namespace nzsl::Ast
 			std::size_t varIndex = *externalVar.varIndex;
 
 			if (!IsVariableUsed(varIndex))
+			{
 				it = externalStatement.externalVars.erase(it);
+				m_eliminationCount++;
+			}
 			else
 				++it;
 		}
@@ -93,7 +124,10 @@ namespace nzsl::Ast
 	{
 		assert(node.funcIndex);
 		if (!IsFunctionUsed(*node.funcIndex))
+		{
+			m_eliminationCount++;
 			return ShaderBuilder::NoOp();
+		}
 
 		return Cloner::Clone(node);
 	}
@@ -102,7 +136,10 @@ namespace nzsl::Ast
 	{
 		assert(node.structIndex);
 		if (!IsStructUsed(*node.structIndex))
+		{
+			m_eliminationCount++;
 			return ShaderBuilder::NoOp();
+		}
 
 		return Cloner::Clone(node);
 	}
@@ -111,7 +148,10 @@ namespace nzsl::Ast
 	{
 		assert(node.varIndex);
 		if (!IsVariableUsed(*node.varIndex))
+		{
+			m_eliminationCount++;
 			return ShaderBuilder::NoOp();
+		}
 
 		return Cloner::Clone(node);
 	}
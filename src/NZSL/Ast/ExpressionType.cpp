@@ -44,7 +44,8 @@ namespace nzsl::Ast
 	}
 
 
-	BaseArrayType::BaseArrayType(const BaseArrayType& array)
+	BaseArrayType::BaseArrayType(const BaseArrayType& array) :
+	isWrapped(array.isWrapped)
 	{
 		assert(array.containedType);
 		containedType = std::make_unique<ContainedType>(*array.containedType);
@@ -55,6 +56,7 @@ namespace nzsl::Ast
 		assert(array.containedType);
 
 		containedType = std::make_unique<ContainedType>(*array.containedType);
+		isWrapped = array.isWrapped;
 
 		return *this;
 	}
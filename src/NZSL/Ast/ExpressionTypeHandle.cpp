@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/ExpressionTypeHandle.hpp>
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+namespace nzsl::Ast
+{
+	struct ExpressionTypeHandle::Interner
+	{
+		// Types are spread over multiple shards, each having its own lock, to limit contention between threads
+		static constexpr std::size_t ShardCount = 16;
+		static constexpr std::size_t MinPurgeThreshold = 64;
+
+		struct Shard
+		{
+			void PurgeExpiredEntries()
+			{
+				for (auto it = entries.begin(); it != entries.end();)
+				{
+					if (it->second.expired())
+						it = entries.erase(it);
+					else
+						++it;
+				}
+
+				purgeThreshold = std::max(entries.size() * 2, MinPurgeThreshold);
+			}
+
+			std::mutex mutex;
+			std::size_t purgeThreshold = MinPurgeThreshold;
+			std::unordered_multimap<std::size_t, std::weak_ptr<const Entry>> entries;
+		};
+
+		static Interner& Instance()
+		{
+			static Interner interner;
+			return interner;
+		}
+
+		std::array<Shard, ShardCount> shards;
+	};
+
+	ExpressionTypeHandle::ExpressionTypeHandle(const ExpressionType& type) :
+	m_entry(Intern(type))
+	{
+	}
+
+	std::size_t ExpressionTypeHandle::GetInternedTypeCount()
+	{
+		Interner& interner = Interner::Instance();
+
+		std::size_t typeCount = 0;
+		for (Interner::Shard& shard : interner.shards)
+		{
+			std::unique_lock lock(shard.mutex);
+			typeCount += std::count_if(shard.entries.begin(), shard.entries.end(), [](const auto& pair) { return !pair.second.expired(); });
+		}
+
+		return typeCount;
+	}
+
+	auto ExpressionTypeHandle::Intern(const ExpressionType& type) -> std::shared_ptr<const Entry>
+	{
+		std::size_t hash = std::hash<ExpressionType>{}(type);
+
+		Interner::Shard& shard = Interner::Instance().shards[hash % Interner::ShardCount];
+
+		std::unique_lock lock(shard.mutex);
+
+		auto [beginIt, endIt] = shard.entries.equal_range(hash);
+		for (auto it = beginIt; it != endIt;)
+		{
+			std::shared_ptr<const Entry> entry = it->second.lock();
+			if (!entry)
+			{
+				// No handle references this type anymore
+				it = shard.entries.erase(it);
+				continue;
+			}
+
+			if (entry->type == type)
+				return entry;
+
+			++it;
+		}
+
+		// Entries whose type was released under another hash are only removed from time to time
+		if (shard.entries.size() >= shard.purgeThreshold)
+			shard.PurgeExpiredEntries();
+
+		std::shared_ptr<const Entry> entry = std::make_shared<Entry>(Entry{ type, hash });
+		shard.entries.emplace(hash, entry);
+
+		return entry;
+	}
+}
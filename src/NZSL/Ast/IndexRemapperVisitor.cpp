@@ -47,7 +47,7 @@ namespace nzsl::Ast
 	{
 		auto clonedExpr = Cloner::CloneExpression(expr);
 		if (clonedExpr->cachedExpressionType)
-			clonedExpr->cachedExpressionType = RemapType(*clonedExpr->cachedExpressionType);
+			clonedExpr->cachedExpressionType = RemapType(clonedExpr->cachedExpressionType->Get());
 
 		return clonedExpr;
 	}
@@ -0,0 +1,609 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/LoopInvariantCodeMotionVisitor.hpp>
+#include <NZSL/ShaderBuilder.hpp>
+#include <NZSL/Ast/Compare.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cassert>
+
+namespace nzsl::Ast
+{
+	namespace
+	{
+		class VariableIndexCollector : public RecursiveVisitor
+		{
+			public:
+				using RecursiveVisitor::Visit;
+
+				void Visit(DeclareExternalStatement& node) override
+				{
+					for (auto& externalVar : node.externalVars)
+					{
+						if (externalVar.varIndex)
+						{
+							externalVariables.UnboundedSet(*externalVar.varIndex);
+							Register(*externalVar.varIndex);
+						}
+					}
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(DeclareFunctionStatement& node) override
+				{
+					for (auto& parameter : node.parameters)
+					{
+						if (parameter.varIndex)
+							Register(*parameter.varIndex);
+					}
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(DeclareVariableStatement& node) override
+				{
+					if (node.varIndex)
+						Register(*node.varIndex);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(ForStatement& node) override
+				{
+					if (node.varIndex)
+						Register(*node.varIndex);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(ForEachStatement& node) override
+				{
+					if (node.varIndex)
+						Register(*node.varIndex);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				Nz::Bitset<> externalVariables;
+				std::size_t nextVarIndex = 0;
+
+			private:
+				void Register(std::size_t varIndex)
+				{
+					nextVarIndex = std::max(nextVarIndex, varIndex + 1);
+				}
+		};
+
+		// Collects the variables which may hold a different value at each iteration
+		class LoopVariantCollector : public RecursiveVisitor
+		{
+			public:
+				using RecursiveVisitor::Visit;
+
+				void Visit(AssignExpression& node) override
+				{
+					// find the assigned variable (x, x.field, x[i].zw, ...)
+					Expression* currentExpr = node.left.get();
+					for (;;)
+					{
+						NodeType nodeType = currentExpr->GetType();
+						if (nodeType == NodeType::AccessIdentifierExpression)
+							currentExpr = static_cast<AccessIdentifierExpression&>(*currentExpr).expr.get();
+						else if (nodeType == NodeType::AccessIndexExpression)
+							currentExpr = static_cast<AccessIndexExpression&>(*currentExpr).expr.get();
+						else if (nodeType == NodeType::SwizzleExpression)
+							currentExpr = static_cast<SwizzleExpression&>(*currentExpr).expression.get();
+						else
+							break;
+					}
+
+					if (currentExpr->GetType() == NodeType::VariableValueExpression)
+						variantVariables.UnboundedSet(static_cast<VariableValueExpression&>(*currentExpr).variableId);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(CallFunctionExpression& node) override
+				{
+					// functions can write to storage buffers
+					hasFunctionCall = true;
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(DeclareVariableStatement& node) override
+				{
+					// variables declared in the loop body are declared again at each iteration
+					assert(node.varIndex);
+					variantVariables.UnboundedSet(*node.varIndex);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(ForStatement& node) override
+				{
+					assert(node.varIndex);
+					variantVariables.UnboundedSet(*node.varIndex);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(ForEachStatement& node) override
+				{
+					assert(node.varIndex);
+					variantVariables.UnboundedSet(*node.varIndex);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				Nz::Bitset<> variantVariables;
+				bool hasFunctionCall = false;
+		};
+
+		class VariableReferenceFinder : public RecursiveVisitor
+		{
+			public:
+				using RecursiveVisitor::Visit;
+
+				void Visit(VariableValueExpression& /*node*/) override
+				{
+					hasVariableReference = true;
+				}
+
+				bool hasVariableReference = false;
+		};
+
+		// Structural equality of the expressions accepted by InvariantHoister::IsInvariant
+		bool IsSameComputation(const Expression& lhs, const Expression& rhs)
+		{
+			if (lhs.GetType() != rhs.GetType())
+				return false;
+
+			ComparisonParams params;
+			params.compareSourceLoc = false;
+
+			auto CompareAll = [](const std::vector<ExpressionPtr>& lhsExprs, const std::vector<ExpressionPtr>& rhsExprs)
+			{
+				return std::equal(lhsExprs.begin(), lhsExprs.end(), rhsExprs.begin(), rhsExprs.end(), [](const ExpressionPtr& l, const ExpressionPtr& r) { return IsSameComputation(*l, *r); });
+			};
+
+			switch (lhs.GetType())
+			{
+				case NodeType::ConstantExpression:
+					return Compare(static_cast<const ConstantExpression&>(lhs), static_cast<const ConstantExpression&>(rhs), params);
+
+				case NodeType::ConstantValueExpression:
+					return Compare(static_cast<const ConstantValueExpression&>(lhs), static_cast<const ConstantValueExpression&>(rhs), params);
+
+				case NodeType::VariableValueExpression:
+					return Compare(static_cast<const VariableValueExpression&>(lhs), static_cast<const VariableValueExpression&>(rhs), params);
+
+				case NodeType::AccessIdentifierExpression:
+				{
+					const auto& lhsAccess = static_cast<const AccessIdentifierExpression&>(lhs);
+					const auto& rhsAccess = static_cast<const AccessIdentifierExpression&>(rhs);
+
+					auto SameIdentifier = [](const AccessIdentifierExpression::Identifier& l, const AccessIdentifierExpression::Identifier& r) { return l.identifier == r.identifier; };
+					if (!std::equal(lhsAccess.identifiers.begin(), lhsAccess.identifiers.end(), rhsAccess.identifiers.begin(), rhsAccess.identifiers.end(), SameIdentifier))
+						return false;
+
+					return IsSameComputation(*lhsAccess.expr, *rhsAccess.expr);
+				}
+
+				case NodeType::AccessIndexExpression:
+				{
+					const auto& lhsAccess = static_cast<const AccessIndexExpression&>(lhs);
+					const auto& rhsAccess = static_cast<const AccessIndexExpression&>(rhs);
+
+					return CompareAll(lhsAccess.indices, rhsAccess.indices) && IsSameComputation(*lhsAccess.expr, *rhsAccess.expr);
+				}
+
+				case NodeType::BinaryExpression:
+				{
+					const auto& lhsBinary = static_cast<const BinaryExpression&>(lhs);
+					const auto& rhsBinary = static_cast<const BinaryExpression&>(rhs);
+
+					return lhsBinary.op == rhsBinary.op && IsSameComputation(*lhsBinary.left, *rhsBinary.left) && IsSameComputation(*lhsBinary.right, *rhsBinary.right);
+				}
+
+				case NodeType::CastExpression:
+				{
+					const auto& lhsCast = static_cast<const CastExpression&>(lhs);
+					const auto& rhsCast = static_cast<const CastExpression&>(rhs);
+
+					if (!lhsCast.targetType.IsResultingValue() || !rhsCast.targetType.IsResultingValue())
+						return false;
+
+					return lhsCast.targetType.GetResultingValue() == rhsCast.targetType.GetResultingValue() && CompareAll(lhsCast.expressions, rhsCast.expressions);
+				}
+
+				case NodeType::IntrinsicExpression:
+				{
+					const auto& lhsIntrinsic = static_cast<const IntrinsicExpression&>(lhs);
+					const auto& rhsIntrinsic = static_cast<const IntrinsicExpression&>(rhs);
+
+					return lhsIntrinsic.intrinsic == rhsIntrinsic.intrinsic && CompareAll(lhsIntrinsic.parameters, rhsIntrinsic.parameters);
+				}
+
+				case NodeType::SwizzleExpression:
+				{
+					const auto& lhsSwizzle = static_cast<const SwizzleExpression&>(lhs);
+					const auto& rhsSwizzle = static_cast<const SwizzleExpression&>(rhs);
+
+					if (lhsSwizzle.componentCount != rhsSwizzle.componentCount || !std::equal(lhsSwizzle.components.begin(), lhsSwizzle.components.begin() + lhsSwizzle.componentCount, rhsSwizzle.components.begin()))
+						return false;
+
+					return IsSameComputation(*lhsSwizzle.expression, *rhsSwizzle.expression);
+				}
+
+				case NodeType::UnaryExpression:
+				{
+					const auto& lhsUnary = static_cast<const UnaryExpression&>(lhs);
+					const auto& rhsUnary = static_cast<const UnaryExpression&>(rhs);
+
+					return lhsUnary.op == rhsUnary.op && IsSameComputation(*lhsUnary.expression, *rhsUnary.expression);
+				}
+
+				default:
+					return false;
+			}
+		}
+
+		bool IsSpeculatable(IntrinsicType intrinsicType)
+		{
+			switch (intrinsicType)
+			{
+				case IntrinsicType::Abs:
+				case IntrinsicType::ArcCos:
+				case IntrinsicType::ArcCosh:
+				case IntrinsicType::ArcSin:
+				case IntrinsicType::ArcSinh:
+				case IntrinsicType::ArcTan:
+				case IntrinsicType::ArcTan2:
+				case IntrinsicType::ArcTanh:
+				case IntrinsicType::Ceil:
+				case IntrinsicType::Clamp:
+				case IntrinsicType::Cos:
+				case IntrinsicType::Cosh:
+				case IntrinsicType::CrossProduct:
+				case IntrinsicType::DegToRad:
+				case IntrinsicType::Distance:
+				case IntrinsicType::DotProduct:
+				case IntrinsicType::Exp:
+				case IntrinsicType::Exp2:
+				case IntrinsicType::Floor:
+				case IntrinsicType::Fract:
+				case IntrinsicType::InverseSqrt:
+				case IntrinsicType::Length:
+				case IntrinsicType::Lerp:
+				case IntrinsicType::Log:
+				case IntrinsicType::Log2:
+				case IntrinsicType::MatrixInverse:
+				case IntrinsicType::MatrixTranspose:
+				case IntrinsicType::Max:
+				case IntrinsicType::Min:
+				case IntrinsicType::Normalize:
+				case IntrinsicType::Pow:
+				case IntrinsicType::RadToDeg:
+				case IntrinsicType::Reflect:
+				case IntrinsicType::Round:
+				case IntrinsicType::RoundEven:
+				case IntrinsicType::Select:
+				case IntrinsicType::Sign:
+				case IntrinsicType::Sin:
+				case IntrinsicType::Sinh:
+				case IntrinsicType::Sqrt:
+				case IntrinsicType::Tan:
+				case IntrinsicType::Tanh:
+				case IntrinsicType::Trunc:
+					return true;
+
+				// texture accesses depend on the control flow (implicit derivatives) or on memory written by other invocations
+				case IntrinsicType::ArraySize:
+				case IntrinsicType::TextureRead:
+				case IntrinsicType::TextureSampleImplicitLod:
+				case IntrinsicType::TextureSampleImplicitLodDepthComp:
+				case IntrinsicType::TextureWrite:
+					return false;
+			}
+
+			return false;
+		}
+
+		bool IsIntegerDivision(const BinaryExpression& node)
+		{
+			if (node.op != BinaryType::Divide && node.op != BinaryType::Modulo)
+				return false;
+
+			const ExpressionType* exprType = GetExpressionType(node);
+			if (!exprType)
+				return true;
+
+			const ExpressionType& resolvedType = ResolveAlias(*exprType);
+
+			PrimitiveType primitiveType;
+			if (IsPrimitiveType(resolvedType))
+				primitiveType = std::get<PrimitiveType>(resolvedType);
+			else if (IsVectorType(resolvedType))
+				primitiveType = std::get<VectorType>(resolvedType).type;
+			else
+				return false;
+
+			return primitiveType == PrimitiveType::Int32 || primitiveType == PrimitiveType::UInt32;
+		}
+
+		// Replaces the largest loop-invariant expressions of a loop by variables declared before it
+		class InvariantHoister : public Cloner
+		{
+			public:
+				InvariantHoister(const LoopVariantCollector& loopVariants, const Nz::Bitset<>& externalVariables, std::size_t& nextVarIndex) :
+				m_externalVariables(externalVariables),
+				m_loopVariants(loopVariants),
+				m_nextVarIndex(nextVarIndex)
+				{
+				}
+
+				template<typename T>
+				void Transform(T& node)
+				{
+					node = TransformInPlace(std::move(node));
+				}
+
+				std::vector<StatementPtr> declarations;
+				std::size_t hoistedCount = 0;
+
+			protected:
+				using Cloner::Clone;
+				using Cloner::CloneExpression;
+
+				ExpressionPtr CloneExpression(Expression& expr) override
+				{
+					if (m_lvalueDepth == 0 && IsWorthHoisting(expr) && IsInvariant(expr))
+						return Hoist(expr);
+
+					return Cloner::CloneExpression(expr);
+				}
+
+				ExpressionPtr Clone(AssignExpression& node) override
+				{
+					auto clone = AllocateNode(node);
+					clone->op = node.op;
+
+					// the assigned expression has to stay an lvalue
+					m_lvalueDepth++;
+					clone->left = CloneExpression(node.left);
+					m_lvalueDepth--;
+
+					clone->right = CloneExpression(node.right);
+
+					clone->cachedExpressionType = node.cachedExpressionType;
+					clone->sourceLocation = node.sourceLocation;
+
+					return clone;
+				}
+
+			private:
+				ExpressionPtr Hoist(Expression& expr)
+				{
+					const ExpressionType& exprType = expr.cachedExpressionType->Get();
+
+					hoistedCount++;
+
+					// the same computation may appear multiple times in the loop
+					for (auto& [hoistedExpr, varIndex] : m_hoistedExpressions)
+					{
+						if (IsSameComputation(*hoistedExpr, expr))
+							return ShaderBuilder::Variable(varIndex, exprType, expr.sourceLocation);
+					}
+
+					std::size_t varIndex = m_nextVarIndex++;
+
+					// hoisted variables are declared in the same scope, give them unique names
+					auto declaration = ShaderBuilder::DeclareVariable(fmt::format("loopInvariant{}", varIndex), exprType, Ast::Clone(expr));
+					declaration->sourceLocation = expr.sourceLocation;
+					declaration->varIndex = varIndex;
+
+					m_hoistedExpressions.emplace_back(declaration->initialExpression.get(), varIndex);
+					declarations.push_back(std::move(declaration));
+
+					return ShaderBuilder::Variable(varIndex, exprType, expr.sourceLocation);
+				}
+
+				bool IsInvariant(const Expression& expr) const
+				{
+					switch (expr.GetType())
+					{
+						case NodeType::ConstantExpression:
+						case NodeType::ConstantValueExpression:
+							return true;
+
+						case NodeType::VariableValueExpression:
+						{
+							std::size_t varIndex = static_cast<const VariableValueExpression&>(expr).variableId;
+							if (m_loopVariants.variantVariables.UnboundedTest(varIndex))
+								return false;
+
+							return !m_loopVariants.hasFunctionCall || !m_externalVariables.UnboundedTest(varIndex);
+						}
+
+						case NodeType::AccessIdentifierExpression:
+							return IsInvariant(*static_cast<const AccessIdentifierExpression&>(expr).expr);
+
+						case NodeType::AccessIndexExpression:
+						{
+							// dynamic indices could be out of bounds when the loop doesn't run
+							const AccessIndexExpression& accessIndex = static_cast<const AccessIndexExpression&>(expr);
+							for (const auto& index : accessIndex.indices)
+							{
+								if (index->GetType() != NodeType::ConstantValueExpression)
+									return false;
+							}
+
+							const ExpressionType* exprType = GetExpressionType(*accessIndex.expr);
+							if (!exprType || IsDynArrayType(ResolveAlias(*exprType)))
+								return false;
+
+							return IsInvariant(*accessIndex.expr);
+						}
+
+						case NodeType::BinaryExpression:
+						{
+							const BinaryExpression& binary = static_cast<const BinaryExpression&>(expr);
+
+							// integer division by zero is undefined behavior
+							if (IsIntegerDivision(binary))
+								return false;
+
+							return IsInvariant(*binary.left) && IsInvariant(*binary.right);
+						}
+
+						case NodeType::CastExpression:
+						{
+							const CastExpression& cast = static_cast<const CastExpression&>(expr);
+							return std::all_of(cast.expressions.begin(), cast.expressions.end(), [&](const ExpressionPtr& param) { return IsInvariant(*param); });
+						}
+
+						case NodeType::IntrinsicExpression:
+						{
+							const IntrinsicExpression& intrinsic = static_cast<const IntrinsicExpression&>(expr);
+							if (!IsSpeculatable(intrinsic.intrinsic))
+								return false;
+
+							return std::all_of(intrinsic.parameters.begin(), intrinsic.parameters.end(), [&](const ExpressionPtr& param) { return IsInvariant(*param); });
+						}
+
+						case NodeType::SwizzleExpression:
+							return IsInvariant(*static_cast<const SwizzleExpression&>(expr).expression);
+
+						case NodeType::UnaryExpression:
+							return IsInvariant(*static_cast<const UnaryExpression&>(expr).expression);
+
+						default:
+							return false;
+					}
+				}
+
+				static bool IsWorthHoisting(Expression& expr)
+				{
+					if (!expr.cachedExpressionType)
+						return false;
+
+					// computations on constants only are left to constant propagation
+					VariableReferenceFinder referenceFinder;
+					expr.Visit(referenceFinder);
+					if (!referenceFinder.hasVariableReference)
+						return false;
+
+					// variable loads (and access to their members) are not computations
+					switch (expr.GetType())
+					{
+						case NodeType::BinaryExpression:
+						case NodeType::CastExpression:
+						case NodeType::IntrinsicExpression:
+						case NodeType::UnaryExpression:
+							return true;
+
+						default:
+							return false;
+					}
+				}
+
+				std::size_t m_lvalueDepth = 0;
+				std::vector<std::pair<const Expression*, std::size_t>> m_hoistedExpressions;
+				const Nz::Bitset<>& m_externalVariables;
+				const LoopVariantCollector& m_loopVariants;
+				std::size_t& m_nextVarIndex;
+		};
+	}
+
+	ModulePtr LoopInvariantCodeMotionVisitor::Process(const Module& shaderModule)
+	{
+		PrepareModule(shaderModule);
+
+		auto rootNode = Nz::StaticUniquePointerCast<MultiStatement>(Clone(*shaderModule.rootNode));
+
+		return std::make_shared<Module>(shaderModule.metadata, std::move(rootNode), shaderModule.importedModules);
+	}
+
+	void LoopInvariantCodeMotionVisitor::ProcessInPlace(Module& shaderModule)
+	{
+		PrepareModule(shaderModule);
+
+		shaderModule.rootNode = Nz::StaticUniquePointerCast<MultiStatement>(TransformInPlace(std::move(shaderModule.rootNode)));
+	}
+
+	StatementPtr LoopInvariantCodeMotionVisitor::Clone(ForStatement& node)
+	{
+		// inner loops first, so their hoisted expressions can move further out
+		auto clone = Nz::StaticUniquePointerCast<ForStatement>(Cloner::Clone(node));
+
+		// range expressions are only evaluated once
+		std::vector<StatementPtr*> loopStatements = { &clone->statement };
+
+		return HoistInvariants(std::move(clone), {}, std::move(loopStatements));
+	}
+
+	StatementPtr LoopInvariantCodeMotionVisitor::Clone(ForEachStatement& node)
+	{
+		auto clone = Nz::StaticUniquePointerCast<ForEachStatement>(Cloner::Clone(node));
+
+		std::vector<StatementPtr*> loopStatements = { &clone->statement };
+
+		return HoistInvariants(std::move(clone), {}, std::move(loopStatements));
+	}
+
+	StatementPtr LoopInvariantCodeMotionVisitor::Clone(WhileStatement& node)
+	{
+		auto clone = Nz::StaticUniquePointerCast<WhileStatement>(Cloner::Clone(node));
+
+		std::vector<ExpressionPtr*> loopExpressions = { &clone->condition };
+		std::vector<StatementPtr*> loopStatements = { &clone->body };
+
+		return HoistInvariants(std::move(clone), std::move(loopExpressions), std::move(loopStatements));
+	}
+
+	void LoopInvariantCodeMotionVisitor::PrepareModule(const Module& shaderModule)
+	{
+		m_hoistedExpressionCount = 0;
+
+		// variable indices are shared with imported modules
+		VariableIndexCollector indexCollector;
+		for (const auto& importedModule : shaderModule.importedModules)
+			importedModule.module->rootNode->Visit(indexCollector);
+
+		shaderModule.rootNode->Visit(indexCollector);
+
+		m_externalVariables = std::move(indexCollector.externalVariables);
+		m_nextVarIndex = indexCollector.nextVarIndex;
+	}
+
+	StatementPtr LoopInvariantCodeMotionVisitor::HoistInvariants(StatementPtr loop, std::vector<ExpressionPtr*> loopExpressions, std::vector<StatementPtr*> loopStatements)
+	{
+		// every store of the loop counts, even the ones skipped by a break, continue or discard, which makes hoisting pure expressions safe whatever the control flow
+		LoopVariantCollector loopVariants;
+		loop->Visit(loopVariants);
+
+		InvariantHoister hoister(loopVariants, m_externalVariables, m_nextVarIndex);
+		for (ExpressionPtr* expression : loopExpressions)
+			hoister.Transform(*expression);
+
+		for (StatementPtr* statement : loopStatements)
+			hoister.Transform(*statement);
+
+		if (hoister.declarations.empty())
+			return loop;
+
+		m_hoistedExpressionCount += hoister.hoistedCount;
+
+		auto multi = std::make_unique<MultiStatement>();
+		multi->sourceLocation = loop->sourceLocation;
+		multi->statements = std::move(hoister.declarations);
+		multi->statements.push_back(std::move(loop));
+
+		return ShaderBuilder::Scoped(std::move(multi));
+	}
+}
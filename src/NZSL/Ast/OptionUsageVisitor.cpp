@@ -0,0 +1,431 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/OptionUsageVisitor.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace nzsl::Ast
+{
+	auto OptionUsageVisitor::Analyze(const Module& shaderModule) -> Result
+	{
+		for (const auto& importedModule : shaderModule.importedModules)
+			importedModule.module->rootNode->Visit(*this);
+
+		shaderModule.rootNode->Visit(*this);
+
+		return BuildResult();
+	}
+
+	auto OptionUsageVisitor::Analyze(Statement& statement) -> Result
+	{
+		statement.Visit(*this);
+
+		return BuildResult();
+	}
+
+	auto OptionUsageVisitor::BuildResult() -> Result
+	{
+		auto ToHashes = [&](const Nz::Bitset<>& optionBits)
+		{
+			std::vector<OptionHash> optionHashes;
+			for (std::size_t optionIndex : optionBits.IterBits())
+				optionHashes.push_back(m_options[optionIndex].hash);
+
+			return optionHashes;
+		};
+
+		Result result;
+		result.options = m_options;
+
+		Nz::Bitset<> moduleOptions;
+		{
+			Nz::Bitset<> visitedSymbols;
+			for (std::size_t symbolIndex = 0; symbolIndex < m_symbols.size(); ++symbolIndex)
+			{
+				// An option is only relevant if something references it
+				if (!m_symbols[symbolIndex].optionIndex)
+					ResolveOptions(symbolIndex, visitedSymbols, moduleOptions);
+			}
+		}
+		result.moduleOptions = ToHashes(moduleOptions);
+
+		result.entryPoints.reserve(m_entryPoints.size());
+		for (const PendingEntryPoint& pendingEntry : m_entryPoints)
+		{
+			Nz::Bitset<> entryOptions;
+			Nz::Bitset<> visitedSymbols;
+			ResolveOptions(pendingEntry.symbolIndex, visitedSymbols, entryOptions);
+
+			auto& entryPoint = result.entryPoints.emplace_back();
+			entryPoint.functionName = pendingEntry.functionName;
+			entryPoint.stage = pendingEntry.stage;
+			entryPoint.options = ToHashes(entryOptions);
+		}
+
+		return result;
+	}
+
+	void OptionUsageVisitor::MergeUsage(UsageSet& usage, const UsageSet& other)
+	{
+		usage.usedAliases |= other.usedAliases;
+		usage.usedConstants |= other.usedConstants;
+		usage.usedFunctions |= other.usedFunctions;
+		usage.usedStructs |= other.usedStructs;
+		usage.usedVariables |= other.usedVariables;
+		usage.usedIdentifiers.insert(usage.usedIdentifiers.end(), other.usedIdentifiers.begin(), other.usedIdentifiers.end());
+	}
+
+	std::size_t OptionUsageVisitor::RegisterSymbol(std::unordered_map<std::size_t, std::size_t>& symbolByIndex, const std::optional<std::size_t>& index, const std::string& name)
+	{
+		std::size_t symbolIndex = m_symbols.size();
+		Symbol& symbol = m_symbols.emplace_back();
+
+		// Symbols declared under a [cond] attribute depend on its condition
+		for (const UsageSet& conditionUsage : m_conditionUsages)
+			MergeUsage(symbol.usage, conditionUsage);
+
+		if (index)
+			symbolByIndex[*index] = symbolIndex;
+
+		if (!name.empty())
+			m_symbolsByName[name].push_back(symbolIndex);
+
+		return symbolIndex;
+	}
+
+	void OptionUsageVisitor::RegisterType(const ExpressionType& exprType)
+	{
+		if (!m_currentUsage)
+			return;
+
+		std::visit([&](auto&& arg)
+		{
+			using T = std::decay_t<decltype(arg)>;
+
+			if constexpr (std::is_same_v<T, AliasType>)
+				m_currentUsage->usedAliases.UnboundedSet(arg.aliasIndex);
+			else if constexpr (std::is_base_of_v<BaseArrayType, T>)
+				RegisterType(arg.containedType->type);
+			else if constexpr (std::is_same_v<T, StructType>)
+				m_currentUsage->usedStructs.UnboundedSet(arg.structIndex);
+			else if constexpr (std::is_same_v<T, StorageType> || std::is_same_v<T, UniformType> || std::is_same_v<T, PushConstantType>)
+				m_currentUsage->usedStructs.UnboundedSet(arg.containedType.structIndex);
+
+		}, exprType);
+	}
+
+	template<typename T>
+	void OptionUsageVisitor::RegisterValue(const ExpressionValue<T>& value)
+	{
+		if (value.IsExpression())
+			value.GetExpression()->Visit(*this);
+		else if constexpr (std::is_same_v<T, ExpressionType>)
+		{
+			if (value.IsResultingValue())
+				RegisterType(value.GetResultingValue());
+		}
+	}
+
+	void OptionUsageVisitor::ResolveOptions(std::size_t symbolIndex, Nz::Bitset<>& visitedSymbols, Nz::Bitset<>& options) const
+	{
+		if (visitedSymbols.UnboundedTest(symbolIndex))
+			return;
+
+		visitedSymbols.UnboundedSet(symbolIndex);
+
+		const Symbol& symbol = m_symbols[symbolIndex];
+		if (symbol.optionIndex)
+			options.UnboundedSet(*symbol.optionIndex);
+
+		auto ResolveIndices = [&](const Nz::Bitset<>& indices, const std::unordered_map<std::size_t, std::size_t>& symbolByIndex)
+		{
+			for (std::size_t index : indices.IterBits())
+			{
+				// Unknown indices come from outside of the analyzed code (and cannot depend on its options)
+				auto it = symbolByIndex.find(index);
+				if (it != symbolByIndex.end())
+					ResolveOptions(it->second, visitedSymbols, options);
+			}
+		};
+
+		ResolveIndices(symbol.usage.usedAliases, m_aliasSymbols);
+		ResolveIndices(symbol.usage.usedConstants, m_constantSymbols);
+		ResolveIndices(symbol.usage.usedFunctions, m_functionSymbols);
+		ResolveIndices(symbol.usage.usedStructs, m_structSymbols);
+		ResolveIndices(symbol.usage.usedVariables, m_variableSymbols);
+
+		// Identifiers may be shadowed by local variables, consider every global symbol sharing this name (conservative)
+		for (const std::string& identifier : symbol.usage.usedIdentifiers)
+		{
+			auto it = m_symbolsByName.find(identifier);
+			if (it == m_symbolsByName.end())
+				continue;
+
+			for (std::size_t namedSymbolIndex : it->second)
+				ResolveOptions(namedSymbolIndex, visitedSymbols, options);
+		}
+	}
+
+	void OptionUsageVisitor::Visit(AliasValueExpression& node)
+	{
+		if (m_currentUsage)
+			m_currentUsage->usedAliases.UnboundedSet(node.aliasId);
+	}
+
+	void OptionUsageVisitor::Visit(CastExpression& node)
+	{
+		RegisterValue(node.targetType);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(ConditionalExpression& node)
+	{
+		node.condition->Visit(*this);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(ConstantExpression& node)
+	{
+		if (m_currentUsage)
+			m_currentUsage->usedConstants.UnboundedSet(node.constantId);
+	}
+
+	void OptionUsageVisitor::Visit(FunctionExpression& node)
+	{
+		if (m_currentUsage)
+			m_currentUsage->usedFunctions.UnboundedSet(node.funcId);
+	}
+
+	void OptionUsageVisitor::Visit(IdentifierExpression& node)
+	{
+		if (m_currentUsage)
+			m_currentUsage->usedIdentifiers.push_back(node.identifier);
+	}
+
+	void OptionUsageVisitor::Visit(StructTypeExpression& node)
+	{
+		if (m_currentUsage)
+			m_currentUsage->usedStructs.UnboundedSet(node.structTypeId);
+	}
+
+	void OptionUsageVisitor::Visit(VariableValueExpression& node)
+	{
+		if (m_currentUsage)
+			m_currentUsage->usedVariables.UnboundedSet(node.variableId);
+	}
+
+	void OptionUsageVisitor::Visit(ConditionalStatement& node)
+	{
+		if (m_currentUsage)
+		{
+			// Inside a declaration, the condition is a regular dependency
+			node.condition->Visit(*this);
+			node.statement->Visit(*this);
+			return;
+		}
+
+		UsageSet& conditionUsage = m_conditionUsages.emplace_back();
+		NAZARA_DEFER({ m_conditionUsages.pop_back(); });
+
+		m_currentUsage = &conditionUsage;
+		node.condition->Visit(*this);
+		m_currentUsage = nullptr;
+
+		node.statement->Visit(*this);
+	}
+
+	void OptionUsageVisitor::Visit(DeclareAliasStatement& node)
+	{
+		std::size_t symbolIndex = RegisterSymbol(m_aliasSymbols, node.aliasIndex, node.name);
+
+		UsageSet* previousUsage = std::exchange(m_currentUsage, &m_symbols[symbolIndex].usage);
+		NAZARA_DEFER({ m_currentUsage = previousUsage; });
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(DeclareConstStatement& node)
+	{
+		std::size_t symbolIndex = RegisterSymbol(m_constantSymbols, node.constIndex, node.name);
+
+		UsageSet* previousUsage = std::exchange(m_currentUsage, &m_symbols[symbolIndex].usage);
+		NAZARA_DEFER({ m_currentUsage = previousUsage; });
+
+		RegisterValue(node.type);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(DeclareExternalStatement& node)
+	{
+		for (const auto& externalVar : node.externalVars)
+		{
+			std::size_t symbolIndex = RegisterSymbol(m_variableSymbols, externalVar.varIndex, externalVar.name);
+			if (!node.name.empty())
+				m_symbolsByName[node.name].push_back(symbolIndex); //< named external blocks are accessed through their name
+
+			UsageSet* previousUsage = std::exchange(m_currentUsage, &m_symbols[symbolIndex].usage);
+			NAZARA_DEFER({ m_currentUsage = previousUsage; });
+
+			RegisterValue(node.autoBinding);
+			RegisterValue(node.bindingSet);
+			RegisterValue(externalVar.bindingIndex);
+			RegisterValue(externalVar.bindingSet);
+			RegisterValue(externalVar.type);
+		}
+	}
+
+	void OptionUsageVisitor::Visit(DeclareFunctionStatement& node)
+	{
+		std::size_t symbolIndex = RegisterSymbol(m_functionSymbols, node.funcIndex, node.name);
+
+		UsageSet* previousUsage = std::exchange(m_currentUsage, &m_symbols[symbolIndex].usage);
+		NAZARA_DEFER({ m_currentUsage = previousUsage; });
+
+		for (const auto& parameter : node.parameters)
+			RegisterValue(parameter.type);
+
+		RegisterValue(node.depthWrite);
+		RegisterValue(node.earlyFragmentTests);
+		RegisterValue(node.entryStage);
+		RegisterValue(node.returnType);
+		RegisterValue(node.workgroupSize);
+
+		if (node.entryStage.HasValue())
+		{
+			auto& entryPoint = m_entryPoints.emplace_back();
+			entryPoint.functionName = node.name;
+			entryPoint.symbolIndex = symbolIndex;
+
+			if (node.entryStage.IsResultingValue())
+				entryPoint.stage = node.entryStage.GetResultingValue();
+		}
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(DeclareOptionStatement& node)
+	{
+		std::size_t symbolIndex = RegisterSymbol(m_constantSymbols, node.optIndex, node.optName);
+
+		Symbol& symbol = m_symbols[symbolIndex];
+		symbol.optionIndex = m_options.size();
+
+		auto& option = m_options.emplace_back();
+		option.name = node.optName;
+		option.hash = HashOption(node.optName.data());
+
+		UsageSet* previousUsage = std::exchange(m_currentUsage, &symbol.usage);
+		NAZARA_DEFER({ m_currentUsage = previousUsage; });
+
+		RegisterValue(node.optType);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(DeclareStructStatement& node)
+	{
+		std::size_t symbolIndex = RegisterSymbol(m_structSymbols, node.structIndex, node.description.name);
+
+		UsageSet* previousUsage = std::exchange(m_currentUsage, &m_symbols[symbolIndex].usage);
+		NAZARA_DEFER({ m_currentUsage = previousUsage; });
+
+		RegisterValue(node.description.layout);
+		for (const auto& member : node.description.members)
+		{
+			RegisterValue(member.builtin);
+			RegisterValue(member.cond);
+			RegisterValue(member.interp);
+			RegisterValue(member.locationIndex);
+			RegisterValue(member.precision);
+			RegisterValue(member.type);
+		}
+	}
+
+	void OptionUsageVisitor::Visit(DeclareVariableStatement& node)
+	{
+		RegisterValue(node.varType);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(ForStatement& node)
+	{
+		RegisterValue(node.unroll);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(ForEachStatement& node)
+	{
+		RegisterValue(node.unroll);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionUsageVisitor::Visit(WhileStatement& node)
+	{
+		RegisterValue(node.unroll);
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	std::vector<OptionHash> OptionUsageVisitor::Result::GetStageOptions(ShaderStageTypeFlags shaderStages) const
+	{
+		std::vector<OptionHash> stageOptions;
+		for (const EntryPoint& entryPoint : entryPoints)
+		{
+			// Entry points with an option-dependent stage have to be considered for every stage
+			if (entryPoint.stage && !(shaderStages & *entryPoint.stage))
+				continue;
+
+			for (OptionHash optionHash : entryPoint.options)
+			{
+				if (std::find(stageOptions.begin(), stageOptions.end(), optionHash) == stageOptions.end())
+					stageOptions.push_back(optionHash);
+			}
+		}
+
+		return stageOptions;
+	}
+
+	std::vector<std::size_t> PartitionOptionSets(const std::vector<OptionHash>& influencingOptions, const std::vector<std::unordered_map<OptionHash, ConstantValue>>& optionSets)
+	{
+		auto GetValue = [&](std::size_t optionSetIndex, OptionHash optionHash) -> const ConstantValue&
+		{
+			static const ConstantValue unsetValue;
+
+			const auto& optionSet = optionSets[optionSetIndex];
+			auto it = optionSet.find(optionHash);
+			return (it != optionSet.end()) ? it->second : unsetValue;
+		};
+
+		std::vector<std::size_t> representatives; //< first option set of each class
+		std::vector<std::size_t> classRepresentatives(optionSets.size());
+		for (std::size_t optionSetIndex = 0; optionSetIndex < optionSets.size(); ++optionSetIndex)
+		{
+			auto it = std::find_if(representatives.begin(), representatives.end(), [&](std::size_t representativeIndex)
+			{
+				return std::all_of(influencingOptions.begin(), influencingOptions.end(), [&](OptionHash optionHash)
+				{
+					return GetValue(optionSetIndex, optionHash) == GetValue(representativeIndex, optionHash);
+				});
+			});
+
+			if (it != representatives.end())
+				classRepresentatives[optionSetIndex] = *it;
+			else
+			{
+				representatives.push_back(optionSetIndex);
+				classRepresentatives[optionSetIndex] = optionSetIndex;
+			}
+		}
+
+		return classRepresentatives;
+	}
+}
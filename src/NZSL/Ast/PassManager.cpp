@@ -0,0 +1,154 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/PassManager.hpp>
+#include <NZSL/CompilationStats.hpp>
+#include <NZSL/Ast/ConstantPropagationVisitor.hpp>
+#include <NZSL/Ast/DeadStoreEliminationVisitor.hpp>
+#include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/LoopInvariantCodeMotionVisitor.hpp>
+#include <stdexcept>
+
+namespace nzsl::Ast
+{
+	namespace
+	{
+		constexpr std::size_t s_fixedPointMaxIterations = 8;
+	}
+
+	void PassManager::AddPass(std::string name, Pass pass)
+	{
+		auto& passData = m_passes.emplace_back();
+		passData.name = std::move(name);
+		passData.pass = std::move(pass);
+	}
+
+	auto PassManager::Run(Module& shaderModule, CompilationStats* compilationStats) const -> Result
+	{
+		Result result;
+		result.fixedPointReached = false;
+		result.iterationCount = 0;
+
+		result.passes.resize(m_passes.size());
+		for (std::size_t i = 0; i < m_passes.size(); ++i)
+		{
+			PassStatistics& passStats = result.passes[i];
+			passStats.name = m_passes[i].name;
+			passStats.changeCount = 0;
+			passStats.duration = std::chrono::microseconds::zero();
+			passStats.runCount = 0;
+		}
+
+		while (result.iterationCount < m_maxIterations)
+		{
+			result.iterationCount++;
+
+			std::size_t changeCount = 0;
+			for (std::size_t i = 0; i < m_passes.size(); ++i)
+			{
+				const PassData& passData = m_passes[i];
+				PassStatistics& passStats = result.passes[i];
+
+				CompilationStats::Scope passScope(compilationStats, "optimize", passData.name);
+
+				auto start = std::chrono::steady_clock::now();
+				std::size_t passChangeCount = passData.pass(shaderModule);
+				passStats.duration += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+				passStats.changeCount += passChangeCount;
+				passStats.runCount++;
+
+				passScope.SetNodeCount(shaderModule);
+
+				changeCount += passChangeCount;
+			}
+
+			if (changeCount == 0)
+			{
+				result.fixedPointReached = true;
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	PassManager PassManager::BuildPreset(OptimizationLevel optimizationLevel, const DependencyCheckerVisitor::Config& dependencyConfig, const AlgebraicSimplificationVisitor::Options& simplificationOptions)
+	{
+		PassManager passManager;
+
+		switch (optimizationLevel)
+		{
+			case OptimizationLevel::None:
+				break;
+
+			case OptimizationLevel::Basic:
+			case OptimizationLevel::Full:
+			case OptimizationLevel::Size:
+			{
+				passManager.AddPass("Constant propagation", &ConstantPropagationPass);
+
+				if (optimizationLevel != OptimizationLevel::Basic)
+				{
+					AlgebraicSimplificationVisitor::Options presetSimplificationOptions = simplificationOptions;
+					if (optimizationLevel == OptimizationLevel::Size)
+						presetSimplificationOptions.optimizeForSize = true;
+
+					// simplified expressions often expose new constants (x * 1.0 * 2.0), hence the fixed point iteration
+					passManager.AddPass("Algebraic simplification", [presetSimplificationOptions](Module& shaderModule)
+					{
+						return AlgebraicSimplificationPass(shaderModule, presetSimplificationOptions);
+					});
+
+					// hoisting declares a new variable per invariant expression, which trades code size for speed
+					if (optimizationLevel != OptimizationLevel::Size)
+						passManager.AddPass("Loop-invariant code motion", &LoopInvariantCodeMotionPass);
+
+					passManager.AddPass("Eliminate dead stores", &DeadStoreEliminationPass);
+				}
+
+				passManager.AddPass("Eliminate unused code", [dependencyConfig](Module& shaderModule)
+				{
+					return EliminateUnusedCodePass(shaderModule, dependencyConfig);
+				});
+
+				if (optimizationLevel != OptimizationLevel::Basic)
+					passManager.SetMaxIterations(s_fixedPointMaxIterations);
+
+				break;
+			}
+
+			default:
+				throw std::runtime_error("unexpected optimization level");
+		}
+
+		return passManager;
+	}
+
+	std::size_t PassManager::AlgebraicSimplificationPass(Module& shaderModule, const AlgebraicSimplificationVisitor::Options& simplificationOptions)
+	{
+		// some rewrites keep the node count unchanged (x / 2.0 => x * 0.5), count them directly
+		return SimplifyAlgebraInPlace(shaderModule, simplificationOptions);
+	}
+
+	std::size_t PassManager::ConstantPropagationPass(Module& shaderModule)
+	{
+		return PropagateConstantsInPlace(shaderModule);
+	}
+
+	std::size_t PassManager::DeadStoreEliminationPass(Module& shaderModule)
+	{
+		return EliminateDeadStoresInPlace(shaderModule);
+	}
+
+	std::size_t PassManager::EliminateUnusedCodePass(Module& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig)
+	{
+		return EliminateUnusedPassInPlace(shaderModule, dependencyConfig);
+	}
+
+	std::size_t PassManager::LoopInvariantCodeMotionPass(Module& shaderModule)
+	{
+		return HoistLoopInvariantsInPlace(shaderModule);
+	}
+}
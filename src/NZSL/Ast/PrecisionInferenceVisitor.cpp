@@ -0,0 +1,525 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/PrecisionInferenceVisitor.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace nzsl::Ast
+{
+	enum class PrecisionInferenceVisitor::Precision
+	{
+		Neutral, //< constants, has no precision on its own
+		Medium,
+		High
+	};
+
+	namespace
+	{
+		// GLSL ES guarantees at least [-2^14, 2^14] for mediump floats
+		constexpr double s_mediumPrecisionRange = 16384.0;
+
+		template<typename T>
+		bool IsInMediumRange(const T& value)
+		{
+			if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+				return std::abs(static_cast<double>(value)) <= s_mediumPrecisionRange;
+			else
+				return false;
+		}
+
+		template<typename T, std::size_t N>
+		bool IsInMediumRange(const Vector<T, N>& value)
+		{
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				if (!IsInMediumRange(value[i]))
+					return false;
+			}
+
+			return true;
+		}
+
+		template<typename T>
+		void UpdateMagnitudeRange(const T& value, double& minMagnitude, double& maxMagnitude)
+		{
+			if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+			{
+				double magnitude = std::abs(static_cast<double>(value));
+				minMagnitude = std::min(minMagnitude, magnitude);
+				maxMagnitude = std::max(maxMagnitude, magnitude);
+			}
+		}
+
+		template<typename T, std::size_t N>
+		void UpdateMagnitudeRange(const Vector<T, N>& value, double& minMagnitude, double& maxMagnitude)
+		{
+			for (std::size_t i = 0; i < N; ++i)
+				UpdateMagnitudeRange(value[i], minMagnitude, maxMagnitude);
+		}
+
+		// returns false if the expression isn't a numeric constant
+		bool GetConstantMagnitudeRange(const Expression& expression, double& minMagnitude, double& maxMagnitude)
+		{
+			if (expression.GetType() != NodeType::ConstantValueExpression)
+				return false;
+
+			minMagnitude = std::numeric_limits<double>::infinity();
+			maxMagnitude = 0.0;
+			std::visit([&](auto&& arg) { UpdateMagnitudeRange(arg, minMagnitude, maxMagnitude); }, static_cast<const ConstantValueExpression&>(expression).value);
+
+			return minMagnitude <= maxMagnitude;
+		}
+
+		// multiplying by a constant greater than one (or dividing by a constant smaller than one) may push a medium precision value out of its range
+		bool IsGrowingFactor(const Expression& expression)
+		{
+			double minMagnitude, maxMagnitude;
+			return GetConstantMagnitudeRange(expression, minMagnitude, maxMagnitude) && maxMagnitude > 1.0;
+		}
+
+		bool IsGrowingDivisor(const Expression& expression)
+		{
+			double minMagnitude, maxMagnitude;
+			return GetConstantMagnitudeRange(expression, minMagnitude, maxMagnitude) && minMagnitude < 1.0;
+		}
+
+		class VariableCollector : public RecursiveVisitor
+		{
+			public:
+				VariableCollector(Nz::Bitset<>& variables) :
+				m_variables(variables)
+				{
+				}
+
+				using RecursiveVisitor::Visit;
+
+				void Visit(VariableValueExpression& node) override
+				{
+					m_variables.UnboundedSet(node.variableId);
+				}
+
+			private:
+				Nz::Bitset<>& m_variables;
+		};
+
+		bool IsRelaxableType(const ExpressionType& exprType)
+		{
+			const ExpressionType& resolvedType = ResolveAlias(exprType);
+			if (IsPrimitiveType(resolvedType))
+				return std::get<PrimitiveType>(resolvedType) == PrimitiveType::Float32;
+			else if (IsVectorType(resolvedType))
+				return std::get<VectorType>(resolvedType).type == PrimitiveType::Float32;
+
+			return false;
+		}
+	}
+
+	Nz::Bitset<> PrecisionInferenceVisitor::Process(const Module& shaderModule)
+	{
+		// variable and struct indices are shared with imported modules
+		for (const auto& importedModule : shaderModule.importedModules)
+			importedModule.module->rootNode->Visit(*this);
+
+		shaderModule.rootNode->Visit(*this);
+
+		return Resolve();
+	}
+
+	Nz::Bitset<> PrecisionInferenceVisitor::Process(Statement& statement)
+	{
+		statement.Visit(*this);
+
+		return Resolve();
+	}
+
+	auto PrecisionInferenceVisitor::Classify(const Expression& expression, std::size_t varIndex, const Nz::Bitset<>& relaxedVariables) const -> Precision
+	{
+		auto CombineAll = [&](auto begin, auto end)
+		{
+			Precision precision = Precision::Neutral;
+			for (auto it = begin; it != end; ++it)
+				precision = std::max(precision, Classify(**it, varIndex, relaxedVariables));
+
+			return precision;
+		};
+
+		switch (expression.GetType())
+		{
+			case NodeType::ConstantValueExpression:
+			{
+				const auto& constant = static_cast<const ConstantValueExpression&>(expression);
+				bool inRange = std::visit([](auto&& arg) { return IsInMediumRange(arg); }, constant.value);
+
+				return (inRange) ? Precision::Neutral : Precision::High;
+			}
+
+			case NodeType::VariableValueExpression:
+			{
+				std::size_t variableId = static_cast<const VariableValueExpression&>(expression).variableId;
+				if (variableId == varIndex)
+					return Precision::Neutral; //< reading itself doesn't change the variable precision (accumulation in loops is handled when registering stores)
+
+				return (relaxedVariables.UnboundedTest(variableId)) ? Precision::Medium : Precision::High;
+			}
+
+			case NodeType::AccessIdentifierExpression:
+			{
+				const auto& accessIdentifier = static_cast<const AccessIdentifierExpression&>(expression);
+
+				const ExpressionType* baseType = GetExpressionType(*accessIdentifier.expr);
+				if (!baseType || accessIdentifier.identifiers.size() != 1)
+					return Precision::High;
+
+				const StructDescription::StructMember* member = FindMember(*baseType, accessIdentifier.identifiers.front().identifier);
+				if (member && member->precision.IsResultingValue() && member->precision.GetResultingValue() == PrecisionQualifier::Medium)
+					return Precision::Medium;
+
+				return Precision::High;
+			}
+
+			case NodeType::AccessIndexExpression:
+			{
+				const auto& accessIndex = static_cast<const AccessIndexExpression&>(expression);
+
+				const ExpressionType* baseType = GetExpressionType(*accessIndex.expr);
+				if (!baseType || accessIndex.indices.size() != 1)
+					return Precision::High;
+
+				if (IsStructAddressible(ResolveAlias(*baseType)))
+				{
+					const Expression& indexExpr = *accessIndex.indices.front();
+					if (indexExpr.GetType() != NodeType::ConstantValueExpression)
+						return Precision::High;
+
+					const auto& indexValue = static_cast<const ConstantValueExpression&>(indexExpr).value;
+					if (!std::holds_alternative<std::int32_t>(indexValue))
+						return Precision::High;
+
+					const StructDescription::StructMember* member = FindMember(*baseType, std::get<std::int32_t>(indexValue));
+					if (member && member->precision.IsResultingValue() && member->precision.GetResultingValue() == PrecisionQualifier::Medium)
+						return Precision::Medium;
+
+					return Precision::High;
+				}
+
+				// elements of arrays and vectors share the precision of their container
+				return Classify(*accessIndex.expr, varIndex, relaxedVariables);
+			}
+
+			case NodeType::BinaryExpression:
+			{
+				const auto& binary = static_cast<const BinaryExpression&>(expression);
+				switch (binary.op)
+				{
+					case BinaryType::Multiply:
+					{
+						if (IsGrowingFactor(*binary.left) || IsGrowingFactor(*binary.right))
+							return Precision::High;
+
+						break;
+					}
+
+					case BinaryType::Divide:
+					{
+						if (IsGrowingDivisor(*binary.right))
+							return Precision::High;
+
+						break;
+					}
+
+					case BinaryType::Add:
+					case BinaryType::Subtract:
+						break;
+
+					default:
+						return Precision::High;
+				}
+
+				return std::max(Classify(*binary.left, varIndex, relaxedVariables), Classify(*binary.right, varIndex, relaxedVariables));
+			}
+
+			case NodeType::CastExpression:
+			{
+				const auto& cast = static_cast<const CastExpression&>(expression);
+				return CombineAll(cast.expressions.begin(), cast.expressions.end());
+			}
+
+			case NodeType::IntrinsicExpression:
+			{
+				const auto& intrinsic = static_cast<const IntrinsicExpression&>(expression);
+				switch (intrinsic.intrinsic)
+				{
+					// sources of medium precision values
+					case IntrinsicType::Normalize:
+					case IntrinsicType::TextureRead:
+					case IntrinsicType::TextureSampleImplicitLod:
+					case IntrinsicType::TextureSampleImplicitLodDepthComp:
+					{
+						const ExpressionType* exprType = GetExpressionType(intrinsic);
+						return (exprType && IsRelaxableType(*exprType)) ? Precision::Medium : Precision::High;
+					}
+
+					case IntrinsicType::Select:
+					{
+						// the condition doesn't carry any precision
+						assert(intrinsic.parameters.size() == 3);
+						return CombineAll(intrinsic.parameters.begin() + 1, intrinsic.parameters.end());
+					}
+
+					case IntrinsicType::Abs:
+					case IntrinsicType::Ceil:
+					case IntrinsicType::Clamp:
+					case IntrinsicType::CrossProduct:
+					case IntrinsicType::Distance:
+					case IntrinsicType::DotProduct:
+					case IntrinsicType::Floor:
+					case IntrinsicType::Fract:
+					case IntrinsicType::Length:
+					case IntrinsicType::Lerp:
+					case IntrinsicType::Max:
+					case IntrinsicType::Min:
+					case IntrinsicType::Pow:
+					case IntrinsicType::Reflect:
+					case IntrinsicType::Round:
+					case IntrinsicType::RoundEven:
+					case IntrinsicType::Sign:
+					case IntrinsicType::Sqrt:
+					case IntrinsicType::Trunc:
+						return CombineAll(intrinsic.parameters.begin(), intrinsic.parameters.end());
+
+					default:
+						return Precision::High;
+				}
+			}
+
+			case NodeType::SwizzleExpression:
+				return Classify(*static_cast<const SwizzleExpression&>(expression).expression, varIndex, relaxedVariables);
+
+			case NodeType::UnaryExpression:
+			{
+				const auto& unary = static_cast<const UnaryExpression&>(expression);
+				if (unary.op != UnaryType::Minus && unary.op != UnaryType::Plus)
+					return Precision::High;
+
+				return Classify(*unary.expression, varIndex, relaxedVariables);
+			}
+
+			default:
+				return Precision::High;
+		}
+	}
+
+	const StructDescription::StructMember* PrecisionInferenceVisitor::FindMember(const ExpressionType& structType, const std::string& memberName) const
+	{
+		std::size_t structIndex = ResolveStructIndex(ResolveAlias(structType));
+		if (structIndex >= m_structs.size() || !m_structs[structIndex])
+			return nullptr;
+
+		for (const auto& member : m_structs[structIndex]->members)
+		{
+			if (member.name == memberName)
+				return &member;
+		}
+
+		return nullptr;
+	}
+
+	const StructDescription::StructMember* PrecisionInferenceVisitor::FindMember(const ExpressionType& structType, std::int32_t memberIndex) const
+	{
+		std::size_t structIndex = ResolveStructIndex(ResolveAlias(structType));
+		if (structIndex >= m_structs.size() || !m_structs[structIndex])
+			return nullptr;
+
+		// disabled members are not counted
+		for (const auto& member : m_structs[structIndex]->members)
+		{
+			if (member.cond.HasValue() && !member.cond.GetResultingValue())
+				continue;
+
+			if (memberIndex-- == 0)
+				return &member;
+		}
+
+		return nullptr;
+	}
+
+	Nz::Bitset<> PrecisionInferenceVisitor::Resolve()
+	{
+		// a variable is relaxed once all the values it holds have medium precision, starting from the sources and growing until nothing changes
+		Nz::Bitset<> relaxedVariables;
+
+		bool hasChanged;
+		do
+		{
+			hasChanged = false;
+			for (std::size_t varIndex : m_candidates)
+			{
+				if (relaxedVariables.UnboundedTest(varIndex) || m_highPrecisionVariables.UnboundedTest(varIndex))
+					continue;
+
+				Precision precision = Precision::Neutral;
+				for (const CandidateStore& store : m_candidateStores[varIndex])
+				{
+					Precision valuePrecision;
+					if (store.accumulatesInLoop)
+						valuePrecision = Precision::High; //< the number of iterations is unknown, so is the accumulated value range
+					else if (store.op == AssignType::CompoundMultiply && IsGrowingFactor(*store.value))
+						valuePrecision = Precision::High;
+					else if (store.op == AssignType::CompoundDivide && IsGrowingDivisor(*store.value))
+						valuePrecision = Precision::High;
+					else
+						valuePrecision = Classify(*store.value, varIndex, relaxedVariables);
+
+					if (valuePrecision == Precision::High)
+					{
+						precision = Precision::High;
+						break;
+					}
+
+					if (valuePrecision == Precision::Medium)
+						precision = Precision::Medium;
+				}
+
+				// variables only holding constants keep their full precision
+				if (precision == Precision::Medium)
+				{
+					relaxedVariables.UnboundedSet(varIndex);
+					hasChanged = true;
+				}
+			}
+		}
+		while (hasChanged);
+
+		return relaxedVariables;
+	}
+
+	void PrecisionInferenceVisitor::Visit(AssignExpression& node)
+	{
+		RecursiveVisitor::Visit(node);
+
+		// x = ..., x.y = ..., x.xy = ...
+		Expression* target = node.left.get();
+		for (;;)
+		{
+			if (target->GetType() == NodeType::SwizzleExpression)
+				target = static_cast<SwizzleExpression&>(*target).expression.get();
+			else if (target->GetType() == NodeType::AccessIndexExpression)
+				target = static_cast<AccessIndexExpression&>(*target).expr.get();
+			else
+				break;
+		}
+
+		if (target->GetType() != NodeType::VariableValueExpression)
+			return;
+
+		std::size_t variableId = static_cast<VariableValueExpression&>(*target).variableId;
+
+		auto it = m_candidateStores.find(variableId);
+		if (it == m_candidateStores.end())
+			return;
+
+		// compound assignments (x += ...) and stores reading the variable (x = x + ...) accumulate into it
+		bool accumulatesInLoop = false;
+		if (m_inLoop)
+		{
+			if (node.op != AssignType::Simple)
+				accumulatesInLoop = true;
+			else
+			{
+				Nz::Bitset<> readVariables;
+				VariableCollector collector(readVariables);
+				node.right->Visit(collector);
+
+				accumulatesInLoop = readVariables.UnboundedTest(variableId);
+			}
+		}
+
+		it->second.push_back({ node.right.get(), node.op, accumulatesInLoop });
+	}
+
+	void PrecisionInferenceVisitor::Visit(IntrinsicExpression& node)
+	{
+		RecursiveVisitor::Visit(node);
+
+		switch (node.intrinsic)
+		{
+			case IntrinsicType::TextureRead:
+			case IntrinsicType::TextureSampleImplicitLod:
+			case IntrinsicType::TextureSampleImplicitLodDepthComp:
+			case IntrinsicType::TextureWrite:
+			{
+				// texture coordinates require high precision to address texels of large textures
+				if (node.parameters.size() < 2)
+					break;
+
+				VariableCollector collector(m_highPrecisionVariables);
+				node.parameters[1]->Visit(collector);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	void PrecisionInferenceVisitor::Visit(DeclareStructStatement& node)
+	{
+		RecursiveVisitor::Visit(node);
+
+		assert(node.structIndex);
+		std::size_t structIndex = *node.structIndex;
+		if (structIndex >= m_structs.size())
+			m_structs.resize(structIndex + 1, nullptr);
+
+		m_structs[structIndex] = &node.description;
+	}
+
+	void PrecisionInferenceVisitor::Visit(DeclareVariableStatement& node)
+	{
+		RecursiveVisitor::Visit(node);
+
+		assert(node.varIndex);
+		if (!node.varType.IsResultingValue() || !IsRelaxableType(node.varType.GetResultingValue()))
+			return;
+
+		std::size_t varIndex = *node.varIndex;
+		m_candidates.push_back(varIndex);
+
+		auto& stores = m_candidateStores[varIndex];
+		if (node.initialExpression)
+			stores.push_back({ node.initialExpression.get(), AssignType::Simple, false });
+	}
+
+	void PrecisionInferenceVisitor::Visit(ForStatement& node)
+	{
+		bool wasInLoop = m_inLoop;
+		m_inLoop = true;
+		NAZARA_DEFER({ m_inLoop = wasInLoop; });
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void PrecisionInferenceVisitor::Visit(ForEachStatement& node)
+	{
+		bool wasInLoop = m_inLoop;
+		m_inLoop = true;
+		NAZARA_DEFER({ m_inLoop = wasInLoop; });
+
+		RecursiveVisitor::Visit(node);
+	}
+
+	void PrecisionInferenceVisitor::Visit(WhileStatement& node)
+	{
+		bool wasInLoop = m_inLoop;
+		m_inLoop = true;
+		NAZARA_DEFER({ m_inLoop = wasInLoop; });
+
+		RecursiveVisitor::Visit(node);
+	}
+}
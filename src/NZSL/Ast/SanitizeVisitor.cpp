@@ -7,6 +7,7 @@
 #include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/StackArray.hpp>
 #include <NazaraUtils/StackVector.hpp>
+#include <NZSL/ParallelFor.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Ast/ConstantPropagationVisitor.hpp>
 #include <NZSL/Ast/DependencyCheckerVisitor.hpp>
@@ -14,14 +15,19 @@
 #include <NZSL/Ast/ExportVisitor.hpp>
 #include <NZSL/Ast/ExpressionType.hpp>
 #include <NZSL/Ast/IndexRemapperVisitor.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <NZSL/Ast/ReflectVisitor.hpp>
+#include <NZSL/Ast/SymbolDependencies.hpp>
 #include <NZSL/Ast/Utils.hpp>
 #include <NZSL/Lang/Errors.hpp>
 #include <NZSL/Lang/LangData.hpp>
 #include <fmt/format.h>
 #include <frozen/unordered_map.h>
+#include <algorithm>
+#include <exception>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -44,6 +50,49 @@ namespace nzsl::Ast
 
 			using type = T;
 		};
+
+		struct ImportCollectorVisitor : RecursiveVisitor
+		{
+			using RecursiveVisitor::Visit;
+
+			void Visit(ImportStatement& node) override
+			{
+				importStatements.push_back(&node);
+			}
+
+			std::vector<ImportStatement*> importStatements;
+		};
+
+		unsigned int GetThreadCount(const SanitizeVisitor::Options& options)
+		{
+			return (options.moduleResolverThreadCount > 0) ? options.moduleResolverThreadCount : std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		MultiStatementPtr FilterRequestedSymbols(MultiStatement& rootNode, const std::unordered_set<std::string>& requestedSymbols)
+		{
+			// Statements are kept if they declare a requested symbol or one of its dependencies
+			std::vector<SymbolDeclaration> declarations;
+			declarations.reserve(rootNode.statements.size());
+			for (const StatementPtr& statement : rootNode.statements)
+				declarations.push_back((statement) ? GetSymbolDeclaration(*statement) : SymbolDeclaration{});
+
+			Nz::Bitset<> keptStatements = ResolveRequiredStatements(declarations, requestedSymbols, [&](std::size_t statementIndex)
+			{
+				return rootNode.statements[statementIndex].get();
+			});
+
+			Cloner cloner;
+
+			MultiStatementPtr filteredRoot = std::make_unique<MultiStatement>();
+			filteredRoot->sourceLocation = rootNode.sourceLocation;
+			for (std::size_t statementIndex = keptStatements.FindFirst(); statementIndex != keptStatements.npos; statementIndex = keptStatements.FindNext(statementIndex))
+			{
+				if (const StatementPtr& statement = rootNode.statements[statementIndex])
+					filteredRoot->statements.push_back(cloner.Clone(*statement));
+			}
+
+			return filteredRoot;
+		}
 	}
 
 	template<typename T>
@@ -198,9 +247,21 @@ namespace nzsl::Ast
 		std::vector<NamedExternalBlockData> namedExternalBlocks;
 		std::vector<StatementPtr>* currentStatementList = nullptr;
 		std::unordered_map<std::string, std::size_t> moduleByName;
+		struct ImportRequest
+		{
+			std::unordered_set<std::string> identifiers;
+			bool importEverything = false;
+		};
+
+		std::unordered_map<std::string, ImportRequest> importRequests;
+		std::unordered_map<std::string, ModulePtr> prefetchedModules;
+		std::unordered_map<std::string, ModulePtr> presanitizedModules;
+		std::unordered_map<std::string, std::exception_ptr> prefetchErrors;
 		std::unordered_map<std::uint64_t, UsedExternalData> usedBindingIndexes;
 		std::unordered_map<std::string, UsedExternalData> declaredExternalVar;
 		std::unordered_map<OptionHash, std::string> declaredOptions;
+		std::unordered_map<std::size_t /*constIndex*/, OptionHash> specializationConstants;
+		std::unordered_set<OptionHash> bakedSpecializationConstants;
 		std::shared_ptr<Environment> globalEnv;
 		std::shared_ptr<Environment> currentEnv;
 		std::shared_ptr<Environment> moduleEnv;
@@ -212,7 +273,7 @@ namespace nzsl::Ast
 		IdentifierList<std::size_t> namedExternalBlockIndices;
 		IdentifierList<StructDescription*> structs;
 		IdentifierList<std::variant<ExpressionType, NamedPartialType>> types;
-		IdentifierList<ExpressionType> variableTypes;
+		IdentifierList<ExpressionTypeHandle> variableTypes;
 		ModulePtr currentModule;
 		Options options;
 		FunctionData* currentFunction = nullptr;
@@ -233,7 +294,18 @@ namespace nzsl::Ast
 		m_context = &currentContext;
 		NAZARA_DEFER({ m_context = nullptr; });
 
-		PreregisterIndices(module);
+		CompilationStats::Scope sanitizeScope(options.compilationStats, "sanitize", (options.partialSanitization) ? "Partial sanitization" : "Sanitization");
+
+		{
+			CompilationStats::Scope preregisterScope(options.compilationStats, "sanitize", "Preregister indices");
+			PreregisterIndices(module);
+		}
+
+		if (m_context->options.moduleResolver)
+		{
+			CompilationStats::Scope prefetchScope(options.compilationStats, "import", "Prefetch imported modules");
+			PrefetchImportedModules(module);
+		}
 
 		// Register global env
 		m_context->globalEnv = std::make_shared<Environment>();
@@ -263,9 +335,15 @@ namespace nzsl::Ast
 
 			m_context->currentEnv = importedModuleEnv;
 
-			cloneImportedModule.module->rootNode = SanitizeInternal(*importedModule.module->rootNode, error);
-			if (!cloneImportedModule.module->rootNode)
-				return {};
+			{
+				CompilationStats::Scope importScope(options.compilationStats, "import", "Sanitize imported module " + cloneImportedModule.module->metadata->moduleName);
+
+				cloneImportedModule.module->rootNode = SanitizeInternal(*importedModule.module->rootNode, error);
+				if (!cloneImportedModule.module->rootNode)
+					return {};
+
+				importScope.SetNodeCount(*cloneImportedModule.module);
+			}
 
 			m_context->moduleByName[cloneImportedModule.module->metadata->moduleName] = moduleId;
 			auto& moduleData = m_context->modules.emplace_back();
@@ -281,7 +359,17 @@ namespace nzsl::Ast
 		if (!clone->rootNode)
 			return {};
 
+		if (!m_context->bakedSpecializationConstants.empty())
+		{
+			// Some options were required at compilation time and cannot be specialization constants, start over with these options resolved
+			Options bakedOptions = options;
+			bakedOptions.bakedOptions.insert(m_context->bakedSpecializationConstants.begin(), m_context->bakedSpecializationConstants.end());
+
+			return Sanitize(module, bakedOptions, error);
+		}
+
 		// Remove unused statements of imported modules
+		CompilationStats::Scope eliminateScope(options.compilationStats, "sanitize", "Eliminate unused imported code");
 		for (std::size_t moduleId = 0; moduleId < clone->importedModules.size(); ++moduleId)
 		{
 			auto& moduleData = m_context->modules[moduleId];
@@ -295,6 +383,13 @@ namespace nzsl::Ast
 			}
 		}
 
+		if (sanitizeScope.IsEnabled())
+		{
+			std::size_t nodeCount = CompilationStats::CountNodes(*clone);
+			eliminateScope.SetNodeCount(nodeCount);
+			sanitizeScope.SetNodeCount(nodeCount);
+		}
+
 		return clone;
 	}
 	
@@ -646,7 +741,7 @@ namespace nzsl::Ast
 		AliasType aliasType;
 		aliasType.aliasIndex = node.aliasId;
 		aliasType.targetType = std::make_unique<ContainedType>();
-		aliasType.targetType->type = *targetExpr->cachedExpressionType;
+		aliasType.targetType->type = targetExpr->cachedExpressionType->Get();
 
 		auto clone = Nz::StaticUniquePointerCast<AliasValueExpression>(Cloner::Clone(node));
 		clone->cachedExpressionType = std::move(aliasType);
@@ -1120,6 +1215,15 @@ namespace nzsl::Ast
 			return Cloner::Clone(node); //< unresolved
 		}
 
+		// Specialization constants are only resolved when computing constant values
+		if (m_context->specializationConstants.find(node.constantId) != m_context->specializationConstants.end())
+		{
+			auto constantExpr = Cloner::Clone(node);
+			constantExpr->cachedExpressionType = GetConstantType(*value);
+
+			return constantExpr;
+		}
+
 		// Replace by constant value if required
 		return std::visit([&](auto&& arg) -> ExpressionPtr
 		{
@@ -1847,6 +1951,41 @@ NAZARA_WARNING_POP()
 			}
 		}
 
+		if (m_context->options.optionsAsSpecializationConstants && !m_context->options.partialSanitization && m_context->options.bakedOptions.find(optionHash) == m_context->options.bakedOptions.end())
+		{
+			const ExpressionType& optionType = ResolveAlias(clone->optType.GetResultingValue());
+			if (IsPrimitiveType(optionType))
+			{
+				switch (std::get<PrimitiveType>(optionType))
+				{
+					case PrimitiveType::Boolean:
+					case PrimitiveType::Float32:
+					case PrimitiveType::Int32:
+					case PrimitiveType::UInt32:
+					{
+						// Keep declaration with its final value as default value
+						const ConstantValue& optionValue = m_context->constantValues.Retrieve(*clone->optIndex, node.sourceLocation);
+						clone->defaultValue = std::visit([&](auto&& arg) -> ExpressionPtr
+						{
+							using T = std::decay_t<decltype(arg)>;
+
+							if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, float> || std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t>)
+								return ShaderBuilder::ConstantValue(arg, node.sourceLocation);
+							else
+								throw std::runtime_error("unexpected option value type");
+						}, optionValue);
+
+						m_context->specializationConstants.emplace(*clone->optIndex, optionHash);
+						return clone;
+					}
+
+					case PrimitiveType::Float64:
+					case PrimitiveType::String:
+						break;
+				}
+			}
+		}
+
 		if (m_context->options.removeOptionDeclaration)
 			return ShaderBuilder::NoOp();
 
@@ -1886,6 +2025,9 @@ NAZARA_WARNING_POP()
 			if (member.locationIndex.HasValue())
 				ComputeExprValue(member.locationIndex, member.sourceLocation);
 
+			if (member.precision.HasValue())
+				ComputeExprValue(member.precision, member.sourceLocation);
+
 			if (member.builtin.HasValue() && member.locationIndex.HasValue())
 				throw CompilerStructFieldBuiltinLocationError{ member.sourceLocation };
 
@@ -1973,6 +2115,24 @@ NAZARA_WARNING_POP()
 						throw CompilerBuiltinUnexpectedTypeError{ member.sourceLocation, builtin, ToString(arg, member.sourceLocation), ToString(memberType, member.sourceLocation) };
 				}, builtinData.type);
 			}
+
+			if (member.precision.HasValue())
+			{
+				const ExpressionType* baseType = &ResolveAlias(memberType);
+				while (IsArrayType(*baseType))
+					baseType = &ResolveAlias(std::get<ArrayType>(*baseType).containedType->type);
+
+				PrimitiveType primitiveType = PrimitiveType::Boolean;
+				if (IsPrimitiveType(*baseType))
+					primitiveType = std::get<PrimitiveType>(*baseType);
+				else if (IsVectorType(*baseType))
+					primitiveType = std::get<VectorType>(*baseType).type;
+				else if (IsMatrixType(*baseType))
+					primitiveType = std::get<MatrixType>(*baseType).type;
+
+				if (primitiveType != PrimitiveType::Float32)
+					throw CompilerStructFieldPrecisionTypeError{ member.sourceLocation, ToString(memberType, member.sourceLocation) };
+			}
 		}
 
 		clone->description.conditionIndex = m_context->currentConditionalIndex;
@@ -2539,7 +2699,21 @@ NAZARA_WARNING_POP()
 			return Nz::StaticUniquePointerCast<ImportStatement>(Cloner::Clone(node));
 		}
 
-		ModulePtr targetModule = m_context->options.moduleResolver->Resolve(node.moduleName);
+		CompilationStats::Scope importScope(m_context->options.compilationStats, "import", "Import " + node.moduleName);
+
+		// Resolution errors caught while prefetching are reported here so they come in the same order as without prefetching
+		if (auto errorIt = m_context->prefetchErrors.find(node.moduleName); errorIt != m_context->prefetchErrors.end())
+			std::rethrow_exception(errorIt->second);
+
+		ModulePtr targetModule;
+		if (auto prefetchIt = m_context->prefetchedModules.find(node.moduleName); prefetchIt != m_context->prefetchedModules.end())
+			targetModule = prefetchIt->second;
+		else
+		{
+			CompilationStats::Scope resolveScope(m_context->options.compilationStats, "import", "Resolve module " + node.moduleName);
+			targetModule = m_context->options.moduleResolver->Resolve(node.moduleName);
+		}
+
 		if (!targetModule)
 			throw CompilerModuleNotFoundError{ node.sourceLocation, node.moduleName };
 
@@ -2586,13 +2760,35 @@ NAZARA_WARNING_POP()
 			indexCallbacks.structIndexGenerator = [this](std::size_t /*previousIndex*/) { return m_context->structs.RegisterNewIndex(true); };
 			indexCallbacks.varIndexGenerator    = [this](std::size_t /*previousIndex*/) { return m_context->variableTypes.RegisterNewIndex(true); };
 
-			sanitizedModule->rootNode = Nz::StaticUniquePointerCast<MultiStatement>(RemapIndices(*targetModule->rootNode, indexCallbacks));
+			// Only keep requested symbols (and their dependencies) if asked to, since all import statements are known at this point
+			MultiStatement* moduleRootNode = targetModule->rootNode.get();
+
+			// Use the module sanitized ahead if any (requested symbols were already filtered), its indices are remapped to this context in import order
+			auto presanitizedIt = m_context->presanitizedModules.find(node.moduleName);
+			bool isPresanitized = (presanitizedIt != m_context->presanitizedModules.end());
+			if (isPresanitized)
+				moduleRootNode = presanitizedIt->second->rootNode.get();
+
+			MultiStatementPtr filteredRootNode;
+			if (m_context->options.importOnlyRequestedSymbols && !m_context->options.partialSanitization && !isPresanitized)
+			{
+				auto requestIt = m_context->importRequests.find(node.moduleName);
+				if (requestIt != m_context->importRequests.end() && !requestIt->second.importEverything)
+				{
+					filteredRootNode = FilterRequestedSymbols(*moduleRootNode, requestIt->second.identifiers);
+					moduleRootNode = filteredRootNode.get();
+				}
+			}
+
+			sanitizedModule->rootNode = Nz::StaticUniquePointerCast<MultiStatement>(RemapIndices(*moduleRootNode, indexCallbacks));
 
 			std::string error;
 			sanitizedModule->rootNode = SanitizeInternal(*sanitizedModule->rootNode, &error);
 			if (!sanitizedModule->rootNode)
 				throw CompilerModuleCompilationFailedError{ node.sourceLocation, node.moduleName, error };
 
+			importScope.SetNodeCount(*sanitizedModule);
+
 			moduleIndex = m_context->modules.size();
 
 			assert(m_context->modules.size() == moduleIndex);
@@ -3054,8 +3250,23 @@ NAZARA_WARNING_POP()
 
 	std::optional<ConstantValue> SanitizeVisitor::ComputeConstantValue(Expression& expr) const
 	{
+		ConstantPropagationVisitor::Options optimizerOptions;
+		optimizerOptions.constantQueryCallback = [&](std::size_t constantId) -> const ConstantValue*
+		{
+			// This option value is required at compilation time, it cannot be a specialization constant
+			auto it = m_context->specializationConstants.find(constantId);
+			if (it != m_context->specializationConstants.end())
+				m_context->bakedSpecializationConstants.insert(it->second);
+
+			const ConstantValue* value = m_context->constantValues.TryRetrieve(constantId, expr.sourceLocation);
+			if (!value && !m_context->options.partialSanitization)
+				throw AstInvalidConstantIndexError{ expr.sourceLocation, constantId };
+
+			return value;
+		};
+
 		// Run optimizer on constant value to hopefully retrieve a single constant value
-		ExpressionPtr optimizedExpr = PropagateConstants(expr);
+		ExpressionPtr optimizedExpr = Ast::PropagateConstants(expr, optimizerOptions);
 		if (optimizedExpr->GetType() == NodeType::ConstantValueExpression)
 		{
 			return std::visit([&](auto&& value) -> ConstantValue
@@ -3189,6 +3400,149 @@ NAZARA_WARNING_POP()
 		return Nz::StaticUniquePointerCast<T>(Ast::PropagateConstants(node, optimizerOptions));
 	}
 
+	void SanitizeVisitor::PrefetchImportedModules(const Module& module)
+	{
+		// Resolve the import graph level by level, modules of a same level being independent from each other.
+		// Resolution (which includes loading, parsing or deserializing lazily registered modules) runs in parallel,
+		// modules which don't import anything are then sanitized ahead in parallel as well (see PresanitizeIndependentModules)
+		std::unordered_set<std::string> requestedModules;
+		auto CollectImports = [&](MultiStatement& rootNode, std::vector<std::string>& moduleNames)
+		{
+			ImportCollectorVisitor importCollector;
+			rootNode.Visit(importCollector);
+
+			for (ImportStatement* importStatement : importCollector.importStatements)
+			{
+				// Gather all symbols requested from each module
+				auto& importRequest = m_context->importRequests[importStatement->moduleName];
+				for (const auto& entry : importStatement->identifiers)
+				{
+					if (entry.identifier.empty())
+						importRequest.importEverything = true;
+					else
+						importRequest.identifiers.insert(entry.identifier);
+				}
+
+				if (requestedModules.insert(importStatement->moduleName).second)
+					moduleNames.push_back(importStatement->moduleName);
+			}
+
+			return !importCollector.importStatements.empty();
+		};
+
+		std::vector<std::string> pendingModules;
+		CollectImports(*module.rootNode, pendingModules);
+
+		ModuleResolver& moduleResolver = *m_context->options.moduleResolver;
+
+		// When only requested symbols are imported, resolvers may skip loading what they don't require (binary modules only materialize required statements)
+		bool resolveSymbols = m_context->options.importOnlyRequestedSymbols && !m_context->options.partialSanitization;
+
+		auto ResolveModules = [&](std::vector<std::string>& moduleNames, std::vector<std::size_t>& requestedSymbolCounts)
+		{
+			std::vector<const Context::ImportRequest*> importRequests(moduleNames.size(), nullptr);
+			requestedSymbolCounts.assign(moduleNames.size(), 0);
+			if (resolveSymbols)
+			{
+				for (std::size_t i = 0; i < moduleNames.size(); ++i)
+				{
+					const auto& importRequest = m_context->importRequests[moduleNames[i]];
+					if (importRequest.importEverything)
+						continue;
+
+					importRequests[i] = &importRequest;
+					requestedSymbolCounts[i] = importRequest.identifiers.size();
+				}
+			}
+
+			std::vector<ModulePtr> resolvedModules(moduleNames.size());
+			std::vector<std::exception_ptr> resolveErrors(moduleNames.size());
+			ParallelFor(moduleNames.size(), GetThreadCount(m_context->options), [&](std::size_t i)
+			{
+				try
+				{
+					if (importRequests[i])
+						resolvedModules[i] = moduleResolver.ResolveSymbols(moduleNames[i], importRequests[i]->identifiers);
+					else
+						resolvedModules[i] = moduleResolver.Resolve(moduleNames[i]);
+				}
+				catch (...)
+				{
+					// kept to be rethrown when visiting the import statement
+					resolveErrors[i] = std::current_exception();
+				}
+			});
+
+			return std::make_pair(std::move(resolvedModules), std::move(resolveErrors));
+		};
+
+		// Modules resolved from the symbols requested at that time, along with their count
+		std::vector<std::pair<std::string, std::size_t>> symbolResolvedModules;
+
+		// Modules which don't import anything, in resolution order
+		std::vector<std::string> independentModules;
+
+		while (!pendingModules.empty())
+		{
+			std::vector<std::size_t> requestedSymbolCounts;
+			auto [resolvedModules, resolveErrors] = ResolveModules(pendingModules, requestedSymbolCounts);
+
+			// Merge in request order to stay deterministic
+			std::vector<std::string> nextModules;
+			for (std::size_t i = 0; i < pendingModules.size(); ++i)
+			{
+				if (resolveErrors[i])
+				{
+					m_context->prefetchErrors.emplace(std::move(pendingModules[i]), std::move(resolveErrors[i]));
+					continue;
+				}
+
+				if (!resolvedModules[i])
+					continue;
+
+				if (!CollectImports(*resolvedModules[i]->rootNode, nextModules))
+					independentModules.push_back(pendingModules[i]);
+
+				if (resolveSymbols)
+					symbolResolvedModules.emplace_back(pendingModules[i], requestedSymbolCounts[i]);
+
+				m_context->prefetchedModules.emplace(std::move(pendingModules[i]), std::move(resolvedModules[i]));
+			}
+
+			pendingModules = std::move(nextModules);
+		}
+
+		// Modules imported at a deeper level may have requested more symbols from an already resolved module, resolve it again with all of them
+		// (partially resolved modules keep all their import statements, so this doesn't change the import graph)
+		std::vector<std::string> outdatedModules;
+		for (const auto& [moduleName, requestedSymbolCount] : symbolResolvedModules)
+		{
+			const auto& importRequest = m_context->importRequests[moduleName];
+			if (importRequest.importEverything || importRequest.identifiers.size() != requestedSymbolCount)
+				outdatedModules.push_back(moduleName);
+		}
+
+		if (!outdatedModules.empty())
+		{
+			std::vector<std::size_t> requestedSymbolCounts;
+			auto [resolvedModules, resolveErrors] = ResolveModules(outdatedModules, requestedSymbolCounts);
+
+			for (std::size_t i = 0; i < outdatedModules.size(); ++i)
+			{
+				if (resolveErrors[i])
+				{
+					m_context->prefetchedModules.erase(outdatedModules[i]);
+					m_context->prefetchErrors.emplace(std::move(outdatedModules[i]), std::move(resolveErrors[i]));
+				}
+				else
+					m_context->prefetchedModules[outdatedModules[i]] = std::move(resolvedModules[i]);
+			}
+		}
+
+		if (!m_context->options.partialSanitization)
+			PresanitizeIndependentModules(independentModules);
+	}
+
 	void SanitizeVisitor::PreregisterIndices(const Module& module)
 	{
 		// If AST has been sanitized before and is sanitized again but with different options that may introduce new variables (for example reduceLoopsToWhile)
@@ -3210,6 +3564,61 @@ NAZARA_WARNING_POP()
 		reflectVisitor.Reflect(*module.rootNode, registerCallbacks);
 	}
 
+	void SanitizeVisitor::PresanitizeIndependentModules(const std::vector<std::string>& moduleNames)
+	{
+		// Modules which don't import anything don't depend on this context, they can be sanitized on their own context on multiple threads.
+		// They are partially sanitized (like binary modules) so names, options and other transformations are only resolved once merged in this context,
+		// where their indices are remapped in import order, which keeps the output independent of the thread count.
+		CompilationStats::Scope presanitizeScope(m_context->options.compilationStats, "import", "Sanitize independent modules");
+
+		std::vector<ModulePtr> moduleList;
+		moduleList.reserve(moduleNames.size());
+		for (const std::string& moduleName : moduleNames)
+		{
+			auto it = m_context->prefetchedModules.find(moduleName);
+			moduleList.push_back((it != m_context->prefetchedModules.end()) ? it->second : nullptr);
+		}
+
+		std::vector<ModulePtr> presanitizedModules(moduleNames.size());
+		ParallelFor(moduleNames.size(), GetThreadCount(m_context->options), [&](std::size_t i)
+		{
+			if (!moduleList[i])
+				return;
+
+			const Module& targetModule = *moduleList[i];
+
+			// Only sanitize requested symbols, as the import would
+			ModulePtr filteredModule;
+			if (m_context->options.importOnlyRequestedSymbols)
+			{
+				auto requestIt = m_context->importRequests.find(moduleNames[i]);
+				if (requestIt != m_context->importRequests.end() && !requestIt->second.importEverything)
+					filteredModule = std::make_shared<Module>(targetModule.metadata, FilterRequestedSymbols(*targetModule.rootNode, requestIt->second.identifiers));
+			}
+
+			Options moduleOptions;
+			moduleOptions.partialSanitization = true;
+
+			try
+			{
+				std::string error;
+				presanitizedModules[i] = SanitizeVisitor{}.Sanitize((filteredModule) ? *filteredModule : targetModule, moduleOptions, &error);
+				if (!error.empty())
+					presanitizedModules[i].reset();
+			}
+			catch (...)
+			{
+				// errors are not reported from here, the module is sanitized from its source when imported which reports them as usual
+			}
+		});
+
+		for (std::size_t i = 0; i < moduleNames.size(); ++i)
+		{
+			if (presanitizedModules[i])
+				m_context->presanitizedModules.emplace(moduleNames[i], std::move(presanitizedModules[i]));
+		}
+	}
+
 	void SanitizeVisitor::PropagateFunctionRequirements(FunctionData& callingFunction, std::size_t funcIndex, Nz::Bitset<>& seen)
 	{
 		// Prevent infinite recursion
@@ -4125,7 +4534,12 @@ NAZARA_WARNING_POP()
 			// First pass, evaluate everything except function code
 			try
 			{
-				output = Nz::StaticUniquePointerCast<MultiStatement>(Cloner::Clone(rootNode));
+				{
+					CompilationStats::Scope cloneScope(m_context->options.compilationStats, "sanitize", "Resolve declarations");
+					output = Nz::StaticUniquePointerCast<MultiStatement>(Cloner::Clone(rootNode));
+				}
+
+				CompilationStats::Scope functionScope(m_context->options.compilationStats, "sanitize", "Resolve functions");
 				ResolveFunctions();
 			}
 			catch (const std::runtime_error& err)
@@ -4864,18 +5278,19 @@ NAZARA_WARNING_POP()
 			else
 				targetArrayType.length = Nz::SafeCast<std::uint32_t>(node.expressions.size());
 
-			const ExpressionType& innerType = targetArrayType.containedType->type;
+			// compare interned types, to avoid walking the inner type for every element
+			ExpressionTypeHandle innerType = targetArrayType.containedType->type;
 			for (std::size_t i = 0; i < node.expressions.size(); ++i)
 			{
 				const auto& exprPtr = node.expressions[i];
 				assert(exprPtr);
 
-				const ExpressionType* exprType = GetExpressionType(*exprPtr);
+				const ExpressionTypeHandle* exprType = GetExpressionTypeHandle(*exprPtr);
 				if (!exprType)
 					return ValidationResult::Unresolved;
 
 				if (innerType != *exprType)
-					throw CompilerCastIncompatibleTypesError{ exprPtr->sourceLocation, ToString(innerType, node.sourceLocation), ToString(*exprType, exprPtr->sourceLocation) };
+					throw CompilerCastIncompatibleTypesError{ exprPtr->sourceLocation, ToString(innerType.Get(), node.sourceLocation), ToString(exprType->Get(), exprPtr->sourceLocation) };
 			}
 		}
 		else
@@ -0,0 +1,343 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/SymbolDependencies.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <array>
+#include <unordered_map>
+
+namespace nzsl::Ast
+{
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		enum class SymbolCategory
+		{
+			Alias,
+			Constant,
+			Function,
+			Struct
+		};
+
+		constexpr std::size_t SymbolCategoryCount = 4;
+
+		std::optional<SymbolCategory> GetSymbolCategory(NodeType declarationType)
+		{
+			switch (declarationType)
+			{
+				case NodeType::DeclareAliasStatement:    return SymbolCategory::Alias;
+				case NodeType::DeclareConstStatement:    return SymbolCategory::Constant;
+				case NodeType::DeclareFunctionStatement: return SymbolCategory::Function;
+				case NodeType::DeclareStructStatement:   return SymbolCategory::Struct;
+				default:                                 return std::nullopt; //< options, externals, imports, etc.
+			}
+		}
+
+		struct SymbolReferenceCollector : RecursiveVisitor
+		{
+			using RecursiveVisitor::Visit;
+
+			template<typename T>
+			void Collect(const ExpressionValue<T>& value)
+			{
+				if (value.IsExpression())
+					value.GetExpression()->Visit(*this);
+				else if constexpr (std::is_same_v<T, ExpressionType>)
+				{
+					if (value.IsResultingValue())
+						CollectType(value.GetResultingValue());
+				}
+			}
+
+			void CollectIndex(SymbolCategory category, std::size_t index)
+			{
+				indices[static_cast<std::size_t>(category)].push_back(index);
+			}
+
+			void CollectType(const ExpressionType& exprType)
+			{
+				std::visit([&](auto&& arg)
+				{
+					using T = std::decay_t<decltype(arg)>;
+
+					if constexpr (std::is_same_v<T, AliasType>)
+					{
+						CollectIndex(SymbolCategory::Alias, arg.aliasIndex);
+						CollectType(arg.targetType->type);
+					}
+					else if constexpr (std::is_base_of_v<BaseArrayType, T>)
+						CollectType(arg.containedType->type);
+					else if constexpr (std::is_same_v<T, StructType>)
+						CollectIndex(SymbolCategory::Struct, arg.structIndex);
+					else if constexpr (std::is_same_v<T, StorageType> || std::is_same_v<T, UniformType> || std::is_same_v<T, PushConstantType>)
+						CollectIndex(SymbolCategory::Struct, arg.containedType.structIndex);
+				}, exprType);
+			}
+
+			void Visit(AliasValueExpression& node) override
+			{
+				CollectIndex(SymbolCategory::Alias, node.aliasId);
+			}
+
+			void Visit(CastExpression& node) override
+			{
+				Collect(node.targetType);
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(ConstantExpression& node) override
+			{
+				CollectIndex(SymbolCategory::Constant, node.constantId);
+			}
+
+			void Visit(FunctionExpression& node) override
+			{
+				CollectIndex(SymbolCategory::Function, node.funcId);
+			}
+
+			void Visit(IdentifierExpression& node) override
+			{
+				identifiers.insert(node.identifier);
+			}
+
+			void Visit(StructTypeExpression& node) override
+			{
+				CollectIndex(SymbolCategory::Struct, node.structTypeId);
+			}
+
+			void Visit(DeclareConstStatement& node) override
+			{
+				Collect(node.isExported);
+				Collect(node.type);
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(DeclareExternalStatement& node) override
+			{
+				Collect(node.autoBinding);
+				Collect(node.bindingSet);
+				for (auto& extVar : node.externalVars)
+				{
+					Collect(extVar.bindingIndex);
+					Collect(extVar.bindingSet);
+					Collect(extVar.type);
+				}
+
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(DeclareFunctionStatement& node) override
+			{
+				Collect(node.depthWrite);
+				Collect(node.earlyFragmentTests);
+				Collect(node.entryStage);
+				Collect(node.isExported);
+				Collect(node.returnType);
+				Collect(node.workgroupSize);
+				for (auto& parameter : node.parameters)
+					Collect(parameter.type);
+
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(DeclareOptionStatement& node) override
+			{
+				Collect(node.optType);
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(DeclareStructStatement& node) override
+			{
+				Collect(node.isExported);
+				Collect(node.description.layout);
+				for (auto& member : node.description.members)
+				{
+					Collect(member.builtin);
+					Collect(member.cond);
+					Collect(member.interp);
+					Collect(member.locationIndex);
+					Collect(member.precision);
+					Collect(member.type);
+				}
+
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(DeclareVariableStatement& node) override
+			{
+				Collect(node.varType);
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(ForEachStatement& node) override
+			{
+				Collect(node.unroll);
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(ForStatement& node) override
+			{
+				Collect(node.unroll);
+				RecursiveVisitor::Visit(node);
+			}
+
+			void Visit(WhileStatement& node) override
+			{
+				Collect(node.unroll);
+				RecursiveVisitor::Visit(node);
+			}
+
+			std::array<std::vector<std::size_t>, SymbolCategoryCount> indices;
+			std::unordered_set<std::string> identifiers;
+		};
+	}
+
+	SymbolDeclaration GetSymbolDeclaration(const Statement& statement)
+	{
+		SymbolDeclaration declaration;
+		declaration.declarationType = statement.GetType();
+
+		switch (declaration.declarationType)
+		{
+			case NodeType::ConditionalStatement:
+			{
+				const auto& condStatement = static_cast<const ConditionalStatement&>(statement);
+				if (condStatement.statement)
+					declaration = GetSymbolDeclaration(*condStatement.statement);
+
+				break;
+			}
+
+			case NodeType::DeclareAliasStatement:
+			{
+				const auto& aliasStatement = static_cast<const DeclareAliasStatement&>(statement);
+				declaration.name = aliasStatement.name;
+				declaration.index = aliasStatement.aliasIndex;
+				break;
+			}
+
+			case NodeType::DeclareConstStatement:
+			{
+				const auto& constStatement = static_cast<const DeclareConstStatement&>(statement);
+				declaration.name = constStatement.name;
+				declaration.index = constStatement.constIndex;
+				break;
+			}
+
+			case NodeType::DeclareFunctionStatement:
+			{
+				const auto& funcStatement = static_cast<const DeclareFunctionStatement&>(statement);
+				declaration.name = funcStatement.name;
+				declaration.index = funcStatement.funcIndex;
+				declaration.isEntryPoint = funcStatement.entryStage.HasValue();
+				break;
+			}
+
+			case NodeType::DeclareStructStatement:
+			{
+				const auto& structStatement = static_cast<const DeclareStructStatement&>(statement);
+				declaration.name = structStatement.description.name;
+				declaration.index = structStatement.structIndex;
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		return declaration;
+	}
+
+	Nz::Bitset<> ResolveRequiredStatements(const std::vector<SymbolDeclaration>& declarations, const std::unordered_set<std::string>& requestedSymbols, const Nz::FunctionRef<Statement*(std::size_t statementIndex)>& getStatement)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		// A symbol may be declared by multiple statements (conditional declarations), all of them are kept
+		std::unordered_map<std::string_view, std::vector<std::size_t>> statementsByName;
+		std::array<std::unordered_map<std::size_t, std::vector<std::size_t>>, SymbolCategoryCount> statementsByIndex;
+
+		Nz::Bitset<> requiredStatements(declarations.size(), false);
+		std::vector<std::size_t> pendingStatements;
+
+		auto RequireStatement = [&](std::size_t statementIndex)
+		{
+			if (requiredStatements.Test(statementIndex))
+				return;
+
+			requiredStatements.Set(statementIndex);
+			pendingStatements.push_back(statementIndex);
+		};
+
+		for (std::size_t i = 0; i < declarations.size(); ++i)
+		{
+			const SymbolDeclaration& declaration = declarations[i];
+
+			std::optional<SymbolCategory> category = GetSymbolCategory(declaration.declarationType);
+			if (!category || declaration.isEntryPoint)
+			{
+				RequireStatement(i);
+				continue;
+			}
+
+			statementsByName[declaration.name].push_back(i);
+			if (declaration.index)
+				statementsByIndex[static_cast<std::size_t>(*category)][*declaration.index].push_back(i);
+		}
+
+		std::unordered_set<std::string> seenNames;
+		std::array<Nz::Bitset<>, SymbolCategoryCount> seenIndices;
+
+		auto RequireName = [&](const std::string& name)
+		{
+			if (!seenNames.insert(name).second)
+				return;
+
+			if (auto it = statementsByName.find(name); it != statementsByName.end())
+			{
+				for (std::size_t statementIndex : it->second)
+					RequireStatement(statementIndex);
+			}
+		};
+
+		auto RequireIndex = [&](std::size_t category, std::size_t index)
+		{
+			if (seenIndices[category].UnboundedTest(index))
+				return;
+
+			seenIndices[category].UnboundedSet(index);
+
+			if (auto it = statementsByIndex[category].find(index); it != statementsByIndex[category].end())
+			{
+				for (std::size_t statementIndex : it->second)
+					RequireStatement(statementIndex);
+			}
+		};
+
+		for (const std::string& name : requestedSymbols)
+			RequireName(name);
+
+		while (!pendingStatements.empty())
+		{
+			std::size_t statementIndex = pendingStatements.back();
+			pendingStatements.pop_back();
+
+			Statement* statement = getStatement(statementIndex);
+			if (!statement)
+				continue;
+
+			SymbolReferenceCollector referenceCollector;
+			statement->Visit(referenceCollector);
+
+			for (const std::string& identifier : referenceCollector.identifiers)
+				RequireName(identifier);
+
+			for (std::size_t category = 0; category < SymbolCategoryCount; ++category)
+			{
+				for (std::size_t index : referenceCollector.indices[category])
+					RequireIndex(category, index);
+			}
+		}
+
+		return requiredStatements;
+	}
+}
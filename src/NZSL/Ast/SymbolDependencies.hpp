@@ -0,0 +1,39 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_SYMBOLDEPENDENCIES_HPP
+#define NZSL_AST_SYMBOLDEPENDENCIES_HPP
+
+#include <NazaraUtils/Bitset.hpp>
+#include <NazaraUtils/FunctionRef.hpp>
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/Nodes.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	// What a root statement declares, known without materializing it (from the statement itself or from a binary module index)
+	struct SymbolDeclaration
+	{
+		std::string_view name;
+		std::optional<std::size_t> index; //< alias, constant, function or struct index once resolved
+		NodeType declarationType = NodeType::None; //< type of the declaring statement, conditional statements are looked through
+		bool isEntryPoint = false;
+	};
+
+	SymbolDeclaration GetSymbolDeclaration(const Statement& statement);
+
+	// Returns the root statements required to use the requested symbols: statements declaring them, their dependencies (by name for identifiers
+	// and by index for resolved symbols) and statements that don't declare an alias, a constant, a function or a struct, or which declare an entry point.
+	// Statements are only retrieved through getStatement once they are known to be required (they're loaded lazily from binary modules).
+	Nz::Bitset<> ResolveRequiredStatements(const std::vector<SymbolDeclaration>& declarations, const std::unordered_set<std::string>& requestedSymbols, const Nz::FunctionRef<Statement*(std::size_t statementIndex)>& getStatement);
+}
+
+#endif // NZSL_AST_SYMBOLDEPENDENCIES_HPP
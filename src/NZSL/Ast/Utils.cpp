@@ -3,10 +3,45 @@
 // For conditions of distribution and use, see copyright notice in Config.hpp
 
 #include <NZSL/Ast/Utils.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <cassert>
 
 namespace nzsl::Ast
 {
+	namespace
+	{
+		class SideEffectChecker : public RecursiveVisitor
+		{
+			public:
+				using RecursiveVisitor::Visit;
+
+				void Visit(AssignExpression& /*node*/) override
+				{
+					hasSideEffects = true;
+				}
+
+				void Visit(CallFunctionExpression& /*node*/) override
+				{
+					hasSideEffects = true;
+				}
+
+				void Visit(CallMethodExpression& /*node*/) override
+				{
+					hasSideEffects = true;
+				}
+
+				void Visit(IntrinsicExpression& node) override
+				{
+					if (node.intrinsic == IntrinsicType::TextureWrite)
+						hasSideEffects = true;
+					else
+						RecursiveVisitor::Visit(node);
+				}
+
+				bool hasSideEffects = false;
+		};
+	}
+
 	ExpressionCategory ValueCategory::GetExpressionCategory(Expression& expression)
 	{
 		expression.Visit(*this);
@@ -155,4 +190,12 @@ namespace nzsl::Ast
 	{
 		m_expressionCategory = ExpressionCategory::RValue;
 	}
+
+	bool HasSideEffects(Expression& expression)
+	{
+		SideEffectChecker checker;
+		expression.Visit(checker);
+
+		return checker.hasSideEffects;
+	}
 }
@@ -0,0 +1,268 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/VaryingPacking.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <NZSL/Ast/ReflectVisitor.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace nzsl::Ast
+{
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		std::uint32_t GetLocationCount(const ExpressionType& type)
+		{
+			const ExpressionType& resolvedType = ResolveAlias(type);
+			if (IsArrayType(resolvedType))
+			{
+				const ArrayType& arrayType = std::get<ArrayType>(resolvedType);
+				return arrayType.length * GetLocationCount(arrayType.containedType->type);
+			}
+			else if (IsMatrixType(resolvedType))
+			{
+				const MatrixType& matrixType = std::get<MatrixType>(resolvedType);
+				std::uint32_t columnLocationCount = (matrixType.type == PrimitiveType::Float64 && matrixType.rowCount > 2) ? 2 : 1;
+				return Nz::SafeCast<std::uint32_t>(matrixType.columnCount) * columnLocationCount;
+			}
+			else if (IsVectorType(resolvedType))
+			{
+				const VectorType& vecType = std::get<VectorType>(resolvedType);
+				return (vecType.type == PrimitiveType::Float64 && vecType.componentCount > 2) ? 2 : 1;
+			}
+			else
+				return 1;
+		}
+
+		std::uint32_t GetComponentCount(const ExpressionType& type)
+		{
+			const ExpressionType& resolvedType = ResolveAlias(type);
+			if (IsArrayType(resolvedType))
+				return GetComponentCount(std::get<ArrayType>(resolvedType).containedType->type);
+			else if (IsMatrixType(resolvedType))
+				return Nz::SafeCast<std::uint32_t>(std::get<MatrixType>(resolvedType).rowCount);
+			else if (IsVectorType(resolvedType))
+				return Nz::SafeCast<std::uint32_t>(std::get<VectorType>(resolvedType).componentCount);
+			else
+				return 1;
+		}
+
+		// Only 32bits scalars and vectors can share a location
+		std::optional<PrimitiveType> GetPackableComponentType(const ExpressionType& type)
+		{
+			const ExpressionType& resolvedType = ResolveAlias(type);
+
+			PrimitiveType componentType;
+			if (IsPrimitiveType(resolvedType))
+				componentType = std::get<PrimitiveType>(resolvedType);
+			else if (IsVectorType(resolvedType))
+				componentType = std::get<VectorType>(resolvedType).type;
+			else
+				return std::nullopt;
+
+			switch (componentType)
+			{
+				case PrimitiveType::Float32:
+				case PrimitiveType::Int32:
+				case PrimitiveType::UInt32:
+					return componentType;
+
+				case PrimitiveType::Boolean:
+				case PrimitiveType::Float64:
+				case PrimitiveType::String:
+					break;
+			}
+
+			return std::nullopt;
+		}
+	}
+
+	VaryingPacking PackVaryings(const StructDescription& structDesc)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		VaryingPacking packing;
+		for (std::size_t memberIndex = 0; memberIndex < structDesc.members.size(); ++memberIndex)
+		{
+			const auto& member = structDesc.members[memberIndex];
+			if (member.cond.HasValue() && !member.cond.GetResultingValue())
+				continue;
+
+			if (member.builtin.HasValue() || !member.locationIndex.HasValue())
+				continue;
+
+			auto& location = packing.locations.emplace_back();
+			location.memberIndex = memberIndex;
+			location.originalLocation = member.locationIndex.GetResultingValue();
+		}
+
+		std::stable_sort(packing.locations.begin(), packing.locations.end(), [](const VaryingLocation& lhs, const VaryingLocation& rhs)
+		{
+			return lhs.originalLocation < rhs.originalLocation;
+		});
+
+		// Packed varyings having a single member don't need packing code and are removed at the end
+		std::vector<PackedVarying> slots;
+
+		std::uint32_t nextLocation = 0;
+		for (std::size_t locationIndex = 0; locationIndex < packing.locations.size(); ++locationIndex)
+		{
+			VaryingLocation& location = packing.locations[locationIndex];
+
+			const auto& member = structDesc.members[location.memberIndex];
+			const ExpressionType& memberType = member.type.GetResultingValue();
+
+			location.componentCount = GetComponentCount(memberType);
+
+			std::optional<PrimitiveType> componentType = GetPackableComponentType(memberType);
+			if (!componentType)
+			{
+				location.firstComponent = 0;
+				location.location = nextLocation;
+				location.locationCount = GetLocationCount(memberType);
+
+				nextLocation += location.locationCount;
+				continue;
+			}
+
+			InterpolationQualifier interpolation = (member.interp.HasValue()) ? member.interp.GetResultingValue() : InterpolationQualifier::Smooth;
+			bool isRelaxed = (member.precision.HasValue() && member.precision.GetResultingValue() == PrecisionQualifier::Medium);
+
+			auto slotIt = std::find_if(slots.begin(), slots.end(), [&](const PackedVarying& slot)
+			{
+				return slot.componentType == *componentType && slot.interpolation == interpolation && slot.componentCount + location.componentCount <= 4;
+			});
+
+			if (slotIt == slots.end())
+			{
+				PackedVarying& slot = slots.emplace_back();
+				slot.componentCount = 0;
+				slot.componentType = *componentType;
+				slot.interpolation = interpolation;
+				slot.location = nextLocation++;
+				slot.relaxedPrecision = true;
+
+				slotIt = std::prev(slots.end());
+			}
+
+			location.firstComponent = slotIt->componentCount;
+			location.location = slotIt->location;
+			location.locationCount = 1;
+
+			slotIt->componentCount += location.componentCount;
+			slotIt->locations.push_back(locationIndex);
+			slotIt->relaxedPrecision = slotIt->relaxedPrecision && isRelaxed;
+		}
+
+		for (PackedVarying& slot : slots)
+		{
+			if (slot.locations.size() < 2)
+				continue;
+
+			std::size_t packedVaryingIndex = packing.packedVaryings.size();
+			for (std::size_t locationIndex : slot.locations)
+				packing.locations[locationIndex].packedVaryingIndex = packedVaryingIndex;
+
+			packing.packedVaryings.push_back(std::move(slot));
+		}
+
+		return packing;
+	}
+
+	void ValidateVaryingPacking(const Module& shaderModule)
+	{
+		std::unordered_map<std::size_t, const StructDescription*> structs;
+		std::vector<const StructDescription*> fragmentInputs;
+		std::vector<const StructDescription*> vertexOutputs;
+
+		ReflectVisitor::Callbacks structCallbacks;
+		structCallbacks.onStructDeclaration = [&](const DeclareStructStatement& structDecl)
+		{
+			if (structDecl.structIndex)
+				structs.emplace(*structDecl.structIndex, &structDecl.description);
+		};
+
+		ReflectVisitor reflectVisitor;
+		reflectVisitor.Reflect(shaderModule, structCallbacks);
+
+		// entry points of imported modules are not generated
+		ReflectVisitor::Callbacks entryCallbacks;
+		entryCallbacks.onFunctionDeclaration = [&](const DeclareFunctionStatement& funcDecl)
+		{
+			if (!funcDecl.entryStage.IsResultingValue())
+				return;
+
+			const ExpressionType* varyingType = nullptr;
+			std::vector<const StructDescription*>* varyingStructs = nullptr;
+			switch (funcDecl.entryStage.GetResultingValue())
+			{
+				case ShaderStageType::Fragment:
+					if (!funcDecl.parameters.empty())
+						varyingType = &funcDecl.parameters.front().type.GetResultingValue();
+
+					varyingStructs = &fragmentInputs;
+					break;
+
+				case ShaderStageType::Vertex:
+					if (funcDecl.returnType.IsResultingValue())
+						varyingType = &funcDecl.returnType.GetResultingValue();
+
+					varyingStructs = &vertexOutputs;
+					break;
+
+				case ShaderStageType::Compute:
+					break;
+			}
+
+			if (varyingType && IsStructType(*varyingType))
+				varyingStructs->push_back(Nz::Retrieve(structs, std::get<StructType>(*varyingType).structIndex));
+		};
+
+		reflectVisitor.Reflect(*shaderModule.rootNode, entryCallbacks);
+
+		auto GetInterpolation = [](const StructDescription::StructMember& member)
+		{
+			return (member.interp.HasValue()) ? member.interp.GetResultingValue() : InterpolationQualifier::Smooth;
+		};
+
+		for (const StructDescription* outputStruct : vertexOutputs)
+		{
+			VaryingPacking outputPacking = PackVaryings(*outputStruct);
+
+			for (const StructDescription* inputStruct : fragmentInputs)
+			{
+				if (inputStruct == outputStruct)
+					continue;
+
+				VaryingPacking inputPacking = PackVaryings(*inputStruct);
+
+				auto ThrowMismatch = [&](std::uint32_t location)
+				{
+					throw std::runtime_error(fmt::format("varying packing requires vertex outputs and fragment inputs to declare the same location members but {} and {} differ at location {}", outputStruct->name, inputStruct->name, location));
+				};
+
+				std::size_t locationCount = std::min(outputPacking.locations.size(), inputPacking.locations.size());
+				for (std::size_t locationIndex = 0; locationIndex < locationCount; ++locationIndex)
+				{
+					const VaryingLocation& outputLocation = outputPacking.locations[locationIndex];
+					const VaryingLocation& inputLocation = inputPacking.locations[locationIndex];
+
+					const auto& outputMember = outputStruct->members[outputLocation.memberIndex];
+					const auto& inputMember = inputStruct->members[inputLocation.memberIndex];
+
+					if (outputLocation.originalLocation != inputLocation.originalLocation || ResolveAlias(outputMember.type.GetResultingValue()) != ResolveAlias(inputMember.type.GetResultingValue()) || GetInterpolation(outputMember) != GetInterpolation(inputMember))
+						ThrowMismatch(std::min(outputLocation.originalLocation, inputLocation.originalLocation));
+				}
+
+				if (outputPacking.locations.size() > locationCount)
+					ThrowMismatch(outputPacking.locations[locationCount].originalLocation);
+				else if (inputPacking.locations.size() > locationCount)
+					ThrowMismatch(inputPacking.locations[locationCount].originalLocation);
+			}
+		}
+	}
+}
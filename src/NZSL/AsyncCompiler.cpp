@@ -0,0 +1,298 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/AsyncCompiler.hpp>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace nzsl
+{
+	struct AsyncCompiler::JobQueue
+	{
+		JobPtr PopJob()
+		{
+			std::unique_lock lock(mutex);
+			return PopJob(lock);
+		}
+
+		JobPtr PopJob(std::unique_lock<std::mutex>& /*lock*/)
+		{
+			// Jobs cancelled while pending are simply dropped
+			pendingJobs.erase(std::remove_if(pendingJobs.begin(), pendingJobs.end(), [](const JobPtr& job) { return job->GetStatus() != CompileJobStatus::Pending; }), pendingJobs.end());
+			if (pendingJobs.empty())
+				return nullptr;
+
+			// Highest priority first, submission order between jobs of the same priority
+			auto it = std::max_element(pendingJobs.begin(), pendingJobs.end(), [](const JobPtr& lhs, const JobPtr& rhs)
+			{
+				int lhsPriority = lhs->GetPriority();
+				int rhsPriority = rhs->GetPriority();
+				if (lhsPriority != rhsPriority)
+					return lhsPriority < rhsPriority;
+
+				return lhs->m_sequence > rhs->m_sequence;
+			});
+
+			JobPtr job = std::move(*it);
+			pendingJobs.erase(it);
+
+			return job;
+		}
+
+		void RunNextJob()
+		{
+			if (JobPtr job = PopJob())
+				job->Run();
+		}
+
+		void WorkerLoop()
+		{
+			for (;;)
+			{
+				JobPtr job;
+				{
+					std::unique_lock lock(mutex);
+					condition.wait(lock, [&] { return stopping || !pendingJobs.empty(); });
+					if (stopping)
+						return;
+
+					job = PopJob(lock);
+				}
+
+				if (job)
+					job->Run();
+			}
+		}
+
+		std::condition_variable condition;
+		std::mutex mutex;
+		std::uint64_t nextSequence = 0;
+		std::vector<JobPtr> pendingJobs;
+		bool stopping = false;
+	};
+
+	AsyncCompiler::AsyncCompiler(unsigned int threadCount) :
+	m_queue(std::make_shared<JobQueue>())
+	{
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		m_workers.reserve(threadCount);
+		for (unsigned int i = 0; i < threadCount; ++i)
+			m_workers.emplace_back([queue = m_queue] { queue->WorkerLoop(); });
+	}
+
+	AsyncCompiler::AsyncCompiler(Executor executor) :
+	m_queue(std::make_shared<JobQueue>()),
+	m_executor(std::move(executor))
+	{
+		assert(m_executor);
+	}
+
+	AsyncCompiler::~AsyncCompiler()
+	{
+		CancelAll();
+
+		{
+			std::unique_lock lock(m_queue->mutex);
+			m_queue->stopping = true;
+		}
+		m_queue->condition.notify_all();
+
+		// Jobs which already started are left to finish, tasks given to a user executor keep the queue alive
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	void AsyncCompiler::CancelAll()
+	{
+		std::vector<JobPtr> pendingJobs;
+		{
+			std::unique_lock lock(m_queue->mutex);
+			pendingJobs = std::move(m_queue->pendingJobs);
+			m_queue->pendingJobs.clear();
+		}
+
+		for (const JobPtr& job : pendingJobs)
+			job->Cancel();
+	}
+
+	auto AsyncCompiler::SubmitGlsl(Ast::ModulePtr module, std::optional<ShaderStageType> shaderStage, const ShaderWriter::States& states, const GlslWriter::BindingMapping& bindingMapping, const GlslWriter::Environment& environment, int priority) -> JobPtr
+	{
+		assert(module);
+		return Submit([module = std::move(module), shaderStage, states, bindingMapping, environment]() -> Job::Output
+		{
+			GlslWriter writer;
+			writer.SetEnv(environment);
+
+			return writer.Generate(shaderStage, *module, bindingMapping, states);
+		}, priority);
+	}
+
+	auto AsyncCompiler::SubmitNzsl(Ast::ModulePtr module, const ShaderWriter::States& states, const LangWriter::Environment& environment, int priority) -> JobPtr
+	{
+		assert(module);
+		return Submit([module = std::move(module), states, environment]() -> Job::Output
+		{
+			LangWriter writer;
+			writer.SetEnv(environment);
+
+			return writer.Generate(*module, states);
+		}, priority);
+	}
+
+	auto AsyncCompiler::SubmitSpirv(Ast::ModulePtr module, const ShaderWriter::States& states, const SpirvWriter::Environment& environment, int priority) -> JobPtr
+	{
+		assert(module);
+		return Submit([module = std::move(module), states, environment]() -> Job::Output
+		{
+			SpirvWriter writer;
+			writer.SetEnv(environment);
+
+			return writer.Generate(*module, states);
+		}, priority);
+	}
+
+	auto AsyncCompiler::Submit(std::function<Job::Output()> task, int priority) -> JobPtr
+	{
+		JobPtr job;
+		{
+			std::unique_lock lock(m_queue->mutex);
+			job.reset(new Job(std::move(task), priority, m_queue->nextSequence++));
+			m_queue->pendingJobs.push_back(job);
+		}
+
+		// Each task runs the most important pending job when it starts, not necessarily the one submitted here
+		if (m_executor)
+			m_executor([queue = m_queue] { queue->RunNextJob(); });
+		else
+			m_queue->condition.notify_one();
+
+		return job;
+	}
+
+
+	AsyncCompiler::Job::Job(std::function<Output()> task, int priority, std::uint64_t sequence) :
+	m_priority(priority),
+	m_task(std::move(task)),
+	m_sequence(sequence),
+	m_status(CompileJobStatus::Pending)
+	{
+	}
+
+	bool AsyncCompiler::Job::Cancel()
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			if (m_status != CompileJobStatus::Pending)
+				return false; //< writers have no interruption point, a running job always completes
+
+			m_status = CompileJobStatus::Cancelled;
+			m_task = {}; //< release the module
+		}
+		m_condition.notify_all();
+
+		return true;
+	}
+
+	const GlslWriter::Output& AsyncCompiler::Job::GetGlslOutput() const
+	{
+		return GetOutput<GlslWriter::Output>();
+	}
+
+	const std::string& AsyncCompiler::Job::GetNzslOutput() const
+	{
+		return GetOutput<std::string>();
+	}
+
+	const std::vector<std::uint32_t>& AsyncCompiler::Job::GetSpirvOutput() const
+	{
+		return GetOutput<std::vector<std::uint32_t>>();
+	}
+
+	CompileJobStatus AsyncCompiler::Job::GetStatus() const
+	{
+		std::unique_lock lock(m_mutex);
+		return m_status;
+	}
+
+	bool AsyncCompiler::Job::IsFinished() const
+	{
+		CompileJobStatus status = GetStatus();
+		return status != CompileJobStatus::Pending && status != CompileJobStatus::Running;
+	}
+
+	void AsyncCompiler::Job::Wait() const
+	{
+		std::unique_lock lock(m_mutex);
+		m_condition.wait(lock, [&] { return m_status != CompileJobStatus::Pending && m_status != CompileJobStatus::Running; });
+	}
+
+	template<typename T>
+	const T& AsyncCompiler::Job::GetOutput() const
+	{
+		Wait();
+
+		// status and output no longer change once the job is finished
+		switch (m_status)
+		{
+			case CompileJobStatus::Cancelled:
+				throw std::runtime_error("compilation job was cancelled");
+
+			case CompileJobStatus::Failed:
+				std::rethrow_exception(m_error);
+
+			case CompileJobStatus::Pending:
+			case CompileJobStatus::Running:
+			case CompileJobStatus::Succeeded:
+				break;
+		}
+
+		const T* output = std::get_if<T>(&m_output);
+		if (!output)
+			throw std::runtime_error("compilation job has no output of the requested kind");
+
+		return *output;
+	}
+
+	void AsyncCompiler::Job::Run()
+	{
+		std::function<Output()> task;
+		{
+			std::unique_lock lock(m_mutex);
+			if (m_status != CompileJobStatus::Pending)
+				return;
+
+			m_status = CompileJobStatus::Running;
+			task = std::move(m_task);
+		}
+
+		Output output;
+		std::exception_ptr error;
+		try
+		{
+			output = task();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		{
+			std::unique_lock lock(m_mutex);
+			if (error)
+			{
+				m_error = std::move(error);
+				m_status = CompileJobStatus::Failed;
+			}
+			else
+			{
+				m_output = std::move(output);
+				m_status = CompileJobStatus::Succeeded;
+			}
+		}
+		m_condition.notify_all();
+	}
+}
@@ -0,0 +1,141 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/CompilationStats.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <cassert>
+
+namespace nzsl
+{
+	namespace
+	{
+		class NodeCounterVisitor : public Ast::RecursiveVisitor
+		{
+			public:
+				using RecursiveVisitor::Visit;
+
+#define NZSL_SHADERAST_NODE(NodeType, Category) \
+				void Visit(Ast::NodeType##Category& node) override \
+				{ \
+					nodeCount++; \
+					RecursiveVisitor::Visit(node); \
+				}
+
+#include <NZSL/Ast/NodeList.hpp>
+
+				std::size_t nodeCount = 0;
+		};
+	}
+
+	CompilationStats::CompilationStats() :
+	m_origin(std::chrono::steady_clock::now())
+	{
+	}
+
+	std::size_t CompilationStats::BeginPhase(std::string_view category, std::string_view name)
+	{
+		std::uint64_t allocationCount = (m_allocationCounter) ? m_allocationCounter() : 0;
+		auto now = std::chrono::steady_clock::now();
+
+		std::unique_lock lock(m_mutex);
+
+		auto threadIt = m_threads.find(std::this_thread::get_id());
+		if (threadIt == m_threads.end())
+		{
+			ThreadData threadData;
+			threadData.index = m_threads.size();
+
+			threadIt = m_threads.emplace(std::this_thread::get_id(), threadData).first;
+		}
+
+		ThreadData& threadData = threadIt->second;
+
+		std::size_t phaseIndex = m_phases.size();
+
+		auto& phase = m_phases.emplace_back();
+		phase.category = category;
+		phase.name = name;
+		phase.start = std::chrono::duration_cast<std::chrono::microseconds>(now - m_origin);
+		phase.duration = std::chrono::microseconds::zero();
+		phase.depth = threadData.depth++;
+		phase.threadIndex = threadData.index;
+		phase.finished = false;
+
+		auto& phaseData = m_phaseData.emplace_back();
+		phaseData.start = now;
+		phaseData.startAllocationCount = allocationCount;
+
+		return phaseIndex;
+	}
+
+	void CompilationStats::Clear()
+	{
+		std::unique_lock lock(m_mutex);
+		m_origin = std::chrono::steady_clock::now();
+		m_phases.clear();
+		m_phaseData.clear();
+		m_threads.clear();
+	}
+
+	void CompilationStats::EndPhase(std::size_t phaseIndex, std::optional<std::size_t> nodeCount)
+	{
+		std::uint64_t allocationCount = (m_allocationCounter) ? m_allocationCounter() : 0;
+		auto now = std::chrono::steady_clock::now();
+
+		std::unique_lock lock(m_mutex);
+		if (phaseIndex >= m_phases.size())
+			return; //< stats were cleared while the phase was running
+
+		auto& phase = m_phases[phaseIndex];
+		assert(!phase.finished);
+
+		const auto& phaseData = m_phaseData[phaseIndex];
+
+		phase.duration = std::chrono::duration_cast<std::chrono::microseconds>(now - phaseData.start);
+		phase.nodeCount = nodeCount;
+		if (m_allocationCounter)
+			phase.allocationCount = allocationCount - phaseData.startAllocationCount;
+
+		phase.finished = true;
+
+		if (auto threadIt = m_threads.find(std::this_thread::get_id()); threadIt != m_threads.end())
+		{
+			assert(threadIt->second.depth > 0);
+			threadIt->second.depth--;
+		}
+	}
+
+	auto CompilationStats::GetPhases() const -> std::vector<Phase>
+	{
+		std::unique_lock lock(m_mutex);
+		return m_phases;
+	}
+
+	void CompilationStats::SetAllocationCounter(AllocationCounter allocationCounter)
+	{
+		// must not be called while a phase is running
+		m_allocationCounter = std::move(allocationCounter);
+	}
+
+	std::size_t CompilationStats::CountNodes(const Ast::Module& module)
+	{
+		std::size_t nodeCount = 0;
+		for (const auto& importedModule : module.importedModules)
+			nodeCount += CountNodes(*importedModule.module);
+
+		if (module.rootNode)
+			nodeCount += CountNodes(*module.rootNode);
+
+		return nodeCount;
+	}
+
+	std::size_t CompilationStats::CountNodes(Ast::Statement& statement)
+	{
+		NodeCounterVisitor visitor;
+		statement.Visit(visitor);
+
+		return visitor.nodeCount;
+	}
+}
@@ -5,6 +5,8 @@
 #include <NZSL/FilesystemModuleResolver.hpp>
 #include <NazaraUtils/PathUtils.hpp>
 #include <NZSL/Archive.hpp>
+#include <NZSL/Lexer.hpp>
+#include <NZSL/ParallelFor.hpp>
 #include <NZSL/Parser.hpp>
 #include <NZSL/Ast/AstSerializer.hpp>
 #ifdef NZSL_EFSW
@@ -13,10 +15,102 @@
 #include <fmt/format.h>
 #include <cassert>
 #include <cctype>
+#include <algorithm>
 #include <fstream>
+#include <optional>
+#include <thread>
 
 namespace nzsl
 {
+	namespace
+	{
+		Ast::ModulePtr LoadArchiveModule(const Archive::ModuleData& moduleData, const std::unordered_set<std::string>* requestedSymbols = nullptr)
+		{
+			std::vector<std::uint8_t> data = Archive::DecompressModule(&moduleData.data[0], moduleData.data.size(), moduleData.flags);
+			switch (moduleData.kind)
+			{
+				case ArchiveEntryKind::BinaryShaderModule:
+				{
+					Deserializer deserializer(&data[0], data.size());
+					if (requestedSymbols)
+						return Ast::DeserializeShader(deserializer, *requestedSymbols);
+
+					return Ast::DeserializeShader(deserializer);
+				}
+			}
+
+			throw std::runtime_error("unexpected archive entry kind");
+		}
+
+		void ThrowErrors(const std::vector<std::string>& errors)
+		{
+			std::string errorMessage;
+			for (const std::string& error : errors)
+			{
+				if (error.empty())
+					continue;
+
+				if (!errorMessage.empty())
+					errorMessage += '\n';
+
+				errorMessage += error;
+			}
+
+			if (!errorMessage.empty())
+				throw std::runtime_error(errorMessage);
+		}
+
+		// Reads the module name from the module statement without parsing the whole source (returns nothing for anonymous modules)
+		std::optional<std::string> ScanModuleName(std::string_view moduleSource, const std::string& filePath)
+		{
+			std::vector<Token> tokens = Tokenize(moduleSource, filePath);
+
+			std::size_t tokenIndex = 0;
+
+			// Skip module attributes
+			while (tokens[tokenIndex].type == TokenType::OpenSquareBracket)
+			{
+				std::size_t depth = 0;
+				do
+				{
+					switch (tokens[tokenIndex].type)
+					{
+						case TokenType::OpenSquareBracket: depth++; break;
+						case TokenType::ClosingSquareBracket: depth--; break;
+						case TokenType::EndOfStream: throw std::runtime_error("unexpected end of file in module attributes");
+						default: break;
+					}
+
+					tokenIndex++;
+				}
+				while (depth > 0);
+			}
+
+			if (tokens[tokenIndex].type != TokenType::Module)
+				throw std::runtime_error("expected module statement");
+
+			tokenIndex++;
+			if (tokens[tokenIndex].type != TokenType::Identifier)
+				return std::nullopt;
+
+			std::string moduleName = std::get<std::string>(tokens[tokenIndex++].data);
+			while (tokens[tokenIndex].type == TokenType::Dot && tokens[tokenIndex + 1].type == TokenType::Identifier)
+			{
+				moduleName += '.';
+				moduleName += std::get<std::string>(tokens[tokenIndex + 1].data);
+
+				tokenIndex += 2;
+			}
+
+			return moduleName;
+		}
+	}
+
+	FilesystemModuleResolver::FilesystemModuleResolver() :
+	m_threadCount(std::max(std::thread::hardware_concurrency(), 1u))
+	{
+	}
+
 	FilesystemModuleResolver::~FilesystemModuleResolver()
 	{
 #ifdef NZSL_EFSW
@@ -27,19 +121,53 @@ namespace nzsl
 
 	void FilesystemModuleResolver::RegisterArchive(const Archive& archive)
 	{
-		for (const Archive::ModuleData& moduleData : archive.GetModules())
+		const std::vector<Archive::ModuleData>& modules = archive.GetModules();
+
+		if (m_lazyLoading)
 		{
-			std::vector<std::uint8_t> data = Archive::DecompressModule(&moduleData.data[0], moduleData.data.size(), moduleData.flags);
-			switch (moduleData.kind)
+			for (const Archive::ModuleData& moduleData : modules)
 			{
-				case ArchiveEntryKind::BinaryShaderModule:
+				auto lazyModuleData = std::make_shared<Archive::ModuleData>(moduleData);
+
+				ModuleLoader moduleLoader;
+				moduleLoader.load = [lazyModuleData]
 				{
-					Deserializer deserializer(&data[0], data.size());
-					RegisterModule(Ast::DeserializeShader(deserializer));
-					break;
-				}
+					return LoadArchiveModule(*lazyModuleData);
+				};
+
+				moduleLoader.loadSymbols = [lazyModuleData](const std::unordered_set<std::string>& symbols)
+				{
+					return LoadArchiveModule(*lazyModuleData, &symbols);
+				};
+
+				RegisterModuleLoader(moduleData.name, std::move(moduleLoader));
 			}
+
+			return;
 		}
+
+		// Decompress and deserialize in parallel, then register in archive order
+		std::vector<Ast::ModulePtr> loadedModules(modules.size());
+		std::vector<std::string> errors(modules.size());
+		ParallelFor(modules.size(), m_threadCount, [&](std::size_t moduleIndex)
+		{
+			try
+			{
+				loadedModules[moduleIndex] = LoadArchiveModule(modules[moduleIndex]);
+			}
+			catch (const std::exception& e)
+			{
+				errors[moduleIndex] = fmt::format("failed to load archive module {}: {}", modules[moduleIndex].name, e.what());
+			}
+		});
+
+		for (Ast::ModulePtr& module : loadedModules)
+		{
+			if (module)
+				RegisterModule(std::move(module));
+		}
+
+		ThrowErrors(errors);
 	}
 
 	void FilesystemModuleResolver::RegisterDirectory(const std::filesystem::path& realPath, bool watchDirectory)
@@ -86,70 +214,60 @@ namespace nzsl
 #endif
 		}
 
+		std::vector<std::filesystem::path> filePaths;
 		for (const auto& entry : std::filesystem::recursive_directory_iterator(realPath))
 		{
 			if (entry.is_regular_file() && CheckExtension(Nz::PathToString(entry.path())))
-			{
-				try
-				{
-					RegisterFile(entry.path());
-				}
-				catch (const std::exception& e)
-				{
-					throw std::runtime_error(fmt::format("failed to register module {}: {}", Nz::PathToString(entry.path()), e.what()));
-				}
-			}
+				filePaths.push_back(entry.path());
 		}
-	}
 
-	void FilesystemModuleResolver::RegisterFile(const std::filesystem::path& realPath)
-	{
-		Ast::ModulePtr module;
-		try
-		{
-			std::uintmax_t filesize = std::filesystem::file_size(realPath);
-			if (filesize == 0)
-				return; //< ignore empty files
+		// Iteration order depends on the filesystem, sort files so modules are always registered in the same order
+		std::sort(filePaths.begin(), filePaths.end());
 
-			std::ifstream inputFile(realPath, std::ios::in | std::ios::binary);
-			if (!inputFile)
-				throw std::runtime_error("failed to open " + Nz::PathToString(realPath));
+		std::vector<FileData> files(filePaths.size());
+		std::vector<std::string> errors(filePaths.size());
+		ParallelFor(filePaths.size(), m_threadCount, [&](std::size_t fileIndex)
+		{
+			try
+			{
+				files[fileIndex] = LoadFile(filePaths[fileIndex]);
+			}
+			catch (const std::exception& e)
+			{
+				errors[fileIndex] = e.what();
+			}
+		});
 
-			std::vector<char> content(Nz::SafeCast<std::size_t>(filesize));
-			if (!inputFile.read(&content[0], Nz::SafeCast<std::size_t>(filesize)))
-				throw std::runtime_error("failed to read " + Nz::PathToString(realPath));
+		for (std::size_t i = 0; i < files.size(); ++i)
+		{
+			if (!errors[i].empty())
+				continue;
 
-			std::string ext = Nz::PathToString(realPath.extension());
-			if (ext == BinaryModuleExtension)
+			try
 			{
-				Deserializer deserializer(content.data(), content.size());
-				module = Ast::DeserializeShader(deserializer);
+				RegisterFileData(filePaths[i], std::move(files[i]));
 			}
-			else if (ext == ArchiveExtension)
+			catch (const std::exception& e)
 			{
-				Deserializer deserializer(content.data(), content.size());
-				RegisterArchive(DeserializeArchive(deserializer));
+				errors[i] = fmt::format("failed to register module {}: {}", Nz::PathToString(filePaths[i]), e.what());
 			}
-			else if (ext == ModuleExtension)
-				module = Parse(std::string_view(content.data(), content.size()), Nz::PathToString(realPath));
-			else
-				throw std::runtime_error("unknown extension " + ext);
+		}
+
+		ThrowErrors(errors);
+	}
+
+	void FilesystemModuleResolver::RegisterFile(const std::filesystem::path& realPath)
+	{
+		FileData fileData = LoadFile(realPath);
+
+		try
+		{
+			RegisterFileData(realPath, std::move(fileData));
 		}
 		catch (const std::exception& e)
 		{
 			throw std::runtime_error(fmt::format("failed to register module {}: {}", Nz::PathToString(realPath), e.what()));
 		}
-
-		if (!module)
-			return;
-
-		std::lock_guard lock(m_moduleLock);
-
-		std::string moduleName = module->metadata->moduleName;
-		RegisterModule(std::move(module));
-
-		std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(realPath);
-		m_moduleByFilepath.emplace(Nz::PathToString(canonicalPath), std::move(moduleName));
 	}
 
 	void FilesystemModuleResolver::RegisterModule(std::string_view moduleSource)
@@ -171,6 +289,8 @@ namespace nzsl
 
 		std::lock_guard lock(m_moduleLock);
 
+		m_moduleLoaders.erase(moduleName);
+
 		auto it = m_modules.find(moduleName);
 		if (it != m_modules.end())
 		{
@@ -184,11 +304,193 @@ namespace nzsl
 
 	Ast::ModulePtr FilesystemModuleResolver::Resolve(const std::string& moduleName)
 	{
-		auto it = m_modules.find(moduleName);
-		if (it == m_modules.end())
-			return {};
+		ModuleLoader moduleLoader;
+		{
+			std::lock_guard lock(m_moduleLock);
+
+			if (auto it = m_modules.find(moduleName); it != m_modules.end())
+				return it->second;
+
+			auto loaderIt = m_moduleLoaders.find(moduleName);
+			if (loaderIt == m_moduleLoaders.end())
+				return {};
+
+			moduleLoader = loaderIt->second;
+		}
+
+		// Load the module without holding the lock so other modules can be resolved meanwhile
+		Ast::ModulePtr module = moduleLoader.load();
+		if (module->metadata->moduleName != moduleName)
+			throw std::runtime_error(fmt::format("module {} was registered as {}", module->metadata->moduleName, moduleName));
+
+		std::lock_guard lock(m_moduleLock);
+
+		// Another thread may have loaded it in the meantime
+		if (auto it = m_modules.find(moduleName); it != m_modules.end())
+			return it->second;
+
+		m_moduleLoaders.erase(moduleName);
+		m_modules.emplace(moduleName, module);
+
+		return module;
+	}
+
+	Ast::ModulePtr FilesystemModuleResolver::ResolveSymbols(const std::string& moduleName, const std::unordered_set<std::string>& symbols)
+	{
+		std::function<Ast::ModulePtr(const std::unordered_set<std::string>& symbols)> symbolLoader;
+		{
+			std::lock_guard lock(m_moduleLock);
+
+			if (auto it = m_modules.find(moduleName); it != m_modules.end())
+				return it->second;
+
+			auto loaderIt = m_moduleLoaders.find(moduleName);
+			if (loaderIt == m_moduleLoaders.end())
+				return {};
+
+			symbolLoader = loaderIt->second.loadSymbols;
+		}
+
+		if (!symbolLoader)
+			return Resolve(moduleName);
 
-		return it->second;
+		// Partially loaded modules depend on the requested symbols, they're not kept
+		Ast::ModulePtr module = symbolLoader(symbols);
+		if (module->metadata->moduleName != moduleName)
+			throw std::runtime_error(fmt::format("module {} was registered as {}", module->metadata->moduleName, moduleName));
+
+		return module;
+	}
+
+	auto FilesystemModuleResolver::LoadFile(const std::filesystem::path& realPath) const -> FileData
+	{
+		FileData fileData;
+		try
+		{
+			std::uintmax_t filesize = std::filesystem::file_size(realPath);
+			if (filesize == 0)
+				return fileData; //< ignore empty files
+
+			std::ifstream inputFile(realPath, std::ios::in | std::ios::binary);
+			if (!inputFile)
+				throw std::runtime_error("failed to open " + Nz::PathToString(realPath));
+
+			auto content = std::make_shared<std::vector<char>>(Nz::SafeCast<std::size_t>(filesize));
+			if (!inputFile.read(content->data(), Nz::SafeCast<std::size_t>(filesize)))
+				throw std::runtime_error("failed to read " + Nz::PathToString(realPath));
+
+			std::string ext = Nz::PathToString(realPath.extension());
+			if (ext == BinaryModuleExtension)
+			{
+				Deserializer deserializer(content->data(), content->size());
+				if (m_lazyLoading)
+				{
+					fileData.moduleName = Ast::DeserializeShaderMetadata(deserializer)->moduleName;
+					fileData.moduleLoader.load = [content]
+					{
+						Deserializer moduleDeserializer(content->data(), content->size());
+						return Ast::DeserializeShader(moduleDeserializer);
+					};
+
+					fileData.moduleLoader.loadSymbols = [content](const std::unordered_set<std::string>& symbols)
+					{
+						Deserializer moduleDeserializer(content->data(), content->size());
+						return Ast::DeserializeShader(moduleDeserializer, symbols);
+					};
+				}
+				else
+					fileData.module = Ast::DeserializeShader(deserializer);
+			}
+			else if (ext == ArchiveExtension)
+			{
+				Deserializer deserializer(content->data(), content->size());
+				fileData.archive = DeserializeArchive(deserializer);
+			}
+			else if (ext == ModuleExtension)
+			{
+				std::string filePath = Nz::PathToString(realPath);
+				std::string_view moduleSource(content->data(), content->size());
+				if (m_lazyLoading)
+				{
+					std::optional<std::string> scannedName = ScanModuleName(moduleSource, filePath);
+					if (!scannedName)
+						return fileData; //< anonymous modules cannot be imported
+
+					fileData.moduleName = std::move(*scannedName);
+					fileData.moduleLoader.load = [content, filePath = std::move(filePath)]
+					{
+						return Parse(std::string_view(content->data(), content->size()), filePath);
+					};
+				}
+				else
+					fileData.module = Parse(moduleSource, filePath);
+			}
+			else
+				throw std::runtime_error("unknown extension " + ext);
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error(fmt::format("failed to register module {}: {}", Nz::PathToString(realPath), e.what()));
+		}
+
+		return fileData;
+	}
+
+	void FilesystemModuleResolver::RegisterFileData(const std::filesystem::path& realPath, FileData&& fileData)
+	{
+		if (fileData.archive)
+			return RegisterArchive(*fileData.archive);
+
+		if (!fileData.module && !fileData.moduleLoader.load)
+			return;
+
+		std::lock_guard lock(m_moduleLock);
+
+		std::string moduleName;
+		if (fileData.module)
+		{
+			moduleName = fileData.module->metadata->moduleName;
+			RegisterModule(std::move(fileData.module));
+		}
+		else
+		{
+			moduleName = std::move(fileData.moduleName);
+
+			std::string filePath = Nz::PathToString(realPath);
+
+			ModuleLoader moduleLoader;
+			moduleLoader.load = [load = std::move(fileData.moduleLoader.load), filePath]
+			{
+				try
+				{
+					return load();
+				}
+				catch (const std::exception& e)
+				{
+					throw std::runtime_error(fmt::format("failed to load module {}: {}", filePath, e.what()));
+				}
+			};
+
+			if (fileData.moduleLoader.loadSymbols)
+			{
+				moduleLoader.loadSymbols = [loadSymbols = std::move(fileData.moduleLoader.loadSymbols), filePath](const std::unordered_set<std::string>& symbols)
+				{
+					try
+					{
+						return loadSymbols(symbols);
+					}
+					catch (const std::exception& e)
+					{
+						throw std::runtime_error(fmt::format("failed to load module {}: {}", filePath, e.what()));
+					}
+				};
+			}
+
+			RegisterModuleLoader(moduleName, std::move(moduleLoader));
+		}
+
+		std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(realPath);
+		m_moduleByFilepath.emplace(Nz::PathToString(canonicalPath), std::move(moduleName));
 	}
 
 	void FilesystemModuleResolver::OnFileAdded(std::string_view directory, std::string_view filename)
@@ -221,6 +523,7 @@ namespace nzsl
 		if (it != m_moduleByFilepath.end())
 		{
 			m_modules.erase(it->second);
+			m_moduleLoaders.erase(it->second);
 			m_moduleByFilepath.erase(it);
 		}
 	}
@@ -264,6 +567,23 @@ namespace nzsl
 		}
 	}
 	
+	void FilesystemModuleResolver::RegisterModuleLoader(const std::string& moduleName, ModuleLoader moduleLoader)
+	{
+		if (moduleName.empty())
+			throw std::runtime_error("cannot register anonymous module");
+
+		std::unique_lock lock(m_moduleLock);
+
+		// Module was already loaded (file update), reload it right away to notify users
+		if (m_modules.find(moduleName) != m_modules.end())
+		{
+			lock.unlock();
+			return RegisterModule(moduleLoader.load());
+		}
+
+		m_moduleLoaders.insert_or_assign(moduleName, std::move(moduleLoader));
+	}
+
 	bool FilesystemModuleResolver::CheckExtension(std::string_view filename)
 	{
 		auto EndsWith = [](std::string_view lhs, std::string_view rhs)
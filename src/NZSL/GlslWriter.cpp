@@ -7,17 +7,21 @@
 #include <NazaraUtils/Bitset.hpp>
 #include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/PathUtils.hpp>
+#include <NZSL/CompilationStats.hpp>
 #include <NZSL/Enums.hpp>
-#include <NZSL/Ast/ConstantPropagationVisitor.hpp>
+#include <NZSL/Ast/Cloner.hpp>
 #include <NZSL/Ast/ConstantValue.hpp>
-#include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/PassManager.hpp>
+#include <NZSL/Ast/PrecisionInferenceVisitor.hpp>
 #include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <NZSL/Ast/Utils.hpp>
+#include <NZSL/Ast/VaryingPacking.hpp>
 #include <NZSL/Lang/LangData.hpp>
 #include <fmt/format.h>
 #include <frozen/unordered_map.h>
 #include <frozen/unordered_set.h>
 #include <tsl/ordered_set.h>
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <optional>
@@ -38,6 +42,7 @@ namespace nzsl
 		constexpr std::string_view s_glslWriterVaryingPrefix = "_nzslVarying";
 		constexpr std::string_view s_glslWriterInputPrefix = "_nzslIn";
 		constexpr std::string_view s_glslWriterOutputPrefix = "_nzslOut";
+		constexpr std::string_view s_glslWriterPackedSuffix = "Packed";
 		constexpr std::string_view s_glslWriterOutputVarName = "_nzslOutput";
 
 		bool IsIntegerMix(Ast::IntrinsicExpression& node)
@@ -346,6 +351,7 @@ namespace nzsl
 		std::unordered_map<std::string, unsigned int> explicitUniformBlockBinding;
 		std::unordered_set<std::string> reservedNames;
 		Nz::Bitset<> declaredFunctions;
+		Nz::Bitset<> relaxedVariables;
 		const GlslWriter::BindingMapping& bindingMapping;
 		GlslWriterPreVisitor previsitor;
 		ShaderStageType stage;
@@ -376,6 +382,7 @@ namespace nzsl
 			Ast::SanitizeVisitor::Options options = GetSanitizeOptions();
 			options.optionValues = states.optionValues;
 			options.moduleResolver = states.shaderModuleResolver;
+			options.compilationStats = states.compilationStats;
 
 			sanitizedModule = Ast::Sanitize(module, options);
 			targetModule = sanitizedModule.get();
@@ -385,16 +392,33 @@ namespace nzsl
 
 		if (states.optimize)
 		{
-			sanitizedModule = Ast::PropagateConstants(*targetModule);
+			Ast::AlgebraicSimplificationVisitor::Options simplificationOptions;
+			simplificationOptions.fastMath = states.fastMath;
 
 			Ast::DependencyCheckerVisitor::Config dependencyConfig;
 			dependencyConfig.usedShaderStages = (shaderStage) ? *shaderStage : ShaderStageType_All; //< only one should exist anyway
 
-			sanitizedModule = Ast::EliminateUnusedPass(*sanitizedModule, dependencyConfig);
+			Ast::PassManager passManager = Ast::PassManager::BuildPreset(states.optimizationLevel, dependencyConfig, simplificationOptions);
+			if (passManager.GetPassCount() > 0)
+			{
+				// the sanitized module belongs to us and can be optimized in place
+				if (!sanitizedModule)
+					sanitizedModule = std::make_shared<Ast::Module>(targetModule->metadata, Nz::StaticUniquePointerCast<Ast::MultiStatement>(Ast::Clone(*targetModule->rootNode)), targetModule->importedModules);
 
-			targetModule = sanitizedModule.get();
+				passManager.Run(*sanitizedModule, states.compilationStats);
+				targetModule = sanitizedModule.get();
+			}
 		}
 
+		// only GLSL ES makes use of precision qualifiers
+		if (states.inferPrecision && m_environment.glES)
+			state.relaxedVariables = Ast::InferRelaxedPrecisionVariables(*targetModule);
+
+		if (states.packVaryings)
+			Ast::ValidateVaryingPacking(*targetModule);
+
+		CompilationStats::Scope codegenScope(states.compilationStats, "codegen", "GLSL generation");
+
 		// Previsitor
 		for (Ast::ModuleFeature feature : targetModule->metadata->enabledFeatures)
 		{
@@ -682,6 +706,15 @@ namespace nzsl
 		throw std::runtime_error("unexpected method type");
 	}
 
+	void GlslWriter::Append(Ast::PrecisionQualifier precision)
+	{
+		switch (precision)
+		{
+			case Ast::PrecisionQualifier::High:   return Append("highp");
+			case Ast::PrecisionQualifier::Medium: return Append("mediump");
+		}
+	}
+
 	void GlslWriter::Append(Ast::PrimitiveType type)
 	{
 		switch (type)
@@ -808,6 +841,7 @@ namespace nzsl
 	{
 		switch (layout)
 		{
+			case Ast::MemoryLayout::Scalar: throw std::runtime_error("scalar layout is not supported by GLSL");
 			case Ast::MemoryLayout::Std140: Append("std140"); break;
 			case Ast::MemoryLayout::Std430: Append("std430"); break;
 		}
@@ -1364,6 +1398,15 @@ namespace nzsl
 			AppendComment("License: " + metadata.license);
 	}
 
+	void GlslWriter::AppendPrecisionQualifier(const Ast::ExpressionValue<Ast::PrecisionQualifier>& precision)
+	{
+		// precision qualifiers have no effect outside of GLSL ES
+		if (!m_environment.glES || !precision.HasValue())
+			return;
+
+		Append(precision.GetResultingValue(), " ");
+	}
+
 	void GlslWriter::AppendStatementList(std::vector<Ast::StatementPtr>& statements)
 	{
 		bool first = true;
@@ -1464,8 +1507,59 @@ namespace nzsl
 		{
 			bool empty = true;
 
-			for (const auto& member : structData.desc->members)
+			// only varyings between vertex and fragment stages are packed
+			std::optional<Ast::VaryingPacking> packing;
+			if (m_currentState->states->packVaryings && m_currentState->stage == ((in) ? ShaderStageType::Fragment : ShaderStageType::Vertex))
+				packing = Ast::PackVaryings(*structData.desc);
+
+			std::vector<std::string> packedVaryingNames;
+			if (packing)
+				packedVaryingNames.resize(packing->packedVaryings.size());
+
+			auto AppendVariable = [&](const Ast::ExpressionValue<Ast::InterpolationQualifier>& interp, const Ast::ExpressionValue<Ast::PrecisionQualifier>& precision, const Ast::ExpressionType& type, std::optional<std::uint32_t> locationIndex, std::string varName) -> std::string
 			{
+				auto WriteVariable = [&](auto&&... arg)
+				{
+					if (interp.HasValue())
+						Append(interp.GetResultingValue(), " ");
+
+					Append((in) ? "in" : "out", " ");
+					AppendPrecisionQualifier(precision);
+					AppendVariableDeclaration(type, varName);
+					AppendLine(";", arg...);
+				};
+
+				if (locationIndex)
+				{
+					bool isSupported = m_currentState->supportsVaryingLocations
+					                || (in && m_currentState->stage == nzsl::ShaderStageType::Vertex)
+					                || (!in && m_currentState->stage == nzsl::ShaderStageType::Fragment);
+
+					if (isSupported)
+					{
+						Append("layout(location = ");
+						Append(*locationIndex);
+						Append(") ");
+
+						WriteVariable();
+					}
+					else
+					{
+						std::string originalName = std::move(varName);
+						varName = std::string(s_glslWriterVaryingPrefix) + std::to_string(*locationIndex);
+						WriteVariable(" // ", originalName);
+					}
+				}
+				else
+					WriteVariable();
+
+				return varName;
+			};
+
+			for (std::size_t memberIndex = 0; memberIndex < structData.desc->members.size(); ++memberIndex)
+			{
+				const auto& member = structData.desc->members[memberIndex];
+
 				if (member.cond.HasValue() && !member.cond.GetResultingValue())
 					continue;
 
@@ -1490,40 +1584,46 @@ namespace nzsl
 
 					std::string varName = std::string(targetPrefix) + member.name;
 
-					auto WriteVariable = [&](auto&&... arg)
+					if (packing && member.locationIndex.HasValue())
 					{
-						if (member.interp.HasValue())
-							Append(member.interp.GetResultingValue(), " ");
+						auto it = std::find_if(packing->locations.begin(), packing->locations.end(), [&](const Ast::VaryingLocation& location) { return location.memberIndex == memberIndex; });
+						assert(it != packing->locations.end());
 
-						Append((in) ? "in" : "out", " ");
-						AppendVariableDeclaration(member.type.GetResultingValue(), varName);
-						AppendLine(";", arg...);
-					};
+						if (it->packedVaryingIndex)
+						{
+							const Ast::PackedVarying& packedVarying = packing->packedVaryings[*it->packedVaryingIndex];
 
-					if (member.locationIndex.HasValue())
-					{
-						bool isSupported = m_currentState->supportsVaryingLocations
-						                || (in && m_currentState->stage == nzsl::ShaderStageType::Vertex)
-						                || (!in && m_currentState->stage == nzsl::ShaderStageType::Fragment);
+							// declare the shared variable along its first member
+							std::string& packedVarName = packedVaryingNames[*it->packedVaryingIndex];
+							if (packedVarName.empty())
+							{
+								Ast::ExpressionValue<Ast::InterpolationQualifier> packedInterp;
+								if (packedVarying.interpolation != Ast::InterpolationQualifier::Smooth)
+									packedInterp = packedVarying.interpolation;
 
-						if (isSupported)
-						{
-							Append("layout(location = ");
-							Append(member.locationIndex.GetResultingValue());
-							Append(") ");
+								Ast::ExpressionValue<Ast::PrecisionQualifier> packedPrecision;
+								if (packedVarying.relaxedPrecision)
+									packedPrecision = Ast::PrecisionQualifier::Medium;
+
+								Ast::ExpressionType packedType = Ast::VectorType{ packedVarying.componentCount, packedVarying.componentType };
+								packedVarName = AppendVariable(packedInterp, packedPrecision, packedType, packedVarying.location, std::string(targetPrefix) + std::string(s_glslWriterPackedSuffix) + std::to_string(packedVarying.location));
+							}
 
-							WriteVariable();
+							constexpr std::string_view componentNames = "xyzw";
+							varName = packedVarName + "." + std::string(componentNames.substr(it->firstComponent, it->componentCount));
 						}
 						else
-						{
-							std::string originalName = std::move(varName);
-							varName = std::string(s_glslWriterVaryingPrefix) + std::to_string(member.locationIndex.GetResultingValue());
-							WriteVariable(" // ", originalName);
-						}
+							varName = AppendVariable(member.interp, member.precision, member.type.GetResultingValue(), it->location, std::move(varName));
 					}
 					else
-						WriteVariable();
-					
+					{
+						std::optional<std::uint32_t> locationIndex;
+						if (member.locationIndex.HasValue())
+							locationIndex = member.locationIndex.GetResultingValue();
+
+						varName = AppendVariable(member.interp, member.precision, member.type.GetResultingValue(), locationIndex, std::move(varName));
+					}
+
 					fields.push_back({
 						member.name,
 						varName
@@ -1671,15 +1771,15 @@ namespace nzsl
 		if (node.op == Ast::AssignType::CompoundModulo)
 		{
 			bool isFmod = false;
-			if (IsPrimitiveType(*node.cachedExpressionType))
+			if (IsPrimitiveType(node.cachedExpressionType->Get()))
 			{
-				Ast::PrimitiveType primitiveType = std::get<Ast::PrimitiveType>(*node.cachedExpressionType);
+				Ast::PrimitiveType primitiveType = std::get<Ast::PrimitiveType>(node.cachedExpressionType->Get());
 				if (primitiveType == Ast::PrimitiveType::Float32 || primitiveType == Ast::PrimitiveType::Float64)
 					isFmod = true;
 			}
-			else if (IsVectorType(*node.cachedExpressionType))
+			else if (IsVectorType(node.cachedExpressionType->Get()))
 			{
-				Ast::PrimitiveType primitiveType = std::get<Ast::VectorType>(*node.cachedExpressionType).type;
+				Ast::PrimitiveType primitiveType = std::get<Ast::VectorType>(node.cachedExpressionType->Get()).type;
 				if (primitiveType == Ast::PrimitiveType::Float32 || primitiveType == Ast::PrimitiveType::Float64)
 					isFmod = true;
 			}
@@ -1727,7 +1827,7 @@ namespace nzsl
 			case Ast::BinaryType::CompLe:
 			case Ast::BinaryType::CompLt:
 			{
-				if (IsVectorType(*node.cachedExpressionType))
+				if (IsVectorType(node.cachedExpressionType->Get()))
 				{
 					constexpr auto s_vecComparison = frozen::make_unordered_map<Ast::BinaryType, std::string_view>({
 						{ Ast::BinaryType::CompEq, "equal" },
@@ -1764,20 +1864,20 @@ namespace nzsl
 					Append(")");
 				};
 
-				if (IsPrimitiveType(*node.cachedExpressionType))
+				if (IsPrimitiveType(node.cachedExpressionType->Get()))
 				{
-					Ast::PrimitiveType primitiveType = std::get<Ast::PrimitiveType>(*node.cachedExpressionType);
+					Ast::PrimitiveType primitiveType = std::get<Ast::PrimitiveType>(node.cachedExpressionType->Get());
 					if (primitiveType == Ast::PrimitiveType::Float32 || primitiveType == Ast::PrimitiveType::Float64)
 						return BuildFmod();
 				}
-				else if (IsVectorType(*node.cachedExpressionType))
+				else if (IsVectorType(node.cachedExpressionType->Get()))
 				{
-					const Ast::VectorType& vecType = std::get<Ast::VectorType>(*node.cachedExpressionType);
+					const Ast::VectorType& vecType = std::get<Ast::VectorType>(node.cachedExpressionType->Get());
 					Ast::PrimitiveType primitiveType = vecType.type;
 					if (primitiveType == Ast::PrimitiveType::Float32 || primitiveType == Ast::PrimitiveType::Float64)
 					{
 						// Special case: primitive % vector, this isn't supported by mod intrinsic, turn primitive into a vec
-						if (IsPrimitiveType(*node.left->cachedExpressionType))
+						if (IsPrimitiveType(node.left->cachedExpressionType->Get()))
 						{
 							Append("mod(");
 							Append(vecType, "(");
@@ -1873,7 +1973,7 @@ namespace nzsl
 
 	void GlslWriter::Visit(Ast::ConstantArrayValueExpression& node)
 	{
-		AppendArray(*node.cachedExpressionType);
+		AppendArray(node.cachedExpressionType->Get());
 		m_currentState->indentLevel++;
 		AppendLine("(");
 		std::visit([&](auto&& vec)
@@ -2258,6 +2358,7 @@ namespace nzsl
 				{
 					switch (structInfo.desc->layout.GetResultingValue())
 					{
+						case Ast::MemoryLayout::Scalar: throw std::runtime_error("scalar layout is not supported by GLSL (struct " + structInfo.desc->name + " is used by external " + externalVar.name + ")");
 						case Ast::MemoryLayout::Std140: memoryLayout = "std140"; break;
 						case Ast::MemoryLayout::Std430: memoryLayout = "std430"; break;
 					}
@@ -2405,6 +2506,7 @@ namespace nzsl
 						if (!member.tag.empty() && m_currentState->states->debugLevel >= DebugLevel::Minimal)
 							AppendComment("member tag: " + member.tag);
 
+						AppendPrecisionQualifier(member.precision);
 						AppendVariableDeclaration(member.type.GetResultingValue(), member.name);
 						Append(";");
 					}
@@ -2521,6 +2623,7 @@ namespace nzsl
 				if (!member.tag.empty() && m_currentState->states->debugLevel >= DebugLevel::Minimal)
 					AppendComment("member tag: " + member.tag);
 
+				AppendPrecisionQualifier(member.precision);
 				AppendVariableDeclaration(member.type.GetResultingValue(), member.name);
 				Append(";");
 			}
@@ -2550,6 +2653,9 @@ namespace nzsl
 			varName = std::move(candidateName);
 		}
 
+		if (m_currentState->relaxedVariables.UnboundedTest(*node.varIndex))
+			Append(Ast::PrecisionQualifier::Medium, " ");
+
 		AppendVariableDeclaration(node.varType.GetResultingValue(), varName);
 		RegisterVariable(*node.varIndex, std::move(varName));
 		
@@ -40,6 +40,7 @@ namespace nzsl::LangData
 		{ Ast::AttributeType::License,            { "license" } },
 		{ Ast::AttributeType::Location,           { "location" } },
 		{ Ast::AttributeType::LangVersion,        { "nzsl_version" } },
+		{ Ast::AttributeType::Precision,          { "precision" } },
 		{ Ast::AttributeType::Set,                { "set" } },
 		{ Ast::AttributeType::Tag,                { "tag" } },
 		{ Ast::AttributeType::Unroll,             { "unroll" } },
@@ -238,8 +239,9 @@ namespace nzsl::LangData
 	};
 
 	constexpr auto s_memoryLayouts = frozen::make_unordered_map<Ast::MemoryLayout, MemoryLayoutData>({
+		{ Ast::MemoryLayout::Scalar, { "scalar", StructLayout::Scalar } },
 		{ Ast::MemoryLayout::Std140, { "std140", StructLayout::Std140 } },
-		{ Ast::MemoryLayout::Std430, { "std430", StructLayout::Std140 } }
+		{ Ast::MemoryLayout::Std430, { "std430", StructLayout::Std430 } }
 	});
 
 	constexpr auto s_moduleFeatures = frozen::make_unordered_map<Ast::ModuleFeature, ModuleFeatureData>({
@@ -248,6 +250,16 @@ namespace nzsl::LangData
 		{ Ast::ModuleFeature::Texture1D,          { "texture1D" } },
 	});
 
+	struct PrecisionData
+	{
+		std::string_view identifier;
+	};
+
+	constexpr auto s_precisions = frozen::make_unordered_map<Ast::PrecisionQualifier, PrecisionData>({
+		{ Ast::PrecisionQualifier::High,   { "high" } },
+		{ Ast::PrecisionQualifier::Medium, { "medium" } }
+	});
+
 	struct LoopUnrollData
 	{
 		std::string_view identifier;
@@ -5,6 +5,7 @@
 #include <NZSL/LangWriter.hpp>
 #include <NazaraUtils/Algorithm.hpp>
 #include <NazaraUtils/CallOnExit.hpp>
+#include <NZSL/CompilationStats.hpp>
 #include <NZSL/Enums.hpp>
 #include <NZSL/Lexer.hpp>
 #include <NZSL/Parser.hpp>
@@ -143,6 +144,13 @@ namespace nzsl
 
 		bool HasValue() const { return locationIndex.HasValue(); }
 	};
+
+	struct LangWriter::PrecisionAttribute
+	{
+		const Ast::ExpressionValue<Ast::PrecisionQualifier>& precision;
+
+		bool HasValue() const { return precision.HasValue(); }
+	};
 	
 	struct LangWriter::SetAttribute
 	{
@@ -198,8 +206,10 @@ namespace nzsl
 		unsigned int indentLevel = 0;
 	};
 
-	std::string LangWriter::Generate(const Ast::Module& module, const States& /*states*/)
+	std::string LangWriter::Generate(const Ast::Module& module, const States& states)
 	{
+		CompilationStats::Scope codegenScope(states.compilationStats, "codegen", "NZSL generation");
+
 		State state;
 		m_currentState = &state;
 		Nz::CallOnExit onExit([this]()
@@ -689,6 +699,21 @@ namespace nzsl
 
 		Append(")");
 	}
+
+	void LangWriter::AppendAttribute(PrecisionAttribute attribute)
+	{
+		if (!attribute.HasValue())
+			return;
+
+		Append("precision(");
+
+		if (attribute.precision.IsResultingValue())
+			Append(Parser::ToString(attribute.precision.GetResultingValue()));
+		else
+			attribute.precision.GetExpression()->Visit(*this);
+
+		Append(")");
+	}
 	
 	void LangWriter::AppendAttribute(SetAttribute attribute)
 	{
@@ -1092,7 +1117,7 @@ namespace nzsl
 	
 	void LangWriter::Visit(Ast::ConstantArrayValueExpression& node)
 	{
-		Append(*node.cachedExpressionType);
+		Append(node.cachedExpressionType->Get());
 		m_currentState->indentLevel++;
 		AppendLine("(");
 		std::visit([&](auto&& vec)
@@ -1487,7 +1512,7 @@ namespace nzsl
 
 				first = false;
 
-				AppendAttributes(false, CondAttribute{ member.cond }, LocationAttribute{ member.locationIndex }, InterpAttribute{ member.interp }, BuiltinAttribute{ member.builtin }, TagAttribute{ member.tag });
+				AppendAttributes(false, CondAttribute{ member.cond }, LocationAttribute{ member.locationIndex }, InterpAttribute{ member.interp }, PrecisionAttribute{ member.precision }, BuiltinAttribute{ member.builtin }, TagAttribute{ member.tag });
 				Append(member.name, ": ", member.type);
 			}
 		}
@@ -9,14 +9,33 @@
 #include <fmt/format.h>
 #include <frozen/string.h>
 #include <frozen/unordered_map.h>
-#include <cctype>
+#include <array>
+#include <cassert>
 #include <charconv>
-#include <locale>
+#include <cstdint>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <unordered_map>
 
+#if defined(__AVX2__)
+#define NZSL_LEXER_AVX2
+#endif
+
+#if defined(NZSL_LEXER_AVX2) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NZSL_LEXER_SSE2
+#endif
+
+#if defined(NZSL_LEXER_AVX2)
+#include <immintrin.h>
+#elif defined(NZSL_LEXER_SSE2)
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace nzsl
 {
 	namespace
@@ -46,6 +65,230 @@ namespace nzsl
 			{ "true",         TokenType::BoolTrue },
 			{ "while",        TokenType::While }
 		});
+
+		enum CharClass : std::uint8_t
+		{
+			CharClass_Blank      = 1 << 0, //< ' ', '\t', '\r' and '\n'
+			CharClass_Identifier = 1 << 1, //< [A-Za-z0-9_]
+		};
+
+		constexpr std::array<std::uint8_t, 256> BuildCharClasses()
+		{
+			std::array<std::uint8_t, 256> charClasses = {};
+			for (char c : { ' ', '\t', '\r', '\n' })
+				charClasses[static_cast<unsigned char>(c)] |= CharClass_Blank;
+
+			for (unsigned int c = 'a'; c <= 'z'; ++c)
+				charClasses[c] |= CharClass_Identifier;
+
+			for (unsigned int c = 'A'; c <= 'Z'; ++c)
+				charClasses[c] |= CharClass_Identifier;
+
+			for (unsigned int c = '0'; c <= '9'; ++c)
+				charClasses[c] |= CharClass_Identifier;
+
+			charClasses['_'] |= CharClass_Identifier;
+
+			return charClasses;
+		}
+
+		constexpr std::array<std::uint8_t, 256> s_charClasses = BuildCharClasses();
+
+		constexpr bool HasCharClass(char c, CharClass charClass)
+		{
+			return (s_charClasses[static_cast<unsigned char>(c)] & charClass) != 0;
+		}
+
+		inline unsigned int CountTrailingZeros(std::uint32_t mask)
+		{
+			assert(mask != 0);
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return index;
+#else
+			return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+		}
+
+		// Registers newlines whose bits are set in mask, blockPos being the position of bit 0
+		inline void RegisterNewlines(std::uint32_t mask, std::size_t blockPos, std::uint32_t& newlineCount, std::size_t& lastNewlinePos)
+		{
+			while (mask != 0)
+			{
+				lastNewlinePos = blockPos + CountTrailingZeros(mask);
+				newlineCount++;
+
+				mask &= mask - 1;
+			}
+		}
+
+#ifdef NZSL_LEXER_SSE2
+		inline __m128i InRange128(__m128i chunk, char first, char last)
+		{
+			// signed comparisons are fine as we only test ASCII ranges (non-ASCII bytes are negative and never match)
+			return _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(first - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8(last + 1)));
+		}
+
+		inline __m128i BlankMask128(__m128i chunk)
+		{
+			__m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+			__m128i lineBreaks = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+
+			return _mm_or_si128(spaces, lineBreaks);
+		}
+
+		inline __m128i IdentifierMask128(__m128i chunk)
+		{
+			// setting 0x20 folds uppercase letters onto lowercase letters without making any other character a letter
+			__m128i letters = InRange128(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), 'a', 'z');
+			__m128i digits = InRange128(chunk, '0', '9');
+			__m128i underscores = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_'));
+
+			return _mm_or_si128(_mm_or_si128(letters, digits), underscores);
+		}
+#endif
+
+#ifdef NZSL_LEXER_AVX2
+		inline __m256i InRange256(__m256i chunk, char first, char last)
+		{
+			return _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(first - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(last + 1), chunk));
+		}
+
+		inline __m256i BlankMask256(__m256i chunk)
+		{
+			__m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+			__m256i lineBreaks = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+
+			return _mm256_or_si256(spaces, lineBreaks);
+		}
+
+		inline __m256i IdentifierMask256(__m256i chunk)
+		{
+			__m256i letters = InRange256(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), 'a', 'z');
+			__m256i digits = InRange256(chunk, '0', '9');
+			__m256i underscores = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('_'));
+
+			return _mm256_or_si256(_mm256_or_si256(letters, digits), underscores);
+		}
+#endif
+
+		// Returns the position of the first character at or after pos which cannot be part of an identifier
+		std::size_t FindIdentifierEnd(std::string_view str, std::size_t pos)
+		{
+			const char* data = str.data();
+			std::size_t size = str.size();
+
+#ifdef NZSL_LEXER_AVX2
+			for (; pos + 32 <= size; pos += 32)
+			{
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+				std::uint32_t endMask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(IdentifierMask256(chunk)));
+				if (endMask != 0)
+					return pos + CountTrailingZeros(endMask);
+			}
+#endif
+
+#ifdef NZSL_LEXER_SSE2
+			for (; pos + 16 <= size; pos += 16)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+				std::uint32_t endMask = ~static_cast<std::uint32_t>(_mm_movemask_epi8(IdentifierMask128(chunk))) & 0xFFFFu;
+				if (endMask != 0)
+					return pos + CountTrailingZeros(endMask);
+			}
+#endif
+
+			while (pos < size && HasCharClass(data[pos], CharClass_Identifier))
+				pos++;
+
+			return pos;
+		}
+
+		// Returns the position of the first non-blank character at or after pos, counting newlines along the way
+		std::size_t SkipBlanks(std::string_view str, std::size_t pos, std::uint32_t& newlineCount, std::size_t& lastNewlinePos)
+		{
+			const char* data = str.data();
+			std::size_t size = str.size();
+
+#ifdef NZSL_LEXER_AVX2
+			for (; pos + 32 <= size; pos += 32)
+			{
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+				std::uint32_t newlineMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))));
+				std::uint32_t endMask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(BlankMask256(chunk)));
+				if (endMask != 0)
+				{
+					unsigned int blankCount = CountTrailingZeros(endMask);
+					RegisterNewlines(newlineMask & ((1u << blankCount) - 1), pos, newlineCount, lastNewlinePos);
+
+					return pos + blankCount;
+				}
+
+				RegisterNewlines(newlineMask, pos, newlineCount, lastNewlinePos);
+			}
+#endif
+
+#ifdef NZSL_LEXER_SSE2
+			for (; pos + 16 <= size; pos += 16)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+				std::uint32_t newlineMask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))));
+				std::uint32_t endMask = ~static_cast<std::uint32_t>(_mm_movemask_epi8(BlankMask128(chunk))) & 0xFFFFu;
+				if (endMask != 0)
+				{
+					unsigned int blankCount = CountTrailingZeros(endMask);
+					RegisterNewlines(newlineMask & ((1u << blankCount) - 1), pos, newlineCount, lastNewlinePos);
+
+					return pos + blankCount;
+				}
+
+				RegisterNewlines(newlineMask, pos, newlineCount, lastNewlinePos);
+			}
+#endif
+
+			for (; pos < size && HasCharClass(data[pos], CharClass_Blank); ++pos)
+			{
+				if (data[pos] == '\n')
+				{
+					lastNewlinePos = pos;
+					newlineCount++;
+				}
+			}
+
+			return pos;
+		}
+
+		// Counts newlines in [pos, endPos)
+		void CountNewlines(std::string_view str, std::size_t pos, std::size_t endPos, std::uint32_t& newlineCount, std::size_t& lastNewlinePos)
+		{
+			const char* data = str.data();
+
+#ifdef NZSL_LEXER_AVX2
+			for (; pos + 32 <= endPos; pos += 32)
+			{
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+				RegisterNewlines(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')))), pos, newlineCount, lastNewlinePos);
+			}
+#endif
+
+#ifdef NZSL_LEXER_SSE2
+			for (; pos + 16 <= endPos; pos += 16)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+				RegisterNewlines(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')))), pos, newlineCount, lastNewlinePos);
+			}
+#endif
+
+			for (; pos < endPos; ++pos)
+			{
+				if (data[pos] == '\n')
+				{
+					lastNewlinePos = pos;
+					newlineCount++;
+				}
+			}
+		}
 	}
 
 	std::string EscapeString(std::string_view str, bool quote)
@@ -83,32 +326,25 @@ namespace nzsl
 
 	std::vector<Token> Tokenize(std::string_view str, const std::string& filePath)
 	{
+		// A null character ends the source
+		if (std::size_t nullPos = str.find('\0'); nullPos != str.npos)
+			str = str.substr(0, nullPos);
+
 		std::size_t currentPos = 0;
 
 		auto Peek = [&](std::size_t advance = 1) -> char
 		{
-			if (currentPos + advance < str.size() && str[currentPos + advance] != '\0')
+			if (currentPos + advance < str.size())
 				return str[currentPos + advance];
 			else
 				return '\0';
 		};
 
-		auto IsAlphaNum = [&](const char c)
-		{
-			return std::isalnum(c) || c == '_';
-		};
-
 		std::uint32_t currentLine = 1;
 		std::size_t lineStartPos = 0;
 		std::string literalTemp;
 		std::vector<Token> tokens;
 
-		auto HandleNewLine = [&]
-		{
-			currentLine++;
-			lineStartPos = currentPos + 1;
-		};
-
 		std::shared_ptr<const std::string> currentFile;
 		if (!filePath.empty())
 			currentFile = std::make_shared<std::string>(filePath);
@@ -141,11 +377,21 @@ namespace nzsl
 				case ' ':
 				case '\t':
 				case '\r':
-					break; //< Ignore blank spaces
-
 				case '\n':
-					HandleNewLine();
+				{
+					// Ignore blank spaces (skip the whole run at once)
+					std::uint32_t newlineCount = 0;
+					std::size_t lastNewlinePos = 0;
+					std::size_t blankEnd = SkipBlanks(str, currentPos, newlineCount, lastNewlinePos);
+					if (newlineCount > 0)
+					{
+						currentLine += newlineCount;
+						lineStartPos = lastNewlinePos + 1;
+					}
+
+					currentPos = blankEnd - 1;
 					break;
+				}
 
 				case '-':
 				{
@@ -171,40 +417,35 @@ namespace nzsl
 					char next = Peek();
 					if (next == '/')
 					{
-						// Line comment
-						do
-						{
-							currentPos++;
-							next = Peek();
-						}
-						while (next != '\0' && next != '\n');
+						// Line comment (stop right before the newline so it gets handled as usual)
+						std::size_t lineEnd = str.find('\n', currentPos + 2);
+						if (lineEnd == str.npos)
+							lineEnd = str.size();
+
+						currentPos = lineEnd - 1;
 					}
 					else if (next == '*')
 					{
 						// Block comment
-						for (;;)
+						std::size_t commentEnd = str.find("*/", currentPos + 2);
+						if (commentEnd == str.npos)
 						{
-							currentPos++;
-							next = Peek();
+							token.location.endColumn = token.location.startColumn + 1;
+							token.location.endLine = token.location.startLine;
 
-							if (next == '*')
-							{
-								if (Peek(2) == '/')
-								{
-									currentPos += 2;
-									break;
-								}
-							}
-							else if (next == '\n')
-								HandleNewLine();
-							else if (next == '\0')
-							{
-								token.location.endColumn = token.location.startColumn + 1;
-								token.location.endLine = token.location.startLine;
+							throw LexerUnfinishedCommentError{ token.location };
+						}
 
-								throw LexerUnfinishedCommentError{ token.location };
-							}
+						std::uint32_t newlineCount = 0;
+						std::size_t lastNewlinePos = 0;
+						CountNewlines(str, currentPos + 2, commentEnd, newlineCount, lastNewlinePos);
+						if (newlineCount > 0)
+						{
+							currentLine += newlineCount;
+							lineStartPos = lastNewlinePos; //< columns following a multiline block comment have always been counted from the newline character
 						}
+
+						currentPos = commentEnd + 1;
 					}
 					else if (next == '=')
 					{
@@ -563,12 +804,10 @@ namespace nzsl
 
 				default:
 				{
-					if (IsAlphaNum(c))
+					if (HasCharClass(c, CharClass_Identifier))
 					{
 						std::size_t start = currentPos;
-
-						while (IsAlphaNum(Peek()))
-							currentPos++;
+						currentPos = FindIdentifierEnd(str, currentPos + 1) - 1;
 
 						std::string_view identifier = str.substr(start, currentPos - start + 1);
 						if (auto it = s_reservedKeywords.find(identifier); it == s_reservedKeywords.end())
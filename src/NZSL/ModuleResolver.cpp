@@ -7,4 +7,9 @@
 namespace nzsl
 {
 	ModuleResolver::~ModuleResolver() = default;
+
+	Ast::ModulePtr ModuleResolver::ResolveSymbols(const std::string& moduleName, const std::unordered_set<std::string>& /*symbols*/)
+	{
+		return Resolve(moduleName);
+	}
 }
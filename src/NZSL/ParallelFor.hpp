@@ -0,0 +1,22 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_PARALLELFOR_HPP
+#define NZSL_PARALLELFOR_HPP
+
+#include <NZSL/Config.hpp>
+#include <cstddef>
+
+namespace nzsl
+{
+	// Calls func(i) for each i in [0, count) on up to threadCount threads (including the calling thread) and waits for all of them,
+	// if some calls throw, the exception of the lowest index is rethrown afterwards so errors don't depend on thread scheduling
+	template<typename F> void ParallelFor(std::size_t count, std::size_t threadCount, F&& func);
+}
+
+#include <NZSL/ParallelFor.inl>
+
+#endif // NZSL_PARALLELFOR_HPP
@@ -0,0 +1,55 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace nzsl
+{
+	template<typename F>
+	void ParallelFor(std::size_t count, std::size_t threadCount, F&& func)
+	{
+		if (count == 0)
+			return;
+
+		std::vector<std::exception_ptr> errors(count);
+
+		std::atomic_size_t nextIndex = 0;
+		auto Process = [&]
+		{
+			for (std::size_t i = nextIndex++; i < count; i = nextIndex++)
+			{
+				try
+				{
+					func(i);
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			}
+		};
+
+		std::size_t workerCount = std::clamp<std::size_t>(threadCount, 1, count);
+
+		std::vector<std::thread> threads;
+		threads.reserve(workerCount - 1);
+		for (std::size_t i = 1; i < workerCount; ++i)
+			threads.emplace_back(Process);
+
+		Process();
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		for (const std::exception_ptr& error : errors)
+		{
+			if (error)
+				std::rethrow_exception(error);
+		}
+	}
+}
@@ -80,6 +80,7 @@ namespace nzsl
 		constexpr auto s_interpMapping        = BuildIdentifierMapping(LangData::s_interpolations);
 		constexpr auto s_layoutMapping        = BuildIdentifierMapping(LangData::s_memoryLayouts);
 		constexpr auto s_moduleFeatureMapping = BuildIdentifierMapping(LangData::s_moduleFeatures);
+		constexpr auto s_precisionMapping     = BuildIdentifierMapping(LangData::s_precisions);
 		constexpr auto s_unrollModeMapping    = BuildIdentifierMapping(LangData::s_unrollModes);
 	}
 
@@ -176,6 +177,14 @@ namespace nzsl
 		return it->second.identifier;
 	}
 
+	std::string_view Parser::ToString(Ast::PrecisionQualifier precisionQualifier)
+	{
+		auto it = LangData::s_precisions.find(precisionQualifier);
+		assert(it != LangData::s_precisions.end());
+
+		return it->second.identifier;
+	}
+
 	std::string_view Parser::ToString(ShaderStageType shaderStage)
 	{
 		auto it = LangData::s_entryPoints.find(shaderStage);
@@ -1358,6 +1367,10 @@ namespace nzsl
 							HandleUniqueAttribute(structField.locationIndex, std::move(attribute));
 							break;
 
+						case Ast::AttributeType::Precision:
+							HandleUniqueStringAttributeKey(structField.precision, std::move(attribute), s_precisionMapping);
+							break;
+
 						case Ast::AttributeType::Tag:
 							if (!structField.tag.empty())
 								throw ParserAttributeMultipleUniqueError{ attribute.sourceLocation, attribute.type };
@@ -0,0 +1,202 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/PermutationCompiler.hpp>
+#include <NZSL/ParallelFor.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <algorithm>
+#include <cassert>
+#include <string_view>
+#include <thread>
+
+namespace nzsl
+{
+	namespace
+	{
+		std::size_t HashOutput(const std::vector<std::uint32_t>& spirv)
+		{
+			return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(std::uint32_t)));
+		}
+
+		std::size_t HashOutput(const GlslWriter::Output& output)
+		{
+			return std::hash<std::string>{}(output.code);
+		}
+
+		bool IsSameOutput(const std::vector<std::uint32_t>& lhs, const std::vector<std::uint32_t>& rhs)
+		{
+			return lhs == rhs;
+		}
+
+		bool IsSameOutput(const GlslWriter::Output& lhs, const GlslWriter::Output& rhs)
+		{
+			return lhs.code == rhs.code &&
+			       lhs.explicitTextureBinding == rhs.explicitTextureBinding &&
+			       lhs.explicitUniformBlockBinding == rhs.explicitUniformBlockBinding &&
+			       lhs.usesDrawParameterBaseInstanceUniform == rhs.usesDrawParameterBaseInstanceUniform &&
+			       lhs.usesDrawParameterBaseVertexUniform == rhs.usesDrawParameterBaseVertexUniform &&
+			       lhs.usesDrawParameterDrawIndexUniform == rhs.usesDrawParameterDrawIndexUniform;
+		}
+	}
+
+	PermutationCompiler::PermutationCompiler(const Ast::Module& module, const ShaderWriter::States& states) :
+	m_states(states),
+	m_threadCount(std::max(std::thread::hardware_concurrency(), 1u))
+	{
+		// Shared front end: resolve imports and everything not depending on options once
+		// base option values are not resolved here as option sets may override them, they're applied with each option set (see BuildStates)
+		Ast::SanitizeVisitor::Options options;
+		options.compilationStats = states.compilationStats;
+		options.moduleResolver = states.shaderModuleResolver;
+		options.partialSanitization = true;
+
+		m_module = Ast::Sanitize(module, options);
+		m_optionUsage = Ast::AnalyzeOptionUsage(*m_module);
+
+		m_states.sanitized = false; //< each permutation still has to be sanitized with its option values
+	}
+
+	template<typename T, typename F>
+	auto PermutationCompiler::Compile(const std::vector<OptionSet>& optionSets, const std::vector<Ast::OptionHash>& influencingOptions, F&& generate) const -> Output<T>
+	{
+		// Option sets only differing by options which cannot influence the output don't have to be generated twice
+		std::vector<std::size_t> classRepresentatives = Ast::PartitionOptionSets(influencingOptions, optionSets);
+
+		std::vector<std::size_t> generatedSets;
+		for (std::size_t i = 0; i < optionSets.size(); ++i)
+		{
+			if (classRepresentatives[i] == i)
+				generatedSets.push_back(i);
+		}
+
+		std::size_t generatedCount = generatedSets.size();
+
+		// Reports the error of the first failing option set, regardless of thread scheduling
+		std::vector<T> outputs(generatedCount);
+		ParallelFor(generatedCount, m_threadCount, [&](std::size_t i)
+		{
+			outputs[i] = generate(optionSets[generatedSets[i]]);
+		});
+
+		// Deduplicate outputs in option set order so variant indices are deterministic
+		Output<T> result;
+		result.generatedCount = generatedCount;
+
+		std::vector<std::size_t> variantByGeneratedSet;
+		variantByGeneratedSet.reserve(generatedCount);
+
+		std::unordered_multimap<std::size_t, std::size_t> variantsByHash;
+		for (T& output : outputs)
+		{
+			std::size_t hash = HashOutput(output);
+
+			std::size_t variantIndex = result.variants.size();
+
+			auto [begin, end] = variantsByHash.equal_range(hash);
+			for (auto it = begin; it != end; ++it)
+			{
+				if (IsSameOutput(result.variants[it->second], output))
+				{
+					variantIndex = it->second;
+					break;
+				}
+			}
+
+			if (variantIndex == result.variants.size())
+			{
+				result.variants.push_back(std::move(output));
+				variantsByHash.emplace(hash, variantIndex);
+			}
+
+			variantByGeneratedSet.push_back(variantIndex);
+		}
+
+		result.variantByOptionSet.resize(optionSets.size());
+		for (std::size_t i = 0; i < optionSets.size(); ++i)
+		{
+			auto it = std::lower_bound(generatedSets.begin(), generatedSets.end(), classRepresentatives[i]);
+			assert(it != generatedSets.end() && *it == classRepresentatives[i]);
+
+			result.variantByOptionSet[i] = variantByGeneratedSet[std::distance(generatedSets.begin(), it)];
+		}
+
+		return result;
+	}
+
+	auto PermutationCompiler::CompileGlsl(std::optional<ShaderStageType> shaderStage, const std::vector<OptionSet>& optionSets, const GlslWriter::BindingMapping& bindingMapping, const GlslWriter::Environment& environment) const -> GlslOutput
+	{
+		std::vector<Ast::OptionHash> influencingOptions = GetInfluencingOptions((shaderStage) ? ShaderStageTypeFlags(*shaderStage) : ShaderStageType_All);
+
+		return Compile<GlslWriter::Output>(optionSets, influencingOptions, [&](const OptionSet& optionSet)
+		{
+			ShaderWriter::States states = BuildStates(optionSet);
+
+			GlslWriter writer;
+			writer.SetEnv(environment);
+
+			return writer.Generate(shaderStage, *m_module, bindingMapping, states);
+		});
+	}
+
+	auto PermutationCompiler::CompileSpirv(const std::vector<OptionSet>& optionSets, const SpirvWriter::Environment& environment) const -> SpirvOutput
+	{
+		std::vector<Ast::OptionHash> influencingOptions = GetInfluencingOptions(ShaderStageType_All);
+
+		return Compile<std::vector<std::uint32_t>>(optionSets, influencingOptions, [&](const OptionSet& optionSet)
+		{
+			ShaderWriter::States states = BuildStates(optionSet);
+
+			SpirvWriter writer;
+			writer.SetEnv(environment);
+
+			return writer.Generate(*m_module, states);
+		});
+	}
+
+	auto PermutationCompiler::ExpandOptionSpace(const OptionSpace& optionSpace) -> std::vector<OptionSet>
+	{
+		std::vector<OptionSet> optionSets;
+		optionSets.emplace_back();
+
+		for (const auto& [optionHash, values] : optionSpace)
+		{
+			if (values.empty())
+				continue;
+
+			std::vector<OptionSet> expandedSets;
+			expandedSets.reserve(optionSets.size() * values.size());
+
+			for (const OptionSet& optionSet : optionSets)
+			{
+				for (const Ast::ConstantValue& value : values)
+				{
+					OptionSet& expandedSet = expandedSets.emplace_back(optionSet);
+					expandedSet[optionHash] = value;
+				}
+			}
+
+			optionSets = std::move(expandedSets);
+		}
+
+		return optionSets;
+	}
+
+	std::vector<Ast::OptionHash> PermutationCompiler::GetInfluencingOptions(ShaderStageTypeFlags shaderStages) const
+	{
+		// Without optimization, code unreachable from entry points is still part of the output
+		if (!m_states.optimize)
+			return m_optionUsage.moduleOptions;
+
+		return m_optionUsage.GetStageOptions(shaderStages);
+	}
+
+	ShaderWriter::States PermutationCompiler::BuildStates(const OptionSet& optionSet) const
+	{
+		ShaderWriter::States states = m_states;
+		for (const auto& [optionHash, value] : optionSet)
+			states.optionValues[optionHash] = value;
+
+		return states;
+	}
+}
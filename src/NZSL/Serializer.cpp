@@ -257,7 +257,7 @@ namespace nzsl
 
 	void Deserializer::Deserialize(std::uint8_t& value)
 	{
-		if NAZARA_UNLIKELY(m_ptr + sizeof(value) > m_ptrEnd)
+		if NAZARA_UNLIKELY(m_ptr == m_ptrEnd)
 			throw std::runtime_error("not enough data to deserialize byte");
 
 		value = *m_ptr++;
@@ -283,7 +283,7 @@ namespace nzsl
 
 	void Deserializer::Deserialize(void* data, std::size_t size)
 	{
-		if NAZARA_UNLIKELY(m_ptr + size > m_ptrEnd)
+		if NAZARA_UNLIKELY(size > static_cast<std::size_t>(m_ptrEnd - m_ptr))
 			throw std::runtime_error(fmt::format("not enough data to deserialize {} bytes", size));
 
 		if (data)
@@ -294,7 +294,7 @@ namespace nzsl
 
 	void Deserializer::Deserialize(std::size_t size, const Nz::FunctionRef<std::size_t(const void* data)>& callback)
 	{
-		if NAZARA_UNLIKELY(m_ptr + size > m_ptrEnd)
+		if NAZARA_UNLIKELY(size > static_cast<std::size_t>(m_ptrEnd - m_ptr))
 			throw std::runtime_error(fmt::format("not enough data to deserialize {} bytes", size));
 
 		std::size_t readSize = callback(m_ptr);
@@ -303,6 +303,10 @@ namespace nzsl
 
 	void Deserializer::SeekTo(std::size_t offset)
 	{
+		// offsets usually come from the data itself, don't trust them
+		if NAZARA_UNLIKELY(offset > static_cast<std::size_t>(m_ptrEnd - m_ptrBegin))
+			throw std::runtime_error(fmt::format("not enough data to seek to offset {} (data size is {})", offset, m_ptrEnd - m_ptrBegin));
+
 		m_ptr = m_ptrBegin + offset;
 	}
 }
@@ -533,7 +533,7 @@ namespace nzsl
 			Ast::ExpressionPtr& expression = node.expressions[0];
 
 			assert(expression->cachedExpressionType.has_value());
-			const Ast::ExpressionType& fromExprType = expression->cachedExpressionType.value();
+			const Ast::ExpressionType& fromExprType = expression->cachedExpressionType->Get();
 
 			Ast::PrimitiveType fromBaseType;
 			if (IsPrimitiveType(fromExprType))
@@ -737,6 +737,9 @@ namespace nzsl
 		m_currentFunc = &m_functionRetriever(*node.funcIndex);
 		m_funcCallIndex = 0;
 
+		// Line information doesn't carry over OpFunctionEnd
+		m_lastLocation = SourceLocation{};
+
 		HandleSourceLocation(node.sourceLocation);
 
 		m_instructions.Append(SpirvOp::OpFunction, m_currentFunc->returnTypeId, m_currentFunc->funcId, 0, m_currentFunc->funcTypeId);
@@ -790,6 +793,36 @@ namespace nzsl
 					m_currentBlock->Append(SpirvOp::OpCopyMemory, resultId, input.varId);
 				}
 
+				for (const auto& packedInput : entryPointData.packedInputs)
+				{
+					std::uint32_t packedId = m_writer.AllocateResultId();
+					m_currentBlock->Append(SpirvOp::OpLoad, packedInput.typeId, packedId, packedInput.varId);
+
+					for (const auto& member : packedInput.members)
+					{
+						std::uint32_t valueId = m_writer.AllocateResultId();
+						if (member.componentCount == 1)
+							m_currentBlock->Append(SpirvOp::OpCompositeExtract, member.memberTypeId, valueId, packedId, member.firstComponent);
+						else
+						{
+							m_currentBlock->AppendVariadic(SpirvOp::OpVectorShuffle, [&](const auto& appender)
+							{
+								appender(member.memberTypeId);
+								appender(valueId);
+								appender(packedId);
+								appender(packedId);
+
+								for (std::uint32_t i = 0; i < member.componentCount; ++i)
+									appender(member.firstComponent + i);
+							});
+						}
+
+						std::uint32_t resultId = m_writer.AllocateResultId();
+						m_currentBlock->Append(SpirvOp::OpAccessChain, member.memberPointerId, resultId, paramId, member.memberIndexConstantId);
+						m_currentBlock->Append(SpirvOp::OpStore, resultId, valueId);
+					}
+				}
+
 				RegisterVariable(*node.parameters.front().varIndex, inputStruct.type, inputStruct.typeId, paramId, SpirvStorageClass::Function);
 			}
 		}
@@ -964,6 +997,31 @@ namespace nzsl
 						m_currentBlock->Append(SpirvOp::OpCompositeExtract, output.typeId, resultId, paramId, output.memberIndex);
 						m_currentBlock->Append(SpirvOp::OpStore, output.varId, resultId);
 					}
+
+					for (const auto& packedOutput : entryPointData.packedOutputs)
+					{
+						std::vector<std::uint32_t> memberIds;
+						memberIds.reserve(packedOutput.members.size());
+
+						for (const auto& member : packedOutput.members)
+						{
+							std::uint32_t resultId = m_writer.AllocateResultId();
+							m_currentBlock->Append(SpirvOp::OpCompositeExtract, member.typeId, resultId, paramId, member.memberIndex);
+							memberIds.push_back(resultId);
+						}
+
+						std::uint32_t packedId = m_writer.AllocateResultId();
+						m_currentBlock->AppendVariadic(SpirvOp::OpCompositeConstruct, [&](const auto& appender)
+						{
+							appender(packedOutput.typeId);
+							appender(packedId);
+
+							for (std::uint32_t memberId : memberIds)
+								appender(memberId);
+						});
+
+						m_currentBlock->Append(SpirvOp::OpStore, packedOutput.varId, packedId);
+					}
 				}
 
 				HandleSourceLocation(node.sourceLocation);
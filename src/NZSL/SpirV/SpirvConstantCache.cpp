@@ -131,6 +131,9 @@ namespace nzsl
 			if (lhs.name != rhs.name)
 				return false;
 
+			if (lhs.relaxedPrecision != rhs.relaxedPrecision)
+				return false;
+
 			return true;
 		}
 
@@ -434,8 +437,9 @@ namespace nzsl
 			std::vector<std::uint32_t> offsets;
 		};
 
-		Internal(SpirvWriter& writer, std::uint32_t& resultId) :
+		Internal(SpirvWriter& writer, std::uint32_t& resultId, const SpirvConstantCache* parentCache) :
 		nextResultId(resultId),
+		parent(parentCache),
 		writer(writer)
 		{
 		}
@@ -446,13 +450,41 @@ namespace nzsl
 		std::vector<std::pair<Variable, std::uint32_t /*id*/>> variables;
 		StructCallback structCallback;
 		std::uint32_t& nextResultId;
+		const SpirvConstantCache* parent; //< entries known by the parent are never registered in this cache
 		SpirvWriter& writer;
 		std::optional<StructLayout> currentBlockLayout;
+
+		std::optional<std::uint32_t> FindParentId(std::string_view debugString) const
+		{
+			if (!parent)
+				return std::nullopt;
+
+			const auto& parentDebugStrings = parent->m_internal->debugStrings;
+			if (auto it = parentDebugStrings.find(debugString); it != parentDebugStrings.end())
+				return it->second;
+
+			return parent->m_internal->FindParentId(debugString);
+		}
+
+		template<typename T>
+		std::optional<std::uint32_t> FindParentId(const T& entry) const
+		{
+			if (!parent)
+				return std::nullopt;
+
+			const auto& parentIds = parent->m_internal->ids;
+			if (auto it = parentIds.find(entry); it != parentIds.end())
+				return it->second;
+
+			return parent->m_internal->FindParentId(entry);
+		}
 	};
 
-	SpirvConstantCache::SpirvConstantCache(SpirvWriter& writer, std::uint32_t& resultId) :
-	m_internal(writer, resultId)
+	SpirvConstantCache::SpirvConstantCache(SpirvWriter& writer, std::uint32_t& resultId, const SpirvConstantCache* parentCache) :
+	m_internal(writer, resultId, parentCache)
 	{
+		if (parentCache)
+			m_internal->structCallback = parentCache->m_internal->structCallback;
 	}
 
 	SpirvConstantCache::~SpirvConstantCache() = default;
@@ -878,6 +910,7 @@ namespace nzsl
 		{
 			switch (structDesc.layout.GetResultingValue())
 			{
+				case Ast::MemoryLayout::Scalar: sType.layout = StructLayout::Scalar; break;
 				case Ast::MemoryLayout::Std140: sType.layout = StructLayout::Std140; break;
 				case Ast::MemoryLayout::Std430: sType.layout = StructLayout::Std430; break;
 			}
@@ -901,6 +934,7 @@ namespace nzsl
 			auto& sMembers = sType.members.emplace_back();
 			sMembers.name = member.name;
 			sMembers.type = BuildType(member.type.GetResultingValue());
+			sMembers.relaxedPrecision = (member.precision.HasValue() && member.precision.GetResultingValue() == Ast::PrecisionQualifier::Medium);
 		}
 
 		m_internal->currentBlockLayout = prevBlockLayout;
@@ -976,7 +1010,12 @@ namespace nzsl
 	{
 		auto it = m_internal->debugStrings.find(debugString);
 		if (it == m_internal->debugStrings.end())
+		{
+			if (std::optional<std::uint32_t> parentId = m_internal->FindParentId(debugString))
+				return *parentId;
+
 			throw std::runtime_error("debug string is not registered");
+		}
 
 		return it->second;
 	}
@@ -985,7 +1024,12 @@ namespace nzsl
 	{
 		auto it = m_internal->ids.find(c.constant);
 		if (it == m_internal->ids.end())
+		{
+			if (std::optional<std::uint32_t> parentId = m_internal->FindParentId(c.constant))
+				return *parentId;
+
 			throw std::runtime_error("constant is not registered");
+		}
 
 		return it->second;
 	}
@@ -994,13 +1038,21 @@ namespace nzsl
 	{
 		auto it = m_internal->ids.find(t.type);
 		if (it == m_internal->ids.end())
+		{
+			if (std::optional<std::uint32_t> parentId = m_internal->FindParentId(t.type))
+				return *parentId;
+
 			throw std::runtime_error("type is not registered");
+		}
 
 		return it->second;
 	}
 
 	std::uint32_t SpirvConstantCache::Register(std::string str)
 	{
+		if (std::optional<std::uint32_t> parentId = m_internal->FindParentId(std::string_view(str)))
+			return *parentId;
+
 		std::size_t h = m_internal->debugStrings.hash_function()(str);
 		auto it = m_internal->debugStrings.find(str, h);
 		if (it == m_internal->debugStrings.end())
@@ -1015,6 +1067,8 @@ namespace nzsl
 	std::uint32_t SpirvConstantCache::Register(Constant c)
 	{
 		AnyConstant& constant = c.constant;
+		if (std::optional<std::uint32_t> parentId = m_internal->FindParentId(constant))
+			return *parentId;
 
 		DepRegisterer registerer(*this);
 		registerer.Register(constant);
@@ -1033,6 +1087,8 @@ namespace nzsl
 	std::uint32_t SpirvConstantCache::Register(Type t)
 	{
 		AnyType& type = t.type;
+		if (std::optional<std::uint32_t> parentId = m_internal->FindParentId(type))
+			return *parentId;
 
 		DepRegisterer registerer(*this);
 		registerer.Register(type);
@@ -1059,6 +1115,57 @@ namespace nzsl
 		return resultId;
 	}
 
+	std::vector<std::uint32_t> SpirvConstantCache::RegisterChildIds(const SpirvConstantCache& childCache, std::uint32_t firstChildId, std::uint32_t childIdCount)
+	{
+		// Ids allocated by a child cache (and the code using it) are replayed in allocation order, registering the child entries in this cache
+		// and allocating a new id for other ids, this gives the same ids as if everything had been registered in this cache in the first place
+		NazaraAssertMsg(childCache.m_internal->parent == this, "cache is not a child of this cache");
+		NazaraAssertMsg(childCache.m_internal->variables.empty(), "child cache variables are not supported");
+
+		using ChildEntry = std::variant<std::monostate, const std::variant<AnyConstant, AnyType>*, const std::string*>;
+
+		std::vector<ChildEntry> childEntries(childIdCount);
+		auto RegisterChildEntry = [&](std::uint32_t childId, ChildEntry entry)
+		{
+			assert(childId >= firstChildId && childId - firstChildId < childIdCount);
+			childEntries[childId - firstChildId] = entry;
+		};
+
+		for (const auto& [entry, childId] : childCache.m_internal->ids)
+			RegisterChildEntry(childId, &entry);
+
+		for (const auto& [debugString, childId] : childCache.m_internal->debugStrings)
+			RegisterChildEntry(childId, &debugString);
+
+		std::vector<std::uint32_t> ids(childIdCount);
+		for (std::uint32_t i = 0; i < childIdCount; ++i)
+		{
+			ids[i] = std::visit([&](auto&& arg) -> std::uint32_t
+			{
+				using T = std::decay_t<decltype(arg)>;
+
+				if constexpr (std::is_same_v<T, std::monostate>)
+					return m_internal->nextResultId++;
+				else if constexpr (std::is_same_v<T, const std::string*>)
+					return Register(*arg);
+				else
+				{
+					return std::visit([&](auto&& entry) -> std::uint32_t
+					{
+						using E = std::decay_t<decltype(entry)>;
+
+						if constexpr (std::is_same_v<E, AnyConstant>)
+							return Register(Constant{ entry });
+						else
+							return Register(Type{ entry });
+					}, *arg);
+				}
+			}, childEntries[i]);
+		}
+
+		return ids;
+	}
+
 	void SpirvConstantCache::RegisterSource(SpirvSourceLanguage sourceLang, std::uint32_t version, std::uint32_t fileNameId, std::string source)
 	{
 		auto& sourceData = m_internal->debugSources.emplace_back();
@@ -1414,11 +1521,26 @@ namespace nzsl
 
 			if (std::holds_alternative<Matrix>(*type))
 			{
+				std::uint32_t matrixStride = 16;
+				if (structData.layout == StructLayout::Scalar)
+				{
+					// columns are tightly packed in scalar layout
+					const Matrix& matrixType = std::get<Matrix>(*type);
+					assert(std::holds_alternative<Vector>(matrixType.columnType->type));
+					const Vector& columnType = std::get<Vector>(matrixType.columnType->type);
+
+					assert(std::holds_alternative<Float>(columnType.componentType->type));
+					matrixStride = columnType.componentCount * std::get<Float>(columnType.componentType->type).width / 8;
+				}
+
 				annotations.Append(SpirvOp::OpMemberDecorate, resultId, memberIndex, SpirvDecoration::ColMajor);
-				annotations.Append(SpirvOp::OpMemberDecorate, resultId, memberIndex, SpirvDecoration::MatrixStride, 16);
+				annotations.Append(SpirvOp::OpMemberDecorate, resultId, memberIndex, SpirvDecoration::MatrixStride, matrixStride);
 			}
 
 			annotations.Append(SpirvOp::OpMemberDecorate, resultId, memberIndex, SpirvDecoration::Offset, member.offset.value());
+
+			if (member.relaxedPrecision)
+				annotations.Append(SpirvOp::OpMemberDecorate, resultId, memberIndex, SpirvDecoration::RelaxedPrecision);
 		}
 	}
 }
@@ -5704,7 +5704,22 @@ namespace nzsl
 		}
 	};
 
-	static std::array<SpirvInstruction, 759> s_instructions = {
+	template<std::size_t IndexCount, typename T, std::size_t N>
+	constexpr std::array<std::uint16_t, IndexCount> BuildInstructionIndices(const std::array<T, N>& instructions)
+	{
+		// opcode => instruction index + 1 (0 if opcode is unknown)
+		std::array<std::uint16_t, IndexCount> indices = {};
+		for (std::size_t i = 0; i < N; ++i)
+		{
+			std::uint16_t& index = indices[static_cast<std::size_t>(instructions[i].op)];
+			if (index == 0)
+				index = static_cast<std::uint16_t>(i + 1);
+		}
+
+		return indices;
+	}
+
+	static constexpr std::array<SpirvInstruction, 759> s_instructions = {
 		{
 			{
 				SpirvOp::OpNop,
@@ -11022,7 +11037,9 @@ namespace nzsl
 		}
 	};
 
-	static std::array<SpirvGlslStd450Instruction, 81> s_instructionsGlslStd450 = {
+	static constexpr auto s_instructionIndices = BuildInstructionIndices<static_cast<std::size_t>(s_instructions.back().op) + 1>(s_instructions);
+
+	static constexpr std::array<SpirvGlslStd450Instruction, 81> s_instructionsGlslStd450 = {
 		{
 			{
 				SpirvGlslStd450Op::Round,
@@ -11594,6 +11611,8 @@ namespace nzsl
 		}
 	};
 
+	static constexpr auto s_instructionIndicesGlslStd450 = BuildInstructionIndices<static_cast<std::size_t>(s_instructionsGlslStd450.back().op) + 1>(s_instructionsGlslStd450);
+
 	
 	std::pair<const SpirvOperand*, std::size_t> GetSpirvExtraOperands([[maybe_unused]] SpirvAccessQualifier kind)
 	{
@@ -12022,20 +12041,26 @@ namespace nzsl
 
 	const SpirvInstruction* GetSpirvInstruction(std::uint16_t op)
 	{
-		auto it = std::lower_bound(std::begin(s_instructions), std::end(s_instructions), op, [](const SpirvInstruction& inst, std::uint16_t op) { return std::uint16_t(inst.op) < op; });
-		if (it != std::end(s_instructions) && std::uint16_t(it->op) == op)
-			return &*it;
-		else
+		if (op >= s_instructionIndices.size())
+			return nullptr;
+
+		std::uint16_t index = s_instructionIndices[op];
+		if (index == 0)
 			return nullptr;
+
+		return &s_instructions[index - 1];
 	}
 
 	const SpirvGlslStd450Instruction* GetSpirvGlslStd450Instruction(std::uint16_t op)
 	{
-		auto it = std::lower_bound(std::begin(s_instructionsGlslStd450), std::end(s_instructionsGlslStd450), op, [](const SpirvGlslStd450Instruction& inst, std::uint16_t op) { return std::uint16_t(inst.op) < op; });
-		if (it != std::end(s_instructionsGlslStd450) && std::uint16_t(it->op) == op)
-			return &*it;
-		else
+		if (op >= s_instructionIndicesGlslStd450.size())
 			return nullptr;
+
+		std::uint16_t index = s_instructionIndicesGlslStd450[op];
+		if (index == 0)
+			return nullptr;
+
+		return &s_instructionsGlslStd450[index - 1];
 	}
 
 	std::string_view ToString(SpirvAccessQualifier value)
@@ -190,6 +190,12 @@ namespace nzsl
 
 	void SpirvExpressionLoad::Visit(Ast::ConstantExpression& node)
 	{
+		if (std::optional<std::uint32_t> specConstantId = m_writer.GetSpecializationConstantId(node.constantId))
+		{
+			m_value = Value{ *specConstantId };
+			return;
+		}
+
 		const auto& var = m_writer.GetConstantVariable(node.constantId);
 		m_value = Pointer{ var.typePtr, var.storageClass, var.pointerId, var.typeId };
 	}
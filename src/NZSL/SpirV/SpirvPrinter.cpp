@@ -7,10 +7,10 @@
 #include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/StackArray.hpp>
 #include <NZSL/SpirV/SpirvData.hpp>
+#include <fmt/format.h>
 #include <cassert>
 #include <cstring>
-#include <iomanip>
-#include <sstream>
+#include <iterator>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -18,30 +18,55 @@ namespace nzsl
 {
 	struct SpirvPrinter::State
 	{
-		State(const Settings& s) :
+		State(const Settings& s, const OutputCallback& callback) :
+		outputCallback(callback),
 		settings(s)
 		{
 		}
 
-		std::ostringstream stream;
+		static constexpr std::size_t FlushThreshold = 64 * 1024;
+
+		void Flush()
+		{
+			if (output.size() > 0)
+			{
+				outputCallback(std::string_view(output.data(), output.size()));
+				output.clear();
+			}
+		}
+
+		fmt::memory_buffer instruction;
+		fmt::memory_buffer output;
 		std::size_t resultOffset;
 		std::unordered_map<std::uint32_t, ExtensionSet> extensionSets;
 		std::unordered_map<std::uint32_t, std::uint32_t /*Width*/> floatingPointTypes;
 		std::unordered_map<std::uint32_t, std::uint32_t /*Width*/> integerTypes;
 		std::unordered_map<std::uint32_t, std::uint32_t /*Width*/> unsignedIntegerTypes;
+		const OutputCallback& outputCallback;
 		const Settings& settings;
 	};
 
 	std::string SpirvPrinter::Print(const std::uint32_t* codepoints, std::size_t count, const Settings& settings)
 	{
-		State state(settings);
+		std::string output;
+		Print(codepoints, count, settings, [&](std::string_view str)
+		{
+			output.append(str);
+		});
+
+		return output;
+	}
+
+	void SpirvPrinter::Print(const std::uint32_t* codepoints, std::size_t count, const Settings& settings, const OutputCallback& outputCallback)
+	{
+		State state(settings, outputCallback);
 
 		m_currentState = &state;
 		Nz::CallOnExit resetOnExit([&] { m_currentState = nullptr; });
 
 		Decode(codepoints, count);
 
-		return m_currentState->stream.str();
+		state.Flush();
 	}
 
 	bool SpirvPrinter::HandleHeader(const SpirvHeader& header)
@@ -53,10 +78,10 @@ namespace nzsl
 
 		if (m_currentState->settings.printHeader)
 		{
-			m_currentState->stream << "Version " + std::to_string(+majorVersion) << "." << std::to_string(+minorVersion) << "\n";
-			m_currentState->stream << "Generator: " << std::to_string(header.generatorId) << "\n";
-			m_currentState->stream << "Bound: " << std::to_string(header.bound) << "\n";
-			m_currentState->stream << "Schema: " << std::to_string(header.schema) << "\n";
+			fmt::format_to(std::back_inserter(m_currentState->output), "Version {}.{}\n", +majorVersion, +minorVersion);
+			fmt::format_to(std::back_inserter(m_currentState->output), "Generator: {}\n", header.generatorId);
+			fmt::format_to(std::back_inserter(m_currentState->output), "Bound: {}\n", header.bound);
+			fmt::format_to(std::back_inserter(m_currentState->output), "Schema: {}\n", header.schema);
 		}
 
 		return true;
@@ -68,8 +93,9 @@ namespace nzsl
 
 		if (m_currentState->settings.printParameters)
 		{
-			std::ostringstream instructionStream;
-			instructionStream << instruction.name;
+			fmt::memory_buffer& instructionBuffer = m_currentState->instruction;
+			instructionBuffer.clear();
+			fmt::format_to(std::back_inserter(instructionBuffer), "{}", instruction.name);
 
 			const std::uint32_t* endPtr = startPtr + wordCount - 1;
 
@@ -82,7 +108,7 @@ namespace nzsl
 					const SpirvOperand* operand = &operands[currentOperand];
 
 					if (operand->kind != SpirvOperandKind::IdResult)
-						PrintOperand(instructionStream, operand);
+						PrintOperand(operand);
 					else
 						resultId = ReadWord();
 
@@ -126,9 +152,7 @@ namespace nzsl
 								const SpirvGlslStd450Instruction* extInst = GetSpirvGlslStd450Instruction(Nz::SafeCast<std::uint16_t>(instructionId));
 								if (extInst)
 								{
-									instructionStream << " %" << resultType;
-									instructionStream << " GLSLstd450 ";
-									instructionStream << extInst->name;
+									fmt::format_to(std::back_inserter(instructionBuffer), " %{} GLSLstd450 {}", resultType, extInst->name);
 									PrintParameter(extInst->operands, extInst->minOperandCount);
 								}
 								else
@@ -186,7 +210,7 @@ namespace nzsl
 				{
 					const std::uint32_t* savedPtr = GetCurrentPtr();
 
-					PrintOperand(instructionStream, &instruction.operands[0]);
+					PrintOperand(&instruction.operands[0]);
 
 					ResetPtr(savedPtr);
 
@@ -203,7 +227,7 @@ namespace nzsl
 							float f32;
 							std::memcpy(&f32, &floatVal, sizeof(floatVal));
 
-							instructionStream << " f32(" << f32 << ")";
+							fmt::format_to(std::back_inserter(instructionBuffer), " f32({:g})", f32);
 						}
 						else if (width == 64)
 						{
@@ -214,10 +238,10 @@ namespace nzsl
 							double f64;
 							std::memcpy(&f64, &doubleVal, sizeof(doubleVal));
 
-							instructionStream << " f64(" << f64 << ")";
+							fmt::format_to(std::back_inserter(instructionBuffer), " f64({:g})", f64);
 						}
 						else
-							PrintOperand(instructionStream, &instruction.operands[2]);
+							PrintOperand(&instruction.operands[2]);
 					}
 					else if (auto intIt = m_currentState->integerTypes.find(resultType); intIt != m_currentState->integerTypes.end())
 					{
@@ -228,7 +252,7 @@ namespace nzsl
 							std::int32_t iVal;
 							std::memcpy(&iVal, &value, sizeof(value));
 
-							instructionStream << " i" << width << "(" << iVal << ")";
+							fmt::format_to(std::back_inserter(instructionBuffer), " i{}({})", width, iVal);
 						}
 						else if (width <= 64)
 						{
@@ -239,10 +263,10 @@ namespace nzsl
 							std::int64_t iVal;
 							std::memcpy(&iVal, &value, sizeof(value));
 
-							instructionStream << " i" << width << "(" << iVal << ")";
+							fmt::format_to(std::back_inserter(instructionBuffer), " i{}({})", width, iVal);
 						}
 						else
-							PrintOperand(instructionStream, &instruction.operands[2]);
+							PrintOperand(&instruction.operands[2]);
 					}
 					else if (auto uintIt = m_currentState->unsignedIntegerTypes.find(resultType); uintIt != m_currentState->unsignedIntegerTypes.end())
 					{
@@ -250,20 +274,20 @@ namespace nzsl
 						if (width >= 16 && width <= 32)
 						{
 							std::uint32_t value = ReadWord();
-							instructionStream << " u" << width << "(" << value << ")";
+							fmt::format_to(std::back_inserter(instructionBuffer), " u{}({})", width, value);
 						}
 						else if (width <= 64)
 						{
 							std::uint64_t low = ReadWord();
 							std::uint64_t high = ReadWord();
 							std::uint64_t value = (high << 32) | low;
-							instructionStream << " u" << width << "(" << value << ")";
+							fmt::format_to(std::back_inserter(instructionBuffer), " u{}({})", width, value);
 						}
 						else
-							PrintOperand(instructionStream, &instruction.operands[2]);
+							PrintOperand(&instruction.operands[2]);
 					}
 					else
-						PrintOperand(instructionStream, &instruction.operands[2]);
+						PrintOperand(&instruction.operands[2]);
 
 					break;
 				}
@@ -273,28 +297,38 @@ namespace nzsl
 					break;
 			}
 
+			// result ids are right-aligned so instruction names line up
 			if (resultId != 0)
 			{
-				std::string resultInfo = "%" + std::to_string(resultId) + " = ";
-				m_currentState->stream << std::setw(m_currentState->resultOffset) << resultInfo;
+				fmt::format_int resultStr(resultId);
+				std::size_t resultSize = resultStr.size() + 4; //< "%" and " = "
+				if (resultSize < m_currentState->resultOffset)
+					fmt::format_to(std::back_inserter(m_currentState->output), "{:{}}", "", m_currentState->resultOffset - resultSize);
+
+				fmt::format_to(std::back_inserter(m_currentState->output), "%{} = ", resultStr.c_str());
 			}
 			else
-				m_currentState->stream << std::string(m_currentState->resultOffset, ' ');
+				fmt::format_to(std::back_inserter(m_currentState->output), "{:{}}", "", m_currentState->resultOffset);
 
-			m_currentState->stream << instructionStream.str();
+			m_currentState->output.append(instructionBuffer.data(), instructionBuffer.data() + instructionBuffer.size());
 
 			assert(GetCurrentPtr() == startPtr + wordCount - 1);
 		}
 		else
-			m_currentState->stream << instruction.name;
+			fmt::format_to(std::back_inserter(m_currentState->output), "{}", instruction.name);
+
+		m_currentState->output.push_back('\n');
 
-		m_currentState->stream << "\n";
+		if (m_currentState->output.size() >= State::FlushThreshold)
+			m_currentState->Flush();
 
 		return true;
 	}
 	
-	void SpirvPrinter::PrintOperand(std::ostream& instructionStream, const SpirvOperand* operand)
+	void SpirvPrinter::PrintOperand(const SpirvOperand* operand)
 	{
+		fmt::memory_buffer& instructionBuffer = m_currentState->instruction;
+
 		switch (operand->kind)
 		{
 			case SpirvOperandKind::IdRef:
@@ -303,7 +337,7 @@ namespace nzsl
 			case SpirvOperandKind::IdScope:
 			{
 				std::uint32_t value = ReadWord();
-				instructionStream << " %" << value;
+				fmt::format_to(std::back_inserter(instructionBuffer), " %{}", value);
 				break;
 			}
 
@@ -311,12 +345,12 @@ namespace nzsl
 			case SpirvOperandKind:: Kind : \
 			{ \
 				Spirv##Kind value = static_cast<Spirv##Kind>(ReadWord()); \
-				instructionStream << " " #Kind "(" << ToString(value) << ")"; \
+				fmt::format_to(std::back_inserter(instructionBuffer), " " #Kind "({})", ToString(value)); \
 \
 				/* handle extra operands */ \
 				auto [operandPtr, operandCount] = GetSpirvExtraOperands(value); \
 				for (std::size_t i = 0; i < operandCount; ++i) \
-					PrintOperand(instructionStream, operandPtr + i); \
+					PrintOperand(operandPtr + i); \
 \
 				break; \
 			} \
@@ -367,21 +401,21 @@ namespace nzsl
 			case SpirvOperandKind::LiteralContextDependentNumber: //< FIXME
 			{
 				std::uint32_t value = ReadWord();
-				instructionStream << " " << operand->name << "(" << value << ")";
+				fmt::format_to(std::back_inserter(instructionBuffer), " {}({})", operand->name, value);
 				break;
 			}
 
 			case SpirvOperandKind::LiteralInteger:
 			{
 				std::uint32_t value = ReadWord();
-				instructionStream << " " << value;
+				fmt::format_to(std::back_inserter(instructionBuffer), " {}", value);
 				break;
 			}
 
 			case SpirvOperandKind::LiteralString:
 			{
 				std::string str = ReadString();
-				instructionStream << " \"" << str << "\"";
+				fmt::format_to(std::back_inserter(instructionBuffer), " \"{}\"", str);
 
 				/*
 				std::size_t offset = GetOutputOffset();
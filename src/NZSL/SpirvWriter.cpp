@@ -6,12 +6,16 @@
 #include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/FixedVector.hpp>
 #include <NazaraUtils/PathUtils.hpp>
+#include <NZSL/CompilationStats.hpp>
 #include <NZSL/Enums.hpp>
+#include <NZSL/ParallelFor.hpp>
 #include <NZSL/Parser.hpp>
-#include <NZSL/Ast/ConstantPropagationVisitor.hpp>
-#include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/PassManager.hpp>
+#include <NZSL/Ast/PrecisionInferenceVisitor.hpp>
 #include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <NZSL/Ast/VaryingPacking.hpp>
 #include <NZSL/Lang/LangData.hpp>
 #include <NZSL/SpirV/SpirvAstVisitor.hpp>
 #include <NZSL/SpirV/SpirvBlock.hpp>
@@ -23,11 +27,14 @@
 #include <frozen/unordered_map.h>
 #include <tsl/ordered_map.h>
 #include <tsl/ordered_set.h>
+#include <algorithm>
 #include <cassert>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace nzsl
@@ -39,6 +46,114 @@ namespace nzsl
 
 		template<typename T>
 		struct IsVector<std::vector<T>> : std::bool_constant<true> {};
+
+		// Calls remap on every id (result, result type and operand ids) of the instructions
+		template<typename F>
+		void RemapIds(std::vector<std::uint32_t>& code, F&& remap)
+		{
+			std::size_t instructionOffset = 0;
+			while (instructionOffset < code.size())
+			{
+				std::uint32_t wordCount = code[instructionOffset] >> 16;
+				std::uint32_t opcode = code[instructionOffset] & 0xFFFF;
+
+				const SpirvInstruction* instruction = GetSpirvInstruction(Nz::SafeCast<std::uint16_t>(opcode));
+				if (!instruction || wordCount == 0 || instructionOffset + wordCount > code.size())
+					throw std::runtime_error("invalid instruction");
+
+				std::size_t wordIndex = instructionOffset + 1;
+				std::size_t instructionEnd = instructionOffset + wordCount;
+				auto RemapNext = [&]
+				{
+					if (wordIndex < instructionEnd)
+						remap(code[wordIndex++]);
+				};
+
+				// the last operand of an instruction can be repeated (variadic instructions)
+				std::size_t operandIndex = 0;
+				while (wordIndex < instructionEnd)
+				{
+					switch (instruction->operands[operandIndex].kind)
+					{
+						case SpirvOperandKind::IdMemorySemantics:
+						case SpirvOperandKind::IdRef:
+						case SpirvOperandKind::IdResult:
+						case SpirvOperandKind::IdResultType:
+						case SpirvOperandKind::IdScope:
+							RemapNext();
+							break;
+
+						case SpirvOperandKind::PairIdRefIdRef:
+							RemapNext();
+							RemapNext();
+							break;
+
+						case SpirvOperandKind::PairIdRefLiteralInteger:
+							RemapNext();
+							wordIndex++;
+							break;
+
+						case SpirvOperandKind::PairLiteralIntegerIdRef:
+							wordIndex++;
+							RemapNext();
+							break;
+
+						case SpirvOperandKind::LiteralString:
+						{
+							// strings are null-terminated and padded with zeroes, the last word always ends with a zero byte
+							while (wordIndex < instructionEnd && (code[wordIndex++] >> 24) != 0);
+							break;
+						}
+
+						case SpirvOperandKind::ImageOperands:
+						{
+							// every image operand parameter is an id
+							wordIndex++;
+							while (wordIndex < instructionEnd)
+								RemapNext();
+
+							break;
+						}
+
+						case SpirvOperandKind::MemoryAccess:
+						{
+							std::uint32_t memoryAccess = code[wordIndex++];
+							if (memoryAccess & 0x02) //< Aligned (literal)
+								wordIndex++;
+
+							if (memoryAccess & 0x08) //< MakePointerAvailable (scope id)
+								RemapNext();
+
+							if (memoryAccess & 0x10) //< MakePointerVisible (scope id)
+								RemapNext();
+
+							break;
+						}
+
+						default:
+							wordIndex++;
+							break;
+					}
+
+					if (operandIndex + 1 < instruction->minOperandCount)
+						operandIndex++;
+				}
+
+				instructionOffset = instructionEnd;
+			}
+		}
+
+		const Ast::VaryingLocation* FindVaryingLocation(const std::optional<Ast::VaryingPacking>& packing, std::size_t memberIndex)
+		{
+			if (!packing)
+				return nullptr;
+
+			auto it = std::find_if(packing->locations.begin(), packing->locations.end(), [&](const Ast::VaryingLocation& location) { return location.memberIndex == memberIndex; });
+			if (it == packing->locations.end())
+				return nullptr;
+
+			return &*it;
+		}
 	}
 
 	class SpirvWriter::PreVisitor : public Ast::RecursiveVisitor
@@ -64,6 +179,7 @@ namespace nzsl
 			using ExtVarContainer = tsl::ordered_map<std::size_t /*varIndex*/, ExternalVar>;
 			using FunctionContainer = tsl::ordered_map<std::size_t, SpirvAstVisitor::FuncData>;
 			using LocalContainer = tsl::ordered_set<Ast::ExpressionType>;
+			using RelaxedPrecisionDecoration = tsl::ordered_set<std::uint32_t>;
 			using StructContainer = std::vector<Ast::StructDescription*>;
 
 			PreVisitor(const SpirvWriter& writer, SpirvConstantCache& constantCache) :
@@ -83,14 +199,14 @@ namespace nzsl
 			{
 				RecursiveVisitor::Visit(node);
 
-				m_constantCache.Register(*m_constantCache.BuildType(node.cachedExpressionType.value()));
+				RegisterExpressionType(node);
 			}
 
 			void Visit(Ast::BinaryExpression& node) override
 			{
 				RecursiveVisitor::Visit(node);
 
-				m_constantCache.Register(*m_constantCache.BuildType(node.cachedExpressionType.value()));
+				RegisterExpressionType(node);
 			}
 
 			void Visit(Ast::CallFunctionExpression& node) override
@@ -117,7 +233,7 @@ namespace nzsl
 			{
 				RecursiveVisitor::Visit(node);
 
-				m_constantCache.Register(*m_constantCache.BuildType(node.cachedExpressionType.value()));
+				RegisterExpressionType(node);
 			}
 
 			void Visit(Ast::ConditionalExpression& /*node*/) override
@@ -250,8 +366,24 @@ namespace nzsl
 				}
 			}
 
+			void Visit(Ast::DeclareOptionStatement& node) override
+			{
+				// Options are only kept by the sanitizer when they have to be specialization constants
+				if (!m_writer.m_environment.optionsAsSpecializationConstants)
+					return;
+
+				if (!node.defaultValue || node.defaultValue->GetType() != Ast::NodeType::ConstantValueExpression)
+					throw std::runtime_error("unexpected option without value, is shader sanitized?");
+
+				m_constantCache.Register(*m_constantCache.BuildType(node.optType.GetResultingValue()));
+
+				specializationConstants.push_back(&node);
+			}
+
 			void Visit(Ast::DeclareFunctionStatement& node) override
 			{
+				NAZARA_USE_ANONYMOUS_NAMESPACE
+
 				std::optional<ShaderStageType> entryPointType;
 				if (node.entryStage.HasValue())
 					entryPointType = node.entryStage.GetResultingValue();
@@ -339,6 +471,7 @@ namespace nzsl
 
 					std::optional<EntryPoint::InputStruct> inputStruct;
 					std::vector<EntryPoint::Input> inputs;
+					std::vector<EntryPoint::PackedInput> packedInputs;
 					if (!node.parameters.empty())
 					{
 						assert(node.parameters.size() == 1);
@@ -350,22 +483,63 @@ namespace nzsl
 						std::size_t structIndex = std::get<Ast::StructType>(parameterType).structIndex;
 						const Ast::StructDescription* structDesc = declaredStructs[structIndex];
 
+						// only varyings between vertex and fragment stages are packed
+						std::optional<Ast::VaryingPacking> packing;
+						if (m_writer.m_context.states->packVaryings && *entryPointType == ShaderStageType::Fragment)
+							packing = Ast::PackVaryings(*structDesc);
+
+						std::vector<std::int32_t> accessIndices(structDesc->members.size(), -1);
+
 						std::size_t memberIndex = 0;
-						for (const auto& member : structDesc->members)
+						for (std::size_t i = 0; i < structDesc->members.size(); ++i)
 						{
+							const auto& member = structDesc->members[i];
 							if (member.cond.HasValue() && !member.cond.GetResultingValue())
 								continue;
 
-							if (std::uint32_t varId = HandleEntryInOutType(*entryPointType, funcIndex, member, SpirvStorageClass::Input); varId != 0)
+							accessIndices[i] = std::int32_t(memberIndex++);
+
+							std::optional<std::uint32_t> locationIndex;
+							if (const Ast::VaryingLocation* varyingLocation = FindVaryingLocation(packing, i))
+							{
+								if (varyingLocation->packedVaryingIndex)
+									continue;
+
+								locationIndex = varyingLocation->location;
+							}
+
+							if (std::uint32_t varId = HandleEntryInOutType(*entryPointType, funcIndex, member, SpirvStorageClass::Input, locationIndex); varId != 0)
 							{
 								inputs.push_back({
-									m_constantCache.Register(*m_constantCache.BuildConstant(std::int32_t(memberIndex))),
+									m_constantCache.Register(*m_constantCache.BuildConstant(accessIndices[i])),
 									m_constantCache.Register(*m_constantCache.BuildPointerType(member.type.GetResultingValue(), SpirvStorageClass::Function)),
 									varId
 								});
 							}
+						}
 
-							memberIndex++;
+						if (packing)
+						{
+							for (const Ast::PackedVarying& packedVarying : packing->packedVaryings)
+							{
+								auto& packedInput = packedInputs.emplace_back();
+								packedInput.typeId = m_constantCache.Register(*m_constantCache.BuildType(Ast::VectorType{ packedVarying.componentCount, packedVarying.componentType }));
+								packedInput.varId = RegisterPackedVarying(funcIndex, packedVarying, SpirvStorageClass::Input);
+
+								for (std::size_t locationIndex : packedVarying.locations)
+								{
+									const Ast::VaryingLocation& varyingLocation = packing->locations[locationIndex];
+									const auto& member = structDesc->members[varyingLocation.memberIndex];
+
+									packedInput.members.push_back({
+										varyingLocation.componentCount,
+										varyingLocation.firstComponent,
+										m_constantCache.Register(*m_constantCache.BuildConstant(accessIndices[varyingLocation.memberIndex])),
+										m_constantCache.Register(*m_constantCache.BuildPointerType(member.type.GetResultingValue(), SpirvStorageClass::Function)),
+										m_constantCache.Register(*m_constantCache.BuildType(member.type.GetResultingValue()))
+									});
+								}
+							}
 						}
 
 						SpirvConstantCache::TypePtr typePtr = m_constantCache.BuildType(parameter.type.GetResultingValue());
@@ -379,6 +553,7 @@ namespace nzsl
 
 					std::optional<std::uint32_t> outputStructId;
 					std::vector<EntryPoint::Output> outputs;
+					std::vector<EntryPoint::PackedOutput> packedOutputs;
 					if (node.returnType.HasValue() && !IsNoType(node.returnType.GetResultingValue()))
 					{
 						const Ast::ExpressionType& returnType = node.returnType.GetResultingValue();
@@ -388,22 +563,60 @@ namespace nzsl
 						std::size_t structIndex = std::get<Ast::StructType>(returnType).structIndex;
 						const Ast::StructDescription* structDesc = declaredStructs[structIndex];
 
+						std::optional<Ast::VaryingPacking> packing;
+						if (m_writer.m_context.states->packVaryings && *entryPointType == ShaderStageType::Vertex)
+							packing = Ast::PackVaryings(*structDesc);
+
+						std::vector<std::int32_t> accessIndices(structDesc->members.size(), -1);
+
 						std::size_t memberIndex = 0;
-						for (const auto& member : structDesc->members)
+						for (std::size_t i = 0; i < structDesc->members.size(); ++i)
 						{
+							const auto& member = structDesc->members[i];
 							if (member.cond.HasValue() && !member.cond.GetResultingValue())
 								continue;
 
-							if (std::uint32_t varId = HandleEntryInOutType(*entryPointType, funcIndex, member, SpirvStorageClass::Output); varId != 0)
+							accessIndices[i] = std::int32_t(memberIndex++);
+
+							std::optional<std::uint32_t> locationIndex;
+							if (const Ast::VaryingLocation* varyingLocation = FindVaryingLocation(packing, i))
+							{
+								if (varyingLocation->packedVaryingIndex)
+									continue;
+
+								locationIndex = varyingLocation->location;
+							}
+
+							if (std::uint32_t varId = HandleEntryInOutType(*entryPointType, funcIndex, member, SpirvStorageClass::Output, locationIndex); varId != 0)
 							{
 								outputs.push_back({
-									std::int32_t(memberIndex),
+									accessIndices[i],
 									m_constantCache.Register(*m_constantCache.BuildType(member.type.GetResultingValue())),
 									varId
 								});
 							}
+						}
+
+						if (packing)
+						{
+							for (const Ast::PackedVarying& packedVarying : packing->packedVaryings)
+							{
+								auto& packedOutput = packedOutputs.emplace_back();
+								packedOutput.typeId = m_constantCache.Register(*m_constantCache.BuildType(Ast::VectorType{ packedVarying.componentCount, packedVarying.componentType }));
+								packedOutput.varId = RegisterPackedVarying(funcIndex, packedVarying, SpirvStorageClass::Output);
 
-							memberIndex++;
+								for (std::size_t locationIndex : packedVarying.locations)
+								{
+									const Ast::VaryingLocation& varyingLocation = packing->locations[locationIndex];
+									const auto& member = structDesc->members[varyingLocation.memberIndex];
+
+									packedOutput.members.push_back({
+										accessIndices[varyingLocation.memberIndex],
+										m_constantCache.Register(*m_constantCache.BuildType(member.type.GetResultingValue())),
+										0
+									});
+								}
+							}
 						}
 
 						outputStructId = m_constantCache.Register(*m_constantCache.BuildType(returnType));
@@ -415,7 +628,9 @@ namespace nzsl
 						outputStructId,
 						std::move(executionModes),
 						std::move(inputs),
-						std::move(outputs)
+						std::move(outputs),
+						std::move(packedInputs),
+						std::move(packedOutputs)
 					};
 				}
 
@@ -455,7 +670,7 @@ namespace nzsl
 
 			void Visit(Ast::IdentifierExpression& node) override
 			{
-				m_constantCache.Register(*m_constantCache.BuildType(node.cachedExpressionType.value()));
+				RegisterExpressionType(node);
 
 				RecursiveVisitor::Visit(node);
 			}
@@ -483,7 +698,7 @@ namespace nzsl
 						static_assert(Nz::AlwaysFalse<T>(), "non-exhaustive visitor");
 				}, it->second.op);
 
-				m_constantCache.Register(*m_constantCache.BuildType(node.cachedExpressionType.value()));
+				RegisterExpressionType(node);
 			}
 
 			void Visit(Ast::SwizzleExpression& node) override
@@ -496,17 +711,17 @@ namespace nzsl
 					m_constantCache.Register(*m_constantCache.BuildConstant(indexCount));
 				}
 
-				m_constantCache.Register(*m_constantCache.BuildType(node.cachedExpressionType.value()));
+				RegisterExpressionType(node);
 			}
 
 			void Visit(Ast::UnaryExpression& node) override
 			{
 				RecursiveVisitor::Visit(node);
 
-				m_constantCache.Register(*m_constantCache.BuildType(node.cachedExpressionType.value()));
+				RegisterExpressionType(node);
 			}
 
-			std::uint32_t HandleEntryInOutType(ShaderStageType entryPointType, std::size_t funcIndex, const Ast::StructDescription::StructMember& member, SpirvStorageClass storageClass)
+			std::uint32_t HandleEntryInOutType(ShaderStageType entryPointType, std::size_t funcIndex, const Ast::StructDescription::StructMember& member, SpirvStorageClass storageClass, std::optional<std::uint32_t> locationOverride = std::nullopt)
 			{
 				NAZARA_USE_ANONYMOUS_NAMESPACE
 
@@ -552,7 +767,7 @@ namespace nzsl
 					variable.type = m_constantCache.BuildPointerType(member.type.GetResultingValue(), storageClass);
 
 					std::uint32_t varId = m_constantCache.Register(variable);
-					locationDecorations[varId] = member.locationIndex.GetResultingValue();
+					locationDecorations[varId] = (locationOverride) ? *locationOverride : member.locationIndex.GetResultingValue();
 
 					if (member.interp.HasValue())
 					{
@@ -567,12 +782,49 @@ namespace nzsl
 						}
 					}
 
+					if (member.precision.HasValue() && member.precision.GetResultingValue() == Ast::PrecisionQualifier::Medium)
+						relaxedPrecisionDecorations.insert(varId);
+
 					return varId;
 				}
 
 				return 0;
 			}
 
+			std::uint32_t RegisterPackedVarying(std::size_t funcIndex, const Ast::PackedVarying& packedVarying, SpirvStorageClass storageClass)
+			{
+				SpirvConstantCache::Variable variable;
+				variable.debugName = fmt::format("packed{}", packedVarying.location);
+				variable.funcId = funcIndex;
+				variable.storageClass = storageClass;
+				variable.type = m_constantCache.BuildPointerType(Ast::VectorType{ packedVarying.componentCount, packedVarying.componentType }, storageClass);
+
+				std::uint32_t varId = m_constantCache.Register(variable);
+				locationDecorations[varId] = packedVarying.location;
+
+				if (packedVarying.interpolation != Ast::InterpolationQualifier::Smooth)
+				{
+					auto spvIt = SpirvGenData::s_interpolationMapping.find(packedVarying.interpolation);
+					if (spvIt == SpirvGenData::s_interpolationMapping.end())
+						throw std::runtime_error("unknown interpolation value " + std::to_string(Nz::UnderlyingCast(packedVarying.interpolation)));
+
+					interpolationDecorations[varId] = spvIt->second.interpolationDecoration;
+				}
+
+				if (packedVarying.relaxedPrecision)
+					relaxedPrecisionDecorations.insert(varId);
+
+				return varId;
+			}
+
+			void RegisterExpressionType(const Ast::Expression& expr)
+			{
+				// most expressions share a few types, only build and register each of them once
+				const Ast::ExpressionTypeHandle& exprType = expr.cachedExpressionType.value();
+				if (m_registeredTypes.insert(exprType).second)
+					m_constantCache.Register(*m_constantCache.BuildType(exprType.Get()));
+			}
+
 			BuiltinDecoration builtinDecorations;
 			ConstantVariables constantVariables;
 			ExtInstList extInsts;
@@ -580,19 +832,22 @@ namespace nzsl
 			FunctionContainer funcs;
 			InterpolationDecoration interpolationDecorations;
 			LocationDecoration locationDecorations;
+			RelaxedPrecisionDecoration relaxedPrecisionDecorations;
 			StructContainer declaredStructs;
+			std::vector<Ast::DeclareOptionStatement*> specializationConstants;
 			tsl::ordered_set<SpirvCapability> spirvCapabilities;
 
 		private:
 			SpirvConstantCache& m_constantCache;
 			const SpirvWriter& m_writer;
 			std::optional<std::size_t> m_funcIndex;
+			std::unordered_set<Ast::ExpressionTypeHandle> m_registeredTypes;
 	};
 
 	struct SpirvWriter::State
 	{
-		State(SpirvWriter& writer) :
-		constantTypeCache(writer, nextResultId)
+		State(SpirvWriter& writer, const SpirvConstantCache* parentCache = nullptr) :
+		constantTypeCache(writer, nextResultId, parentCache)
 		{
 		}
 
@@ -605,6 +860,7 @@ namespace nzsl
 
 		tsl::ordered_map<std::size_t, SpirvAstVisitor::FuncData> funcs;
 		tsl::ordered_map<std::string, std::uint32_t> extensionInstructionSet;
+		std::unordered_map<std::size_t /*constIndex*/, std::uint32_t /*resultId*/> specializationConstantIds;
 		std::unordered_map<std::shared_ptr<const std::string>, std::uint32_t> sourceFiles;
 		std::vector<std::uint32_t> resultIds;
 		std::uint32_t nextResultId = 1;
@@ -634,6 +890,8 @@ namespace nzsl
 			Ast::SanitizeVisitor::Options options = GetSanitizeOptions();
 			options.optionValues = states.optionValues;
 			options.moduleResolver = states.shaderModuleResolver;
+			options.compilationStats = states.compilationStats;
+			options.optionsAsSpecializationConstants = m_environment.optionsAsSpecializationConstants;
 
 			sanitizedModule = Ast::Sanitize(module, options);
 			targetModule = sanitizedModule.get();
@@ -643,19 +901,37 @@ namespace nzsl
 
 		if (states.optimize)
 		{
-			sanitizedModule = Ast::PropagateConstants(*targetModule);
-			
+			Ast::AlgebraicSimplificationVisitor::Options simplificationOptions;
+			simplificationOptions.fastMath = states.fastMath;
+
 			Ast::DependencyCheckerVisitor::Config dependencyConfig;
 			dependencyConfig.usedShaderStages = ShaderStageType_All;
 
-			sanitizedModule = Ast::EliminateUnusedPass(*sanitizedModule, dependencyConfig);
+			Ast::PassManager passManager = Ast::PassManager::BuildPreset(states.optimizationLevel, dependencyConfig, simplificationOptions);
+			if (passManager.GetPassCount() > 0)
+			{
+				// the sanitized module belongs to us and can be optimized in place
+				if (!sanitizedModule)
+					sanitizedModule = std::make_shared<Ast::Module>(targetModule->metadata, Nz::StaticUniquePointerCast<Ast::MultiStatement>(Ast::Clone(*targetModule->rootNode)), targetModule->importedModules);
 
-			targetModule = sanitizedModule.get();
+				passManager.Run(*sanitizedModule, states.compilationStats);
+				targetModule = sanitizedModule.get();
+			}
 		}
 
+		Nz::Bitset<> relaxedVariables;
+		if (states.inferPrecision)
+			relaxedVariables = Ast::InferRelaxedPrecisionVariables(*targetModule);
+
+		if (states.packVaryings)
+			Ast::ValidateVaryingPacking(*targetModule);
+
+		CompilationStats::Scope codegenScope(states.compilationStats, "codegen", "SPIR-V generation");
+
 		// Previsitor
 
 		m_context.states = &states;
+		m_specializationConstants.clear();
 
 		State state(*this);
 		m_currentState = &state;
@@ -700,6 +976,23 @@ namespace nzsl
 		}
 		previsitor.funcs.clear(); //< since we moved every value, prevent further usage
 
+		// Assign specialization constant IDs (SpecId follows declaration order)
+		std::vector<std::uint32_t> specializationConstantResultIds;
+		for (Ast::DeclareOptionStatement* optionDecl : previsitor.specializationConstants)
+		{
+			assert(optionDecl->optIndex);
+
+			auto& specConstant = m_specializationConstants.emplace_back();
+			specConstant.optionName = optionDecl->optName;
+			specConstant.optionHash = Ast::HashOption(optionDecl->optName.data());
+			specConstant.specId = Nz::SafeCast<std::uint32_t>(m_specializationConstants.size() - 1);
+			specConstant.value = Ast::ToConstantValue(static_cast<Ast::ConstantValueExpression&>(*optionDecl->defaultValue).value);
+
+			std::uint32_t resultId = AllocateResultId();
+			state.specializationConstantIds.emplace(*optionDecl->optIndex, resultId);
+			specializationConstantResultIds.push_back(resultId);
+		}
+
 		if (states.debugLevel >= DebugLevel::Regular)
 		{
 			auto RegisterSourceFile = [this, &states](const Ast::Module& module)
@@ -765,20 +1058,7 @@ namespace nzsl
 		else if (states.debugLevel >= DebugLevel::Minimal)
 			m_currentState->constantTypeCache.RegisterSource(SpirvSourceLanguage::NZSL, module.metadata->shaderLangVersion);
 
-		auto funcDataRetriever = [&](std::size_t funcIndex) -> SpirvAstVisitor::FuncData&
-		{
-			auto it = m_currentState->funcs.find(funcIndex);
-			if NAZARA_UNLIKELY(it == m_currentState->funcs.end())
-				throw std::runtime_error("internal error");
-
-			return it.value();
-		};
-
-		SpirvAstVisitor visitor(*this, state.instructions, funcDataRetriever);
-		for (const auto& importedModule : targetModule->importedModules)
-			importedModule.module->rootNode->Visit(visitor);
-
-		targetModule->rootNode->Visit(visitor);
+		AppendFunctions(*targetModule);
 
 		AppendHeader();
 
@@ -806,8 +1086,51 @@ namespace nzsl
 		for (auto&& [varId, interp] : previsitor.interpolationDecorations)
 			state.annotations.Append(SpirvOp::OpDecorate, varId, interp);
 
+		for (std::uint32_t varId : previsitor.relaxedPrecisionDecorations)
+			state.annotations.Append(SpirvOp::OpDecorate, varId, SpirvDecoration::RelaxedPrecision);
+
+		for (std::size_t varIndex = relaxedVariables.FindFirst(); varIndex != relaxedVariables.npos; varIndex = relaxedVariables.FindNext(varIndex))
+		{
+			for (auto&& [funcIndex, func] : state.funcs)
+			{
+				auto it = func.varIndexToVarId.find(varIndex);
+				if (it != func.varIndexToVarId.end())
+				{
+					state.annotations.Append(SpirvOp::OpDecorate, func.variables[it->second].varId, SpirvDecoration::RelaxedPrecision);
+					break;
+				}
+			}
+		}
+
 		m_currentState->constantTypeCache.Write(m_currentState->annotations, m_currentState->constants, m_currentState->debugInfo, states.debugLevel);
 
+		for (std::size_t i = 0; i < m_specializationConstants.size(); ++i)
+		{
+			const SpecializationConstant& specConstant = m_specializationConstants[i];
+			std::uint32_t resultId = specializationConstantResultIds[i];
+
+			state.annotations.Append(SpirvOp::OpDecorate, resultId, SpirvDecoration::SpecId, specConstant.specId);
+
+			std::visit([&](auto&& arg)
+			{
+				using T = std::decay_t<decltype(arg)>;
+
+				if constexpr (std::is_same_v<T, bool>)
+					state.constants.Append((arg) ? SpirvOp::OpSpecConstantTrue : SpirvOp::OpSpecConstantFalse, GetTypeId(Ast::ExpressionType{ Ast::PrimitiveType::Boolean }), resultId);
+				else if constexpr (std::is_same_v<T, float>)
+					state.constants.Append(SpirvOp::OpSpecConstant, GetTypeId(Ast::ExpressionType{ Ast::PrimitiveType::Float32 }), resultId, SpirvSection::Raw{ &arg, sizeof(arg) });
+				else if constexpr (std::is_same_v<T, std::int32_t>)
+					state.constants.Append(SpirvOp::OpSpecConstant, GetTypeId(Ast::ExpressionType{ Ast::PrimitiveType::Int32 }), resultId, SpirvSection::Raw{ &arg, sizeof(arg) });
+				else if constexpr (std::is_same_v<T, std::uint32_t>)
+					state.constants.Append(SpirvOp::OpSpecConstant, GetTypeId(Ast::ExpressionType{ Ast::PrimitiveType::UInt32 }), resultId, SpirvSection::Raw{ &arg, sizeof(arg) });
+				else
+					throw std::runtime_error("unexpected specialization constant type");
+			}, specConstant.value);
+
+			if (states.debugLevel >= DebugLevel::Minimal)
+				state.debugInfo.Append(SpirvOp::OpName, resultId, specConstant.optionName);
+		}
+
 		if (m_context.states->debugLevel >= DebugLevel::Minimal)
 		{
 			for (auto&& [funcIndex, func] : m_currentState->funcs)
@@ -829,6 +1152,15 @@ namespace nzsl
 		return Nz::Retrieve(m_currentState->previsitor->constantVariables, constIndex);
 	}
 
+	std::optional<std::uint32_t> SpirvWriter::GetSpecializationConstantId(std::size_t constIndex) const
+	{
+		auto it = m_currentState->specializationConstantIds.find(constIndex);
+		if (it == m_currentState->specializationConstantIds.end())
+			return std::nullopt;
+
+		return it->second;
+	}
+
 	bool SpirvWriter::IsVersionGreaterOrEqual(std::uint32_t spvMajor, std::uint32_t spvMinor) const
 	{
 		if (m_environment.spvMajorVersion > spvMajor)
@@ -883,6 +1215,102 @@ namespace nzsl
 		return m_currentState->nextResultId++;
 	}
 
+	void SpirvWriter::AppendFunctions(const Ast::Module& module)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		auto funcDataRetriever = [this](std::size_t funcIndex) -> SpirvAstVisitor::FuncData&
+		{
+			auto it = m_currentState->funcs.find(funcIndex);
+			if NAZARA_UNLIKELY(it == m_currentState->funcs.end())
+				throw std::runtime_error("internal error");
+
+			return it.value();
+		};
+
+		if (m_environment.codegenThreadCount <= 1 || m_currentState->funcs.size() <= 1)
+		{
+			SpirvAstVisitor visitor(*this, m_currentState->instructions, funcDataRetriever);
+			for (const auto& importedModule : module.importedModules)
+				importedModule.module->rootNode->Visit(visitor);
+
+			module.rootNode->Visit(visitor);
+			return;
+		}
+
+		// Other top-level statements are handled by the previsitor
+		std::vector<Ast::DeclareFunctionStatement*> functions;
+		auto RegisterFunctions = [&](auto&& self, Ast::MultiStatement& multiStatement) -> void
+		{
+			for (Ast::StatementPtr& statement : multiStatement.statements)
+			{
+				if (statement->GetType() == Ast::NodeType::DeclareFunctionStatement)
+					functions.push_back(&static_cast<Ast::DeclareFunctionStatement&>(*statement));
+				else if (statement->GetType() == Ast::NodeType::MultiStatement)
+					self(self, static_cast<Ast::MultiStatement&>(*statement));
+			}
+		};
+
+		for (const auto& importedModule : module.importedModules)
+			RegisterFunctions(RegisterFunctions, *importedModule.module->rootNode);
+
+		RegisterFunctions(RegisterFunctions, *module.rootNode);
+
+		// Each function is generated by its own writer, allocating ids starting from the same first id and registering new types and constants
+		// in a child cache, only its own FuncData is modified. Ids are then remapped in declaration order to match what a single writer would output
+		std::uint32_t firstFunctionId = m_currentState->nextResultId;
+
+		std::vector<std::unique_ptr<SpirvWriter>> functionWriters(functions.size());
+		std::vector<std::unique_ptr<State>> functionStates(functions.size());
+
+		// Reports the error of the first failing function, as a serial generation would
+		ParallelFor(functions.size(), m_environment.codegenThreadCount, [&](std::size_t funcIndex)
+		{
+			auto& functionWriter = functionWriters[funcIndex];
+			functionWriter = std::make_unique<SpirvWriter>();
+			functionWriter->m_context = m_context;
+			functionWriter->m_environment = m_environment;
+
+			auto& functionState = functionStates[funcIndex];
+			functionState = std::make_unique<State>(*functionWriter, &m_currentState->constantTypeCache);
+			functionState->extensionInstructionSet = m_currentState->extensionInstructionSet;
+			functionState->nextResultId = firstFunctionId;
+			functionState->previsitor = m_currentState->previsitor;
+			functionState->sourceFiles = m_currentState->sourceFiles;
+			functionState->specializationConstantIds = m_currentState->specializationConstantIds;
+
+			functionWriter->m_currentState = functionState.get();
+
+			SpirvAstVisitor visitor(*functionWriter, functionState->instructions, funcDataRetriever);
+			functions[funcIndex]->Visit(visitor);
+		});
+
+		std::vector<std::uint32_t> functionCode;
+		for (std::size_t funcIndex = 0; funcIndex < functions.size(); ++funcIndex)
+		{
+			State& functionState = *functionStates[funcIndex];
+
+			std::vector<std::uint32_t> ids = m_currentState->constantTypeCache.RegisterChildIds(functionState.constantTypeCache, firstFunctionId, functionState.nextResultId - firstFunctionId);
+
+			functionCode = functionState.instructions.GetBytecode();
+			RemapIds(functionCode, [&](std::uint32_t& id)
+			{
+				if (id >= firstFunctionId)
+					id = ids[id - firstFunctionId];
+			});
+
+			// local variables ids are also used to decorate them
+			assert(functions[funcIndex]->funcIndex);
+			for (auto& variable : funcDataRetriever(*functions[funcIndex]->funcIndex).variables)
+			{
+				if (variable.varId >= firstFunctionId)
+					variable.varId = ids[variable.varId - firstFunctionId];
+			}
+
+			m_currentState->instructions.AppendRaw(SpirvSection::Raw{ functionCode.data(), functionCode.size() * sizeof(std::uint32_t) });
+		}
+	}
+
 	void SpirvWriter::AppendHeader()
 	{
 		constexpr std::uint32_t VendorId = 39; //< NZSLc has been registered!
@@ -943,6 +1371,12 @@ namespace nzsl
 
 					for (const auto& output : entryPointData.outputs)
 						appender(output.varId);
+
+					for (const auto& packedInput : entryPointData.packedInputs)
+						appender(packedInput.varId);
+
+					for (const auto& packedOutput : entryPointData.packedOutputs)
+						appender(packedOutput.varId);
 				});
 			}
 		}
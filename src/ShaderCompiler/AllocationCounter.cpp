@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <ShaderCompiler/AllocationCounter.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// phases are measured on the thread running them, a process-wide counter would include allocations of the other backends running concurrently
+	thread_local std::uint64_t s_threadAllocationCount = 0;
+
+	void* Allocate(std::size_t size)
+	{
+		s_threadAllocationCount++;
+
+		if (size == 0)
+			size = 1;
+
+		for (;;)
+		{
+			if (void* ptr = std::malloc(size))
+				return ptr;
+
+			std::new_handler handler = std::get_new_handler();
+			if (!handler)
+				throw std::bad_alloc();
+
+			handler();
+		}
+	}
+}
+
+// Replacing global (non-aligned) allocation functions also counts allocations made by a shared NZSL library, except on Windows where DLLs use their own
+void* operator new(std::size_t size)
+{
+	return Allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return Allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return Allocate(size);
+	}
+	catch (...)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return Allocate(size);
+	}
+	catch (...)
+	{
+		return nullptr;
+	}
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+namespace nzslc
+{
+	std::uint64_t GetAllocationCount()
+	{
+		return s_threadAllocationCount;
+	}
+}
@@ -0,0 +1,18 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSLC_ALLOCATIONCOUNTER_HPP
+#define NZSLC_ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+namespace nzslc
+{
+	// Number of calls to global operator new made by the calling thread since its start
+	std::uint64_t GetAllocationCount();
+}
+
+#endif // NZSLC_ALLOCATIONCOUNTER_HPP
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in Config.hpp
 
 #include <ShaderCompiler/Compiler.hpp>
+#include <ShaderCompiler/AllocationCounter.hpp>
 #include <NazaraUtils/Algorithm.hpp>
 #include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/PathUtils.hpp>
@@ -11,13 +12,19 @@
 #include <NZSL/LangWriter.hpp>
 #include <NZSL/Lang/Errors.hpp>
 #include <NZSL/Lexer.hpp>
+#include <NZSL/ParallelFor.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/PermutationCompiler.hpp>
 #include <NZSL/SpirV/SpirvPrinter.hpp>
 #include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Serializer.hpp>
 #include <NZSL/Ast/AstSerializer.hpp>
+#include <NZSL/Ast/BlockLayout.hpp>
+#include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/PassManager.hpp>
 #include <NZSL/Ast/ReflectVisitor.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <NZSL/Ast/VaryingPacking.hpp>
 #include <fmt/color.h>
 #include <fmt/format.h>
 #include <frozen/string.h>
@@ -25,7 +32,9 @@
 #include <nlohmann/json.hpp>
 #include <cassert>
 #include <chrono>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <stdexcept>
 
 namespace nzslc
@@ -46,11 +55,120 @@ namespace nzslc
 			{ "regular", nzsl::DebugLevel::Regular },
 			{ "none",    nzsl::DebugLevel::None }
 		});
+
+		constexpr auto s_optimizationLevels = frozen::make_unordered_map<frozen::string, nzsl::OptimizationLevel>({
+			{ "0", nzsl::OptimizationLevel::None },
+			{ "1", nzsl::OptimizationLevel::Basic },
+			{ "2", nzsl::OptimizationLevel::Full },
+			{ "s", nzsl::OptimizationLevel::Size }
+		});
+
+		nlohmann::json ReadPermutationFile(const std::filesystem::path& filePath)
+		{
+			std::ifstream inputFile(filePath);
+			if (!inputFile)
+				throw std::runtime_error("failed to open " + Nz::PathToString(filePath));
+
+			nlohmann::json permutations = nlohmann::json::parse(inputFile);
+			if (!permutations.is_array())
+				throw std::runtime_error(fmt::format("{} must contain an array of option sets", Nz::PathToString(filePath)));
+
+			return permutations;
+		}
+
+		std::vector<nzsl::PermutationCompiler::OptionSet> BuildOptionSets(const nlohmann::json& permutations, const nzsl::Ast::Module& module)
+		{
+			// Use declared option types to convert JSON values
+			std::unordered_map<std::string, nzsl::Ast::PrimitiveType> optionTypes;
+
+			nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+			callbacks.onOptionDeclaration = [&](const nzsl::Ast::DeclareOptionStatement& optionDecl)
+			{
+				if (!optionDecl.optType.IsResultingValue())
+					return;
+
+				if (const auto* primitiveType = std::get_if<nzsl::Ast::PrimitiveType>(&optionDecl.optType.GetResultingValue()))
+					optionTypes.emplace(optionDecl.optName, *primitiveType);
+			};
+
+			nzsl::Ast::ReflectVisitor reflectVisitor;
+			reflectVisitor.Reflect(module, callbacks);
+
+			std::vector<nzsl::PermutationCompiler::OptionSet> optionSets;
+			for (const nlohmann::json& permutation : permutations)
+			{
+				if (!permutation.is_object())
+					throw std::runtime_error("option sets must be objects mapping option names to their values");
+
+				nzsl::PermutationCompiler::OptionSet& optionSet = optionSets.emplace_back();
+				for (auto it = permutation.begin(); it != permutation.end(); ++it)
+				{
+					const std::string& optionName = it.key();
+					const nlohmann::json& value = it.value();
+
+					auto typeIt = optionTypes.find(optionName);
+					if (typeIt == optionTypes.end())
+						throw std::runtime_error(fmt::format("unknown option {} (only options of a primitive type are supported: bool, f32, f64, i32, u32 or string)", optionName));
+
+					nzsl::Ast::ConstantValue& optionValue = optionSet[nzsl::Ast::HashOption(optionName.c_str())];
+					switch (typeIt->second)
+					{
+						case nzsl::Ast::PrimitiveType::Boolean: optionValue = value.get<bool>(); break;
+						case nzsl::Ast::PrimitiveType::Float32: optionValue = value.get<float>(); break;
+						case nzsl::Ast::PrimitiveType::Float64: optionValue = value.get<double>(); break;
+						case nzsl::Ast::PrimitiveType::Int32:   optionValue = value.get<std::int32_t>(); break;
+						case nzsl::Ast::PrimitiveType::UInt32:  optionValue = value.get<std::uint32_t>(); break;
+						case nzsl::Ast::PrimitiveType::String:  optionValue = value.get<std::string>(); break;
+					}
+				}
+			}
+
+			return optionSets;
+		}
+
+		// Changes whenever a module file is added, removed or modified
+		std::size_t ComputeFilesystemStamp(const std::vector<std::string>& modulePaths)
+		{
+			std::size_t stamp = 0;
+			auto RegisterFile = [&](const std::filesystem::path& filePath)
+			{
+				Nz::HashCombine(stamp, Nz::PathToString(filePath));
+				Nz::HashCombine(stamp, std::filesystem::last_write_time(filePath).time_since_epoch().count());
+				Nz::HashCombine(stamp, std::filesystem::file_size(filePath));
+			};
+
+			for (const std::string& modulePath : modulePaths)
+			{
+				std::filesystem::path path = Nz::Utf8Path(modulePath);
+				if (std::filesystem::is_regular_file(path))
+					RegisterFile(path);
+				else if (std::filesystem::is_directory(path))
+				{
+					for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+					{
+						if (entry.is_regular_file())
+							RegisterFile(entry.path());
+					}
+				}
+			}
+
+			return stamp;
+		}
+
+		// Runs the tasks on as many threads (including the calling one), rethrows the error of the first failing task
+		void RunConcurrently(const std::vector<std::function<void()>>& tasks)
+		{
+			nzsl::ParallelFor(tasks.size(), tasks.size(), [&](std::size_t taskIndex)
+			{
+				tasks[taskIndex]();
+			});
+		}
 	}
 
-	Compiler::Compiler(cxxopts::ParseResult& options) :
+	Compiler::Compiler(cxxopts::ParseResult& options, ModuleResolverCache* moduleResolverCache) :
 	m_logFormat(LogFormat::Classic),
 	m_options(options),
+	m_moduleResolverCache(moduleResolverCache),
 	m_profiling(false),
 	m_outputToStdout(false),
 	m_verbose(false),
@@ -102,6 +220,14 @@ namespace nzslc
 		if (m_options.count("measure") > 0)
 			m_profiling = m_options["measure"].as<bool>();
 
+		if (m_options.count("trace") > 0)
+		{
+			m_tracePath = Nz::Utf8Path(m_options["trace"].as<std::string>());
+
+			m_compilationStats = std::make_unique<nzsl::CompilationStats>();
+			m_compilationStats->SetAllocationCounter(&GetAllocationCount);
+		}
+
 		m_verbose = m_options.count("verbose") > 0;
 	}
 
@@ -194,6 +320,9 @@ namespace nzslc
 
 		if (m_profiling)
 			PrintTime();
+
+		if (m_compilationStats)
+			SaveTrace();
 	}
 
 	cxxopts::Options Compiler::BuildOptions()
@@ -203,15 +332,18 @@ namespace nzslc
 		options.add_options()
 			("benchmark-iteration", "Benchmark each step of the compilation repeat over a huge number of time, implies --measure", cxxopts::value<unsigned int>()->implicit_value("1000"))
 			("measure", "Measure time taken for every step of the compilation process", cxxopts::value<bool>()->default_value("false"))
+			("trace", "Save time, AST node count and allocation count of every compilation phase as a Chrome trace-event JSON file (chrome://tracing, Perfetto)", cxxopts::value<std::string>(), "path")
 			("log-format", "Set log format (classic, vs)", cxxopts::value<std::string>())
 			("i,input", "Input file(s)", cxxopts::value<std::string>())
 			("o,output", "Output path (use @stdout to output on stdout)", cxxopts::value<std::string>()->default_value("."), "path")
 			("s,show", "Show informations about the shader (default)")
 			("v,verbose", "Verbose output", cxxopts::value<bool>()->default_value("false"))
 			("h,help", "Print usage")
+			("server", "Run as a compilation server: read requests from stdin and write responses to stdout, keeping loaded modules between requests")
 			("version", "Print version");
 
 		options.add_options("compilation")
+			("block-layouts", "Report the member order minimizing the size of uniform, storage and push constant blocks (generates a .layouts.json file)")
 			("c,compile", R"(Compile input shader to the following format. Possible values are:
 - glsl : GLSL (GLSL ES if --gl-es is set)
 - nzsl : textual NZSL
@@ -223,9 +355,14 @@ Multiple values can be specified using commas (ex: --compile=glsl,nzslb).
 You can also specify -header as a suffix (ex: --compile=glsl-header) to generate an includable header file.
 )", cxxopts::value<std::vector<std::string>>()->implicit_value("nzslb"))
 			("d,debug-level", "Debug level to generate", cxxopts::value<std::string>(), "[none|minimal|regular|full]")
+			("fast-math", "Allow optimizations which may change floating-point results (only used with -O2 and -Os)")
+			("infer-precision", "Use medium precision for local variables computed from textures, normalized vectors and precision(medium) fields (GLSL ES and SPIR-V)")
 			("m,module", "Module file or directory", cxxopts::value<std::vector<std::string>>())
+			("O,optimization-level", "Optimization passes to run (0 disables optimization, 1 is the same as --optimize, 2 repeats every pass until the code stops changing, s does the same but favors code size)", cxxopts::value<std::string>(), "[0|1|2|s]")
 			("optimize", "Optimize shader code")
-			("p,partial", "Allow partial compilation");
+			("pack-varyings", "Pack vertex outputs and fragment inputs sharing a component type and interpolation qualifier into the same locations, both stages must declare the same location members (generates a .varyings.json location map)")
+			("p,partial", "Allow partial compilation")
+			("permutations", "Compile GLSL/SPIR-V outputs once per option set listed in a JSON file (an array of objects mapping option names to values), identical outputs are only written once", cxxopts::value<std::string>(), "path");
 
 		options.add_options("glsl output")
 			("gl-es", "Generate GLSL ES instead of GLSL", cxxopts::value<bool>()->default_value("false"))
@@ -235,7 +372,8 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 			("gl-bindingmap", "Add binding support (generates a .binding.json mapping file)");
 
 		options.add_options("spirv output")
-			("spv-version", "SPIR-V version (110 being 1.1)", cxxopts::value<std::uint32_t>(), "version");
+			("spv-version", "SPIR-V version (110 being 1.1)", cxxopts::value<std::uint32_t>(), "version")
+			("spv-spec-constants", "Emit options as specialization constants when possible (generates a .spec.json mapping file)");
 
 		options.parse_positional("input");
 		options.positional_help("shader path");
@@ -243,10 +381,71 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		return options;
 	}
 
+	nzsl::GlslWriter::Environment Compiler::BuildGlslEnvironment()
+	{
+		nzsl::GlslWriter::Environment env;
+		if (m_options.count("gl-es") > 0)
+			env.glES = m_options["gl-es"].as<bool>();
+
+		env.flipYPosition = (m_options.count("gl-flipy") > 0);
+		env.remapZPosition = (m_options.count("gl-remapz") > 0);
+
+		if (m_options.count("gl-version") > 0)
+		{
+			std::uint32_t minVersion = (env.glES) ? 300 : 330; //< OpenGL ES 3.0 and OpenGL 3.3 are the lowest supported versions of OpenGL
+			std::uint32_t maxVersion = (env.glES) ? 320 : 460; //< OpenGL ES 3.2 and OpenGL 4.6 are the highest supported versions of OpenGL
+
+			std::uint32_t version = m_options["gl-version"].as<std::uint32_t>();
+			if (version < minVersion || version > maxVersion)
+				throw std::runtime_error(fmt::format("invalid GLSL version (must be between {} and {})", minVersion, maxVersion));
+
+			env.glMajorVersion = version / 100;
+			env.glMinorVersion = (version % 100) / 10;
+		}
+
+		return env;
+	}
+
+	nzsl::SpirvWriter::Environment Compiler::BuildSpirvEnvironment()
+	{
+		nzsl::SpirvWriter::Environment env;
+		if (m_options.count("spv-version"))
+		{
+			constexpr std::uint32_t maxVersion = nzsl::SpirvMajorVersion * 100 + nzsl::SpirvMinorVersion * 10;
+
+			std::uint32_t version = m_options["spv-version"].as<std::uint32_t>();
+			if (version < 100 || version > maxVersion)
+				throw std::runtime_error(fmt::format("invalid SPIR-V version (must be between 100 and {})", maxVersion));
+
+			env.spvMajorVersion = version / 100;
+			env.spvMinorVersion = (version % 100) / 10;
+		}
+
+		env.optionsAsSpecializationConstants = (m_options.count("spv-spec-constants") > 0);
+
+		return env;
+	}
+
 	nzsl::ShaderWriter::States Compiler::BuildWriterOptions()
 	{
 		nzsl::ShaderWriter::States states;
+		states.compilationStats = m_compilationStats.get();
+		states.fastMath = (m_options.count("fast-math") > 0);
+		states.inferPrecision = (m_options.count("infer-precision") > 0);
 		states.optimize = (m_options.count("optimize") > 0);
+		states.packVaryings = (m_options.count("pack-varyings") > 0);
+
+		if (m_options.count("optimization-level"))
+		{
+			const std::string& optimizationLevelStr = m_options["optimization-level"].as<std::string>();
+
+			auto it = s_optimizationLevels.find(frozen::string(optimizationLevelStr));
+			if (it == s_optimizationLevels.end())
+				throw cxxopts::exceptions::specification("invalid optimization-level " + optimizationLevelStr);
+
+			states.optimizationLevel = it->second;
+			states.optimize = (states.optimizationLevel != nzsl::OptimizationLevel::None);
+		}
 
 		if (m_options.count("debug-level"))
 		{
@@ -273,10 +472,62 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 
 		outputFilePath /= m_inputFilePath.filename();
 
+		bool hasPermutations = (m_options.count("permutations") > 0);
+
 		const std::vector<std::string>& options = m_options["compile"].as<std::vector<std::string>>();
+
+		// Generate each backend output once even if it's requested multiple times (ex: glsl and glsl-header)
+		bool generateGlsl = false;
+		bool generateNzsl = false;
+		bool generateNzslb = false;
+		bool generateSpirv = false;
+		for (std::string_view outputType : options)
+		{
+			if (EndsWith(outputType, "-header"))
+				outputType.remove_suffix(7);
+
+			if (outputType == "nzsl")
+				generateNzsl = true;
+			else if (outputType == "nzslb")
+				generateNzslb = true;
+			else if ((outputType == "spv" || outputType == "spv-dis") && !hasPermutations)
+				generateSpirv = true;
+			else if (outputType == "glsl" && !hasPermutations)
+				generateGlsl = true;
+		}
+
+		GeneratedOutputs outputs;
+		Step("Generate outputs"sv, [&]
+		{
+			outputs = {};
+
+			nzsl::ShaderWriter::States states = BuildWriterOptions();
+
+			// Backends only read the module, run them concurrently
+			std::vector<std::function<void()>> backends;
+			if (generateGlsl)
+				backends.push_back([&, env = BuildGlslEnvironment()] { GenerateGLSL(outputs, *m_shaderModule, env, states); });
+
+			if (generateNzsl)
+				backends.push_back([&] { GenerateNZSL(outputs, *m_shaderModule, states); });
+
+			if (generateNzslb)
+				backends.push_back([&] { GenerateNZSLB(outputs, *m_shaderModule, states); });
+
+			if (generateSpirv)
+				backends.push_back([&, env = BuildSpirvEnvironment()] { GenerateSPV(outputs, *m_shaderModule, env, states); });
+
+			RunConcurrently(backends);
+		});
+
+		if (m_options.count("pack-varyings") > 0 && !m_outputToStdout)
+			Step("Output varying locations", &Compiler::OutputVaryingLocations, outputFilePath, *m_shaderModule);
+
+		if (m_options.count("block-layouts") > 0 && !m_outputToStdout)
+			Step("Output block layouts", &Compiler::OutputBlockLayouts, outputFilePath, *m_shaderModule);
+
 		for (std::string_view outputType : options)
 		{
-			// TODO: Don't compile multiple times unnecessary (ex: glsl and glsl-header)
 			if (m_outputToStdout && options.size() > 1)
 				fmt::print("-- {}\n", outputType);
 
@@ -285,15 +536,21 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 				outputType.remove_suffix(7);
 
 			if (outputType == "nzsl")
-				Step("Compile to NZSL", &Compiler::CompileToNZSL, outputFilePath, *m_shaderModule);
+				Step("Output NZSL", &Compiler::OutputNZSL, outputFilePath, outputs);
 			else if (outputType == "nzslb")
-				Step("Compile to NZSLB", &Compiler::CompileToNZSLB, outputFilePath, *m_shaderModule);
+				Step("Output NZSLB", &Compiler::OutputNZSLB, outputFilePath, outputs);
+			else if (outputType == "spv" && hasPermutations)
+				Step("Compile permutations to SPIR-V", &Compiler::CompilePermutationsToSPV, outputFilePath, *m_shaderModule, false);
 			else if (outputType == "spv")
-				Step("Compile to SPIR-V", &Compiler::CompileToSPV, outputFilePath, *m_shaderModule, false);
+				Step("Output SPIR-V", &Compiler::OutputSPV, outputFilePath, outputs, false);
+			else if (outputType == "spv-dis" && hasPermutations)
+				Step("Compile permutations to textual SPIR-V", &Compiler::CompilePermutationsToSPV, outputFilePath, *m_shaderModule, true);
 			else if (outputType == "spv-dis")
-				Step("Compile to textual SPIR-V", &Compiler::CompileToSPV, outputFilePath, *m_shaderModule, true);
+				Step("Output textual SPIR-V", &Compiler::OutputSPV, outputFilePath, outputs, true);
+			else if (outputType == "glsl" && hasPermutations)
+				Step("Compile permutations to GLSL", &Compiler::CompilePermutationsToGLSL, outputFilePath, *m_shaderModule);
 			else if (outputType == "glsl")
-				Step("Compile to GLSL", &Compiler::CompileToGLSL, outputFilePath, *m_shaderModule);
+				Step("Output GLSL", &Compiler::OutputGLSL, outputFilePath, outputs);
 			else
 			{
 				fmt::print("Unknown format {}, ignoring\n", outputType);
@@ -302,28 +559,131 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		}
 	}
 
-	void Compiler::CompileToGLSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
+	void Compiler::CompilePermutationsToGLSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
 	{
-		nzsl::GlslWriter::Environment env;
-		if (m_options.count("gl-es") > 0)
-			env.glES = m_options["gl-es"].as<bool>();
+		if (m_outputToStdout)
+			throw std::runtime_error("permutations cannot be output to stdout");
 
-		env.flipYPosition = (m_options.count("gl-flipy") > 0);
-		env.remapZPosition = (m_options.count("gl-remapz") > 0);
+		if (m_options.count("gl-bindingmap") > 0)
+			throw std::runtime_error("--gl-bindingmap is not supported with --permutations");
 
-		if (m_options.count("gl-version") > 0)
+		nlohmann::json permutations = ReadPermutationFile(Nz::Utf8Path(m_options["permutations"].as<std::string>()));
+		std::vector<nzsl::PermutationCompiler::OptionSet> optionSets = BuildOptionSets(permutations, module);
+
+		nzsl::ShaderStageTypeFlags entryTypes;
+		nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+		callbacks.onEntryPointDeclaration = [&](nzsl::ShaderStageType shaderStage, const std::string& /*functionName*/)
 		{
-			std::uint32_t minVersion = (env.glES) ? 300 : 330; //< OpenGL ES 3.0 and OpenGL 3.3 are the lowest supported versions of OpenGL
-			std::uint32_t maxVersion = (env.glES) ? 320 : 460; //< OpenGL ES 3.2 and OpenGL 4.6 are the highest supported versions of OpenGL
+			entryTypes |= shaderStage;
+		};
 
-			std::uint32_t version = m_options["gl-version"].as<std::uint32_t>();
-			if (version < minVersion || version > maxVersion)
-				throw std::runtime_error(fmt::format("invalid GLSL version (must be between {} and {})", minVersion, maxVersion));
+		nzsl::Ast::ReflectVisitor reflectVisitor;
+		reflectVisitor.Reflect(module, callbacks);
 
-			env.glMajorVersion = version / 100;
-			env.glMinorVersion = (version % 100) / 10;
+		if (entryTypes == 0)
+			throw std::runtime_error("shader has no entry function!");
+
+		nzsl::PermutationCompiler permutationCompiler(module, BuildWriterOptions());
+		nzsl::GlslWriter::Environment env = BuildGlslEnvironment();
+
+		nlohmann::json manifest;
+		for (nzsl::ShaderStageType entryType : entryTypes)
+		{
+			nzsl::PermutationCompiler::GlslOutput output = permutationCompiler.CompileGlsl(entryType, optionSets, {}, env);
+			if (m_verbose)
+				fmt::print("{} option sets: {} generated, {} unique {} shaders\n", optionSets.size(), output.generatedCount, output.variants.size(), nzsl::Parser::ToString(entryType));
+
+			std::string_view stageExtension;
+			switch (entryType)
+			{
+				case nzsl::ShaderStageType::Compute:  stageExtension = "comp"; break;
+				case nzsl::ShaderStageType::Fragment: stageExtension = "frag"; break;
+				case nzsl::ShaderStageType::Vertex:   stageExtension = "vert"; break;
+			}
+
+			std::vector<std::string> variantFiles;
+			for (std::size_t i = 0; i < output.variants.size(); ++i)
+			{
+				std::filesystem::path filePath = outputPath;
+				filePath.replace_extension(fmt::format("{}.{}.glsl", i, stageExtension));
+
+				variantFiles.push_back(Nz::PathToString(filePath.filename()));
+
+				const std::string& code = output.variants[i].code;
+				OutputFile(std::move(filePath), code.data(), code.size());
+			}
+
+			nlohmann::json& stageDoc = manifest[std::string(stageExtension)];
+			for (std::size_t i = 0; i < optionSets.size(); ++i)
+			{
+				nlohmann::json& permutationDoc = stageDoc.emplace_back();
+				permutationDoc["options"] = permutations[i];
+				permutationDoc["file"] = variantFiles[output.variantByOptionSet[i]];
+			}
 		}
 
+		std::string manifestStr = manifest.dump(4);
+
+		outputPath.replace_extension("glsl.permutations.json");
+		WriteFileContent(outputPath, manifestStr.data(), manifestStr.size());
+	}
+
+	void Compiler::CompilePermutationsToSPV(std::filesystem::path outputPath, const nzsl::Ast::Module& module, bool textual)
+	{
+		if (m_outputToStdout)
+			throw std::runtime_error("permutations cannot be output to stdout");
+
+		nlohmann::json permutations = ReadPermutationFile(Nz::Utf8Path(m_options["permutations"].as<std::string>()));
+		std::vector<nzsl::PermutationCompiler::OptionSet> optionSets = BuildOptionSets(permutations, module);
+
+		nzsl::PermutationCompiler permutationCompiler(module, BuildWriterOptions());
+		nzsl::PermutationCompiler::SpirvOutput output = permutationCompiler.CompileSpirv(optionSets, BuildSpirvEnvironment());
+		if (m_verbose)
+			fmt::print("{} option sets: {} generated, {} unique SPIR-V modules\n", optionSets.size(), output.generatedCount, output.variants.size());
+
+		std::vector<std::string> variantFiles;
+		for (std::size_t i = 0; i < output.variants.size(); ++i)
+		{
+			const std::vector<std::uint32_t>& spirv = output.variants[i];
+
+			std::filesystem::path filePath = outputPath;
+			if (textual)
+			{
+				nzsl::SpirvPrinter printer;
+				std::string spirvTxt = printer.Print(spirv);
+
+				filePath.replace_extension(fmt::format("{}.spv.txt", i));
+				variantFiles.push_back(Nz::PathToString(filePath.filename()));
+
+				OutputFile(std::move(filePath), spirvTxt.data(), spirvTxt.size());
+			}
+			else
+			{
+				filePath.replace_extension(fmt::format("{}.spv", i));
+				variantFiles.push_back(Nz::PathToString(filePath.filename()));
+
+				OutputFile(std::move(filePath), spirv.data(), spirv.size() * sizeof(std::uint32_t));
+			}
+		}
+
+		nlohmann::json manifest = nlohmann::json::array();
+		for (std::size_t i = 0; i < optionSets.size(); ++i)
+		{
+			nlohmann::json& permutationDoc = manifest.emplace_back();
+			permutationDoc["options"] = permutations[i];
+			permutationDoc["file"] = variantFiles[output.variantByOptionSet[i]];
+		}
+
+		std::string manifestStr = manifest.dump(4);
+
+		outputPath.replace_extension((textual) ? "spv.txt.permutations.json" : "spv.permutations.json");
+		WriteFileContent(outputPath, manifestStr.data(), manifestStr.size());
+	}
+
+	void Compiler::GenerateGLSL(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::GlslWriter::Environment& env, const nzsl::ShaderWriter::States& states)
+	{
+		nzsl::CompilationStats::Scope backendScope(states.compilationStats, "nzslc", "GLSL backend");
+
 		nzsl::GlslWriter::BindingMapping bindingMapping;
 		if (m_options.count("gl-bindingmap") > 0)
 		{
@@ -379,17 +739,10 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 				nlohmann::json finalDoc;
 				finalDoc["bindings"] = std::move(bindingArray);
 
-				std::string bindingStr = finalDoc.dump(4);
-
-				std::filesystem::path bindingOutputPath = outputPath;
-				bindingOutputPath.replace_extension("glsl.binding.json");
-				OutputFile(std::move(bindingOutputPath), bindingStr.data(), bindingStr.size());
+				outputs.glslBindings = finalDoc.dump(4);
 			}
 		}
 
-		nzsl::GlslWriter writer;
-		writer.SetEnv(env);
-
 		nzsl::ShaderStageTypeFlags entryTypes;
 		nzsl::Ast::ReflectVisitor::Callbacks callbacks;
 		callbacks.onEntryPointDeclaration = [&](nzsl::ShaderStageType shaderStage, const std::string& /*functionName*/)
@@ -403,12 +756,89 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		if (entryTypes == 0)
 			throw std::runtime_error("shader has no entry function!");
 
-		nzsl::ShaderWriter::States states = BuildWriterOptions();
+		// Lower the module once for all stages, only optimization depends on the stage
+		nzsl::Ast::SanitizeVisitor::Options sanitizeOptions = nzsl::GlslWriter::GetSanitizeOptions();
+		sanitizeOptions.compilationStats = states.compilationStats;
+		sanitizeOptions.moduleResolver = states.shaderModuleResolver;
+		sanitizeOptions.optionValues = states.optionValues;
+
+		nzsl::Ast::ModulePtr sanitizedModule = nzsl::Ast::Sanitize(module, sanitizeOptions);
+
+		nzsl::ShaderWriter::States stageStates = states;
+		stageStates.optimize = false;
+		stageStates.sanitized = true;
+
+		nzsl::GlslWriter writer;
+		writer.SetEnv(env);
 
 		for (nzsl::ShaderStageType entryType : entryTypes)
 		{
-			nzsl::GlslWriter::Output output = writer.Generate(entryType, module, bindingMapping, states);
+			nzsl::Ast::ModulePtr stageModule = sanitizedModule;
+			if (states.optimize)
+			{
+				nzsl::Ast::AlgebraicSimplificationVisitor::Options simplificationOptions;
+				simplificationOptions.fastMath = states.fastMath;
+
+				nzsl::Ast::DependencyCheckerVisitor::Config dependencyConfig;
+				dependencyConfig.usedShaderStages = entryType;
+
+				nzsl::Ast::PassManager passManager = nzsl::Ast::PassManager::BuildPreset(states.optimizationLevel, dependencyConfig, simplificationOptions);
+				if (passManager.GetPassCount() > 0)
+				{
+					// every stage optimizes its own copy of the sanitized module
+					stageModule = std::make_shared<nzsl::Ast::Module>(sanitizedModule->metadata, Nz::StaticUniquePointerCast<nzsl::Ast::MultiStatement>(nzsl::Ast::Clone(*sanitizedModule->rootNode)), sanitizedModule->importedModules);
+					passManager.Run(*stageModule, states.compilationStats);
+				}
+			}
+
+			outputs.glslStages.emplace_back(entryType, writer.Generate(entryType, *stageModule, bindingMapping, stageStates));
 
+			// only the first stage can be printed on stdout
+			if (m_outputToStdout)
+				break;
+		}
+	}
+
+	void Compiler::GenerateNZSL(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::ShaderWriter::States& states)
+	{
+		nzsl::CompilationStats::Scope backendScope(states.compilationStats, "nzslc", "NZSL backend");
+
+		nzsl::LangWriter nzslWriter;
+		outputs.nzsl = nzslWriter.Generate(module, states);
+	}
+
+	void Compiler::GenerateNZSLB(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::ShaderWriter::States& states)
+	{
+		nzsl::CompilationStats::Scope backendScope(states.compilationStats, "nzslc", "NZSLB backend");
+
+		nzsl::Serializer serializer;
+		nzsl::Ast::SerializeShader(serializer, module);
+
+		outputs.nzslb = serializer.GetData();
+	}
+
+	void Compiler::GenerateSPV(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::SpirvWriter::Environment& env, const nzsl::ShaderWriter::States& states)
+	{
+		nzsl::CompilationStats::Scope backendScope(states.compilationStats, "nzslc", "SPIR-V backend");
+
+		nzsl::SpirvWriter writer;
+		writer.SetEnv(env);
+
+		outputs.spirv = writer.Generate(module, states);
+		outputs.spirvSpecializationConstants = writer.GetSpecializationConstants();
+	}
+
+	void Compiler::OutputGLSL(std::filesystem::path outputPath, const GeneratedOutputs& outputs)
+	{
+		if (!outputs.glslBindings.empty())
+		{
+			std::filesystem::path bindingOutputPath = outputPath;
+			bindingOutputPath.replace_extension("glsl.binding.json");
+			OutputFile(std::move(bindingOutputPath), outputs.glslBindings.data(), outputs.glslBindings.size());
+		}
+
+		for (const auto& [entryType, output] : outputs.glslStages)
+		{
 			if (m_outputToStdout)
 			{
 				OutputToStdout(output.code);
@@ -427,29 +857,21 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		}
 	}
 
-	void Compiler::CompileToNZSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
+	void Compiler::OutputNZSL(std::filesystem::path outputPath, const GeneratedOutputs& outputs)
 	{
-		nzsl::ShaderWriter::States states = BuildWriterOptions();
-
-		nzsl::LangWriter nzslWriter;
-		std::string nzsl = nzslWriter.Generate(module, states);
-
 		if (m_outputToStdout)
 		{
-			OutputToStdout(nzsl);
+			OutputToStdout(outputs.nzsl);
 			return;
 		}
 
 		outputPath.replace_extension("nzsl");
-		OutputFile(std::move(outputPath), nzsl.data(), nzsl.size());
+		OutputFile(std::move(outputPath), outputs.nzsl.data(), outputs.nzsl.size());
 	}
 
-	void Compiler::CompileToNZSLB(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
+	void Compiler::OutputNZSLB(std::filesystem::path outputPath, const GeneratedOutputs& outputs)
 	{
-		nzsl::Serializer serializer;
-		nzsl::Ast::SerializeShader(serializer, module);
-
-		const std::vector<std::uint8_t>& data = serializer.GetData();
+		const std::vector<std::uint8_t>& data = outputs.nzslb;
 
 		if (m_outputToStdout)
 		{
@@ -465,28 +887,38 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		OutputFile(std::move(outputPath), data.data(), data.size());
 	}
 
-	void Compiler::CompileToSPV(std::filesystem::path outputPath, const nzsl::Ast::Module& module, bool textual)
+	void Compiler::OutputSPV(std::filesystem::path outputPath, const GeneratedOutputs& outputs, bool textual)
 	{
-		nzsl::SpirvWriter::Environment env;
-		if (m_options.count("spv-version"))
-		{
-			constexpr std::uint32_t maxVersion = nzsl::SpirvMajorVersion * 100 + nzsl::SpirvMinorVersion * 10;
+		const std::vector<std::uint32_t>& spirv = outputs.spirv;
+		std::size_t size = spirv.size() * sizeof(std::uint32_t);
 
-			std::uint32_t version = m_options["spv-version"].as<std::uint32_t>();
-			if (version < 100 || version > maxVersion)
-				throw std::runtime_error(fmt::format("invalid SPIR-V version (must be between 100 and {})", maxVersion));
+		if (m_options.count("spv-spec-constants") > 0 && !m_outputToStdout)
+		{
+			nlohmann::json specConstantArray = nlohmann::json::array();
+			for (const nzsl::SpirvWriter::SpecializationConstant& specConstant : outputs.spirvSpecializationConstants)
+			{
+				nlohmann::json& specConstantDoc = specConstantArray.emplace_back();
+				specConstantDoc["option"] = specConstant.optionName;
+				specConstantDoc["hash"] = specConstant.optionHash;
+				specConstantDoc["spec_id"] = specConstant.specId;
+				std::visit([&](auto&& arg)
+				{
+					using T = std::decay_t<decltype(arg)>;
 
-			env.spvMajorVersion = version / 100;
-			env.spvMinorVersion = (version % 100) / 10;
-		}
+					if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, float> || std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t>)
+						specConstantDoc["default"] = arg;
+				}, specConstant.value);
+			}
 
-		nzsl::SpirvWriter writer;
-		writer.SetEnv(env);
+			nlohmann::json finalDoc;
+			finalDoc["specialization_constants"] = std::move(specConstantArray);
 
-		nzsl::ShaderWriter::States states = BuildWriterOptions();
+			std::string specConstantStr = finalDoc.dump(4);
 
-		std::vector<std::uint32_t> spirv = writer.Generate(module, states);
-		std::size_t size = spirv.size() * sizeof(std::uint32_t);
+			std::filesystem::path specConstantOutputPath = outputPath;
+			specConstantOutputPath.replace_extension("spv.spec.json");
+			OutputFile(std::move(specConstantOutputPath), specConstantStr.data(), specConstantStr.size());
+		}
 
 		if (textual)
 		{
@@ -569,6 +1001,101 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		}
 	}
 
+	void Compiler::OutputBlockLayouts(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
+	{
+		std::unordered_map<std::size_t, const nzsl::Ast::StructDescription*> structs;
+		std::vector<std::pair<std::string, std::size_t /*structIndex*/>> blockStructs;
+
+		nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+		callbacks.onStructDeclaration = [&](const nzsl::Ast::DeclareStructStatement& structDecl)
+		{
+			if (structDecl.structIndex)
+				structs.emplace(*structDecl.structIndex, &structDecl.description);
+		};
+
+		callbacks.onExternalDeclaration = [&](const nzsl::Ast::DeclareExternalStatement& extDecl)
+		{
+			for (const auto& extVar : extDecl.externalVars)
+			{
+				const nzsl::Ast::ExpressionType& varType = nzsl::Ast::ResolveAlias(extVar.type.GetResultingValue());
+				if (nzsl::Ast::IsUniformType(varType) || nzsl::Ast::IsStorageType(varType) || nzsl::Ast::IsPushConstantType(varType))
+					blockStructs.emplace_back(extVar.name, nzsl::Ast::ResolveStructIndex(varType));
+			}
+		};
+
+		nzsl::Ast::ReflectVisitor reflectVisitor;
+		reflectVisitor.Reflect(module, callbacks);
+
+		auto GetMemberName = [](const nzsl::Ast::StructDescription::StructMember& member) -> const std::string&
+		{
+			return (!member.originalName.empty()) ? member.originalName : member.name;
+		};
+
+		nlohmann::json blockArray = nlohmann::json::array();
+		for (auto&& [blockName, structIndex] : blockStructs)
+		{
+			const nzsl::Ast::StructDescription& structDesc = *Nz::Retrieve(structs, structIndex);
+			nzsl::StructLayout layout = nzsl::Ast::GetStructLayout(structDesc);
+
+			// Nested structs are laid out using the block layout
+			std::unordered_map<std::size_t, nzsl::FieldOffsets> nestedStructOffsets;
+			nzsl::Ast::StructFinder structFinder = [&](std::size_t nestedStructIndex) -> const nzsl::FieldOffsets&
+			{
+				if (auto it = nestedStructOffsets.find(nestedStructIndex); it != nestedStructOffsets.end())
+					return it->second;
+
+				nzsl::FieldOffsets fieldOffsets = nzsl::Ast::ComputeStructFieldOffsets(*Nz::Retrieve(structs, nestedStructIndex), layout, structFinder);
+				return nestedStructOffsets.emplace(nestedStructIndex, fieldOffsets).first->second;
+			};
+
+			nzsl::Ast::BlockLayoutOptimization optimization = nzsl::Ast::OptimizeBlockLayout(structDesc, structFinder);
+
+			nlohmann::json& blockDoc = blockArray.emplace_back();
+			blockDoc["block"] = blockName;
+			blockDoc["struct"] = structDesc.name;
+			blockDoc["layout"] = std::string((structDesc.layout.HasValue()) ? nzsl::Parser::ToString(structDesc.layout.GetResultingValue()) : "std140");
+			blockDoc["size"] = optimization.originalSize;
+			blockDoc["optimized_size"] = optimization.optimizedSize;
+			blockDoc["savings"] = optimization.originalSize - optimization.optimizedSize;
+
+			nlohmann::json& memberArray = blockDoc["members"];
+			memberArray = nlohmann::json::array();
+			for (std::size_t memberIndex : optimization.memberOrder)
+			{
+				const auto& member = structDesc.members[memberIndex];
+				if (member.cond.HasValue() && !member.cond.GetResultingValue())
+					continue;
+
+				nlohmann::json& memberDoc = memberArray.emplace_back();
+				memberDoc["member"] = GetMemberName(member);
+				memberDoc["original_index"] = memberIndex;
+				memberDoc["offset"] = optimization.memberOffsets[memberIndex];
+			}
+
+			if (m_verbose && optimization.optimizedSize < optimization.originalSize)
+			{
+				std::string memberOrder;
+				for (const nlohmann::json& memberDoc : memberArray)
+				{
+					if (!memberOrder.empty())
+						memberOrder += ", ";
+
+					memberOrder += memberDoc["member"].get<std::string>();
+				}
+
+				fmt::print("{} ({}): {} bytes could be {} bytes by declaring members as: {}\n", blockName, structDesc.name, optimization.originalSize, optimization.optimizedSize, memberOrder);
+			}
+		}
+
+		nlohmann::json finalDoc;
+		finalDoc["blocks"] = std::move(blockArray);
+
+		std::string layoutStr = finalDoc.dump(4);
+
+		outputPath.replace_extension("layouts.json");
+		OutputFile(std::move(outputPath), layoutStr.data(), layoutStr.size());
+	}
+
 	void Compiler::OutputFile(std::filesystem::path filePath, const void* data, std::size_t size)
 	{
 		if (m_outputHeader)
@@ -593,6 +1120,84 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 			fmt::print("{}", str);
 	}
 
+	void Compiler::OutputVaryingLocations(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
+	{
+		std::unordered_map<std::size_t, const nzsl::Ast::StructDescription*> structs;
+		std::vector<std::pair<nzsl::ShaderStageType, std::size_t /*structIndex*/>> varyingStructs;
+
+		nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+		callbacks.onStructDeclaration = [&](const nzsl::Ast::DeclareStructStatement& structDecl)
+		{
+			if (structDecl.structIndex)
+				structs.emplace(*structDecl.structIndex, &structDecl.description);
+		};
+
+		callbacks.onFunctionDeclaration = [&](const nzsl::Ast::DeclareFunctionStatement& funcDecl)
+		{
+			if (!funcDecl.entryStage.IsResultingValue())
+				return;
+
+			// only vertex outputs and fragment inputs are packed
+			const nzsl::Ast::ExpressionType* varyingType = nullptr;
+			switch (funcDecl.entryStage.GetResultingValue())
+			{
+				case nzsl::ShaderStageType::Fragment:
+					if (!funcDecl.parameters.empty())
+						varyingType = &funcDecl.parameters.front().type.GetResultingValue();
+					break;
+
+				case nzsl::ShaderStageType::Vertex:
+					if (funcDecl.returnType.HasValue())
+						varyingType = &funcDecl.returnType.GetResultingValue();
+					break;
+
+				case nzsl::ShaderStageType::Compute:
+					break;
+			}
+
+			if (varyingType && nzsl::Ast::IsStructType(*varyingType))
+				varyingStructs.emplace_back(funcDecl.entryStage.GetResultingValue(), std::get<nzsl::Ast::StructType>(*varyingType).structIndex);
+		};
+
+		nzsl::Ast::ReflectVisitor reflectVisitor;
+		reflectVisitor.Reflect(module, callbacks);
+
+		nlohmann::json varyingArray = nlohmann::json::array();
+		for (auto&& [stage, structIndex] : varyingStructs)
+		{
+			const nzsl::Ast::StructDescription& structDesc = *Nz::Retrieve(structs, structIndex);
+			nzsl::Ast::VaryingPacking packing = nzsl::Ast::PackVaryings(structDesc);
+
+			nlohmann::json& varyingDoc = varyingArray.emplace_back();
+			varyingDoc["stage"] = nzsl::Parser::ToString(stage);
+			varyingDoc["struct"] = structDesc.name;
+
+			nlohmann::json& memberArray = varyingDoc["members"];
+			memberArray = nlohmann::json::array();
+			for (const nzsl::Ast::VaryingLocation& location : packing.locations)
+			{
+				const auto& member = structDesc.members[location.memberIndex];
+
+				nlohmann::json& memberDoc = memberArray.emplace_back();
+				memberDoc["member"] = (!member.originalName.empty()) ? member.originalName : member.name;
+				memberDoc["original_location"] = location.originalLocation;
+				memberDoc["location"] = location.location;
+				memberDoc["location_count"] = location.locationCount;
+				memberDoc["first_component"] = location.firstComponent;
+				memberDoc["component_count"] = location.componentCount;
+				memberDoc["packed"] = location.packedVaryingIndex.has_value();
+			}
+		}
+
+		nlohmann::json finalDoc;
+		finalDoc["varyings"] = std::move(varyingArray);
+
+		std::string varyingStr = finalDoc.dump(4);
+
+		outputPath.replace_extension("varyings.json");
+		OutputFile(std::move(outputPath), varyingStr.data(), varyingStr.size());
+	}
+
 	void Compiler::ReadInput()
 	{
 		using namespace std::literals;
@@ -618,27 +1223,53 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		using namespace std::literals;
 
 		nzsl::Ast::SanitizeVisitor::Options sanitizeOptions;
+		sanitizeOptions.compilationStats = m_compilationStats.get();
 		sanitizeOptions.partialSanitization = m_options.count("partial") > 0;
 
+		// Options have to stay unresolved to compile permutations
+		if (m_options.count("permutations") > 0)
+			sanitizeOptions.partialSanitization = true;
+
 		if (m_options.count("module") > 0)
 		{
-			std::shared_ptr<nzsl::FilesystemModuleResolver> resolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+			const std::vector<std::string>& modulePaths = m_options["module"].as<std::vector<std::string>>();
 
-			for (const std::string& modulePath : m_options["module"].as<std::vector<std::string>>())
+			std::shared_ptr<nzsl::FilesystemModuleResolver> resolver;
+			std::size_t filesystemStamp = 0;
+			if (m_moduleResolverCache)
 			{
-				std::filesystem::path path = Nz::Utf8Path(modulePath);
-				if (std::filesystem::is_regular_file(path))
-				{
-					std::string stepName = "Register module " + Nz::PathToString(path);
-					Step(stepName, [&] { resolver->RegisterFile(path); });
-				}
-				else if (std::filesystem::is_directory(path))
+				// Reuse modules loaded by a previous compilation as long as no module file changed
+				filesystemStamp = Step("Check module files"sv, [&] { return ComputeFilesystemStamp(modulePaths); });
+
+				auto it = m_moduleResolverCache->entries.find(modulePaths);
+				if (it != m_moduleResolverCache->entries.end() && it->second.filesystemStamp == filesystemStamp)
+					resolver = it->second.resolver;
+			}
+
+			if (!resolver)
+			{
+				resolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+				resolver->SetLazyLoading(true); //< only parse modules which are imported
+
+				for (const std::string& modulePath : modulePaths)
 				{
-					std::string stepName = "Register module directory " + Nz::PathToString(path);
-					Step(stepName, [&] { resolver->RegisterDirectory(path); });
+					std::filesystem::path path = Nz::Utf8Path(modulePath);
+					if (std::filesystem::is_regular_file(path))
+					{
+						std::string stepName = "Register module " + Nz::PathToString(path);
+						Step(stepName, [&] { resolver->RegisterFile(path); });
+					}
+					else if (std::filesystem::is_directory(path))
+					{
+						std::string stepName = "Register module directory " + Nz::PathToString(path);
+						Step(stepName, [&] { resolver->RegisterDirectory(path); });
+					}
+					else
+						throw std::runtime_error(modulePath + " is not a path nor a directory");
 				}
-				else
-					throw std::runtime_error(modulePath + " is not a path nor a directory");
+
+				if (m_moduleResolverCache)
+					m_moduleResolverCache->entries[modulePaths] = { resolver, filesystemStamp };
 			}
 
 			sanitizeOptions.moduleResolver = std::move(resolver);
@@ -647,6 +1278,43 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		m_shaderModule = Step("AST processing"sv, [&] { return nzsl::Ast::Sanitize(*m_shaderModule, sanitizeOptions); });
 	}
 
+	void Compiler::SaveTrace()
+	{
+		nlohmann::json traceEvents = nlohmann::json::array();
+		for (const nzsl::CompilationStats::Phase& phase : m_compilationStats->GetPhases())
+		{
+			if (!phase.finished)
+				continue;
+
+			nlohmann::json& eventDoc = traceEvents.emplace_back();
+			eventDoc["name"] = phase.name;
+			eventDoc["cat"] = phase.category;
+			eventDoc["ph"] = "X"; //< complete event
+			eventDoc["ts"] = phase.start.count();
+			eventDoc["dur"] = phase.duration.count();
+			eventDoc["pid"] = 0;
+			eventDoc["tid"] = phase.threadIndex;
+
+			nlohmann::json& argsDoc = eventDoc["args"];
+			argsDoc = nlohmann::json::object();
+			if (phase.nodeCount)
+				argsDoc["nodes"] = *phase.nodeCount;
+
+			if (phase.allocationCount)
+				argsDoc["allocations"] = *phase.allocationCount;
+		}
+
+		nlohmann::json traceDoc;
+		traceDoc["traceEvents"] = std::move(traceEvents);
+		traceDoc["displayTimeUnit"] = "ms";
+
+		std::string traceStr = traceDoc.dump(4);
+		WriteFileContent(m_tracePath, traceStr.data(), traceStr.size());
+
+		if (m_verbose)
+			fmt::print("Generated file {}\n", Nz::PathToString(std::filesystem::absolute(m_tracePath)));
+	}
+
 	template<typename F, typename... Args>
 	auto Compiler::Step(std::enable_if_t<!std::is_member_function_pointer_v<F>, std::string_view> stepName, F&& func, Args&&... args) -> decltype(std::invoke(func, std::forward<Args>(args)...))
 	{
@@ -662,6 +1330,8 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 	template<typename F>
 	auto Compiler::StepInternal(std::string_view stepName, F&& func) -> decltype(func())
 	{
+		nzsl::CompilationStats::Scope stepScope(m_compilationStats.get(), "nzslc", stepName);
+
 		if (!m_profiling)
 			return func();
 
@@ -705,8 +1375,18 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 
 	nzsl::Ast::ModulePtr Compiler::Parse(std::string_view sourceContent, const std::string& filePath)
 	{
-		std::vector<nzsl::Token> tokens = nzsl::Tokenize(sourceContent, filePath);
-		return nzsl::Parse(tokens);
+		std::vector<nzsl::Token> tokens;
+		{
+			nzsl::CompilationStats::Scope lexerScope(m_compilationStats.get(), "lexer", "Tokenize " + filePath);
+			tokens = nzsl::Tokenize(sourceContent, filePath);
+		}
+
+		nzsl::CompilationStats::Scope parserScope(m_compilationStats.get(), "parser", "Parse " + filePath);
+
+		nzsl::Ast::ModulePtr module = nzsl::Parse(tokens);
+		parserScope.SetNodeCount(*module);
+
+		return module;
 	}
 
 	std::vector<std::uint8_t> Compiler::ReadFileContent(const std::filesystem::path& filePath)
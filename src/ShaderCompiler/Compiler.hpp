@@ -7,17 +7,37 @@
 #ifndef NZSLC_COMPILER_HPP
 #define NZSLC_COMPILER_HPP
 
+#include <NZSL/CompilationStats.hpp>
 #include <NZSL/Config.hpp>
+#include <NZSL/FilesystemModuleResolver.hpp>
+#include <NZSL/GlslWriter.hpp>
 #include <NZSL/ShaderWriter.hpp>
+#include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Lang/Errors.hpp>
 #include <NZSL/Ast/Module.hpp>
 #include <cxxopts.hpp>
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace nzslc
 {
+	// Keeps module resolvers (and the modules they loaded) alive across compilations, indexed by module paths
+	struct ModuleResolverCache
+	{
+		struct Entry
+		{
+			std::shared_ptr<nzsl::FilesystemModuleResolver> resolver;
+			std::size_t filesystemStamp;
+		};
+
+		std::map<std::vector<std::string>, Entry> entries;
+	};
+
 	class Compiler
 	{
 		public:
@@ -25,7 +45,7 @@ namespace nzslc
 			static constexpr std::uint32_t MinorVersion = 1;
 			static constexpr std::uint32_t PatchVersion = 0;
 
-			Compiler(cxxopts::ParseResult& options);
+			Compiler(cxxopts::ParseResult& options, ModuleResolverCache* moduleResolverCache = nullptr);
 			Compiler(const Compiler&) = delete;
 			Compiler(Compiler&&) = delete;
 			~Compiler() = default;
@@ -48,23 +68,45 @@ namespace nzslc
 			};
 
 		private:
+			// Backend outputs generated from the sanitized module, each backend writes its own members
+			struct GeneratedOutputs
+			{
+				std::string glslBindings;
+				std::string nzsl;
+				std::vector<std::pair<nzsl::ShaderStageType, nzsl::GlslWriter::Output>> glslStages;
+				std::vector<std::uint8_t> nzslb;
+				std::vector<std::uint32_t> spirv;
+				std::vector<nzsl::SpirvWriter::SpecializationConstant> spirvSpecializationConstants;
+			};
+
+			nzsl::GlslWriter::Environment BuildGlslEnvironment();
+			nzsl::SpirvWriter::Environment BuildSpirvEnvironment();
 			nzsl::ShaderWriter::States BuildWriterOptions();
 			void Compile();
-			void CompileToGLSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
-			void CompileToNZSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
-			void CompileToNZSLB(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
-			void CompileToSPV(std::filesystem::path outputPath, const nzsl::Ast::Module& module, bool textual);
+			void CompilePermutationsToGLSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
+			void CompilePermutationsToSPV(std::filesystem::path outputPath, const nzsl::Ast::Module& module, bool textual);
+			void GenerateGLSL(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::GlslWriter::Environment& env, const nzsl::ShaderWriter::States& states);
+			void GenerateNZSL(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::ShaderWriter::States& states);
+			void GenerateNZSLB(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::ShaderWriter::States& states);
+			void GenerateSPV(GeneratedOutputs& outputs, const nzsl::Ast::Module& module, const nzsl::SpirvWriter::Environment& env, const nzsl::ShaderWriter::States& states);
+			nzsl::Ast::ModulePtr Parse(std::string_view sourceContent, const std::string& filePath);
 			void PrintTime();
+			void OutputBlockLayouts(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
 			void OutputFile(std::filesystem::path filePath, const void* data, std::size_t size);
+			void OutputGLSL(std::filesystem::path outputPath, const GeneratedOutputs& outputs);
+			void OutputNZSL(std::filesystem::path outputPath, const GeneratedOutputs& outputs);
+			void OutputNZSLB(std::filesystem::path outputPath, const GeneratedOutputs& outputs);
+			void OutputSPV(std::filesystem::path outputPath, const GeneratedOutputs& outputs, bool textual);
 			void OutputToStdout(std::string_view str);
+			void OutputVaryingLocations(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
 			void ReadInput();
 			void Sanitize();
+			void SaveTrace();
 			template<typename F, typename... Args> auto Step(std::enable_if_t<!std::is_member_function_pointer_v<F>, std::string_view> stepName, F&& func, Args&&... args) -> decltype(std::invoke(func, std::forward<Args>(args)...));
 			template<typename F, typename... Args> auto Step(std::enable_if_t<std::is_member_function_pointer_v<F>, std::string_view> stepName, F&& func, Args&&... args) -> decltype(std::invoke(func, this, std::forward<Args>(args)...));
 			template<typename F> auto StepInternal(std::string_view stepName, F&& func) -> decltype(func());
 			nzsl::Ast::ModulePtr Deserialize(const std::uint8_t* data, std::size_t size);
 
-			static nzsl::Ast::ModulePtr Parse(std::string_view sourceContent, const std::string& filePath);
 			static std::vector<std::uint8_t> ReadFileContent(const std::filesystem::path& filePath);
 			static std::string ReadSourceFileContent(const std::filesystem::path& filePath);
 			static std::string ToHeader(const void* data, std::size_t size);
@@ -79,10 +121,13 @@ namespace nzslc
 
 			std::filesystem::path m_inputFilePath;
 			std::filesystem::path m_outputPath;
+			std::filesystem::path m_tracePath;
+			std::unique_ptr<nzsl::CompilationStats> m_compilationStats;
 			std::vector<StepTime> m_steps;
 			LogFormat m_logFormat;
 			nzsl::Ast::ModulePtr m_shaderModule;
 			cxxopts::ParseResult& m_options;
+			ModuleResolverCache* m_moduleResolverCache;
 			bool m_profiling;
 			bool m_outputHeader;
 			bool m_outputToStdout;
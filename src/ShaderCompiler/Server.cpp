@@ -0,0 +1,149 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <ShaderCompiler/Server.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <nlohmann/json.hpp>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace nzslc
+{
+	int Server::Run()
+	{
+		std::fflush(stdout);
+
+		// Keep the real stdout for responses and redirect everything else printed on stdout to stderr
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+
+		int responseFd = _dup(_fileno(stdout));
+		if (responseFd < 0 || _dup2(_fileno(stderr), _fileno(stdout)) < 0)
+			throw std::runtime_error("failed to redirect stdout");
+
+		m_output = _fdopen(responseFd, "wb");
+#else
+		int responseFd = dup(STDOUT_FILENO);
+		if (responseFd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+			throw std::runtime_error("failed to redirect stdout");
+
+		m_output = fdopen(responseFd, "wb");
+#endif
+		if (!m_output)
+			throw std::runtime_error("failed to open response stream");
+
+		m_input = stdin;
+
+		std::string request;
+		while (ReadMessage(request))
+			WriteMessage(ProcessRequest(request));
+
+		std::fclose(m_output);
+		m_output = nullptr;
+
+		return EXIT_SUCCESS;
+	}
+
+	std::string Server::ProcessRequest(const std::string& request)
+	{
+		nlohmann::json response;
+		try
+		{
+			nlohmann::json arguments = nlohmann::json::parse(request);
+			if (!arguments.is_array())
+				throw std::runtime_error("request must be an array of command-line arguments");
+
+			std::vector<std::string> args;
+			args.reserve(arguments.size() + 1);
+			args.emplace_back("nzslc");
+			for (const nlohmann::json& argument : arguments)
+				args.push_back(argument.get<std::string>());
+
+			std::vector<const char*> argv;
+			argv.reserve(args.size());
+			for (const std::string& arg : args)
+				argv.push_back(arg.c_str());
+
+			cxxopts::Options cmdOptions = Compiler::BuildOptions();
+			cxxopts::ParseResult options = cmdOptions.parse(static_cast<int>(argv.size()), argv.data());
+
+			if (options.count("server") > 0)
+				throw std::runtime_error("server mode cannot be nested");
+
+			if (options["output"].as<std::string>() == "@stdout")
+				throw std::runtime_error("@stdout output is not supported in server mode, stdout is used for responses");
+
+			Compiler compiler(options, &m_moduleResolverCache);
+
+			try
+			{
+				compiler.HandleParameters();
+				compiler.Process();
+			}
+			catch (const nzsl::Error& error)
+			{
+				compiler.PrintError(error);
+				throw;
+			}
+
+			response["success"] = true;
+		}
+		catch (const std::exception& e)
+		{
+			response["success"] = false;
+			response["error"] = e.what();
+		}
+
+		std::fflush(stdout);
+		std::fflush(stderr);
+
+		return response.dump();
+	}
+
+	bool Server::ReadMessage(std::string& message)
+	{
+		std::array<std::uint8_t, 4> sizeBytes;
+		std::size_t readSize = std::fread(sizeBytes.data(), 1, sizeBytes.size(), m_input);
+		if (readSize == 0 && std::feof(m_input))
+			return false; //< client closed the connection
+
+		if (readSize != sizeBytes.size())
+			throw std::runtime_error("failed to read message size");
+
+		std::uint32_t messageSize = std::uint32_t(sizeBytes[0]) | std::uint32_t(sizeBytes[1]) << 8 | std::uint32_t(sizeBytes[2]) << 16 | std::uint32_t(sizeBytes[3]) << 24;
+
+		message.resize(messageSize);
+		if (messageSize > 0 && std::fread(message.data(), 1, messageSize, m_input) != messageSize)
+			throw std::runtime_error("failed to read message");
+
+		return true;
+	}
+
+	void Server::WriteMessage(const std::string& message)
+	{
+		std::uint32_t messageSize = Nz::SafeCast<std::uint32_t>(message.size());
+
+		std::array<std::uint8_t, 4> sizeBytes = {
+			std::uint8_t(messageSize & 0xFF),
+			std::uint8_t((messageSize >> 8) & 0xFF),
+			std::uint8_t((messageSize >> 16) & 0xFF),
+			std::uint8_t((messageSize >> 24) & 0xFF)
+		};
+
+		if (std::fwrite(sizeBytes.data(), 1, sizeBytes.size(), m_output) != sizeBytes.size() || std::fwrite(message.data(), 1, message.size(), m_output) != message.size())
+			throw std::runtime_error("failed to write response");
+
+		std::fflush(m_output);
+	}
+}
@@ -0,0 +1,48 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSLC_SERVER_HPP
+#define NZSLC_SERVER_HPP
+
+#include <ShaderCompiler/Compiler.hpp>
+#include <cstdio>
+#include <string>
+
+namespace nzslc
+{
+	// Compiles shaders on request, keeping loaded modules between requests
+	//
+	// Every message (request or response) is a 32-bit little-endian byte count followed by a UTF-8 JSON payload:
+	// - requests are arrays of command-line arguments (ex: ["-c", "spv", "-m", "modules/", "shader.nzsl"])
+	// - responses are objects of the form { "success": bool, "error": string (only set on failure) }
+	// Requests are read from stdin and responses written to stdout, what nzslc would print on stdout goes to stderr instead.
+	class Server
+	{
+		public:
+			Server() = default;
+			Server(const Server&) = delete;
+			Server(Server&&) = delete;
+			~Server() = default;
+
+			int Run();
+
+			Server& operator=(const Server&) = delete;
+			Server& operator=(Server&&) = delete;
+
+		private:
+			std::string ProcessRequest(const std::string& request);
+			bool ReadMessage(std::string& message);
+			void WriteMessage(const std::string& message);
+
+			ModuleResolverCache m_moduleResolverCache;
+			std::FILE* m_input = nullptr;
+			std::FILE* m_output = nullptr;
+	};
+}
+
+#include <ShaderCompiler/Server.inl>
+
+#endif // NZSLC_SERVER_HPP
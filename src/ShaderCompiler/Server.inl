@@ -0,0 +1,9 @@
+// Copyright (C) 2024 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <ShaderCompiler/Server.hpp>
+
+namespace nzslc
+{
+}
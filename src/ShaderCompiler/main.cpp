@@ -1,4 +1,5 @@
 #include <ShaderCompiler/Compiler.hpp>
+#include <ShaderCompiler/Server.hpp>
 #include <fmt/format.h>
 
 int main(int argc, char* argv[])
@@ -23,6 +24,12 @@ int main(int argc, char* argv[])
 			return EXIT_SUCCESS;
 		}
 
+		if (options.count("server") > 0)
+		{
+			nzslc::Server server;
+			return server.Run();
+		}
+
 		nzslc::Compiler compiler(options);
 
 		try
@@ -0,0 +1,100 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/AsyncCompiler.hpp>
+#include <NZSL/Parser.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <deque>
+
+TEST_CASE("async compiler", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseColor: bool = false;
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	const if (UseColor)
+		output.color = vec4[f32](1.0, 0.0, 0.0, 1.0);
+	else
+		output.color = vec4[f32](1.0, 1.0, 1.0, 1.0);
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::ShaderWriter::States states;
+	states.optionValues[nzsl::Ast::HashOption("UseColor")] = true;
+
+	WHEN("Using internal threads")
+	{
+		nzsl::AsyncCompiler compiler(2);
+
+		nzsl::AsyncCompiler::JobPtr spirvJob = compiler.SubmitSpirv(shaderModule, states);
+		nzsl::AsyncCompiler::JobPtr glslJob = compiler.SubmitGlsl(shaderModule, nzsl::ShaderStageType::Fragment, states);
+		nzsl::AsyncCompiler::JobPtr nzslJob = compiler.SubmitNzsl(shaderModule, states);
+
+		nzsl::SpirvWriter spirvWriter;
+		CHECK(spirvJob->GetSpirvOutput() == spirvWriter.Generate(*shaderModule, states));
+		CHECK(spirvJob->GetStatus() == nzsl::CompileJobStatus::Succeeded);
+
+		nzsl::GlslWriter glslWriter;
+		CHECK(glslJob->GetGlslOutput().code == glslWriter.Generate(nzsl::ShaderStageType::Fragment, *shaderModule, {}, states).code);
+
+		nzsl::LangWriter langWriter;
+		CHECK(nzslJob->GetNzslOutput() == langWriter.Generate(*shaderModule, states));
+
+		// Errors are reported when retrieving the output
+		nzsl::Ast::ModulePtr invalidModule = nzsl::Parse(R"(
+[nzsl_version("1.0")]
+module;
+
+option RequiredOption: bool;
+)");
+
+		nzsl::AsyncCompiler::JobPtr failingJob = compiler.SubmitSpirv(invalidModule);
+		CHECK_THROWS(failingJob->GetSpirvOutput());
+		CHECK(failingJob->GetStatus() == nzsl::CompileJobStatus::Failed);
+		CHECK_FALSE(failingJob->Cancel());
+	}
+
+	WHEN("Using a user executor")
+	{
+		std::deque<std::function<void()>> tasks;
+		nzsl::AsyncCompiler compiler([&](std::function<void()> task) { tasks.push_back(std::move(task)); });
+
+		nzsl::AsyncCompiler::JobPtr lowPriorityJob = compiler.SubmitSpirv(shaderModule, states, {}, 0);
+		nzsl::AsyncCompiler::JobPtr highPriorityJob = compiler.SubmitSpirv(shaderModule, states, {}, 10);
+		nzsl::AsyncCompiler::JobPtr cancelledJob = compiler.SubmitGlsl(shaderModule, std::nullopt, states, {}, {}, 20);
+		REQUIRE(tasks.size() == 3);
+
+		CHECK(cancelledJob->Cancel());
+		CHECK(cancelledJob->GetStatus() == nzsl::CompileJobStatus::Cancelled);
+		CHECK(cancelledJob->IsFinished());
+		CHECK_THROWS(cancelledJob->GetGlslOutput());
+
+		CHECK_FALSE(lowPriorityJob->WaitFor(std::chrono::milliseconds(1)));
+
+		// Executor tasks run the most important pending job first
+		tasks.front()();
+		tasks.pop_front();
+
+		CHECK(highPriorityJob->GetStatus() == nzsl::CompileJobStatus::Succeeded);
+		CHECK(lowPriorityJob->GetStatus() == nzsl::CompileJobStatus::Pending);
+
+		for (auto& task : tasks)
+			task();
+
+		CHECK(lowPriorityJob->GetStatus() == nzsl::CompileJobStatus::Succeeded);
+		CHECK(lowPriorityJob->GetSpirvOutput() == highPriorityJob->GetSpirvOutput());
+	}
+}
@@ -0,0 +1,135 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/CompilationStats.hpp>
+#include <NZSL/FilesystemModuleResolver.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <thread>
+
+TEST_CASE("compilation stats", "[Shader]")
+{
+	std::string_view importedSource = R"(
+[nzsl_version("1.0")]
+module Color;
+
+[export]
+fn GetColor() -> vec4[f32]
+{
+	return vec4[f32](1.0, 0.0, 0.0, 1.0);
+}
+)";
+
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+import GetColor from Color;
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	output.color = GetColor();
+	return output;
+}
+)";
+
+	auto moduleResolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+	moduleResolver->RegisterModule(importedSource);
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::CompilationStats stats;
+
+	std::uint64_t allocationCount = 0;
+	stats.SetAllocationCounter([&] { return allocationCount += 10; });
+
+	nzsl::ShaderWriter::States states;
+	states.compilationStats = &stats;
+	states.optimize = true;
+	states.shaderModuleResolver = moduleResolver;
+
+	nzsl::SpirvWriter writer;
+	writer.Generate(*shaderModule, states);
+
+	std::vector<nzsl::CompilationStats::Phase> phases = stats.GetPhases();
+
+	auto FindPhase = [&](std::string_view category, std::string_view name) -> const nzsl::CompilationStats::Phase*
+	{
+		auto it = std::find_if(phases.begin(), phases.end(), [&](const nzsl::CompilationStats::Phase& phase) { return phase.category == category && phase.name == name; });
+		return (it != phases.end()) ? &*it : nullptr;
+	};
+
+	const nzsl::CompilationStats::Phase* sanitizePhase = FindPhase("sanitize", "Sanitization");
+	REQUIRE(sanitizePhase);
+	CHECK(sanitizePhase->depth == 0);
+	REQUIRE(sanitizePhase->nodeCount);
+	CHECK(*sanitizePhase->nodeCount > 0);
+
+	const nzsl::CompilationStats::Phase* importPhase = FindPhase("import", "Import Color");
+	REQUIRE(importPhase);
+	CHECK(importPhase->depth > sanitizePhase->depth);
+	CHECK(importPhase->start >= sanitizePhase->start);
+	CHECK(importPhase->nodeCount);
+
+	CHECK(FindPhase("optimize", "Constant propagation"));
+	CHECK(FindPhase("optimize", "Eliminate unused code"));
+
+	const nzsl::CompilationStats::Phase* codegenPhase = FindPhase("codegen", "SPIR-V generation");
+	REQUIRE(codegenPhase);
+	CHECK(codegenPhase->depth == 0);
+
+	for (const nzsl::CompilationStats::Phase& phase : phases)
+	{
+		CHECK(phase.finished);
+		CHECK(phase.threadIndex == 0);
+		REQUIRE(phase.allocationCount);
+		CHECK(*phase.allocationCount > 0);
+	}
+
+	WHEN("Clearing stats")
+	{
+		stats.Clear();
+		CHECK(stats.GetPhases().empty());
+	}
+
+	WHEN("Counting allocations of concurrent phases")
+	{
+		static thread_local std::uint64_t threadAllocationCount = 0;
+
+		nzsl::CompilationStats threadStats;
+		threadStats.SetAllocationCounter([] { return threadAllocationCount; });
+
+		std::size_t mainPhase = threadStats.BeginPhase("codegen", "Main thread");
+
+		std::thread worker([&]
+		{
+			std::size_t workerPhase = threadStats.BeginPhase("codegen", "Worker thread");
+			threadAllocationCount += 7;
+			threadStats.EndPhase(workerPhase);
+		});
+		worker.join();
+
+		threadAllocationCount += 3;
+		threadStats.EndPhase(mainPhase);
+
+		std::vector<nzsl::CompilationStats::Phase> threadPhases = threadStats.GetPhases();
+		REQUIRE(threadPhases.size() == 2);
+		REQUIRE(threadPhases[0].allocationCount);
+		CHECK(*threadPhases[0].allocationCount == 3);
+		REQUIRE(threadPhases[1].allocationCount);
+		CHECK(*threadPhases[1].allocationCount == 7);
+		CHECK(threadPhases[1].threadIndex == 1);
+	}
+
+	WHEN("Counting nodes")
+	{
+		CHECK(nzsl::CompilationStats::CountNodes(*shaderModule) > 0);
+	}
+}
@@ -848,6 +848,34 @@ struct Bar
 }
 )"), "(14, 2): CStructLayoutInnerMismatch error: inner struct layout mismatch, struct is declared with std430 but field has layout std140");
 
+			CHECK_THROWS_WITH(Compile(R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(scalar)]
+struct Foo
+{
+	a: bool
+}
+)"), "(8, 2): CStructLayoutTypeNotAllowed error: bool type is not allowed in scalar layout");
+
+			CHECK_THROWS_WITH(Compile(R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(std430)]
+struct Foo
+{
+	a: vec3[f32]
+}
+
+[layout(scalar)]
+struct Bar
+{
+	a: Foo
+}
+)"), "(14, 2): CStructLayoutInnerMismatch error: inner struct layout mismatch, struct is declared with scalar but field has layout std430");
+
 		}
 
 		/************************************************************************/
@@ -980,6 +1008,21 @@ option WrongType: array[baz];
 
 		/************************************************************************/
 
+		SECTION("Precision")
+		{
+			CHECK_THROWS_WITH(Compile(R"(
+[nzsl_version("1.0")]
+module;
+
+struct Foo
+{
+	[precision(medium)] a: vec2[i32]
+}
+)"), "(7, 22): CStructFieldPrecisionType error: precision attribute requires a f32 type (scalar, vector, matrix or array of them), got vec2[i32]");
+		}
+
+		/************************************************************************/
+
 		SECTION("Variables")
 		{
 			CHECK_THROWS_WITH(Compile(R"(
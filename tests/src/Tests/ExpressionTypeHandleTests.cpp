@@ -0,0 +1,92 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/Ast/ExpressionTypeHandle.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <unordered_set>
+
+TEST_CASE("expression type handles", "[Shader]")
+{
+	WHEN("Interning types")
+	{
+		nzsl::Ast::ArrayType arrayType;
+		arrayType.containedType = std::make_unique<nzsl::Ast::ContainedType>();
+		arrayType.containedType->type = nzsl::Ast::VectorType{ 3, nzsl::Ast::PrimitiveType::Float32 };
+		arrayType.length = 4;
+
+		nzsl::Ast::ExpressionTypeHandle first = arrayType;
+		nzsl::Ast::ExpressionTypeHandle second = nzsl::Ast::ExpressionType{ arrayType };
+
+		CHECK(first == second);
+		CHECK(&first.Get() == &second.Get());
+		CHECK(first.GetHash() == std::hash<nzsl::Ast::ExpressionType>{}(first.Get()));
+		CHECK(first != nzsl::Ast::ExpressionTypeHandle(nzsl::Ast::VectorType{ 3, nzsl::Ast::PrimitiveType::Float32 }));
+
+		std::unordered_set<nzsl::Ast::ExpressionTypeHandle> handles = { first, second };
+		CHECK(handles.size() == 1);
+	}
+
+	WHEN("Releasing handles")
+	{
+		nzsl::Ast::ArrayType arrayType;
+		arrayType.containedType = std::make_unique<nzsl::Ast::ContainedType>();
+		arrayType.containedType->type = nzsl::Ast::PrimitiveType::UInt32;
+		arrayType.length = 7919;
+
+		std::size_t typeCount = nzsl::Ast::ExpressionTypeHandle::GetInternedTypeCount();
+		{
+			nzsl::Ast::ExpressionTypeHandle handle = arrayType;
+			nzsl::Ast::ExpressionTypeHandle handleCopy = handle;
+			CHECK(nzsl::Ast::ExpressionTypeHandle::GetInternedTypeCount() == typeCount + 1);
+		}
+
+		// the type is released with its last handle
+		CHECK(nzsl::Ast::ExpressionTypeHandle::GetInternedTypeCount() == typeCount);
+
+		nzsl::Ast::ExpressionTypeHandle handle = arrayType;
+		CHECK(handle.Get() == nzsl::Ast::ExpressionType{ arrayType });
+		CHECK(nzsl::Ast::ExpressionTypeHandle::GetInternedTypeCount() == typeCount + 1);
+	}
+
+	WHEN("Sanitizing a module")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+[entry(frag)]
+fn main()
+{
+	let a = vec3[f32](1.0, 2.0, 3.0);
+	let b = a + a;
+	let c = b * a;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+		shaderModule = nzsl::Ast::Sanitize(*shaderModule);
+
+		struct TypeCollector : nzsl::Ast::RecursiveVisitor
+		{
+			using RecursiveVisitor::Visit;
+
+			void Visit(nzsl::Ast::BinaryExpression& node) override
+			{
+				RecursiveVisitor::Visit(node);
+				types.insert(node.cachedExpressionType.value());
+				typeAddresses.insert(&node.cachedExpressionType->Get());
+			}
+
+			std::unordered_set<nzsl::Ast::ExpressionTypeHandle> types;
+			std::unordered_set<const nzsl::Ast::ExpressionType*> typeAddresses;
+		};
+
+		TypeCollector collector;
+		shaderModule->rootNode->Visit(collector);
+
+		// both binary expressions share the same type instance
+		CHECK(collector.types.size() == 1);
+		CHECK(collector.typeAddresses.size() == 1);
+	}
+}
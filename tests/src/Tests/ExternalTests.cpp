@@ -674,6 +674,144 @@ fn main()
       OpFunctionEnd)", {}, spirvEnv, true);
 			}
 		}
+
+		SECTION("With scalar layout")
+		{
+			std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(scalar)]
+struct Particle
+{
+	position: vec3[f32],
+	mass: f32,
+	velocity: vec3[f32]
+}
+
+[layout(scalar)]
+struct Data
+{
+	transform: mat3[f32],
+	scale: f32,
+	particles: array[Particle, 4],
+	colors: dyn_array[vec3[f32]]
+}
+
+external
+{
+	[set(0), binding(0)] data: storage[Data]
+}
+
+[entry(frag)]
+fn main()
+{
+	data.colors[0] = data.transform * data.particles[1].velocity * data.scale;
+}
+)";
+
+			nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+			shaderModule = SanitizeModule(*shaderModule);
+
+			nzsl::GlslWriter::Environment glslEnv;
+			glslEnv.glMajorVersion = 4;
+			glslEnv.glMinorVersion = 6;
+			glslEnv.glES = false;
+
+			nzsl::GlslWriter glslWriter;
+			glslWriter.SetEnv(glslEnv);
+			CHECK_THROWS_WITH(glslWriter.Generate(*shaderModule), "scalar layout is not supported by GLSL (struct Data is used by external data)");
+
+			ExpectNZSL(*shaderModule, R"(
+[layout(scalar)]
+struct Particle
+{
+	position: vec3[f32],
+	mass: f32,
+	velocity: vec3[f32]
+}
+)");
+
+			nzsl::SpirvWriter::Environment spirvEnv;
+			spirvEnv.spvMajorVersion = 1;
+			spirvEnv.spvMinorVersion = 3;
+
+			ExpectSPIRV(*shaderModule, R"(
+      OpSource SourceLanguage(NZSL) 100
+      OpName %4 "Particle"
+      OpMemberName %4 0 "position"
+      OpMemberName %4 1 "mass"
+      OpMemberName %4 2 "velocity"
+      OpName %9 "Data"
+      OpMemberName %9 0 "transform"
+      OpMemberName %9 1 "scale"
+      OpMemberName %9 2 "particles"
+      OpMemberName %9 3 "colors"
+      OpName %19 "Particle"
+      OpMemberName %19 0 "position"
+      OpMemberName %19 1 "mass"
+      OpMemberName %19 2 "velocity"
+      OpName %11 "data"
+      OpName %22 "main"
+      OpDecorate %11 Decoration(Binding) 0
+      OpDecorate %11 Decoration(DescriptorSet) 0
+      OpMemberDecorate %4 0 Decoration(Offset) 0
+      OpMemberDecorate %4 1 Decoration(Offset) 12
+      OpMemberDecorate %4 2 Decoration(Offset) 16
+      OpDecorate %7 Decoration(ArrayStride) 28
+      OpDecorate %8 Decoration(ArrayStride) 12
+      OpDecorate %9 Decoration(Block)
+      OpMemberDecorate %9 0 Decoration(ColMajor)
+      OpMemberDecorate %9 0 Decoration(MatrixStride) 12
+      OpMemberDecorate %9 0 Decoration(Offset) 0
+      OpMemberDecorate %9 1 Decoration(Offset) 36
+      OpMemberDecorate %9 2 Decoration(Offset) 40
+      OpMemberDecorate %9 3 Decoration(Offset) 152
+      OpDecorate %19 Decoration(Block)
+      OpMemberDecorate %19 0 Decoration(Offset) 0
+      OpMemberDecorate %19 1 Decoration(Offset) 12
+      OpMemberDecorate %19 2 Decoration(Offset) 16
+ %1 = OpTypeFloat 32
+ %2 = OpTypeVector %1 3
+ %3 = OpTypeMatrix %2 3
+ %4 = OpTypeStruct %2 %1 %2
+ %5 = OpTypeInt 32 0
+ %6 = OpConstant %5 u32(4)
+ %7 = OpTypeArray %4 %6
+ %8 = OpTypeRuntimeArray %2
+ %9 = OpTypeStruct %3 %1 %7 %8
+%10 = OpTypePointer StorageClass(StorageBuffer) %9
+%12 = OpTypeVoid
+%13 = OpTypeFunction %12
+%14 = OpTypeInt 32 1
+%15 = OpConstant %14 i32(3)
+%16 = OpTypeRuntimeArray %2
+%17 = OpConstant %14 i32(0)
+%18 = OpConstant %14 i32(2)
+%19 = OpTypeStruct %2 %1 %2
+%20 = OpTypeArray %19 %6
+%21 = OpConstant %14 i32(1)
+%24 = OpTypePointer StorageClass(StorageBuffer) %3
+%27 = OpTypePointer StorageClass(StorageBuffer) %2
+%31 = OpTypePointer StorageClass(StorageBuffer) %1
+%36 = OpTypePointer StorageClass(StorageBuffer) %8
+%11 = OpVariable %10 StorageClass(StorageBuffer)
+%22 = OpFunction %12 FunctionControl(0) %13
+%23 = OpLabel
+%25 = OpAccessChain %24 %11 %17
+%26 = OpLoad %3 %25
+%28 = OpAccessChain %27 %11 %18 %21 %18
+%29 = OpLoad %2 %28
+%30 = OpMatrixTimesVector %2 %26 %29
+%32 = OpAccessChain %31 %11 %21
+%33 = OpLoad %1 %32
+%34 = OpVectorTimesScalar %2 %30 %33
+%35 = OpAccessChain %36 %11 %15
+%37 = OpAccessChain %27 %35 %17
+      OpStore %37 %34
+      OpReturn
+      OpFunctionEnd)", {}, spirvEnv, true);
+		}
 	}
 
 	SECTION("Primitive external")
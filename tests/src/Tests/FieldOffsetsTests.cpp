@@ -1,5 +1,9 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
 #include <NZSL/Math/FieldOffsets.hpp>
+#include <NZSL/Ast/BlockLayout.hpp>
 #include <NZSL/Ast/ExpressionType.hpp>
+#include <NZSL/Ast/ReflectVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("Field offsets", "[FieldOffsets]")
@@ -38,6 +42,25 @@ TEST_CASE("Field offsets", "[FieldOffsets]")
 		REQUIRE(fieldOffsets.AddField(nzsl::StructFieldType::Float1) == 80);
 		REQUIRE(fieldOffsets.GetAlignedSize() == 96);
 	}
+
+	SECTION("scalar")
+	{
+		nzsl::FieldOffsets innerStruct(nzsl::StructLayout::Scalar);
+		REQUIRE(innerStruct.AddField(nzsl::StructFieldType::Float3) == 0);
+		REQUIRE(innerStruct.AddField(nzsl::StructFieldType::Float1) == 12);
+		REQUIRE(innerStruct.GetLargestFieldAlignement() == 4);
+
+		nzsl::FieldOffsets fieldOffsets(nzsl::StructLayout::Scalar);
+		REQUIRE(fieldOffsets.AddField(nzsl::StructFieldType::Float1) == 0);
+		REQUIRE(fieldOffsets.AddField(nzsl::StructFieldType::Float3) == 4);
+		REQUIRE(fieldOffsets.AddFieldArray(nzsl::StructFieldType::Float3, 3) == 16);
+		REQUIRE(fieldOffsets.AddMatrix(nzsl::StructFieldType::Float1, 3, 3, true) == 52);
+		REQUIRE(fieldOffsets.AddField(nzsl::StructFieldType::Double1) == 88);
+		REQUIRE(fieldOffsets.AddField(nzsl::StructFieldType::Float2) == 96);
+		REQUIRE(fieldOffsets.AddStructArray(innerStruct, 2) == 104);
+		REQUIRE(fieldOffsets.AddField(nzsl::StructFieldType::Float1) == 136);
+		REQUIRE(fieldOffsets.GetAlignedSize() == 144);
+	}
 }
 
 TEST_CASE("RegisterStructField", "[FieldOffsets]")
@@ -75,3 +98,74 @@ TEST_CASE("RegisterStructField", "[FieldOffsets]")
 	CHECK(RegisterStructField(fieldOffsets, nzsl::Ast::PrimitiveType::UInt32, 2) == 2336);
 	CHECK(RegisterStructField(fieldOffsets, nzsl::Ast::VectorType{ 2, nzsl::Ast::PrimitiveType::UInt32 }) == 2368);
 }
+
+TEST_CASE("Block layout optimization", "[FieldOffsets]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(std140)]
+struct PerDraw
+{
+	color: vec3[f32],
+	position: vec3[f32],
+	intensity: f32,
+	radius: f32
+}
+
+[layout(std430)]
+struct Particles
+{
+	flag: u32,
+	transform: mat4[f32],
+	scale: f32,
+	offset: vec2[f32],
+	data: dyn_array[vec4[f32]]
+}
+
+external
+{
+	[binding(0)] perDraw: uniform[PerDraw],
+	[binding(1)] particles: storage[Particles]
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+	shaderModule = SanitizeModule(*shaderModule);
+
+	std::unordered_map<std::string, const nzsl::Ast::StructDescription*> structs;
+
+	nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+	callbacks.onStructDeclaration = [&](const nzsl::Ast::DeclareStructStatement& structDecl)
+	{
+		structs.emplace(structDecl.description.name, &structDecl.description);
+	};
+
+	nzsl::Ast::ReflectVisitor reflectVisitor;
+	reflectVisitor.Reflect(*shaderModule, callbacks);
+
+	SECTION("std140")
+	{
+		REQUIRE(structs.count("PerDraw"));
+
+		nzsl::Ast::BlockLayoutOptimization optimization = nzsl::Ast::OptimizeBlockLayout(*structs["PerDraw"], {});
+		CHECK(optimization.layout == nzsl::StructLayout::Std140);
+		CHECK(optimization.originalSize == 48);
+		CHECK(optimization.optimizedSize == 32);
+		CHECK(optimization.memberOrder == std::vector<std::size_t>{ 0, 2, 1, 3 });
+		CHECK(optimization.memberOffsets == std::vector<std::size_t>{ 0, 16, 12, 28 });
+	}
+
+	SECTION("std430 with a runtime array")
+	{
+		REQUIRE(structs.count("Particles"));
+
+		nzsl::Ast::BlockLayoutOptimization optimization = nzsl::Ast::OptimizeBlockLayout(*structs["Particles"], {});
+		CHECK(optimization.layout == nzsl::StructLayout::Std430);
+		CHECK(optimization.originalSize == 112);
+		CHECK(optimization.optimizedSize == 96);
+		CHECK(optimization.memberOrder == std::vector<std::size_t>{ 1, 3, 0, 2, 4 });
+		CHECK(optimization.memberOffsets == std::vector<std::size_t>{ 72, 0, 76, 64, 80 });
+	}
+}
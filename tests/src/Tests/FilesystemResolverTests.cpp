@@ -6,6 +6,7 @@
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cctype>
+#include <fstream>
 
 TEST_CASE("FilesystemModuleResolver", "[Shader]")
 {
@@ -196,3 +197,99 @@ fn main() -> Output
       OpReturn
       OpFunctionEnd)", {}, {}, true);
 }
+
+TEST_CASE("FilesystemModuleResolver lazy loading", "[Shader]")
+{
+	std::filesystem::path resourceDir = GetResourceDir();
+
+	auto GenerateShader = [&](bool lazyLoading)
+	{
+		std::shared_ptr<nzsl::FilesystemModuleResolver> moduleResolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+		moduleResolver->SetLazyLoading(lazyLoading);
+
+		REQUIRE_NOTHROW(moduleResolver->RegisterDirectory(resourceDir / "modules"));
+		REQUIRE_NOTHROW(moduleResolver->RegisterFile(resourceDir / "Shader.nzsl"));
+
+		nzsl::Ast::ModulePtr shaderModule = moduleResolver->Resolve("Shader");
+		REQUIRE(shaderModule);
+
+		nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
+		sanitizeOpt.moduleResolver = moduleResolver;
+
+		shaderModule = SanitizeModule(*shaderModule, sanitizeOpt);
+
+		nzsl::LangWriter langWriter;
+		return langWriter.Generate(*shaderModule);
+	};
+
+	CHECK(GenerateShader(true) == GenerateShader(false));
+
+	WHEN("Registering a directory containing an invalid module")
+	{
+		std::filesystem::path moduleDir = std::filesystem::temp_directory_path() / "nzsl_lazy_modules";
+		std::filesystem::create_directories(moduleDir);
+
+		{
+			std::ofstream(moduleDir / "Valid.nzsl") << "[nzsl_version(\"1.0\")]\n[author(\"Lynix\")]\nmodule Lazy.Valid;\n\nconst Value = 42;\n";
+			std::ofstream(moduleDir / "Broken.nzsl") << "[nzsl_version(\"1.0\")]\nmodule Lazy.Broken;\n\nfn Broken(\n";
+		}
+
+		nzsl::FilesystemModuleResolver moduleResolver;
+		moduleResolver.SetLazyLoading(true);
+
+		// Broken module is only parsed when resolved
+		REQUIRE_NOTHROW(moduleResolver.RegisterDirectory(moduleDir));
+
+		nzsl::Ast::ModulePtr validModule = moduleResolver.Resolve("Lazy.Valid");
+		REQUIRE(validModule);
+		CHECK(validModule->metadata->moduleName == "Lazy.Valid");
+		CHECK(moduleResolver.Resolve("Lazy.Valid") == validModule);
+
+		CHECK_THROWS(moduleResolver.Resolve("Lazy.Broken"));
+		CHECK_FALSE(moduleResolver.Resolve("Lazy.Unknown"));
+
+		std::filesystem::remove_all(moduleDir);
+	}
+}
+
+TEST_CASE("FilesystemModuleResolver parallel registration", "[Shader]")
+{
+	std::filesystem::path moduleDir = std::filesystem::temp_directory_path() / "nzsl_parallel_modules";
+	std::filesystem::remove_all(moduleDir);
+	std::filesystem::create_directories(moduleDir);
+
+	constexpr std::size_t ModuleCount = 16;
+	for (std::size_t i = 0; i < ModuleCount; ++i)
+		std::ofstream(moduleDir / ("Module" + std::to_string(i) + ".nzsl")) << "[nzsl_version(\"1.0\")]\nmodule Parallel.Module" << i << ";\n\n[export]\nconst Value = " << i << ";\n";
+
+	std::ofstream(moduleDir / "BrokenA.nzsl") << "[nzsl_version(\"1.0\")]\nmodule Parallel.BrokenA;\n\nfn Broken(\n";
+	std::ofstream(moduleDir / "BrokenB.nzsl") << "[nzsl_version(\"1.0\")]\nmodule Parallel.BrokenB;\n\nstruct\n";
+
+	nzsl::FilesystemModuleResolver moduleResolver;
+	moduleResolver.SetThreadCount(4);
+
+	// Errors of every file are reported, valid modules are still registered
+	try
+	{
+		moduleResolver.RegisterDirectory(moduleDir);
+		FAIL("registering broken modules should fail");
+	}
+	catch (const std::exception& e)
+	{
+		std::string_view errorMessage = e.what();
+		CHECK(errorMessage.find("BrokenA.nzsl") != errorMessage.npos);
+		CHECK(errorMessage.find("BrokenB.nzsl") != errorMessage.npos);
+	}
+
+	for (std::size_t i = 0; i < ModuleCount; ++i)
+	{
+		nzsl::Ast::ModulePtr module = moduleResolver.Resolve("Parallel.Module" + std::to_string(i));
+		REQUIRE(module);
+		CHECK(module->metadata->moduleName == "Parallel.Module" + std::to_string(i));
+	}
+
+	CHECK_FALSE(moduleResolver.Resolve("Parallel.BrokenA"));
+	CHECK_FALSE(moduleResolver.Resolve("Parallel.BrokenB"));
+
+	std::filesystem::remove_all(moduleDir);
+}
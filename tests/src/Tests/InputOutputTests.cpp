@@ -1,6 +1,8 @@
 #include <Tests/ShaderUtils.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/Ast/ReflectVisitor.hpp>
+#include <NZSL/Ast/VaryingPacking.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cctype>
 
@@ -383,4 +385,690 @@ fn main(input: VertIn) -> VertOut
       OpReturn
       OpFunctionEnd)", {}, spirvEnv, true);
 	}
+
+	SECTION("Testing precision qualifiers")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+struct Material
+{
+	[precision(medium)] tint: vec4[f32],
+	scale: f32
+}
+
+external
+{
+	[binding(0)] material: uniform[Material],
+	[binding(1)] tex: sampler2D[f32]
+}
+
+struct VertOut
+{
+	[location(0), precision(medium)] normal: vec3[f32],
+	[location(1)] uv: vec2[f32]
+}
+
+struct FragOut
+{
+	[location(0), precision(medium)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: VertOut) -> FragOut
+{
+	let uv = input.uv * material.scale;
+	let albedo = tex.Sample(uv) * material.tint;
+	let normal = normalize(input.normal);
+	let lighting = max(dot(normal, vec3[f32](0.0, 1.0, 0.0)), 0.0);
+	let brightness = lighting * material.scale;
+
+	let output: FragOut;
+	output.color = albedo * brightness;
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+		shaderModule = SanitizeModule(*shaderModule);
+
+		nzsl::ShaderWriter::States states;
+		states.inferPrecision = true;
+
+		ExpectGLSL(*shaderModule, R"(
+uniform _nzslBindingmaterial
+{
+	mediump vec4 tint;
+	float scale;
+} material;
+
+uniform sampler2D tex;
+
+struct VertOut
+{
+	mediump vec3 normal;
+	vec2 uv;
+};
+
+struct FragOut
+{
+	mediump vec4 color;
+};
+
+/**************** Inputs ****************/
+in mediump vec3 _nzslVarying0; // _nzslInnormal
+in vec2 _nzslVarying1; // _nzslInuv
+
+/*************** Outputs ***************/
+layout(location = 0) out mediump vec4 _nzslOutcolor;
+
+void main()
+{
+	VertOut input_;
+	input_.normal = _nzslVarying0;
+	input_.uv = _nzslVarying1;
+
+	vec2 uv = input_.uv * material.scale;
+	mediump vec4 albedo = (texture(tex, uv)) * material.tint;
+	mediump vec3 normal = normalize(input_.normal);
+	mediump float lighting = max(dot(normal, vec3(0.0, 1.0, 0.0)), 0.0);
+	float brightness = lighting * material.scale;
+	FragOut output_;
+	output_.color = albedo * brightness;
+
+	_nzslOutcolor = output_.color;
+	return;
+}
+)", states);
+
+		ExpectNZSL(*shaderModule, R"(
+struct Material
+{
+	[precision(medium)] tint: vec4[f32],
+	scale: f32
+}
+
+external
+{
+	[set(0), binding(0)] material: uniform[Material],
+	[set(0), binding(1)] tex: sampler2D[f32]
+}
+
+struct VertOut
+{
+	[location(0), precision(medium)] normal: vec3[f32],
+	[location(1)] uv: vec2[f32]
+}
+
+struct FragOut
+{
+	[location(0), precision(medium)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: VertOut) -> FragOut
+{
+	let uv: vec2[f32] = input.uv * material.scale;
+	let albedo: vec4[f32] = (tex.Sample(uv)) * material.tint;
+	let normal: vec3[f32] = normalize(input.normal);
+	let lighting: f32 = max(dot(normal, vec3[f32](0.0, 1.0, 0.0)), 0.0);
+	let brightness: f32 = lighting * material.scale;
+	let output: FragOut;
+	output.color = albedo * brightness;
+	return output;
+}
+)");
+
+		ExpectSPIRV(*shaderModule, R"(
+      OpDecorate %14 Decoration(Location) 0
+      OpDecorate %20 Decoration(Location) 1
+      OpDecorate %26 Decoration(Location) 0
+      OpDecorate %14 Decoration(RelaxedPrecision)
+      OpDecorate %26 Decoration(RelaxedPrecision)
+      OpDecorate %37 Decoration(RelaxedPrecision)
+      OpDecorate %38 Decoration(RelaxedPrecision)
+      OpDecorate %39 Decoration(RelaxedPrecision)
+      OpDecorate %3 Decoration(Block)
+      OpMemberDecorate %3 0 Decoration(Offset) 0
+      OpMemberDecorate %3 0 Decoration(RelaxedPrecision)
+      OpMemberDecorate %3 1 Decoration(Offset) 16
+      OpMemberDecorate %23 0 Decoration(Offset) 0
+      OpMemberDecorate %23 0 Decoration(RelaxedPrecision)
+      OpMemberDecorate %23 1 Decoration(Offset) 16
+      OpMemberDecorate %27 0 Decoration(Offset) 0
+      OpMemberDecorate %27 0 Decoration(RelaxedPrecision)
+)", states, {}, true);
+	}
+
+	SECTION("Testing precision inference of growing values")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+external
+{
+	[binding(0)] tex: sampler2D[f32]
+}
+
+struct VertOut
+{
+	[location(0)] uv: vec2[f32]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: VertOut) -> FragOut
+{
+	let sample = tex.Sample(input.uv);
+	let halved = sample.x * 0.5;
+	let scaled = sample.x * 10000.0 * 10000.0;
+
+	let acc = vec4[f32](0.0, 0.0, 0.0, 0.0);
+	let i = 0;
+	while (i < 16)
+	{
+		acc = acc + sample;
+		i += 1;
+	}
+
+	let output: FragOut;
+	output.color = acc * (halved + scaled);
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+		shaderModule = SanitizeModule(*shaderModule);
+
+		nzsl::ShaderWriter::States states;
+		states.inferPrecision = true;
+
+		// the multiplication by large constants and the accumulation in the loop may overflow medium precision
+		ExpectGLSL(*shaderModule, R"(
+void main()
+{
+	VertOut input_;
+	input_.uv = _nzslVarying0;
+
+	mediump vec4 sample_ = texture(tex, input_.uv);
+	mediump float halved = sample_.x * (0.5);
+	float scaled = (sample_.x * (10000.0)) * (10000.0);
+	vec4 acc = vec4(0.0, 0.0, 0.0, 0.0);
+	int i = 0;
+	while (i < (16))
+	{
+		acc = acc + sample_;
+		i += 1;
+	}
+
+	FragOut output_;
+	output_.color = acc * (halved + scaled);
+
+	_nzslOutcolor = output_.color;
+	return;
+}
+)", states);
+	}
+
+	SECTION("Testing varying packing")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+struct VertIn
+{
+	[location(0)] pos: vec3[f32],
+	[location(1)] uv: vec2[f32],
+	[location(2)] normal: vec3[f32]
+}
+
+struct VertOut
+{
+	[builtin(position)] position: vec4[f32],
+	[location(0)] uv: vec2[f32],
+	[location(1)] normal: vec3[f32],
+	[location(2)] lightUv: vec2[f32],
+	[location(3)] fogFactor: f32,
+	[location(4), interp(flat)] materialIndex: u32,
+	[location(5), interp(flat)] instanceIndex: u32
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: VertOut) -> FragOut
+{
+	let output: FragOut;
+	output.color = vec4[f32](input.normal * input.fogFactor, f32(input.materialIndex + input.instanceIndex)) + vec4[f32](input.uv, input.lightUv);
+	return output;
+}
+
+[entry(vert)]
+fn main(input: VertIn) -> VertOut
+{
+	let output: VertOut;
+	output.position = vec4[f32](input.pos, 1.0);
+	output.uv = input.uv;
+	output.normal = input.normal;
+	output.lightUv = input.uv * 0.5;
+	output.fogFactor = input.pos.z;
+	output.materialIndex = u32(1);
+	output.instanceIndex = u32(2);
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+		shaderModule = SanitizeModule(*shaderModule);
+
+		nzsl::ShaderWriter::States states;
+		states.packVaryings = true;
+
+		nzsl::GlslWriter::Environment glslEnv;
+		glslEnv.glES = false;
+		glslEnv.glMajorVersion = 4;
+		glslEnv.glMinorVersion = 6;
+
+		ExpectGLSL(nzsl::ShaderStageType::Vertex, *shaderModule, R"(
+/*************** Outputs ***************/
+layout(location = 0) out vec4 _nzslOutPacked0;
+layout(location = 1) out vec4 _nzslOutPacked1;
+layout(location = 2) flat out uvec2 _nzslOutPacked2;
+
+void main()
+{
+	VertIn input_;
+	input_.pos = _nzslInpos;
+	input_.uv = _nzslInuv;
+	input_.normal = _nzslInnormal;
+
+	VertOut output_;
+	output_.position = vec4(input_.pos, 1.0);
+	output_.uv = input_.uv;
+	output_.normal = input_.normal;
+	output_.lightUv = input_.uv * (0.5);
+	output_.fogFactor = input_.pos.z;
+	output_.materialIndex = uint(1);
+	output_.instanceIndex = uint(2);
+
+	gl_Position = output_.position;
+	_nzslOutPacked0.xy = output_.uv;
+	_nzslOutPacked1.xyz = output_.normal;
+	_nzslOutPacked0.zw = output_.lightUv;
+	_nzslOutPacked1.w = output_.fogFactor;
+	_nzslOutPacked2.x = output_.materialIndex;
+	_nzslOutPacked2.y = output_.instanceIndex;
+	return;
+}
+)", states, glslEnv);
+
+		ExpectGLSL(nzsl::ShaderStageType::Fragment, *shaderModule, R"(
+/**************** Inputs ****************/
+layout(location = 0) in vec4 _nzslInPacked0;
+layout(location = 1) in vec4 _nzslInPacked1;
+layout(location = 2) flat in uvec2 _nzslInPacked2;
+
+/*************** Outputs ***************/
+layout(location = 0) out vec4 _nzslOutcolor;
+
+void main()
+{
+	VertOut input_;
+	input_.uv = _nzslInPacked0.xy;
+	input_.normal = _nzslInPacked1.xyz;
+	input_.lightUv = _nzslInPacked0.zw;
+	input_.fogFactor = _nzslInPacked1.w;
+	input_.materialIndex = _nzslInPacked2.x;
+	input_.instanceIndex = _nzslInPacked2.y;
+
+	FragOut output_;
+	output_.color = (vec4(input_.normal * input_.fogFactor, float(input_.materialIndex + input_.instanceIndex))) + (vec4(input_.uv, input_.lightUv));
+
+	_nzslOutcolor = output_.color;
+	return;
+}
+)", states, glslEnv);
+
+		ExpectSPIRV(*shaderModule, R"(
+       OpCapability Capability(Shader)
+       OpMemoryModel AddressingModel(Logical) MemoryModel(GLSL450)
+       OpEntryPoint ExecutionModel(Fragment) %46 "main" %28 %6 %12 %21
+       OpEntryPoint ExecutionModel(Vertex) %47 "main" %33 %35 %36 %39 %40 %41 %43
+       OpExecutionMode %46 ExecutionMode(OriginUpperLeft)
+       OpSource SourceLanguage(NZSL) 100
+       OpName %25 "VertOut"
+       OpMemberName %25 0 "position"
+       OpMemberName %25 1 "uv"
+       OpMemberName %25 2 "normal"
+       OpMemberName %25 3 "lightUv"
+       OpMemberName %25 4 "fogFactor"
+       OpMemberName %25 5 "materialIndex"
+       OpMemberName %25 6 "instanceIndex"
+       OpName %29 "FragOut"
+       OpMemberName %29 0 "color"
+       OpName %37 "VertIn"
+       OpMemberName %37 0 "pos"
+       OpMemberName %37 1 "uv"
+       OpMemberName %37 2 "normal"
+       OpName %6 "packed0"
+       OpName %12 "packed1"
+       OpName %21 "packed2"
+       OpName %28 "color"
+       OpName %33 "pos"
+       OpName %35 "uv"
+       OpName %36 "normal"
+       OpName %39 "position"
+       OpName %40 "packed0"
+       OpName %41 "packed1"
+       OpName %43 "packed2"
+       OpName %46 "main"
+       OpName %47 "main"
+       OpDecorate %39 Decoration(BuiltIn) BuiltIn(Position)
+       OpDecorate %6 Decoration(Location) 0
+       OpDecorate %12 Decoration(Location) 1
+       OpDecorate %21 Decoration(Location) 2
+       OpDecorate %28 Decoration(Location) 0
+       OpDecorate %33 Decoration(Location) 0
+       OpDecorate %35 Decoration(Location) 1
+       OpDecorate %36 Decoration(Location) 2
+       OpDecorate %40 Decoration(Location) 0
+       OpDecorate %41 Decoration(Location) 1
+       OpDecorate %43 Decoration(Location) 2
+       OpDecorate %21 Decoration(Flat)
+       OpDecorate %43 Decoration(Flat)
+       OpMemberDecorate %25 0 Decoration(Offset) 0
+       OpMemberDecorate %25 1 Decoration(Offset) 16
+       OpMemberDecorate %25 2 Decoration(Offset) 32
+       OpMemberDecorate %25 3 Decoration(Offset) 48
+       OpMemberDecorate %25 4 Decoration(Offset) 56
+       OpMemberDecorate %25 5 Decoration(Offset) 60
+       OpMemberDecorate %25 6 Decoration(Offset) 64
+       OpMemberDecorate %29 0 Decoration(Offset) 0
+       OpMemberDecorate %37 0 Decoration(Offset) 0
+       OpMemberDecorate %37 1 Decoration(Offset) 16
+       OpMemberDecorate %37 2 Decoration(Offset) 32
+  %1 = OpTypeVoid
+  %2 = OpTypeFunction %1
+  %3 = OpTypeFloat 32
+  %4 = OpTypeVector %3 4
+  %5 = OpTypePointer StorageClass(Input) %4
+  %7 = OpTypeInt 32 1
+  %8 = OpConstant %7 i32(1)
+  %9 = OpTypeVector %3 2
+ %10 = OpTypePointer StorageClass(Function) %9
+ %11 = OpConstant %7 i32(3)
+ %13 = OpConstant %7 i32(2)
+ %14 = OpTypeVector %3 3
+ %15 = OpTypePointer StorageClass(Function) %14
+ %16 = OpConstant %7 i32(4)
+ %17 = OpTypePointer StorageClass(Function) %3
+ %18 = OpTypeInt 32 0
+ %19 = OpTypeVector %18 2
+ %20 = OpTypePointer StorageClass(Input) %19
+ %22 = OpConstant %7 i32(5)
+ %23 = OpTypePointer StorageClass(Function) %18
+ %24 = OpConstant %7 i32(6)
+ %25 = OpTypeStruct %4 %9 %14 %9 %3 %18 %18
+ %26 = OpTypePointer StorageClass(Function) %25
+ %27 = OpTypePointer StorageClass(Output) %4
+ %29 = OpTypeStruct %4
+ %30 = OpTypePointer StorageClass(Function) %29
+ %31 = OpConstant %7 i32(0)
+ %32 = OpTypePointer StorageClass(Input) %14
+ %34 = OpTypePointer StorageClass(Input) %9
+ %37 = OpTypeStruct %14 %9 %14
+ %38 = OpTypePointer StorageClass(Function) %37
+ %42 = OpTypePointer StorageClass(Output) %19
+ %44 = OpConstant %3 f32(1)
+ %45 = OpConstant %3 f32(0.5)
+ %85 = OpTypePointer StorageClass(Function) %4
+  %6 = OpVariable %5 StorageClass(Input)
+ %12 = OpVariable %5 StorageClass(Input)
+ %21 = OpVariable %20 StorageClass(Input)
+ %28 = OpVariable %27 StorageClass(Output)
+ %33 = OpVariable %32 StorageClass(Input)
+ %35 = OpVariable %34 StorageClass(Input)
+ %36 = OpVariable %32 StorageClass(Input)
+ %39 = OpVariable %27 StorageClass(Output)
+ %40 = OpVariable %27 StorageClass(Output)
+ %41 = OpVariable %27 StorageClass(Output)
+ %43 = OpVariable %42 StorageClass(Output)
+ %46 = OpFunction %1 FunctionControl(0) %2
+ %48 = OpLabel
+ %49 = OpVariable %30 StorageClass(Function)
+ %50 = OpVariable %26 StorageClass(Function)
+ %51 = OpLoad %4 %6
+ %52 = OpVectorShuffle %9 %51 %51 0 1
+ %53 = OpAccessChain %10 %50 %8
+       OpStore %53 %52
+ %54 = OpVectorShuffle %9 %51 %51 2 3
+ %55 = OpAccessChain %10 %50 %11
+       OpStore %55 %54
+ %56 = OpLoad %4 %12
+ %57 = OpVectorShuffle %14 %56 %56 0 1 2
+ %58 = OpAccessChain %15 %50 %13
+       OpStore %58 %57
+ %59 = OpCompositeExtract %3 %56 3
+ %60 = OpAccessChain %17 %50 %16
+       OpStore %60 %59
+ %61 = OpLoad %19 %21
+ %62 = OpCompositeExtract %18 %61 0
+ %63 = OpAccessChain %23 %50 %22
+       OpStore %63 %62
+ %64 = OpCompositeExtract %18 %61 1
+ %65 = OpAccessChain %23 %50 %24
+       OpStore %65 %64
+ %66 = OpAccessChain %15 %50 %13
+ %67 = OpLoad %14 %66
+ %68 = OpAccessChain %17 %50 %16
+ %69 = OpLoad %3 %68
+ %70 = OpVectorTimesScalar %14 %67 %69
+ %71 = OpAccessChain %23 %50 %22
+ %72 = OpLoad %18 %71
+ %73 = OpAccessChain %23 %50 %24
+ %74 = OpLoad %18 %73
+ %75 = OpIAdd %18 %72 %74
+ %76 = OpConvertUToF %3 %75
+ %77 = OpCompositeConstruct %4 %70 %76
+ %78 = OpAccessChain %10 %50 %8
+ %79 = OpLoad %9 %78
+ %80 = OpAccessChain %10 %50 %11
+ %81 = OpLoad %9 %80
+ %82 = OpCompositeConstruct %4 %79 %81
+ %83 = OpFAdd %4 %77 %82
+ %84 = OpAccessChain %85 %49 %31
+       OpStore %84 %83
+ %86 = OpLoad %29 %49
+ %87 = OpCompositeExtract %4 %86 0
+       OpStore %28 %87
+       OpReturn
+       OpFunctionEnd
+ %47 = OpFunction %1 FunctionControl(0) %2
+ %88 = OpLabel
+ %89 = OpVariable %26 StorageClass(Function)
+ %90 = OpVariable %38 StorageClass(Function)
+ %91 = OpAccessChain %15 %90 %31
+       OpCopyMemory %91 %33
+ %92 = OpAccessChain %10 %90 %8
+       OpCopyMemory %92 %35
+ %93 = OpAccessChain %15 %90 %13
+       OpCopyMemory %93 %36
+ %94 = OpAccessChain %15 %90 %31
+ %95 = OpLoad %14 %94
+ %96 = OpCompositeConstruct %4 %95 %44
+ %97 = OpAccessChain %85 %89 %31
+       OpStore %97 %96
+ %98 = OpAccessChain %10 %90 %8
+ %99 = OpLoad %9 %98
+%100 = OpAccessChain %10 %89 %8
+       OpStore %100 %99
+%101 = OpAccessChain %15 %90 %13
+%102 = OpLoad %14 %101
+%103 = OpAccessChain %15 %89 %13
+       OpStore %103 %102
+%104 = OpAccessChain %10 %90 %8
+%105 = OpLoad %9 %104
+%106 = OpVectorTimesScalar %9 %105 %45
+%107 = OpAccessChain %10 %89 %11
+       OpStore %107 %106
+%108 = OpAccessChain %15 %90 %31
+%109 = OpLoad %14 %108
+%110 = OpCompositeExtract %3 %109 2
+%111 = OpAccessChain %17 %89 %16
+       OpStore %111 %110
+%112 = OpBitcast %18 %8
+%113 = OpAccessChain %23 %89 %22
+       OpStore %113 %112
+%114 = OpBitcast %18 %13
+%115 = OpAccessChain %23 %89 %24
+       OpStore %115 %114
+%116 = OpLoad %25 %89
+%117 = OpCompositeExtract %4 %116 0
+       OpStore %39 %117
+%118 = OpCompositeExtract %9 %116 1
+%119 = OpCompositeExtract %9 %116 3
+%120 = OpCompositeConstruct %4 %118 %119
+       OpStore %40 %120
+%121 = OpCompositeExtract %14 %116 2
+%122 = OpCompositeExtract %3 %116 4
+%123 = OpCompositeConstruct %4 %121 %122
+       OpStore %41 %123
+%124 = OpCompositeExtract %18 %116 5
+%125 = OpCompositeExtract %18 %116 6
+%126 = OpCompositeConstruct %19 %124 %125
+       OpStore %43 %126
+       OpReturn
+       OpFunctionEnd)", states, {}, true);
+
+		SECTION("Reflecting packed locations")
+		{
+			const nzsl::Ast::StructDescription* outputStruct = nullptr;
+
+			nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+			callbacks.onStructDeclaration = [&](const nzsl::Ast::DeclareStructStatement& structDecl)
+			{
+				if (structDecl.description.name == "VertOut")
+					outputStruct = &structDecl.description;
+			};
+
+			nzsl::Ast::ReflectVisitor reflectVisitor;
+			reflectVisitor.Reflect(*shaderModule, callbacks);
+
+			REQUIRE(outputStruct);
+
+			nzsl::Ast::VaryingPacking packing = nzsl::Ast::PackVaryings(*outputStruct);
+			CHECK(packing.packedVaryings.size() == 3);
+
+			REQUIRE(packing.locations.size() == 6);
+			CHECK(packing.locations[3].memberIndex == 4); //< fogFactor
+			CHECK(packing.locations[3].originalLocation == 3);
+			CHECK(packing.locations[3].location == 1);
+			CHECK(packing.locations[3].firstComponent == 3);
+			CHECK(packing.locations[3].componentCount == 1);
+			CHECK(packing.locations[5].location == 2);
+			CHECK(packing.locations[5].firstComponent == 1);
+		}
+	}
+
+	SECTION("Testing varying packing across stages")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+struct VertOut
+{
+	[builtin(position)] position: vec4[f32],
+	[location(0)] fogFactor: f32,
+	[location(1)] normal: vec3[f32],
+	[location(2)] depth: f32
+}
+
+struct FragIn
+{
+	[location(0)] fogFactor: f32,
+	[location(2)] depth: f32
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: FragIn) -> FragOut
+{
+	let output: FragOut;
+	output.color = vec4[f32](input.fogFactor, input.depth, 0.0, 1.0);
+	return output;
+}
+
+[entry(vert)]
+fn main() -> VertOut
+{
+	let output: VertOut;
+	output.position = vec4[f32](0.0, 0.0, 0.0, 1.0);
+	output.fogFactor = 0.5;
+	output.normal = vec3[f32](0.0, 1.0, 0.0);
+	output.depth = 1.0;
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+		shaderModule = SanitizeModule(*shaderModule);
+
+		const nzsl::Ast::StructDescription* outputStruct = nullptr;
+		const nzsl::Ast::StructDescription* inputStruct = nullptr;
+
+		nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+		callbacks.onStructDeclaration = [&](const nzsl::Ast::DeclareStructStatement& structDecl)
+		{
+			if (structDecl.description.name == "VertOut")
+				outputStruct = &structDecl.description;
+			else if (structDecl.description.name == "FragIn")
+				inputStruct = &structDecl.description;
+		};
+
+		nzsl::Ast::ReflectVisitor reflectVisitor;
+		reflectVisitor.Reflect(*shaderModule, callbacks);
+
+		REQUIRE(outputStruct);
+		REQUIRE(inputStruct);
+
+		// depth shares the location of fogFactor and normal in the vertex stage but only the one of fogFactor in the fragment stage
+		nzsl::Ast::VaryingPacking outputPacking = nzsl::Ast::PackVaryings(*outputStruct);
+		nzsl::Ast::VaryingPacking inputPacking = nzsl::Ast::PackVaryings(*inputStruct);
+
+		REQUIRE(outputPacking.locations.size() == 3);
+		REQUIRE(inputPacking.locations.size() == 2);
+		CHECK(outputPacking.locations[2].location == 1);
+		CHECK(inputPacking.locations[1].location == 0);
+
+		std::string_view expectedError = "varying packing requires vertex outputs and fragment inputs to declare the same location members but VertOut and FragIn differ at location 1";
+		CHECK_THROWS_WITH(nzsl::Ast::ValidateVaryingPacking(*shaderModule), expectedError.data());
+
+		nzsl::ShaderWriter::States states;
+		states.packVaryings = true;
+
+		nzsl::GlslWriter glslWriter;
+		CHECK_THROWS_WITH(glslWriter.Generate(nzsl::ShaderStageType::Fragment, *shaderModule, {}, states), expectedError.data());
+
+		nzsl::SpirvWriter spirvWriter;
+		CHECK_THROWS_WITH(spirvWriter.Generate(*shaderModule, states), expectedError.data());
+
+		// without packing, each member keeps its own location and stages can declare a subset of them
+		states.packVaryings = false;
+		CHECK_NOTHROW(spirvWriter.Generate(*shaderModule, states));
+	}
 }
@@ -2,6 +2,7 @@
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Lexer.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <cctype>
 
 TEST_CASE("lexer", "[Shader]")
@@ -60,4 +61,67 @@ Let Identifier(b) Assign Identifier(a) Semicolon
 ClosingCurlyBracket
 EndOfStream)");
 	}
+
+	SECTION("Long blank runs and identifiers")
+	{
+		std::string nzslSource = "\t  \r\n" + std::string(40, ' ') + "\n\n" + std::string(70, 'a') + "_B0 /* multi\nline\n" + std::string(50, '*') + "\n*/ let\n" + std::string(33, '\t') + "x";
+
+		std::vector<nzsl::Token> tokens = nzsl::Tokenize(nzslSource);
+		REQUIRE(tokens.size() == 4);
+
+		CHECK(tokens[0].type == nzsl::TokenType::Identifier);
+		CHECK(std::get<std::string>(tokens[0].data) == std::string(70, 'a') + "_B0");
+		CHECK(tokens[0].location.startLine == 4);
+		CHECK(tokens[0].location.startColumn == 1);
+		CHECK(tokens[0].location.endColumn == 73);
+
+		CHECK(tokens[1].type == nzsl::TokenType::Let);
+		CHECK(tokens[1].location.startLine == 7);
+
+		CHECK(tokens[2].type == nzsl::TokenType::Identifier);
+		CHECK(tokens[2].location.startLine == 8);
+		CHECK(tokens[2].location.startColumn == 34);
+	}
+}
+
+TEST_CASE("lexer benchmark", "[.][Shader][benchmark]")
+{
+	std::string_view nzslSnippet = R"(
+// Computes lighting for a single light
+[entry(frag)]
+fn main(input: FragIn) -> FragOut
+{
+	/* accumulate every light contribution
+	   before applying the albedo */
+	let lightContribution = vec3[f32](0.0, 0.0, 0.0);
+	for i in 0 -> 16
+	{
+		let lightDir = normalize(lightData.lights[i].position - input.worldPos);
+		lightContribution += max(dot(input.normal, lightDir), 0.0) * lightData.lights[i].color.rgb;
+	}
+
+	let output: FragOut;
+	output.color = vec4[f32](lightContribution * albedo.rgb, 1.0);
+	return output;
+}
+)";
+
+	constexpr std::size_t SourceSize = 16 * 1024 * 1024;
+
+	std::string nzslSource;
+	nzslSource.reserve(SourceSize + nzslSnippet.size());
+	std::size_t snippetCount = 0;
+	while (nzslSource.size() < SourceSize)
+	{
+		nzslSource += nzslSnippet;
+		snippetCount++;
+	}
+
+	std::size_t snippetTokenCount = nzsl::Tokenize(nzslSnippet).size() - 1; //< EndOfStream
+	REQUIRE(nzsl::Tokenize(nzslSource).size() == snippetCount * snippetTokenCount + 1);
+
+	BENCHMARK("Tokenize (16MiB)")
+	{
+		return nzsl::Tokenize(nzslSource);
+	};
 }
@@ -1,11 +1,20 @@
 #include <Tests/ShaderUtils.hpp>
+#include <NZSL/Archive.hpp>
 #include <NZSL/FilesystemModuleResolver.hpp>
+#include <NZSL/GlslWriter.hpp>
 #include <NZSL/LangWriter.hpp>
 #include <NZSL/ShaderBuilder.hpp>
+#include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/Serializer.hpp>
+#include <NZSL/Ast/AstSerializer.hpp>
+#include <NZSL/Ast/Compare.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <atomic>
 #include <cctype>
+#include <stdexcept>
+#include <tuple>
 
 void RegisterModule(const std::shared_ptr<nzsl::FilesystemModuleResolver>& moduleResolver, std::string_view source)
 {
@@ -353,6 +362,22 @@ fn main(input: Input) -> OutputData
 		nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
 		sanitizeOpt.moduleResolver = directoryModuleResolver;
 
+		// Resolving imports on multiple threads must give the exact same result
+		nzsl::Ast::SanitizeVisitor::Options parallelSanitizeOpt = sanitizeOpt;
+		parallelSanitizeOpt.moduleResolverThreadCount = 4;
+
+		nzsl::Ast::ModulePtr sequentialShaderModule;
+		REQUIRE_NOTHROW(sequentialShaderModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt));
+
+		nzsl::Ast::ModulePtr parallelShaderModule;
+		REQUIRE_NOTHROW(parallelShaderModule = nzsl::Ast::Sanitize(*shaderModule, parallelSanitizeOpt));
+
+		// unnamed modules get a random name
+		nzsl::Ast::ComparisonParams comparisonParams;
+		comparisonParams.compareModuleName = false;
+
+		CHECK(nzsl::Ast::Compare(*sequentialShaderModule, *parallelShaderModule, comparisonParams));
+
 		shaderModule = SanitizeModule(*shaderModule, sanitizeOpt);
 
 		ExpectGLSL(*shaderModule, R"(
@@ -962,4 +987,443 @@ fn FragMain() -> FragOut
 )");
 		}
 	}
+
+	WHEN("Importing only requested symbols")
+	{
+		std::string_view libModule = R"(
+[nzsl_version("1.0")]
+module Modules.Lib;
+
+fn Helper() -> f32
+{
+	return 2.0;
+}
+
+[export]
+fn Compute(value: f32) -> f32
+{
+	return value * Helper();
+}
+
+[export]
+fn Broken() -> f32
+{
+	return 42;
+}
+)";
+
+		std::string_view shaderSource = R"(
+[nzsl_version("1.0")]
+module;
+
+import Compute from Modules.Lib;
+
+struct FragOut
+{
+	[location(0)] value: f32
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let output: FragOut;
+	output.value = Compute(1.0);
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(shaderSource);
+
+		auto directoryModuleResolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+		directoryModuleResolver->RegisterModule(libModule);
+
+		nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
+		sanitizeOpt.moduleResolver = directoryModuleResolver;
+
+		// Broken() has a type error, which is reported when the whole module is sanitized
+		CHECK_THROWS(nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt));
+
+		sanitizeOpt.importOnlyRequestedSymbols = true;
+
+		REQUIRE_NOTHROW(shaderModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt));
+
+		ExpectNZSL(*shaderModule, R"(
+[nzsl_version("1.0")]
+module _Modules_Lib
+{
+	fn Helper() -> f32
+	{
+		return 2.0;
+	}
+
+	fn Compute(value: f32) -> f32
+	{
+		return value * (Helper());
+	}
+
+}
+)");
+	}
+
+	WHEN("Importing only requested symbols referencing constants through attributes")
+	{
+		std::string_view libModule = R"(
+[nzsl_version("1.0")]
+module Modules.Lib;
+
+const BaseBinding: u32 = u32(2);
+const HasScale = true;
+const Unused = 5;
+
+[layout(std140)]
+struct Data
+{
+	value: f32,
+	[cond(HasScale)] scale: f32
+}
+
+external
+{
+	[set(0), binding(BaseBinding + u32(1))] data: uniform[Data]
+}
+
+[export]
+fn GetValue() -> f32
+{
+	return data.value;
+}
+
+[export]
+fn Broken() -> f32
+{
+	return 42;
+}
+)";
+
+		std::string_view shaderSource = R"(
+[nzsl_version("1.0")]
+module;
+
+import GetValue from Modules.Lib;
+
+struct FragOut
+{
+	[location(0)] value: f32
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let output: FragOut;
+	output.value = GetValue();
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(shaderSource);
+
+		auto directoryModuleResolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+		directoryModuleResolver->RegisterModule(libModule);
+
+		nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
+		sanitizeOpt.moduleResolver = directoryModuleResolver;
+		sanitizeOpt.importOnlyRequestedSymbols = true;
+
+		REQUIRE_NOTHROW(shaderModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt));
+
+		ExpectNZSL(*shaderModule, R"(
+[nzsl_version("1.0")]
+module _Modules_Lib
+{
+	[layout(std140)]
+	struct Data
+	{
+		value: f32,
+		[cond(true)] scale: f32
+	}
+
+	external
+	{
+		[set(0), binding(3)] data: uniform[Data]
+	}
+
+	fn GetValue() -> f32
+	{
+		return data.value;
+	}
+
+}
+)");
+	}
+
+	WHEN("Importing only requested symbols from a lazily loaded binary module")
+	{
+		std::string_view libModule = R"(
+[nzsl_version("1.0")]
+module Modules.Lib;
+
+fn Helper() -> f32
+{
+	return 2.0;
+}
+
+[export]
+fn Compute(value: f32) -> f32
+{
+	return value * Helper();
+}
+
+[export]
+fn Unused() -> f32
+{
+	return 42.0;
+}
+)";
+
+		std::string_view shaderSource = R"(
+[nzsl_version("1.0")]
+module;
+
+import Compute from Modules.Lib;
+
+struct FragOut
+{
+	[location(0)] value: f32
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let output: FragOut;
+	output.value = Compute(1.0);
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr libAst = nzsl::Ast::Sanitize(*nzsl::Parse(libModule));
+
+		nzsl::Serializer serializer;
+		nzsl::Ast::SerializeShader(serializer, *libAst);
+
+		const std::vector<std::uint8_t>& libData = serializer.GetData();
+
+		nzsl::Archive archive;
+		archive.AddModule("Modules.Lib", nzsl::ArchiveEntryKind::BinaryShaderModule, libData.data(), libData.size());
+
+		auto archiveModuleResolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+		archiveModuleResolver->SetLazyLoading(true);
+		archiveModuleResolver->RegisterArchive(archive);
+
+		// Unused() is never materialized, Helper() is loaded as Compute() depends on it
+		nzsl::Ast::ModulePtr partialLib = archiveModuleResolver->ResolveSymbols("Modules.Lib", { "Compute" });
+		REQUIRE(partialLib);
+		REQUIRE(partialLib->rootNode->statements.size() == 2);
+		CHECK(static_cast<nzsl::Ast::DeclareFunctionStatement&>(*partialLib->rootNode->statements[0]).name == "Helper");
+		CHECK(static_cast<nzsl::Ast::DeclareFunctionStatement&>(*partialLib->rootNode->statements[1]).name == "Compute");
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(shaderSource);
+
+		nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
+		sanitizeOpt.moduleResolver = archiveModuleResolver;
+		sanitizeOpt.importOnlyRequestedSymbols = true;
+
+		REQUIRE_NOTHROW(shaderModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt));
+
+		ExpectNZSL(*shaderModule, R"(
+[nzsl_version("1.0")]
+module _Modules_Lib
+{
+	fn Helper() -> f32
+	{
+		return 2.0;
+	}
+
+	fn Compute(value: f32) -> f32
+	{
+		return value * (Helper());
+	}
+
+}
+)");
+	}
+
+	WHEN("Sanitizing imported modules on multiple threads")
+	{
+		std::string_view dataModule = R"(
+[nzsl_version("1.0")]
+module Modules.Data;
+
+[export]
+[layout(std140)]
+struct Data
+{
+	color: vec4[f32],
+	intensity: f32
+}
+)";
+
+		std::string_view mathModule = R"(
+[nzsl_version("1.0")]
+module Modules.Math;
+
+option Gamma: f32 = 2.2;
+
+const Half = 0.5;
+
+[export]
+fn Scale(value: vec4[f32], factor: f32) -> vec4[f32]
+{
+	let result = value;
+	for i in 0 -> 4
+		result[i] *= factor * Half;
+
+	return result;
+}
+
+[export]
+fn ToLinear(value: vec4[f32]) -> vec4[f32]
+{
+	return pow(value, vec4[f32](Gamma, Gamma, Gamma, 1.0));
+}
+
+[export]
+fn Unused() -> f32
+{
+	return 42.0;
+}
+)";
+
+		std::string_view outputModule = R"(
+[nzsl_version("1.0")]
+module Modules.Output;
+
+[export]
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+)";
+
+		std::string_view lightingModule = R"(
+[nzsl_version("1.0")]
+module Modules.Lighting;
+
+import Data from Modules.Data;
+import Scale from Modules.Math;
+
+[export]
+fn Shade(data: Data) -> vec4[f32]
+{
+	return Scale(data.color, data.intensity);
+}
+)";
+
+		std::string_view shaderSource = R"(
+[nzsl_version("1.0")]
+module Shader;
+
+import Data from Modules.Data;
+import Shade from Modules.Lighting;
+import ToLinear from Modules.Math;
+import FragOut from Modules.Output;
+
+external
+{
+	[binding(0)] data: uniform[Data]
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let lightData: Data;
+	lightData.color = data.color;
+	lightData.intensity = data.intensity;
+
+	let output: FragOut;
+	output.color = ToLinear(Shade(lightData));
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(shaderSource);
+
+		auto directoryModuleResolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+		RegisterModule(directoryModuleResolver, dataModule);
+		RegisterModule(directoryModuleResolver, mathModule);
+		RegisterModule(directoryModuleResolver, outputModule);
+		RegisterModule(directoryModuleResolver, lightingModule);
+
+		auto SanitizeAndGenerate = [&](unsigned int threadCount, bool importOnlyRequestedSymbols)
+		{
+			nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
+			sanitizeOpt.moduleResolver = directoryModuleResolver;
+			sanitizeOpt.moduleResolverThreadCount = threadCount;
+			sanitizeOpt.importOnlyRequestedSymbols = importOnlyRequestedSymbols;
+
+			nzsl::Ast::ModulePtr sanitizedModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+
+			nzsl::LangWriter langWriter;
+			std::string nzsl = langWriter.Generate(*sanitizedModule);
+
+			nzsl::GlslWriter glslWriter;
+			std::string glsl = glslWriter.Generate(nzsl::ShaderStageType::Fragment, *sanitizedModule).code;
+
+			nzsl::SpirvWriter spirvWriter;
+			std::vector<std::uint32_t> spirv = spirvWriter.Generate(*sanitizedModule);
+
+			return std::make_tuple(std::move(sanitizedModule), std::move(nzsl), std::move(glsl), std::move(spirv));
+		};
+
+		// Independent modules (Data, Math and Output) are sanitized on worker threads and merged in import order, outputs must not depend on the thread count
+		for (bool importOnlyRequestedSymbols : { false, true })
+		{
+			INFO("importOnlyRequestedSymbols: " << importOnlyRequestedSymbols);
+
+			auto [sequentialModule, sequentialNzsl, sequentialGlsl, sequentialSpirv] = SanitizeAndGenerate(1, importOnlyRequestedSymbols);
+			for (unsigned int threadCount : { 2u, 4u })
+			{
+				INFO("threadCount: " << threadCount);
+
+				auto [parallelModule, parallelNzsl, parallelGlsl, parallelSpirv] = SanitizeAndGenerate(threadCount, importOnlyRequestedSymbols);
+				CHECK(nzsl::Ast::Compare(*sequentialModule, *parallelModule));
+				CHECK(sequentialNzsl == parallelNzsl);
+				CHECK(sequentialGlsl == parallelGlsl);
+				CHECK(sequentialSpirv == parallelSpirv);
+			}
+		}
+	}
+
+	WHEN("Prefetching a module which fails to resolve")
+	{
+		class FailingModuleResolver : public nzsl::ModuleResolver
+		{
+			public:
+				nzsl::Ast::ModulePtr Resolve(const std::string& moduleName) override
+				{
+					resolveCount++;
+					throw std::runtime_error("failed to load " + moduleName + ": file is corrupted");
+				}
+
+				std::atomic_int resolveCount = 0;
+		};
+
+		std::string_view shaderSource = R"(
+[nzsl_version("1.0")]
+module;
+
+import * from Modules.Broken;
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(shaderSource);
+
+		auto moduleResolver = std::make_shared<FailingModuleResolver>();
+
+		nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
+		sanitizeOpt.moduleResolver = moduleResolver;
+		sanitizeOpt.moduleResolverThreadCount = 4;
+
+		// The resolver error is reported as is, without resolving the module a second time
+		CHECK_THROWS_WITH(nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt), "failed to load Modules.Broken: file is corrupted");
+		CHECK(moduleResolver->resolveCount == 1);
+	}
 }
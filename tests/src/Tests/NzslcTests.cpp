@@ -61,4 +61,53 @@ TEST_CASE("Standalone compiler", "[NZSLC]")
 		CheckHeaderMatch("test_files/Shader.nzslb");
 		CheckHeaderMatch("test_files/Shader.spv");
 	}
+
+	WHEN("Running as a compilation server")
+	{
+		std::filesystem::remove_all("test_server");
+
+		Nz::CallOnExit cleanupOnExit([] { std::filesystem::remove_all("test_server"); });
+
+		auto BuildMessage = [](std::string_view payload)
+		{
+			std::uint32_t size = Nz::SafeCast<std::uint32_t>(payload.size());
+
+			std::string message;
+			for (unsigned int i = 0; i < 4; ++i)
+				message.push_back(static_cast<char>((size >> (i * 8)) & 0xFF));
+
+			message += payload;
+			return message;
+		};
+
+		std::string output;
+		std::string errOutput;
+		TinyProcessLib::Process server("./nzslc --server", {}, [&](const char* str, std::size_t size) { output.append(str, size); }, [&](const char* str, std::size_t size) { errOutput.append(str, size); }, true);
+
+		std::string compileRequest = R"(["--compile=spv", "-o", "test_server", "-m", "../resources/modules", "../resources/Shader.nzsl"])";
+		server.write(BuildMessage(compileRequest));
+		server.write(BuildMessage(compileRequest)); //< second compilation reuses loaded modules
+		server.write(BuildMessage(R"(["../resources/NotAShader.nzsl"])"));
+		server.close_stdin();
+
+		INFO("stderr: " << errOutput);
+		REQUIRE(server.get_exit_status() == 0);
+
+		std::vector<std::string> responses;
+		for (std::size_t offset = 0; offset + 4 <= output.size();)
+		{
+			std::uint32_t size = 0;
+			for (unsigned int i = 0; i < 4; ++i)
+				size |= std::uint32_t(static_cast<std::uint8_t>(output[offset + i])) << (i * 8);
+
+			responses.push_back(output.substr(offset + 4, size));
+			offset += 4 + size;
+		}
+
+		REQUIRE(responses.size() == 3);
+		CHECK(responses[0] == R"({"success":true})");
+		CHECK(responses[1] == R"({"success":true})");
+		CHECK_THAT(responses[2], Catch::Matchers::ContainsSubstring(R"("success":false)"));
+		CHECK(std::filesystem::exists("test_server/Shader.spv"));
+	}
 }
@@ -1,8 +1,13 @@
 #include <Tests/ShaderUtils.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/Ast/AlgebraicSimplificationVisitor.hpp>
+#include <NZSL/Ast/Compare.hpp>
 #include <NZSL/Ast/ConstantPropagationVisitor.hpp>
+#include <NZSL/Ast/DeadStoreEliminationVisitor.hpp>
 #include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/LoopInvariantCodeMotionVisitor.hpp>
+#include <NZSL/Ast/PassManager.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cctype>
@@ -12,9 +17,14 @@ void PropagateConstantAndExpect(std::string_view sourceCode, std::string_view ex
 	nzsl::Ast::ModulePtr shaderModule;
 	REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
 	shaderModule = SanitizeModule(*shaderModule);
-	REQUIRE_NOTHROW(shaderModule = nzsl::Ast::PropagateConstants(*shaderModule));
 
-	ExpectNZSL(*shaderModule, expectedOptimizedResult);
+	nzsl::Ast::ModulePtr optimizedModule;
+	REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::PropagateConstants(*shaderModule));
+	ExpectNZSL(*optimizedModule, expectedOptimizedResult);
+
+	// Transforming the module in place should give the same result
+	REQUIRE_NOTHROW(nzsl::Ast::PropagateConstantsInPlace(*shaderModule));
+	CHECK(nzsl::Ast::Compare(*shaderModule, *optimizedModule));
 }
 
 void EliminateUnusedAndExpect(std::string_view sourceCode, std::string_view expectedOptimizedResult)
@@ -25,9 +35,67 @@ void EliminateUnusedAndExpect(std::string_view sourceCode, std::string_view expe
 	nzsl::Ast::ModulePtr shaderModule;
 	REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
 	shaderModule = SanitizeModule(*shaderModule);
-	REQUIRE_NOTHROW(shaderModule = nzsl::Ast::EliminateUnusedPass(*shaderModule, depConfig));
 
-	ExpectNZSL(*shaderModule, expectedOptimizedResult);
+	nzsl::Ast::ModulePtr optimizedModule;
+	REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::EliminateUnusedPass(*shaderModule, depConfig));
+	ExpectNZSL(*optimizedModule, expectedOptimizedResult);
+
+	// Transforming the module in place should give the same result and reuse the nodes
+	const nzsl::Ast::MultiStatement* rootNode = shaderModule->rootNode.get();
+	REQUIRE_NOTHROW(nzsl::Ast::EliminateUnusedPassInPlace(*shaderModule, depConfig));
+	CHECK(nzsl::Ast::Compare(*shaderModule, *optimizedModule));
+	CHECK(shaderModule->rootNode.get() == rootNode);
+}
+
+void EliminateDeadStoresAndExpect(std::string_view sourceCode, std::string_view expectedOptimizedResult)
+{
+	nzsl::Ast::ModulePtr shaderModule;
+	REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
+	shaderModule = SanitizeModule(*shaderModule);
+
+	nzsl::Ast::ModulePtr optimizedModule;
+	REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::EliminateDeadStores(*shaderModule));
+	ExpectNZSL(*optimizedModule, expectedOptimizedResult);
+
+	// Transforming the module in place should give the same result
+	REQUIRE_NOTHROW(nzsl::Ast::EliminateDeadStoresInPlace(*shaderModule));
+	CHECK(nzsl::Ast::Compare(*shaderModule, *optimizedModule));
+}
+
+void HoistLoopInvariantsAndExpect(std::string_view sourceCode, std::string_view expectedOptimizedResult)
+{
+	nzsl::Ast::ModulePtr shaderModule;
+	REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
+	shaderModule = SanitizeModule(*shaderModule);
+
+	nzsl::Ast::ModulePtr optimizedModule;
+	REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::HoistLoopInvariants(*shaderModule));
+	ExpectNZSL(*optimizedModule, expectedOptimizedResult);
+
+	// Transforming the module in place should give the same result
+	REQUIRE_NOTHROW(nzsl::Ast::HoistLoopInvariantsInPlace(*shaderModule));
+	CHECK(nzsl::Ast::Compare(*shaderModule, *optimizedModule));
+}
+
+void SimplifyAlgebraAndExpect(std::string_view sourceCode, std::string_view expectedOptimizedResult, bool fastMath = false)
+{
+	nzsl::Ast::AlgebraicSimplificationVisitor::Options options;
+	options.fastMath = fastMath;
+
+	nzsl::Ast::ModulePtr shaderModule;
+	REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
+	shaderModule = SanitizeModule(*shaderModule);
+
+	// turn casted literals (u32(8)) into constants, as the optimization presets do
+	REQUIRE_NOTHROW(nzsl::Ast::PropagateConstantsInPlace(*shaderModule));
+
+	nzsl::Ast::ModulePtr optimizedModule;
+	REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::SimplifyAlgebra(*shaderModule, options));
+	ExpectNZSL(*optimizedModule, expectedOptimizedResult);
+
+	// Transforming the module in place should give the same result
+	REQUIRE_NOTHROW(nzsl::Ast::SimplifyAlgebraInPlace(*shaderModule, options));
+	CHECK(nzsl::Ast::Compare(*shaderModule, *optimizedModule));
 }
 
 TEST_CASE("optimizations", "[Shader]")
@@ -376,6 +444,306 @@ fn main()
 )");
 	}
 
+	WHEN("simplifying algebraic identities")
+	{
+		SimplifyAlgebraAndExpect(R"(
+[nzsl_version("1.0")]
+module;
+
+struct inputStruct
+{
+	value: vec4[f32],
+	scalar: f32,
+	count: u32,
+	index: i32,
+	flag: bool
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[inputStruct]
+}
+
+[entry(frag)]
+fn main()
+{
+	let a = data.scalar * 1.0;
+	let b = data.scalar + 0.0;
+	let c = data.scalar / 4.0;
+	let d = data.scalar / 3.0;
+	let e = data.value * -1.0;
+	let f = data.index + 0;
+	let g = data.index * 8;
+	let h = data.count / u32(16);
+	let i = data.count % u32(16);
+	let j = data.index | 0;
+	let k = data.flag && true;
+	let l = -(-data.scalar);
+	let m = data.value.xyzw;
+	let n = data.value.wzyx.xy;
+	let o = pow(data.scalar, 2.0);
+	let p = abs(abs(data.scalar));
+	let q = floor(floor(data.scalar));
+	let r = data.scalar * 0.0;
+}
+)", R"(
+[entry(frag)]
+fn main()
+{
+	let a: f32 = data.scalar;
+	let b: f32 = data.scalar + (0.0);
+	let c: f32 = data.scalar * (0.25);
+	let d: f32 = data.scalar / (3.0);
+	let e: vec4[f32] = -data.value;
+	let f: i32 = data.index;
+	let g: i32 = data.index << (3);
+	let h: u32 = data.count >> (u32(4));
+	let i: u32 = data.count & (u32(15));
+	let j: i32 = data.index;
+	let k: bool = data.flag;
+	let l: f32 = data.scalar;
+	let m: vec4[f32] = data.value;
+	let n: vec2[f32] = data.value.wz;
+	let o: f32 = data.scalar * data.scalar;
+	let p: f32 = abs(data.scalar);
+	let q: f32 = floor(data.scalar);
+	let r: f32 = data.scalar * (0.0);
+}
+)");
+	}
+
+	WHEN("simplifying algebraic identities with fast-math")
+	{
+		SimplifyAlgebraAndExpect(R"(
+[nzsl_version("1.0")]
+module;
+
+struct inputStruct
+{
+	value: vec4[f32],
+	scalar: f32
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[inputStruct]
+}
+
+[entry(frag)]
+fn main()
+{
+	let a = data.scalar + 0.0;
+	let b = data.scalar / 5.0;
+	let c = data.scalar * 0.0;
+	let d = 0.0 - data.scalar;
+	let e = pow(data.scalar, 0.5);
+	let f = normalize(normalize(data.value.xyz));
+}
+)", R"(
+[entry(frag)]
+fn main()
+{
+	let a: f32 = data.scalar;
+	let b: f32 = data.scalar * (0.2);
+	let c: f32 = 0.0;
+	let d: f32 = -data.scalar;
+	let e: f32 = sqrt(data.scalar);
+	let f: vec3[f32] = normalize(data.value.xyz);
+}
+)", true);
+	}
+
+	WHEN("eliminating dead stores")
+	{
+		EliminateDeadStoresAndExpect(R"(
+[nzsl_version("1.0")]
+module;
+
+struct inputStruct
+{
+	value: vec4[f32],
+	scalar: f32
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[inputStruct]
+}
+
+struct Output
+{
+	value: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let value = data.value;
+	let copy = value;
+	let unused = data.scalar * 2.0;
+	let overwritten = data.scalar;
+	overwritten = copy.x;
+	let neverRead: f32;
+	neverRead = overwritten;
+	let factor = 2.0;
+
+	let output: Output;
+	output.value = copy * overwritten * factor;
+	return output;
+}
+)", R"(
+[entry(frag)]
+fn main() -> Output
+{
+	let value: vec4[f32] = data.value;
+	let overwritten: f32;
+	overwritten = value.x;
+	let output: Output;
+	output.value = (value * overwritten) * (2.0);
+	return output;
+}
+)");
+	}
+
+	WHEN("eliminating dead stores in loops")
+	{
+		EliminateDeadStoresAndExpect(R"(
+[nzsl_version("1.0")]
+module;
+
+struct inputStruct
+{
+	scalar: f32
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[inputStruct]
+}
+
+[entry(frag)]
+fn main()
+{
+	let i = 0;
+	let last = 0.0;
+	while (i < 10)
+	{
+		last = data.scalar;
+		if (data.scalar > 1.0)
+			break;
+
+		last = 0.0;
+		i += 1;
+	}
+
+	let result = last;
+	result = 1.0;
+	result = 2.0;
+	discard;
+}
+)", R"(
+[entry(frag)]
+fn main()
+{
+	let i: i32 = 0;
+	let last: f32 = 0.0;
+	while (i < (10))
+	{
+		last = data.scalar;
+		if (data.scalar > (1.0))
+		{
+			break;
+		}
+
+		last = 0.0;
+		i += 1;
+	}
+
+	discard;
+}
+)");
+	}
+
+	WHEN("hoisting loop invariants")
+	{
+		HoistLoopInvariantsAndExpect(R"(
+[nzsl_version("1.0")]
+module;
+
+struct inputStruct
+{
+	viewMatrix: mat4[f32],
+	worldMatrix: mat4[f32],
+	lightCount: u32,
+	scale: f32
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[inputStruct]
+}
+
+[entry(frag)]
+fn main()
+{
+	let color = vec4[f32](0.0, 0.0, 0.0, 0.0);
+	let factor = 1.0;
+	let i = u32(0);
+	while (i < data.lightCount * u32(2))
+	{
+		let position = data.viewMatrix * data.worldMatrix * vec4[f32](1.0, 0.0, 0.0, 1.0);
+		color += position * (data.scale * 2.0) + position * (data.scale * factor);
+		if (color.x > 1.0)
+			break;
+
+		factor = factor * 0.5;
+		for j in 0 -> 4
+		{
+			color += position * (data.scale * 2.0) * f32(j);
+		}
+
+		i += u32(1);
+	}
+}
+)", R"(
+[entry(frag)]
+fn main()
+{
+	let color: vec4[f32] = vec4[f32](0.0, 0.0, 0.0, 0.0);
+	let factor: f32 = 1.0;
+	let i: u32 = u32(0);
+	{
+		let loopInvariant7: u32 = data.lightCount * (u32(2));
+		let loopInvariant8: vec4[f32] = (data.viewMatrix * data.worldMatrix) * (vec4[f32](1.0, 0.0, 0.0, 1.0));
+		let loopInvariant9: f32 = data.scale * (2.0);
+		while (i < loopInvariant7)
+		{
+			let position: vec4[f32] = loopInvariant8;
+			color += (position * loopInvariant9) + (position * (data.scale * factor));
+			if (color.x > (1.0))
+			{
+				break;
+			}
+
+			factor = factor * (0.5);
+			{
+				let loopInvariant6: vec4[f32] = position * loopInvariant9;
+				for j in 0 -> 4
+				{
+					color += loopInvariant6 * (f32(j));
+				}
+
+			}
+
+			i += u32(1);
+		}
+
+	}
+
+}
+)");
+	}
+
 	WHEN("eliminating unused code")
 	{
 		EliminateUnusedAndExpect(R"(
@@ -444,3 +812,162 @@ fn main() -> Output
 })");
 	}
 }
+
+TEST_CASE("pass manager", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+fn unusedFunction() -> f32
+{
+	return 1.0;
+}
+
+[entry(frag)]
+fn main()
+{
+	let value = 8.0 * (7.0 + 5.0);
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+	shaderModule = SanitizeModule(*shaderModule);
+
+	nzsl::Ast::DependencyCheckerVisitor::Config depConfig;
+	depConfig.usedShaderStages = nzsl::ShaderStageType_All;
+
+	WHEN("Running passes to a fixed point")
+	{
+		std::size_t remainingChanges = 3;
+
+		nzsl::Ast::PassManager passManager;
+		passManager.AddPass("Countdown", [&](nzsl::Ast::Module&) -> std::size_t
+		{
+			if (remainingChanges == 0)
+				return 0;
+
+			return remainingChanges--;
+		});
+		passManager.AddPass("Nothing", [](nzsl::Ast::Module&) -> std::size_t { return 0; });
+
+		passManager.SetMaxIterations(10);
+
+		nzsl::Ast::PassManager::Result result = passManager.Run(*shaderModule);
+		CHECK(result.fixedPointReached);
+		CHECK(result.iterationCount == 4);
+		REQUIRE(result.passes.size() == 2);
+		CHECK(result.passes[0].name == "Countdown");
+		CHECK(result.passes[0].changeCount == 6);
+		CHECK(result.passes[0].runCount == 4);
+		CHECK(result.passes[1].changeCount == 0);
+		CHECK(result.passes[1].runCount == 4);
+
+		remainingChanges = 3;
+		passManager.SetMaxIterations(2);
+
+		result = passManager.Run(*shaderModule);
+		CHECK_FALSE(result.fixedPointReached);
+		CHECK(result.iterationCount == 2);
+		CHECK(result.passes[0].changeCount == 5);
+	}
+
+	WHEN("Using presets")
+	{
+		nzsl::Ast::ModulePtr expectedModule = nzsl::Ast::EliminateUnusedPass(*nzsl::Ast::PropagateConstants(*shaderModule), depConfig);
+
+		CHECK(nzsl::Ast::PassManager::BuildPreset(nzsl::OptimizationLevel::None, depConfig).GetPassCount() == 0);
+
+		nzsl::Ast::PassManager::Result basicResult = nzsl::Ast::PassManager::BuildPreset(nzsl::OptimizationLevel::Basic, depConfig).Run(*shaderModule);
+		CHECK(basicResult.iterationCount == 1);
+		CHECK(basicResult.passes[0].changeCount == 2); //< 7.0 + 5.0 and 8.0 * 12.0
+		CHECK(basicResult.passes[1].changeCount == 2); //< unusedFunction and value
+		CHECK(nzsl::Ast::Compare(*shaderModule, *expectedModule));
+
+		// the module is already optimized, running everything again shouldn't change it
+		nzsl::Ast::PassManager::Result fullResult = nzsl::Ast::PassManager::BuildPreset(nzsl::OptimizationLevel::Full, depConfig).Run(*shaderModule);
+		CHECK(fullResult.fixedPointReached);
+		CHECK(fullResult.iterationCount == 1);
+		CHECK(nzsl::Ast::Compare(*shaderModule, *expectedModule));
+	}
+
+	WHEN("Optimizing for size")
+	{
+		std::string_view loopSource = R"(
+[nzsl_version("1.0")]
+module;
+
+struct inputStruct
+{
+	scale: f32,
+	count: u32
+}
+
+struct outputStruct
+{
+	[location(0)] value: f32
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[inputStruct]
+}
+
+[entry(frag)]
+fn main() -> outputStruct
+{
+	let value = 0.0;
+	let i = u32(0);
+	while (i < data.count)
+	{
+		value += pow(data.scale, 2.0) * data.scale;
+		i += u32(1);
+	}
+
+	let output: outputStruct;
+	output.value = value;
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr loopModule;
+		REQUIRE_NOTHROW(loopModule = nzsl::Ast::Sanitize(*nzsl::Parse(loopSource)));
+
+		nzsl::Ast::PassManager fullPreset = nzsl::Ast::PassManager::BuildPreset(nzsl::OptimizationLevel::Full, depConfig);
+		nzsl::Ast::PassManager sizePreset = nzsl::Ast::PassManager::BuildPreset(nzsl::OptimizationLevel::Size, depConfig);
+
+		// no loop-invariant code motion
+		CHECK(sizePreset.GetPassCount() == fullPreset.GetPassCount() - 1);
+
+		AND_THEN("pow(x, 2.0) is kept and nothing is hoisted out of the loop")
+		{
+			nzsl::Ast::PassManager::Result sizeResult = sizePreset.Run(*loopModule);
+			CHECK(sizeResult.fixedPointReached);
+
+			ExpectNZSL(*loopModule, R"(
+	while (i < data.count)
+	{
+		value += (pow(data.scale, 2.0)) * data.scale;
+		i += u32(1);
+	}
+)");
+		}
+
+		AND_THEN("the full preset still applies them")
+		{
+			fullPreset.Run(*loopModule);
+
+			ExpectNZSL(*loopModule, R"(
+	{
+		let loopInvariant4: f32 = (data.scale * data.scale) * data.scale;
+		while (i < data.count)
+		{
+			value += loopInvariant4;
+			i += u32(1);
+		}
+
+	}
+)");
+		}
+	}
+}
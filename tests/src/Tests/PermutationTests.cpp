@@ -0,0 +1,265 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/PermutationCompiler.hpp>
+#include <NZSL/Ast/OptionUsageVisitor.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <optional>
+
+TEST_CASE("permutations", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseColor: bool = false;
+option UnusedOption: bool = false;
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	const if (UseColor)
+		output.color = vec4[f32](1.0, 0.0, 0.0, 1.0);
+	else
+		output.color = vec4[f32](1.0, 1.0, 1.0, 1.0);
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::PermutationCompiler::OptionSpace optionSpace = {
+		{ nzsl::Ast::HashOption("UseColor"),     { false, true } },
+		{ nzsl::Ast::HashOption("UnusedOption"), { false, true } },
+	};
+
+	std::vector<nzsl::PermutationCompiler::OptionSet> optionSets = nzsl::PermutationCompiler::ExpandOptionSpace(optionSpace);
+	REQUIRE(optionSets.size() == 4);
+
+	nzsl::PermutationCompiler permutationCompiler(*shaderModule);
+	permutationCompiler.SetThreadCount(2);
+
+	WHEN("Generating SPIR-V")
+	{
+		nzsl::PermutationCompiler::SpirvOutput output = permutationCompiler.CompileSpirv(optionSets);
+		REQUIRE(output.variants.size() == 2);
+		REQUIRE(output.variantByOptionSet.size() == optionSets.size());
+
+		// Option sets only differing by UnusedOption share the same variant
+		std::optional<std::size_t> variantByUseColor[2];
+		for (std::size_t i = 0; i < optionSets.size(); ++i)
+		{
+			bool useColor = std::get<bool>(optionSets[i][nzsl::Ast::HashOption("UseColor")]);
+
+			std::optional<std::size_t>& variantIndex = variantByUseColor[useColor];
+			if (!variantIndex)
+				variantIndex = output.variantByOptionSet[i];
+
+			CHECK(output.variantByOptionSet[i] == *variantIndex);
+		}
+		CHECK(variantByUseColor[0] != variantByUseColor[1]);
+		CHECK(output.variants[0] != output.variants[1]);
+
+		// Variants must match what a single compilation would give
+		nzsl::ShaderWriter::States states;
+		states.optionValues = optionSets[0];
+
+		nzsl::SpirvWriter writer;
+		CHECK(writer.Generate(*shaderModule, states) == output.variants[output.variantByOptionSet[0]]);
+	}
+
+	WHEN("Generating GLSL")
+	{
+		nzsl::PermutationCompiler::GlslOutput output = permutationCompiler.CompileGlsl(nzsl::ShaderStageType::Fragment, optionSets);
+		REQUIRE(output.variants.size() == 2);
+		REQUIRE(output.variantByOptionSet.size() == optionSets.size());
+
+		for (std::size_t i = 0; i < optionSets.size(); ++i)
+		{
+			bool useColor = std::get<bool>(optionSets[i][nzsl::Ast::HashOption("UseColor")]);
+			const std::string& code = output.variants[output.variantByOptionSet[i]].code;
+
+			if (useColor)
+				CHECK(code.find("vec4(1.0, 0.0, 0.0, 1.0)") != std::string::npos);
+			else
+				CHECK(code.find("vec4(1.0, 1.0, 1.0, 1.0)") != std::string::npos);
+		}
+	}
+
+	WHEN("Overriding base option values")
+	{
+		nzsl::ShaderWriter::States baseStates;
+		baseStates.optionValues[nzsl::Ast::HashOption("UseColor")] = true;
+
+		nzsl::PermutationCompiler baseCompiler(*shaderModule, baseStates);
+
+		std::vector<nzsl::PermutationCompiler::OptionSet> overridingSets(2);
+		overridingSets[1][nzsl::Ast::HashOption("UseColor")] = false;
+
+		nzsl::PermutationCompiler::GlslOutput output = baseCompiler.CompileGlsl(nzsl::ShaderStageType::Fragment, overridingSets);
+		REQUIRE(output.variants.size() == 2);
+		REQUIRE(output.variantByOptionSet.size() == 2);
+
+		// the first set keeps the base value while the second one overrides it
+		CHECK(output.variants[output.variantByOptionSet[0]].code.find("vec4(1.0, 0.0, 0.0, 1.0)") != std::string::npos);
+		CHECK(output.variants[output.variantByOptionSet[1]].code.find("vec4(1.0, 1.0, 1.0, 1.0)") != std::string::npos);
+	}
+}
+
+TEST_CASE("option usage", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option ColorMode: i32 = 0;
+option UseHighlight: bool = false;
+option UseVertexColor: bool = false;
+option UseOldMethod: bool = false;
+option Unused: bool = false;
+
+[cond(UseHighlight)]
+struct Highlight
+{
+	color: vec4[f32]
+}
+
+struct FragOutput
+{
+	[location(0)] color: vec4[f32]
+}
+
+struct VertOutput
+{
+	[builtin(position)] position: vec4[f32]
+}
+
+fn GetVertexColor() -> vec4[f32]
+{
+	const if (UseVertexColor)
+		return vec4[f32](1.0, 0.0, 0.0, 1.0);
+	else
+		return vec4[f32](1.0, 1.0, 1.0, 1.0);
+}
+
+fn OldMethod() -> f32
+{
+	const if (UseOldMethod)
+		return 1.0;
+	else
+		return 0.0;
+}
+
+[entry(frag)]
+fn fragMain() -> FragOutput
+{
+	let output: FragOutput;
+	const if (ColorMode == 1)
+		output.color = vec4[f32](1.0, 0.0, 0.0, 1.0);
+	else
+		output.color = vec4[f32](1.0, 1.0, 1.0, 1.0);
+
+	const if (UseHighlight)
+	{
+		let highlight: Highlight;
+		highlight.color = output.color;
+		output.color = highlight.color * 2.0;
+	}
+
+	return output;
+}
+
+[entry(vert)]
+fn vertMain() -> VertOutput
+{
+	let output: VertOutput;
+	output.position = GetVertexColor();
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::Ast::SanitizeVisitor::Options sanitizeOptions;
+	sanitizeOptions.partialSanitization = true;
+
+	shaderModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOptions);
+
+	nzsl::Ast::OptionUsageVisitor::Result optionUsage = nzsl::Ast::AnalyzeOptionUsage(*shaderModule);
+
+	auto SortedHashes = [](std::initializer_list<const char*> optionNames)
+	{
+		std::vector<nzsl::Ast::OptionHash> hashes;
+		for (const char* optionName : optionNames)
+			hashes.push_back(nzsl::Ast::HashOption(optionName));
+
+		std::sort(hashes.begin(), hashes.end());
+		return hashes;
+	};
+
+	auto Sorted = [](std::vector<nzsl::Ast::OptionHash> hashes)
+	{
+		std::sort(hashes.begin(), hashes.end());
+		return hashes;
+	};
+
+	REQUIRE(optionUsage.options.size() == 5);
+	REQUIRE(optionUsage.entryPoints.size() == 2);
+
+	const auto& fragEntry = optionUsage.entryPoints[0];
+	CHECK(fragEntry.functionName == "fragMain");
+	CHECK(fragEntry.stage == nzsl::ShaderStageType::Fragment);
+	CHECK(Sorted(fragEntry.options) == SortedHashes({ "ColorMode", "UseHighlight" }));
+
+	const auto& vertEntry = optionUsage.entryPoints[1];
+	CHECK(vertEntry.functionName == "vertMain");
+	CHECK(vertEntry.stage == nzsl::ShaderStageType::Vertex);
+	CHECK(Sorted(vertEntry.options) == SortedHashes({ "UseVertexColor" }));
+
+	CHECK(Sorted(optionUsage.GetStageOptions(nzsl::ShaderStageType::Fragment)) == SortedHashes({ "ColorMode", "UseHighlight" }));
+	CHECK(Sorted(optionUsage.moduleOptions) == SortedHashes({ "ColorMode", "UseHighlight", "UseOldMethod", "UseVertexColor" }));
+
+	WHEN("Partitioning option sets")
+	{
+		std::vector<std::unordered_map<nzsl::Ast::OptionHash, nzsl::Ast::ConstantValue>> optionSets = {
+			{ { nzsl::Ast::HashOption("ColorMode"), std::int32_t(0) }, { nzsl::Ast::HashOption("UseVertexColor"), false } },
+			{ { nzsl::Ast::HashOption("ColorMode"), std::int32_t(0) }, { nzsl::Ast::HashOption("UseVertexColor"), true } },
+			{ { nzsl::Ast::HashOption("ColorMode"), std::int32_t(1) }, { nzsl::Ast::HashOption("UseVertexColor"), false } },
+			{ { nzsl::Ast::HashOption("ColorMode"), std::int32_t(1) }, { nzsl::Ast::HashOption("UseVertexColor"), true } },
+		};
+
+		std::vector<std::size_t> fragClasses = nzsl::Ast::PartitionOptionSets(fragEntry.options, optionSets);
+		CHECK(fragClasses == std::vector<std::size_t>{ 0, 0, 2, 2 });
+
+		std::vector<std::size_t> vertClasses = nzsl::Ast::PartitionOptionSets(vertEntry.options, optionSets);
+		CHECK(vertClasses == std::vector<std::size_t>{ 0, 1, 0, 1 });
+	}
+
+	WHEN("Compiling permutations of a single stage")
+	{
+		nzsl::ShaderWriter::States states;
+		states.optimize = true;
+
+		nzsl::PermutationCompiler permutationCompiler(*shaderModule, states);
+
+		std::vector<nzsl::PermutationCompiler::OptionSet> optionSets = nzsl::PermutationCompiler::ExpandOptionSpace({
+			{ nzsl::Ast::HashOption("ColorMode"),      { std::int32_t(0), std::int32_t(1) } },
+			{ nzsl::Ast::HashOption("UseVertexColor"), { false, true } },
+			{ nzsl::Ast::HashOption("Unused"),         { false, true } },
+		});
+		REQUIRE(optionSets.size() == 8);
+
+		nzsl::PermutationCompiler::GlslOutput output = permutationCompiler.CompileGlsl(nzsl::ShaderStageType::Fragment, optionSets);
+		CHECK(output.generatedCount == 2);
+		CHECK(output.variants.size() == 2);
+	}
+}
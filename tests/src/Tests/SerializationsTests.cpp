@@ -1,4 +1,6 @@
 #include <Tests/ShaderUtils.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <NazaraUtils/Endianness.hpp>
 #include <NZSL/Serializer.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/LangWriter.hpp>
@@ -7,7 +9,9 @@
 #include <NZSL/Ast/Compare.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
 #include <cctype>
+#include <cstring>
 
 void ParseSerializeDeserialize(std::string_view sourceCode, bool sanitize)
 {
@@ -556,4 +560,179 @@ fn main()
 }
 )", false);
 	}
+
+	WHEN("reading the statement index and materializing only some statements")
+	{
+		std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+[export]
+struct Data
+{
+	value: f32
+}
+
+[export]
+fn Compute(data: Data) -> f32
+{
+	return data.value * 2.0;
+}
+
+fn Unused() -> f32
+{
+	return 42.0;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule;
+		REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
+
+		nzsl::Serializer serializer;
+		REQUIRE_NOTHROW(nzsl::Ast::SerializeShader(serializer, *shaderModule));
+
+		const std::vector<std::uint8_t>& data = serializer.GetData();
+
+		nzsl::Ast::ModuleIndex moduleIndex;
+		{
+			nzsl::Deserializer deserializer(data.data(), data.size());
+			REQUIRE_NOTHROW(moduleIndex = nzsl::Ast::DeserializeShaderIndex(deserializer));
+		}
+
+		REQUIRE(moduleIndex.statements.size() == 3);
+		CHECK(moduleIndex.statements[0].name == "Data");
+		CHECK(moduleIndex.statements[0].nodeType == nzsl::Ast::NodeType::DeclareStructStatement);
+		CHECK(moduleIndex.statements[0].isExported);
+		CHECK(moduleIndex.statements[1].name == "Compute");
+		CHECK(moduleIndex.statements[1].nodeType == nzsl::Ast::NodeType::DeclareFunctionStatement);
+		CHECK(moduleIndex.statements[1].isExported);
+		CHECK(moduleIndex.statements[2].name == "Unused");
+		CHECK_FALSE(moduleIndex.statements[2].isExported);
+
+		nzsl::Ast::ModulePtr partialModule;
+		{
+			std::vector<std::uint8_t> borrowedData = data;
+
+			nzsl::Deserializer deserializer(borrowedData.data(), borrowedData.size());
+			REQUIRE_NOTHROW(partialModule = nzsl::Ast::DeserializeShader(deserializer, [](const nzsl::Ast::ModuleIndex::StatementEntry& entry) { return entry.isExported; }));
+
+			// materialized nodes must not reference the deserialized data
+			std::fill(borrowedData.begin(), borrowedData.end(), std::uint8_t(0));
+		}
+
+		shaderModule->rootNode->statements.pop_back();
+		CHECK(nzsl::Ast::Compare(*shaderModule, *partialModule));
+	}
+
+	WHEN("materializing only the statements required by some symbols")
+	{
+		std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+[export]
+struct Data
+{
+	value: f32
+}
+
+fn Helper(data: Data) -> f32
+{
+	return data.value * 2.0;
+}
+
+[export]
+fn Compute(data: Data) -> f32
+{
+	return Helper(data) + 1.0;
+}
+
+fn Unused() -> f32
+{
+	return 42.0;
+}
+)";
+
+		// sanitized modules reference symbols by index (Compute calls Helper through its function index)
+		nzsl::Ast::ModulePtr shaderModule;
+		REQUIRE_NOTHROW(shaderModule = nzsl::Ast::Sanitize(*nzsl::Parse(sourceCode)));
+
+		nzsl::Serializer serializer;
+		REQUIRE_NOTHROW(nzsl::Ast::SerializeShader(serializer, *shaderModule));
+
+		const std::vector<std::uint8_t>& data = serializer.GetData();
+
+		nzsl::Ast::ModulePtr partialModule;
+		{
+			nzsl::Deserializer deserializer(data.data(), data.size());
+			REQUIRE_NOTHROW(partialModule = nzsl::Ast::DeserializeShader(deserializer, std::unordered_set<std::string>{ "Compute" }));
+		}
+
+		shaderModule->rootNode->statements.pop_back();
+		CHECK(nzsl::Ast::Compare(*shaderModule, *partialModule));
+	}
+
+	WHEN("reading a truncated or corrupted statement index")
+	{
+		std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+[export]
+fn Compute(value: f32) -> f32
+{
+	return value * 2.0;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule;
+		REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
+
+		nzsl::Serializer serializer;
+		REQUIRE_NOTHROW(nzsl::Ast::SerializeShader(serializer, *shaderModule));
+
+		std::vector<std::uint8_t> data = serializer.GetData();
+
+		nzsl::Ast::ModuleIndex moduleIndex;
+		{
+			nzsl::Deserializer deserializer(data.data(), data.size());
+			REQUIRE_NOTHROW(moduleIndex = nzsl::Ast::DeserializeShaderIndex(deserializer));
+		}
+		REQUIRE(moduleIndex.statements.size() == 1);
+
+		auto AcceptAll = [](const nzsl::Ast::ModuleIndex::StatementEntry& /*entry*/) { return true; };
+
+		AND_THEN("truncated data is rejected")
+		{
+			std::vector<std::uint8_t> truncatedData(data.begin(), data.begin() + data.size() / 2);
+
+			nzsl::Deserializer deserializer(truncatedData.data(), truncatedData.size());
+			CHECK_THROWS_AS(nzsl::Ast::DeserializeShader(deserializer, AcceptAll), std::runtime_error);
+		}
+
+		AND_THEN("an entry pointing outside of the data is rejected")
+		{
+			// Locate the index entry from its offset and size, and make it point past the end of the data
+			std::uint32_t entryData[2] = { Nz::SafeCast<std::uint32_t>(moduleIndex.statements[0].offset), Nz::SafeCast<std::uint32_t>(moduleIndex.statements[0].size) };
+			for (std::uint32_t& value : entryData)
+				value = Nz::HostToLittleEndian(value);
+
+			const std::uint8_t* entryBytes = reinterpret_cast<const std::uint8_t*>(entryData);
+			auto entryIt = std::search(data.begin(), data.end(), entryBytes, entryBytes + sizeof(entryData));
+			REQUIRE(entryIt != data.end());
+
+			std::uint32_t corruptedOffset = Nz::HostToLittleEndian(Nz::SafeCast<std::uint32_t>(data.size() + 16));
+			std::memcpy(&*entryIt, &corruptedOffset, sizeof(corruptedOffset));
+
+			{
+				nzsl::Deserializer deserializer(data.data(), data.size());
+				CHECK_THROWS_AS(nzsl::Ast::DeserializeShader(deserializer, AcceptAll), std::runtime_error);
+			}
+
+			{
+				nzsl::Deserializer deserializer(data.data(), data.size());
+				CHECK_THROWS_AS(nzsl::Ast::DeserializeShader(deserializer, std::unordered_set<std::string>{ "Compute" }), std::runtime_error);
+			}
+		}
+	}
 }
@@ -384,6 +384,25 @@ void ExpectSPIRV(const nzsl::Ast::Module& shaderModule, std::string_view expecte
 				HandleSourceError("SPIR-V", source, output);
 		}
 
+		SECTION("Generating function bodies in parallel")
+		{
+			nzsl::SpirvWriter::Environment parallelEnv = env;
+			parallelEnv.codegenThreadCount = 4;
+
+			nzsl::SpirvWriter parallelWriter;
+			parallelWriter.SetEnv(parallelEnv);
+
+			CHECK(parallelWriter.Generate(targetModule, options) == spirv);
+		}
+
+		SECTION("Printing SPIR-V to a callback")
+		{
+			std::string streamedOutput;
+			printer.Print(spirv.data(), spirv.size(), settings, [&](std::string_view text) { streamedOutput += text; });
+
+			CHECK(SanitizeSource(streamedOutput) == output);
+		}
+
 		SECTION("Validating full SPIR-V code (using libspirv)")
 		{
 			std::uint32_t spvVersion = env.spvMajorVersion * 100 + env.spvMinorVersion * 10;
@@ -411,7 +430,23 @@ void ExpectSPIRV(const nzsl::Ast::Module& shaderModule, std::string_view expecte
 				UNSCOPED_INFO(fullSpirv + "\n" + message);
 			});
 
-			REQUIRE(spirvTools.Validate(spirv));
+			// scalar block layout requires VK_EXT_scalar_block_layout, which has to be enabled explicitly in the validator
+			bool usesScalarLayout = false;
+
+			nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+			callbacks.onStructDeclaration = [&](const nzsl::Ast::DeclareStructStatement& structDecl)
+			{
+				if (structDecl.description.layout.HasValue() && structDecl.description.layout.GetResultingValue() == nzsl::Ast::MemoryLayout::Scalar)
+					usesScalarLayout = true;
+			};
+
+			nzsl::Ast::ReflectVisitor reflectVisitor;
+			reflectVisitor.Reflect(targetModule, callbacks);
+
+			spvtools::ValidatorOptions validatorOptions;
+			validatorOptions.SetScalarBlockLayout(usesScalarLayout);
+
+			REQUIRE(spirvTools.Validate(spirv.data(), spirv.size(), validatorOptions));
 		}
 	}
 }
@@ -0,0 +1,173 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/SpirV/SpirvPrinter.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+TEST_CASE("specialization constants", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option Intensity: f32 = 0.5;
+option UseColor: bool = false;
+option LightCount: u32 = u32(3);
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	const if (UseColor)
+		output.color = vec4[f32](1.0, 0.0, 0.0, 1.0);
+	else
+		output.color = vec4[f32](1.0, 1.0, 1.0, 1.0);
+
+	let lights: array[f32, LightCount];
+	lights[0] = Intensity;
+
+	output.color = output.color * lights[0];
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::SpirvWriter::Environment env;
+	env.optionsAsSpecializationConstants = true;
+
+	nzsl::ShaderWriter::States states;
+	states.optionValues[nzsl::Ast::HashOption("Intensity")] = 2.0f;
+
+	nzsl::SpirvWriter writer;
+	writer.SetEnv(env);
+
+	std::vector<std::uint32_t> spirv = writer.Generate(*shaderModule, states);
+
+	// UseColor and LightCount are read at compile-time (const if and array size) and must be baked in the module
+	const auto& specConstants = writer.GetSpecializationConstants();
+	REQUIRE(specConstants.size() == 1);
+	CHECK(specConstants[0].optionName == "Intensity");
+	CHECK(specConstants[0].optionHash == nzsl::Ast::HashOption("Intensity"));
+	CHECK(specConstants[0].specId == 0);
+	CHECK(specConstants[0].value == nzsl::Ast::ConstantValue(2.0f));
+
+	nzsl::SpirvPrinter printer;
+
+	nzsl::SpirvPrinter::Settings settings;
+	settings.printHeader = false;
+
+	std::string output = printer.Print(spirv.data(), spirv.size(), settings);
+	CHECK(output.find("Decoration(SpecId) 0") != std::string::npos);
+	CHECK(output.find("OpSpecConstant ") != std::string::npos);
+	CHECK(output.find("OpSpecConstantTrue") == std::string::npos);
+	CHECK(output.find("OpSpecConstantFalse") == std::string::npos);
+
+	// validate SPIR-V with libspirv
+	spvtools::SpirvTools spirvTools(spv_target_env::SPV_ENV_VULKAN_1_0);
+	CHECK(spirvTools.Validate(spirv));
+
+	WHEN("Disabling specialization constants")
+	{
+		writer.SetEnv({});
+		writer.Generate(*shaderModule, states);
+		CHECK(writer.GetSpecializationConstants().empty());
+	}
+}
+
+TEST_CASE("specialization constant types", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option Enabled: bool = true;
+option Inverted: bool = false;
+option Offset: i32 = -2;
+option Count: u32 = u32(4);
+option Scale: f32 = 1.5;
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let value = Scale;
+	if (Enabled && !Inverted)
+		value = value * f32(Offset) + f32(Count);
+
+	let output: Output;
+	output.color = vec4[f32](value, value, value, 1.0);
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::SpirvWriter::Environment env;
+	env.optionsAsSpecializationConstants = true;
+
+	nzsl::SpirvWriter writer;
+	writer.SetEnv(env);
+
+	std::vector<std::uint32_t> spirv = writer.Generate(*shaderModule);
+
+	const auto& specConstants = writer.GetSpecializationConstants();
+	REQUIRE(specConstants.size() == 5);
+
+	auto CheckSpecConstant = [&](std::size_t index, const char* optionName, const nzsl::Ast::ConstantValue& value)
+	{
+		INFO(optionName);
+		CHECK(specConstants[index].optionName == optionName);
+		CHECK(specConstants[index].optionHash == nzsl::Ast::HashOption(optionName));
+		CHECK(specConstants[index].specId == index);
+		CHECK(specConstants[index].value == value);
+	};
+
+	CheckSpecConstant(0, "Enabled", true);
+	CheckSpecConstant(1, "Inverted", false);
+	CheckSpecConstant(2, "Offset", std::int32_t(-2));
+	CheckSpecConstant(3, "Count", std::uint32_t(4));
+	CheckSpecConstant(4, "Scale", 1.5f);
+
+	nzsl::SpirvPrinter printer;
+
+	nzsl::SpirvPrinter::Settings settings;
+	settings.printHeader = false;
+	settings.printParameters = true;
+
+	std::string output = printer.Print(spirv.data(), spirv.size(), settings);
+	INFO(output);
+
+	CHECK(output.find("OpDecorate %16 Decoration(SpecId) 0") != std::string::npos);
+	CHECK(output.find("OpDecorate %17 Decoration(SpecId) 1") != std::string::npos);
+	CHECK(output.find("OpDecorate %18 Decoration(SpecId) 2") != std::string::npos);
+	CHECK(output.find("OpDecorate %19 Decoration(SpecId) 3") != std::string::npos);
+	CHECK(output.find("OpDecorate %20 Decoration(SpecId) 4") != std::string::npos);
+
+	CHECK(output.find("%2 = OpTypeInt 32 1") != std::string::npos);
+	CHECK(output.find("%3 = OpTypeInt 32 0") != std::string::npos);
+	CHECK(output.find("%16 = OpSpecConstantTrue %1") != std::string::npos);
+	CHECK(output.find("%17 = OpSpecConstantFalse %1") != std::string::npos);
+	CHECK(output.find("%18 = OpSpecConstant %2 'Value'(4294967294)") != std::string::npos); //< -2
+	CHECK(output.find("%19 = OpSpecConstant %3 'Value'(4)") != std::string::npos);
+	CHECK(output.find("%20 = OpSpecConstant %4 'Value'(1069547520)") != std::string::npos); //< 1.5f
+
+	// validate SPIR-V with libspirv
+	spvtools::SpirvTools spirvTools(spv_target_env::SPV_ENV_VULKAN_1_0);
+	spirvTools.SetMessageConsumer([&](spv_message_level_t /*level*/, const char* /*source*/, const spv_position_t& /*position*/, const char* message)
+	{
+		UNSCOPED_INFO(message);
+	});
+
+	CHECK(spirvTools.Validate(spirv));
+}
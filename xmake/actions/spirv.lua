@@ -445,11 +445,29 @@ namespace nzsl
 		}
 	};
 
+]])
+
+	sourceFile:write([[
+	template<std::size_t IndexCount, typename T, std::size_t N>
+	constexpr std::array<std::uint16_t, IndexCount> BuildInstructionIndices(const std::array<T, N>& instructions)
+	{
+		// opcode => instruction index + 1 (0 if opcode is unknown)
+		std::array<std::uint16_t, IndexCount> indices = {};
+		for (std::size_t i = 0; i < N; ++i)
+		{
+			std::uint16_t& index = indices[static_cast<std::size_t>(instructions[i].op)];
+			if (index == 0)
+				index = static_cast<std::uint16_t>(i + 1);
+		}
+
+		return indices;
+	}
+
 ]])
 
 	for _, grammarData in pairs(grammars) do
 		sourceFile:write([[
-	static std::array<Spirv]] .. grammarData.Prefix .. [[Instruction, ]] .. grammarData.InstructionCount .. [[> s_instructions]] .. grammarData.Prefix .. [[ = {
+	static constexpr std::array<Spirv]] .. grammarData.Prefix .. [[Instruction, ]] .. grammarData.InstructionCount .. [[> s_instructions]] .. grammarData.Prefix .. [[ = {
 		{
 ]])
 
@@ -474,6 +492,8 @@ namespace nzsl
 		}
 	};
 
+	static constexpr auto s_instructionIndices]] .. grammarData.Prefix .. [[ = BuildInstructionIndices<static_cast<std::size_t>(s_instructions]] .. grammarData.Prefix .. [[.back().op) + 1>(s_instructions]] .. grammarData.Prefix .. [[);
+
 ]])
 	end
 
@@ -520,11 +540,14 @@ namespace nzsl
 
 	const Spirv]] .. grammarData.Prefix .. [[Instruction* GetSpirv]] .. grammarData.Prefix .. [[Instruction(std::uint16_t op)
 	{
-		auto it = std::lower_bound(std::begin(s_instructions]] .. grammarData.Prefix .. [[), std::end(s_instructions]] .. grammarData.Prefix .. [[), op, [](const Spirv]] .. grammarData.Prefix .. [[Instruction& inst, std::uint16_t op) { return std::uint16_t(inst.op) < op; });
-		if (it != std::end(s_instructions]] .. grammarData.Prefix .. [[) && std::uint16_t(it->op) == op)
-			return &*it;
-		else
+		if (op >= s_instructionIndices]] .. grammarData.Prefix .. [[.size())
 			return nullptr;
+
+		std::uint16_t index = s_instructionIndices]] .. grammarData.Prefix .. [[[op];
+		if (index == 0)
+			return nullptr;
+
+		return &s_instructions]] .. grammarData.Prefix .. [[[index - 1];
 	}
 ]])
 	end